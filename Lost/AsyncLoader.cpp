@@ -0,0 +1,202 @@
+#include "AsyncLoader.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lost
+{
+
+	// Loads move from queued, to loading (on a worker), to loaded (waiting for the main thread to finish them)
+	static std::deque<_AsyncLoad*> s_QueuedLoads;
+	static std::vector<_AsyncLoad*> s_LoadingLoads;
+	static std::deque<_AsyncLoad*> s_LoadedLoads;
+
+	static std::mutex s_LoaderMutex;
+	static std::condition_variable s_LoadQueued;   // Wakes the workers
+	static std::condition_variable s_LoadFinished; // Wakes waitForAsyncLoads()
+
+	static std::vector<std::thread> s_LoaderWorkers;
+	static bool s_StoppingLoader = false;
+
+	static float s_AsyncLoadBudget = 2.0f; // In milliseconds
+
+	static void asyncLoadWorker()
+	{
+		std::unique_lock<std::mutex> lock(s_LoaderMutex);
+		while (true)
+		{
+			s_LoadQueued.wait(lock, [] { return s_StoppingLoader || !s_QueuedLoads.empty(); });
+			if (s_StoppingLoader)
+				return;
+
+			_AsyncLoad* load = s_QueuedLoads.front();
+			s_QueuedLoads.pop_front();
+			s_LoadingLoads.push_back(load);
+
+			// Counted as busy so loads that split their work with _parallelRanges() don't take more than their share of threads
+			lock.unlock();
+			_parallelBusyThreads().fetch_add(1, std::memory_order_relaxed);
+			_parallelThreadIsBusy() = true;
+			load->load();
+			_parallelThreadIsBusy() = false;
+			_parallelBusyThreads().fetch_sub(1, std::memory_order_relaxed);
+			lock.lock();
+
+			// If the target was destroyed while this was loading, the load was taken out of the list and is only deleted here
+			std::vector<_AsyncLoad*>::iterator loading = std::find(s_LoadingLoads.begin(), s_LoadingLoads.end(), load);
+			bool cancelled = loading == s_LoadingLoads.end();
+			if (!cancelled)
+			{
+				s_LoadingLoads.erase(loading);
+				s_LoadedLoads.push_back(load);
+			}
+			s_LoadFinished.notify_all();
+
+			// Loads are never deleted while the lock is held, so their destructors are free to use the loader
+			if (cancelled)
+			{
+				lock.unlock();
+				delete load;
+				lock.lock();
+			}
+		}
+	}
+
+	void _queueAsyncLoad(_AsyncLoad* load)
+	{
+		std::lock_guard<std::mutex> lock(s_LoaderMutex);
+
+		// Leave a thread for the main thread, loading is mostly waiting on the disk so a few workers is plenty
+		if (s_LoaderWorkers.empty())
+		{
+			unsigned int hardwareThreads = std::thread::hardware_concurrency();
+			unsigned int workerCount = std::min(std::max(hardwareThreads, 2u) - 1, 4u);
+			for (unsigned int i = 0; i < workerCount; i++)
+				s_LoaderWorkers.emplace_back(asyncLoadWorker);
+		}
+
+		s_QueuedLoads.push_back(load);
+		s_LoadQueued.notify_one();
+	}
+
+	void _cancelAsyncLoads(void* target)
+	{
+		// Nothing has ever been loaded asynchronously, which is most targets being destroyed
+		if (s_LoaderWorkers.empty())
+			return;
+
+		std::vector<_AsyncLoad*> cancelledLoads;
+		{
+			std::lock_guard<std::mutex> lock(s_LoaderMutex);
+
+			auto takeTargets = [target, &cancelledLoads](_AsyncLoad* load)
+			{
+				if (load->getTarget() != target)
+					return false;
+				cancelledLoads.push_back(load);
+				return true;
+			};
+
+			s_QueuedLoads.erase(std::remove_if(s_QueuedLoads.begin(), s_QueuedLoads.end(), takeTargets), s_QueuedLoads.end());
+			s_LoadedLoads.erase(std::remove_if(s_LoadedLoads.begin(), s_LoadedLoads.end(), takeTargets), s_LoadedLoads.end());
+
+			// The workers delete these once they're done with them
+			s_LoadingLoads.erase(std::remove_if(s_LoadingLoads.begin(), s_LoadingLoads.end(), [target](_AsyncLoad* load) { return load->getTarget() == target; }), s_LoadingLoads.end());
+		}
+
+		for (_AsyncLoad* load : cancelledLoads)
+			delete load;
+	}
+
+	// Takes the next load that's ready to be finished, nullptr if there aren't any
+	static _AsyncLoad* takeLoadedLoad()
+	{
+		std::lock_guard<std::mutex> lock(s_LoaderMutex);
+		if (s_LoadedLoads.empty())
+			return nullptr;
+
+		_AsyncLoad* load = s_LoadedLoads.front();
+		s_LoadedLoads.pop_front();
+		return load;
+	}
+
+	void _finishAsyncLoads()
+	{
+		if (s_LoaderWorkers.empty())
+			return;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (_AsyncLoad* load = takeLoadedLoad())
+		{
+			load->finish();
+			delete load;
+
+			std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			if (elapsed.count() >= s_AsyncLoadBudget)
+				break;
+		}
+	}
+
+	void _exitAsyncLoader()
+	{
+		if (s_LoaderWorkers.empty())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(s_LoaderMutex);
+			s_StoppingLoader = true;
+			s_LoadQueued.notify_all();
+		}
+
+		// Workers finish the load they're on before stopping, which moves it into the loaded list
+		for (std::thread& worker : s_LoaderWorkers)
+			worker.join();
+		s_LoaderWorkers.clear();
+		s_StoppingLoader = false;
+
+		for (_AsyncLoad* load : s_QueuedLoads)
+			delete load;
+		for (_AsyncLoad* load : s_LoadedLoads)
+			delete load;
+		s_QueuedLoads.clear();
+		s_LoadedLoads.clear();
+	}
+
+	void setAsyncLoadBudget(float milliseconds)
+	{
+		s_AsyncLoadBudget = milliseconds;
+	}
+
+	unsigned int getAsyncLoadCount()
+	{
+		std::lock_guard<std::mutex> lock(s_LoaderMutex);
+		return (unsigned int)(s_QueuedLoads.size() + s_LoadingLoads.size() + s_LoadedLoads.size());
+	}
+
+	void waitForAsyncLoads()
+	{
+		if (s_LoaderWorkers.empty())
+			return;
+
+		while (true)
+		{
+			while (_AsyncLoad* load = takeLoadedLoad())
+			{
+				load->finish();
+				delete load;
+			}
+
+			std::unique_lock<std::mutex> lock(s_LoaderMutex);
+			if (s_QueuedLoads.empty() && s_LoadingLoads.empty() && s_LoadedLoads.empty())
+				return;
+
+			s_LoadFinished.wait(lock, [] { return !s_LoadedLoads.empty() || (s_QueuedLoads.empty() && s_LoadingLoads.empty()); });
+		}
+	}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+namespace lost
+{
+
+	// An asset being loaded in the background, split into the work that can be done on any thread and the work that has to be on the main one
+	// The target it's loading into is given out straight away, and shows as a placeholder until finish() runs
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _AsyncLoad
+	{
+	public:
+		_AsyncLoad(void* target) : m_Target(target) {};
+		virtual ~_AsyncLoad() {};
+
+		// Ran on one of the loader's worker threads, reads and decodes the asset without touching OpenGL or the target
+		virtual void load() = 0;
+		// Ran on the main thread once load() is done, uploads the asset and moves it into the target
+		// Never ran if the target was destroyed first, in which case the load is just deleted
+		virtual void finish() = 0;
+
+		inline void* getTarget() const { return m_Target; };
+	private:
+		void* m_Target;
+	};
+
+	// Hands the load to the worker threads, starting them if they aren't already, the loader owns and deletes the load from now on
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _queueAsyncLoad(_AsyncLoad* load);
+	// Drops any loads into the target given, must be ran before the target is destroyed
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _cancelAsyncLoads(void* target);
+	// Finishes loads the workers are done with until the frame's budget is used up, ran once per frame
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _finishAsyncLoads();
+	// Stops the worker threads and drops every load that hasn't finished
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _exitAsyncLoader();
+
+	// Sets how long the main thread can spend finishing loads each frame (uploading them to the GPU), by default 2ms
+	// At least one load is always finished per frame so loading can't stall, even if it takes longer than the budget
+	void setAsyncLoadBudget(float milliseconds);
+	// Returns the amount of loads that haven't finished yet
+	unsigned int getAsyncLoadCount();
+	// Blocks until every load has finished, useful for loading screens which need everything before starting
+	void waitForAsyncLoads();
+
+}
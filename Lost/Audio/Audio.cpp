@@ -1,13 +1,14 @@
 #include "Audio.h"
 #include "../Log.h"
-#include "../DeltaTime.h"
 
 #include "ResourceManagers/AudioResourceManagers.h"
+#include "Mixer.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <vector>
 
-typedef short _ChannelQuality;
+#include <atomic>
 
 namespace lost
 {
@@ -15,245 +16,473 @@ namespace lost
 	class _Sound;
 	class _SoundStream;
 
-	struct SamplerPassInInfo
+	static const unsigned int s_MaxVoices = LOST_MAX_VOICES;
+	static_assert(LOST_MAX_VOICES > 0 && LOST_MAX_VOICES <= 0xFFFF, "LOST_MAX_VOICES must fit in the 16 bits a VoiceHandle keeps for it");
+	static const unsigned int s_AudioCommandCapacity = 256; // The amount of commands that can wait for the audio thread before they're held back on the main thread
+
+	// Voice positions and steps are in source frames, 32.32 fixed point so long sounds don't drift
+	static const uint64_t s_ResampleUnity = 1ull << 32;
+	static const uint64_t s_MaxResampleStep = 8ull << 32; // The scratch buffer is sized for reading 8 source frames per frame played
+	static const uint64_t s_MinResampleStep = 1ull << 24;
+	static const unsigned int s_FallbackSampleRate = 44100; // Used if the device doesn't say what rate it runs at
+
+	// A message from the main thread to the audio thread, the audio thread applies these at the start of every callback
+	struct _AudioCommand
 	{
-		_HaltWrite<std::vector<PlaybackSound*>> activeSounds;
-		_HaltWrite<std::vector<_SoundStream*>>  activeStreams;
+		enum Type : unsigned char
+		{
+			PlayVoice,
+			StopVoice,
+			SetVoiceVolume,
+			SetVoicePanning,
+			SetVoiceRate,
+			SetVoicePaused,
+			SetMasterVolume
+		};
+
+		Type type;
+		unsigned int voice;      // The slot of the voice the command is for
+		unsigned int generation; // Which play of the slot the command is for, so commands for a finished voice don't effect the next one
+		float volume;
+		float panning;
+		float rate;              // PlayVoice and SetVoiceRate, the playback rate on top of the sound's sample rate
+		ResampleQuality quality; // PlayVoice only
+		bool paused;             // SetVoicePaused only
+		_PlaybackData playback;  // PlayVoice for sounds only, the audio thread keeps it's own copy
+		_SoundStream* stream;    // PlayVoice for sound streams only
 	};
 
-	int playRaw(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
-		double streamTime, RtAudioStreamStatus status, void* data)
+	// A sound or sound stream being played, only ever touched by the audio thread
+	struct _Voice
 	{
+		unsigned int generation = 0; // 0 while the voice isn't playing
+		_PlaybackData playback;
+		_SoundStream* stream = nullptr;
+		float volume = 1.0f;
+		float panning = 0.0f;
+		_VoiceGains gains;
+		bool paused = false; // Paused voices keep their place but aren't mixed
+
+		// Sound streams keep their position relative to the stream's window, see readStreamFrames()
+		uint64_t position = 0;      // The source frame being played, 32.32 fixed point
+		uint64_t step = s_ResampleUnity; // Source frames moved per frame played, 32.32 fixed point
+		float rate = 1.0f;
+		ResampleQuality quality = LOST_RESAMPLE_SINC;
+		bool looped = false;        // Sounds only, once the sound has looped frames before it's start are read from it's end
+	};
 
-		// This will compile all sounds and soundstreams into one buffer
-		
-		// Since the audio is on a different thread we need to make sure we don't run into any
-		// race conditions. We can use mutex to do this
+	struct SamplerPassInInfo
+	{
+		// Main thread to audio thread
+		_WaitFreeQueue<_AudioCommand, s_AudioCommandCapacity> commands;
+		// Audio thread to main thread, the generation of each voice is written here once the audio thread has stopped using it
+		std::atomic<unsigned int> finishedVoices[s_MaxVoices];
+
+		// Owned by the audio thread once the stream is started, sized by AudioHandler::init() so mixing never allocates
+		_Voice voices[s_MaxVoices];
+		float masterVolume = 1.0f;
+		RtAudioFormat format = RTAUDIO_SINT16;
+		unsigned int sampleRate = s_FallbackSampleRate;
+		_MixBuffer bus;       // Interleaved stereo, every voice is added into this
+		_MixBuffer samples;   // The current voice's samples decoded into floats, big enough for the widest resampling window
+		_MixBuffer resampled; // The current voice's samples once resampled to the device's rate
+	};
 
-		// Solution of race conditions:
-		// Update function is ran:
-		//  > Main thread will pause when audio thread is using main_sounddata
-		//  > It will check the status of each sound
-		//  > Then it will remove ownership of main_sounddata
-		// When sound is added or removed:
-		//  > Main thread will pause when audio thread is using main_sounddata
-		//  > Then it will take ownership of the main_sounddata
-		//  > Then it will add / remove the sound
-		//  > Then remove ownership of main_sounddata
-		// When this function is ran:
-		// 
-		// All sounds are ran with audio_sounddata, this lets audio work while the main thread is adding sounds
-		// 
-		// Note: audio_sounddata is never accessed by the main thread, and so the audio thread owns it completely.
-		
-		// The sounds may be in different PCM formats, we will need to convert them into the same as this one
-		// It should be processed beforehand
+	// Works out how many source frames a voice moves through per frame played
+	static uint64_t calculateStep(unsigned int sourceRate, unsigned int deviceRate, float rate)
+	{
+		// Exactly 1 when nothing needs resampling, so the voice can be decoded straight into the mix
+		if ((sourceRate == 0 || sourceRate == deviceRate) && rate == 1.0f)
+			return s_ResampleUnity;
+
+		double step = (sourceRate == 0 ? 1.0 : (double)sourceRate / deviceRate) * rate * (double)s_ResampleUnity;
+		if (!(step >= (double)s_MinResampleStep))
+			return s_MinResampleStep;
+		if (step > (double)s_MaxResampleStep)
+			return s_MaxResampleStep;
+		return (uint64_t)step;
+	}
 
-		// Eg. Sound format is 32-PCM and out is 16-PCM
-		// Sound in >> 16 (Bitshift the input 16 bits to the right)
-		// Eg. Sound format is 8-PCM and out is 16-PCM
-		// Sound in << 8 (Bitshift the input 8 bits to the left)
+	// Decodes up to "frameCount" frames of a sound into "out", handling looping
+	// Returns the amount of frames decoded, which is less than asked for once the sound has finished
+	static unsigned int readSoundFrames(_PlaybackData& playbackData, unsigned int frameCount, float* out)
+	{
+		const unsigned int frameBytes = playbackData.bytesPerSample * playbackData.channelCount;
+		if (frameBytes == 0 || playbackData.dataCount < frameBytes)
+			return 0;
 
-		// The "middle man" format will need to be the maximum that RtAudio supports
-		// which is 32 bits/an integer
+		unsigned int framesRead = 0;
+		while (framesRead < frameCount)
+		{
+			unsigned int framesLeft = (playbackData.dataCount - playbackData.currentByte) / frameBytes;
+			unsigned int framesToRead = framesLeft < frameCount - framesRead ? framesLeft : frameCount - framesRead;
 
-		SamplerPassInInfo* inData = (SamplerPassInInfo*)data;
-		
-		// Will ALWAYS be 2!!!
-		const unsigned int channelCount = 2;
-		const float volumeDecrement = 1.0f / 4.0f; // The second number is prefered to be a power of 2
+			_decodeSamples(playbackData.data + playbackData.currentByte, playbackData.bytesPerSample, framesToRead * playbackData.channelCount, out + framesRead * playbackData.channelCount);
+			playbackData.currentByte += framesToRead * frameBytes;
+			framesRead += framesToRead;
 
-		_ChannelQuality* outData = (_ChannelQuality*)outputBuffer;
-		unsigned int outDataCapacity = sizeof(_ChannelQuality) * nBufferFrames * channelCount;
+			// Reached the end of the data, either go back to the start or finish
+			if (playbackData.currentByte + frameBytes > playbackData.dataCount)
+			{
+				if (playbackData.loopCount == 0)
+				{
+					playbackData.currentByte = playbackData.dataCount;
+					break;
+				}
 
-		memset((char*)outputBuffer, 0, outDataCapacity);
+				playbackData.currentByte = 0;
+				if (playbackData.loopCount != UINT_MAX)
+					playbackData.loopCount--;
+			}
+		}
+		return framesRead;
+	}
 
-		// [----------------------]
-		//       Update Sounds
-		// [----------------------]
+	// Decodes "frameCount" frames of a sound starting at "firstFrame", which may be outside of the sound
+	// Frames past either end are wrapped around if the sound loops there, otherwise they're silent
+	static void decodeSoundWindow(const _PlaybackData& playbackData, int64_t firstFrame, unsigned int frameCount, bool wrapStart, float* out)
+	{
+		const unsigned int channelCount = playbackData.channelCount;
+		const unsigned int frameBytes = playbackData.bytesPerSample * channelCount;
+		const int64_t totalFrames = playbackData.dataCount / frameBytes;
+		const bool wrapEnd = playbackData.loopCount != 0;
 
-		std::vector<PlaybackSound*> sounds = inData->activeSounds.read();
-		for (unsigned int i = 0; i < sounds.size(); i++)
+		unsigned int framesDone = 0;
+		while (framesDone < frameCount)
 		{
-			_PlaybackData& playbackData = sounds.at(i)->_getPlaybackData();
+			int64_t frame = firstFrame + framesDone;
+			if ((frame < 0 && wrapStart) || (frame >= totalFrames && wrapEnd))
+			{
+				frame %= totalFrames;
+				if (frame < 0)
+					frame += totalFrames;
+			}
 
-			unsigned int inFormatSize = playbackData.bytesPerSample;
-			int formatFactor = playbackData.formatFactor;
+			unsigned int framesLeft = frameCount - framesDone;
+			if (frame < 0 || frame >= totalFrames)
+			{
+				// Silent until the sound starts, or for the rest of the window
+				unsigned int silentFrames = frame < 0 && -frame < framesLeft ? (unsigned int)-frame : framesLeft;
+				memset(out + framesDone * channelCount, 0, silentFrames * channelCount * sizeof(float));
+				framesDone += silentFrames;
+				continue;
+			}
 
-			int inChannelCount = playbackData.channelCount;
+			unsigned int framesToRead = totalFrames - frame < framesLeft ? (unsigned int)(totalFrames - frame) : framesLeft;
+			_decodeSamples(playbackData.data + frame * frameBytes, playbackData.bytesPerSample, framesToRead * channelCount, out + framesDone * channelCount);
+			framesDone += framesToRead;
+		}
+	}
 
-			unsigned int mask = 0;
-			bool isSigned = true;
-			switch (inFormatSize)
+	// Resamples up to "frameCount" frames of a voice's sound into "out" at the voice's step, handling looping
+	// "window" is scratch space for the source frames, returns the amount of frames played like readSoundFrames()
+	static unsigned int resampleSoundFrames(_Voice& voice, unsigned int frameCount, float* window, float* out)
+	{
+		_PlaybackData& playbackData = voice.playback;
+		const unsigned int channelCount = playbackData.channelCount;
+		const unsigned int frameBytes = playbackData.bytesPerSample * channelCount;
+		if (frameBytes == 0 || playbackData.dataCount < frameBytes)
+			return 0;
+
+		const uint64_t end = (uint64_t)(playbackData.dataCount / frameBytes) << 32;
+
+		unsigned int framesPlayed = 0;
+		while (framesPlayed < frameCount && voice.position < end)
+		{
+			// Only play up to the end of the sound at once, so a loop can wrap around
+			uint64_t framesLeft = (end - voice.position + voice.step - 1) / voice.step;
+			unsigned int framesToPlay = framesLeft < frameCount - framesPlayed ? (unsigned int)framesLeft : frameCount - framesPlayed;
+
+			// Every source frame the filter touches, from _ResamplerHalfTaps - 1 before the first frame to _ResamplerHalfTaps + 1 after the last
+			uint32_t fraction = (uint32_t)voice.position;
+			int64_t firstFrame = (int64_t)(voice.position >> 32) - (_ResamplerHalfTaps - 1);
+			unsigned int windowFrames = (unsigned int)((fraction + voice.step * (framesToPlay - 1)) >> 32) + _ResamplerHalfTaps * 2 + 1;
+
+			decodeSoundWindow(playbackData, firstFrame, windowFrames, voice.looped, window);
+			_resample(window, channelCount, fraction, voice.step, framesToPlay, out + framesPlayed * channelCount, voice.quality);
+			voice.position += voice.step * framesToPlay;
+			framesPlayed += framesToPlay;
+
+			// Reached the end of the data, either go back to the start or finish
+			if (voice.position >= end && playbackData.loopCount != 0)
 			{
-			case 1:
-				//isSigned = false;
-				//mask = 0x000000FF;
-				//break; 
-				sounds.at(i)->_setIsPlaying();
-				continue; // Skip to the next sound, currently there's no support for this
-			case 2:
-				mask = 0x0000FFFF;
-				break;
-			case 3:
-				mask = 0x00FFFFFF;
-				break;
-			case 4:
-				mask = 0xFFFFFFFF;
-				break;
-			default:
-				break;
+				voice.position %= end;
+				voice.looped = true;
+				if (playbackData.loopCount != UINT_MAX)
+					playbackData.loopCount--;
 			}
+		}
+		return framesPlayed;
+	}
 
-			unsigned int bytesLeft = playbackData.loopCount > 0 ? UINT_MAX : playbackData.dataCount - playbackData.currentByte;
-			if (bytesLeft == 0)
-				continue;
-			
-			// Checks if the amount of data left in the raw sound is enough to fill the buffer
-			// byteWrite is the amount of samples it will write into the outBuffer
-			bool fillsBuffer = nBufferFrames * channelCount < bytesLeft / inFormatSize * channelCount / inChannelCount;
-			unsigned int sampleWrite = fillsBuffer ? nBufferFrames * channelCount : bytesLeft / inFormatSize * channelCount / inChannelCount;
+	// Plays up to "frameCount" frames of a voice's sound stream into "out" at the voice's step
+	// Fewer are played if the stream loader has fallen behind, "finished" is set once the last of the stream's data is played
+	static unsigned int readStreamFrames(_Voice& voice, unsigned int frameCount, float* out, bool& finished)
+	{
+		_SoundStream& stream = *voice.stream;
+		const unsigned int channelCount = stream._getSoundInfo().channelCount;
+
+		// Frames the filter can't reach anymore are dropped, leaving the position inside of the window's first frame
+		stream._consumeWindow((unsigned int)(voice.position >> 32));
+		voice.position &= 0xFFFFFFFFull;
+		const uint32_t fraction = (uint32_t)voice.position;
+
+		// Every window frame the filter touches, up to _ResamplerHalfTaps + 1 after the last frame played
+		stream._fillWindow((unsigned int)((fraction + voice.step * (frameCount - 1)) >> 32) + _ResamplerHalfTaps * 2 + 1);
+
+		// Frame "n" reads up to window frame ((fraction + step * n) >> 32) + _ResamplerHalfTaps * 2, only what the window covers is played
+		const unsigned int windowFrames = stream._getWindowFrames();
+		uint64_t framesCovered = 0;
+		if (windowFrames > _ResamplerHalfTaps * 2)
+			framesCovered = (((uint64_t)(windowFrames - _ResamplerHalfTaps * 2) << 32) - fraction + voice.step - 1) / voice.step;
+
+		// Frame "n" plays window frame ((fraction + step * n) >> 32) + _ResamplerHalfTaps - 1, which has to be before the end of the data
+		uint64_t framesLeft = ~0ull;
+		const unsigned int windowEnd = stream._getWindowEnd();
+		if (windowEnd != UINT_MAX)
+		{
+			uint64_t end = windowEnd >= _ResamplerHalfTaps - 1 ? (uint64_t)(windowEnd - (_ResamplerHalfTaps - 1)) << 32 : 0;
+			framesLeft = end > fraction ? (end - fraction + voice.step - 1) / voice.step : 0;
+		}
 
-			float volume = sounds.at(i)->_getVolume() * volumeDecrement * getMasterVolume();
-			float panning = fmaxf(fminf(sounds.at(i)->_getPanning(), 1.0f), -1.0f);
+		unsigned int framesToPlay = framesCovered < frameCount ? (unsigned int)framesCovered : frameCount;
+		finished = framesLeft <= framesToPlay;
+		if (finished)
+			framesToPlay = (unsigned int)framesLeft;
 
-			for (int sample = 0; sample < sampleWrite / channelCount; sample++)
-			{
+		if (voice.step == s_ResampleUnity && fraction == 0)
+		{
+			// Nothing to resample, copied out as the mix needs aligned samples
+			memcpy(out, stream._getWindow() + (_ResamplerHalfTaps - 1) * channelCount, framesToPlay * channelCount * sizeof(float));
+		}
+		else
+			_resample(stream._getWindow(), channelCount, fraction, voice.step, framesToPlay, out, voice.quality);
 
-				_ChannelQuality channelOutputs[channelCount];
+		voice.position += voice.step * framesToPlay;
+		return framesToPlay;
+	}
 
-				// Calculate the per channel data
-				for (int channel = 0; channel < channelCount; channel++)
-				{
-					// Get the amount of bytes to go through the data for this sample
-					unsigned int sampleOffset = playbackData.currentByte + (sample * inChannelCount + (inChannelCount == 2 ? channel : 0)) * inFormatSize;
-
-					// Loop sound read offset
-					if (playbackData.loopCount > 0 && sampleOffset > playbackData.dataCount)
-					{
-						playbackData.currentByte -= playbackData.dataCount;
-						sampleOffset = sampleOffset % playbackData.dataCount;
-						if (playbackData.loopCount != UINT_MAX)
-							playbackData.loopCount--;
-					}
-
-					// The value of the sample cast to an integer, doesn't scale to fit range
-					int outSample = (*(int*)(playbackData.data + sampleOffset) & mask);
-
-					// Scale output and store it for pan processing, apply volume here
-					if (formatFactor >= 0)
-						channelOutputs[channel] = (_ChannelQuality)(outSample >> (formatFactor * 8)) * volume;
-					else
-						channelOutputs[channel] = (_ChannelQuality)(outSample << (-formatFactor * 8)) * volume;
-				}
+	// Frees the voice and lets the main thread know it's done with it
+	static void finishVoice(SamplerPassInInfo* inData, unsigned int voice)
+	{
+		// Release so the main thread only reuses the voice's sound stream after the audio thread is done reading it
+		inData->finishedVoices[voice].store(inData->voices[voice].generation, std::memory_order_release);
+		inData->voices[voice].generation = 0;
+		inData->voices[voice].stream = nullptr;
+	}
+
+	// Decodes the next block of a voice and adds it into the bus, finishing the voice if it runs out
+	// Fading out ramps the voice to silence across the block, so stopping, pausing or replacing it doesn't click
+	static void mixVoice(SamplerPassInInfo* inData, unsigned int index, unsigned int frameCount, bool fadeOut)
+	{
+		const float volumeDecrement = 1.0f / 4.0f; // The second number is prefered to be a power of 2
+
+		_Voice& voice = inData->voices[index];
+		float* samples = inData->samples.data();
+
+		unsigned int voiceChannelCount = 0;
+		unsigned int framesRead = 0;
+		const float* voiceSamples = samples;
+		float volume = voice.volume;
+		bool finished = false;
+
+		if (!voice.stream)
+		{
+			// [----------------------]
+			//       Update Sounds
+			// [----------------------]
 
-				// This is the amount to merge the right channel into the left channel
-				float leftPanAmount  = -fminf(panning, 0.0f) * PI / 2.0f;
-				float rightPanAmount =  fmaxf(panning, 0.0f) * PI / 2.0f;
+			_PlaybackData& playbackData = voice.playback;
+			voiceChannelCount = playbackData.channelCount;
 
-				// Apply pan
-				outData[sample * channelCount + 0] += channelOutputs[0] * fmaxf(sinf(leftPanAmount),  0.0f);
-				outData[sample * channelCount + 1] += channelOutputs[0] * fmaxf(cosf(leftPanAmount),  0.0f);
-				outData[sample * channelCount + 1] += channelOutputs[1] * fmaxf(sinf(rightPanAmount), 0.0f);
-				outData[sample * channelCount + 0] += channelOutputs[1] * fmaxf(cosf(rightPanAmount), 0.0f);
+			// 8 bit sounds are unsigned and currently aren't supported, so they're stopped straight away
+			if (playbackData.bytesPerSample < 2 || playbackData.bytesPerSample > 4 || voiceChannelCount < 1 || voiceChannelCount > 2)
+			{
+				finishVoice(inData, index);
+				return;
 			}
 
-			// Seek to the next data we need to read, if it's the end of the data and we've finished looping, stop the sound
-			if (playbackData.currentByte + sampleWrite * inFormatSize / channelCount * inChannelCount < playbackData.dataCount - 1)
-				playbackData.currentByte += sampleWrite * inFormatSize / channelCount * inChannelCount;
-			else if (playbackData.loopCount == 0)
+			if (voice.step == s_ResampleUnity && (uint32_t)voice.position == 0)
 			{
-				playbackData.currentByte = playbackData.dataCount;
-				sounds.at(i)->_setIsPlaying();
+				// Nothing to resample, the sound is decoded straight into the mix
+				const unsigned int frameBytes = playbackData.bytesPerSample * voiceChannelCount;
+				uint64_t startPosition = voice.position;
+				playbackData.currentByte = (unsigned int)(voice.position >> 32) * frameBytes;
+				framesRead = readSoundFrames(playbackData, frameCount, samples);
+				voice.position = (uint64_t)(playbackData.currentByte / frameBytes) << 32;
+				voice.looped |= voice.position < startPosition;
 			}
+			else
+			{
+				framesRead = resampleSoundFrames(voice, frameCount, samples, inData->resampled.data());
+				voiceSamples = inData->resampled.data();
+			}
+			finished = framesRead < frameCount;
+			volume *= volumeDecrement;
 		}
-
-		// [----------------------]
-		//   Update Sound Streams
-		// [----------------------]
-
-		std::vector<_SoundStream*> streams = inData->activeStreams.read();
-		for (unsigned int i = 0; i < streams.size(); i++)
+		else
 		{
-			_SoundStream& stream = *streams.at(i);
-			const _SoundInfo& streamInfo = stream._getSoundInfo();
+			// [----------------------]
+			//   Update Sound Streams
+			// [----------------------]
 
-			unsigned int inFormatSize = streamInfo.bitsPerSample / 8;
-			int formatFactor = stream._getFormatFactor();
+			_SoundStream& stream = *voice.stream;
+			const _SoundInfo& streamInfo = stream._getSoundInfo();
 
-			int inChannelCount = stream._getSoundInfo().channelCount;
+			unsigned int bytesPerSample = streamInfo.bitsPerSample / 8;
+			voiceChannelCount = streamInfo.channelCount;
 
-			unsigned int mask = 0;
-			bool isSigned = true;
-			switch (inFormatSize)
+			if (bytesPerSample < 2 || bytesPerSample > 4 || voiceChannelCount < 1 || voiceChannelCount > 2)
 			{
-			case 1:
-				//isSigned = false;
-				//mask = 0x000000FF;
-				//break; 
-				stream._setIsPlaying(false);
-				continue; // Skip to the next sound, currently there's no support for this
-			case 2:
-				mask = 0x0000FFFF;
-				break;
-			case 3:
-				mask = 0x00FFFFFF;
-				break;
-			case 4:
-				mask = 0xFFFFFFFF;
-				break;
-			default:
-				break;
+				finishVoice(inData, index);
+				return;
 			}
 
-			// Figure out how many samples to write (samples * channels)
-			unsigned int bytesLeft = stream._getBytesLeftToPlay();
-			unsigned int sampleWrite = nBufferFrames * channelCount < bytesLeft / inFormatSize ? nBufferFrames * channelCount : bytesLeft / inFormatSize;
+			// We don't need to do loop processing here as it is done by _getNextDataBlock()
+			framesRead = readStreamFrames(voice, frameCount, inData->resampled.data(), finished);
+			voiceSamples = inData->resampled.data();
+		}
 
-			// Get data in const char* form
-			const char* data = stream._getNextDataBlock();
+		// Gains are worked out once per block, changes since the last block are ramped across it
+		float gains[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		if (!fadeOut)
+			_calculatePanGains(volume, voice.panning, gains);
+		_mixIntoBusRamped(inData->bus.data(), voiceSamples, framesRead, voiceChannelCount, voice.gains, gains);
 
-			// Get volume and panning info
-			float volume = stream._getVolume();
-			float panning = fmaxf(fminf(stream._getPanning(), 1.0f), -1.0f);
+		// If it's the end of the data and we've finished looping, stop the voice
+		if (finished)
+			finishVoice(inData, index);
+	}
 
-			for (int sample = 0; sample < sampleWrite / channelCount; sample++)
-			{
-				_ChannelQuality channelOutputs[channelCount];
+	// Whether a voice has been heard, and so needs fading out rather than cutting off
+	static bool isVoiceAudible(const _Voice& voice)
+	{
+		return voice.generation != 0 && !voice.paused && voice.gains.started;
+	}
 
-				// Get sample data
-				for (int channel = 0; channel < channelCount; channel++)
-				{
-					// Get the amount of bytes to go through the data for this sample
-					unsigned int sampleOffset = (sample * inChannelCount + (inChannelCount == 2 ? channel : 0)) * inFormatSize;
+	// Commands are applied after the bus is cleared, as voices that are cut off are given their last block here
+	static void applyAudioCommand(SamplerPassInInfo* inData, const _AudioCommand& command, unsigned int frameCount)
+	{
+		if (command.type == _AudioCommand::SetMasterVolume)
+		{
+			inData->masterVolume = command.volume;
+			return;
+		}
 
-					// We don't need to do loop processing here as it is done by _getNextDataBlock()
+		_Voice& voice = inData->voices[command.voice];
+		if (command.type == _AudioCommand::PlayVoice)
+		{
+			// A stolen voice fades out underneath the new one
+			if (isVoiceAudible(voice))
+				mixVoice(inData, command.voice, frameCount, true);
+
+			voice.generation = command.generation;
+			voice.playback = command.playback;
+			voice.stream = command.stream;
+			voice.volume = command.volume;
+			voice.panning = command.panning;
+			voice.gains.started = false;
+			voice.paused = false;
+			voice.position = 0;
+			voice.rate = command.rate;
+			voice.step = calculateStep(command.playback.sampleRate, inData->sampleRate, command.rate);
+			voice.quality = command.quality;
+			voice.looped = false;
+			return;
+		}
 
-					// The value of the sample cast to an integer, doesn't scale to fit range
-					int outSample = (*(int*)(data + sampleOffset) & mask);
+		// The voice may have already finished by itself and been replaced, in which case the command is old
+		if (voice.generation != command.generation)
+			return;
 
-					// Scale output and store it for pan processing, apply volume here
-					if (formatFactor >= 0)
-						channelOutputs[channel] = (_ChannelQuality)(outSample >> (formatFactor * 8)) * volume;
-					else
-						channelOutputs[channel] = (_ChannelQuality)(outSample << (-formatFactor * 8)) * volume;
-				}
+		switch (command.type)
+		{
+		case _AudioCommand::StopVoice:
+			if (isVoiceAudible(voice))
+				mixVoice(inData, command.voice, frameCount, true);
+			// The fade may have reached the end of the voice and finished it already
+			if (voice.generation != 0)
+				finishVoice(inData, command.voice);
+			break;
+		case _AudioCommand::SetVoiceVolume:
+			voice.volume = command.volume;
+			break;
+		case _AudioCommand::SetVoicePanning:
+			voice.panning = command.panning;
+			break;
+		case _AudioCommand::SetVoicePaused:
+			if (command.paused && isVoiceAudible(voice))
+				mixVoice(inData, command.voice, frameCount, true);
+			// Resumed voices ramp up from silence instead of jumping back in at full volume
+			if (voice.paused && !command.paused)
+				memset(voice.gains.gains, 0, sizeof(voice.gains.gains));
+			voice.paused = command.paused;
+			break;
+		case _AudioCommand::SetVoiceRate:
+			voice.rate = command.rate;
+			voice.step = calculateStep(voice.playback.sampleRate, inData->sampleRate, command.rate);
+			break;
+		default:
+			break;
+		}
+	}
 
-				// This is the amount to merge the right channel into the left channel
-				float leftPanAmount = -fminf(panning, 0.0f) * PI / 2.0f;
-				float rightPanAmount = fmaxf(panning, 0.0f) * PI / 2.0f;
+	int playRaw(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
+		double streamTime, RtAudioStreamStatus status, void* data)
+	{
 
-				// Apply pan
-				outData[sample * channelCount + 0] += channelOutputs[0] * fmaxf(sinf(leftPanAmount), 0.0f);
-				outData[sample * channelCount + 1] += channelOutputs[0] * fmaxf(cosf(leftPanAmount), 0.0f);
-				outData[sample * channelCount + 1] += channelOutputs[1] * fmaxf(sinf(rightPanAmount), 0.0f);
-				outData[sample * channelCount + 0] += channelOutputs[1] * fmaxf(cosf(rightPanAmount), 0.0f);
-			}
+		// This will compile all sounds and soundstreams into one buffer
+		
+		// Since the audio is on a different thread we need to make sure we don't run into any
+		// race conditions, without ever waiting on the main thread as that would glitch the audio
 
-			// If it's the end of the data and we've finished looping, stop the sound
-			if (sampleWrite == bytesLeft / inFormatSize)
-				stream._setIsPlaying(false);
+		// Solution of race conditions:
+		// When a sound is played, stopped or changed:
+		//  > The main thread pushes a command onto a wait-free ring, it never touches the voices itself
+		// When this function is ran:
+		//  > All waiting commands are applied to the voices first
+		//  > Then every voice is mixed
+		//  > When a voice finishes or is stopped, it's generation is written to finishedVoices
+		// When the update function is ran:
+		//  > The main thread checks finishedVoices and only then reuses the voice
+		// 
+		// Note: the voices are never accessed by the main thread, and so the audio thread owns them completely.
+		// Nothing here locks or allocates
+		
+		// The sounds may be in different PCM formats, so every voice is decoded into floats between -1 and 1
+		// and added into a float mix bus. The bus is only converted into the device's format once at the end,
+		// saturating there instead of wrapping around per voice
+
+		// Sounds recorded at a different rate to the device, or played faster or slower, are resampled as they're decoded
+
+		SamplerPassInInfo* inData = (SamplerPassInInfo*)data;
+		
+		// Will ALWAYS be 2!!!
+		const unsigned int channelCount = 2;
+
+		// The buffers are sized for the frame count the stream was opened with, which RtAudio keeps to
+		// Commands are left on the ring until a block can be mixed
+		if (nBufferFrames * channelCount > inData->bus.size())
+		{
+			memset(outputBuffer, 0, nBufferFrames * channelCount * _getFormatByteSize(inData->format));
+			return 0;
 		}
+
+		memset(inData->bus.data(), 0, nBufferFrames * channelCount * sizeof(float));
+
+		_AudioCommand command;
+		while (inData->commands.pop(command))
+			applyAudioCommand(inData, command, nBufferFrames);
+
+		for (unsigned int i = 0; i < s_MaxVoices; i++)
+		{
+			const _Voice& voice = inData->voices[i];
+			if (voice.generation != 0 && !voice.paused)
+				mixVoice(inData, i, nBufferFrames, false);
+		}
+
+		// Master volume is applied once here so it covers both sounds and streams
+		_writeBus(inData->bus.data(), nBufferFrames * channelCount, inData->masterVolume, outputBuffer, inData->format);
 		return 0;
 	}
 
@@ -261,9 +490,9 @@ namespace lost
 	{
 	public:
 		AudioHandler()
-			: m_SamplerPassInInfo{ { {} }, { {} } }
 		{
-
+			for (unsigned int i = 0; i < s_MaxVoices; i++)
+				m_SamplerPassInInfo.finishedVoices[i].store(0, std::memory_order_relaxed);
 		}
 
 		void init(RtAudioFormat format = RTAUDIO_SINT16)
@@ -276,11 +505,26 @@ namespace lost
 			m_OutputParameters.nChannels = 2;
 			m_OutputParameters.firstChannel = 0;
 
-			m_CurrentDeviceName = m_Dac.getDeviceInfo(m_OutputParameters.deviceId).name;
+			RtAudio::DeviceInfo deviceInfo = m_Dac.getDeviceInfo(m_OutputParameters.deviceId);
+			m_CurrentDeviceName = deviceInfo.name;
+
+			// Opening at the rate the device already runs at stops the OS from resampling everything again
+			m_SampleRate = deviceInfo.currentSampleRate ? deviceInfo.currentSampleRate : deviceInfo.preferredSampleRate;
+			if (m_SampleRate == 0)
+				m_SampleRate = s_FallbackSampleRate;
 
 			m_Format = format;
 
-			m_Dac.openStream(&m_OutputParameters, NULL, format, 44100, &m_BufferFrames, &playRaw, (void*)&m_SamplerPassInInfo);
+			_initResampler();
+			m_Dac.openStream(&m_OutputParameters, NULL, format, m_SampleRate, &m_BufferFrames, &playRaw, (void*)&m_SamplerPassInInfo);
+
+			// The buffer frame count is only known once the stream is open, the callback doesn't run until it's started
+			m_SamplerPassInInfo.format = format;
+			m_SamplerPassInInfo.sampleRate = m_SampleRate;
+			m_SamplerPassInInfo.bus.resize(m_BufferFrames * m_OutputParameters.nChannels);
+			m_SamplerPassInInfo.samples.resize(((unsigned int)(s_MaxResampleStep >> 32) * m_BufferFrames + _ResamplerHalfTaps * 2 + 1) * m_OutputParameters.nChannels);
+			m_SamplerPassInInfo.resampled.resize(m_BufferFrames * m_OutputParameters.nChannels);
+
 			m_Dac.startStream();
 			
 			debugLog("Successfully initialized audio on device: " + m_CurrentDeviceName, LOST_LOG_SUCCESS);
@@ -290,222 +534,379 @@ namespace lost
 		{
 			if (m_Dac.isStreamOpen()) m_Dac.closeStream();
 
-			const std::vector<PlaybackSound*>& list1 = m_SamplerPassInInfo.activeSounds.read();
-			for (PlaybackSound* sound : list1)
-				delete sound;
+			// The audio thread has stopped, so every voice can be let go of straight away
+			for (VoiceSlot& slot : m_Voices)
+			{
+				if (slot.stream)
+				{
+					slot.stream->_setIsPlaying(false);
+					slot.stream->_setActive(false);
+				}
+				slot.state = VoiceSlot::Free;
+				slot.sound = nullptr;
+				slot.stream = nullptr;
+			}
 		}
 
 		unsigned int getBufferFrameCount() const { return m_BufferFrames; };
 		RtAudio& getDac() { return m_Dac; }
 		RtAudio::StreamParameters& getOutputStreamParams() { return m_OutputParameters; }
 		RtAudioFormat getAudioFormat() const { return m_Format; };
-		
-		// Loopcount - when UINT_MAX / -1 - will cause the sound to loop forever, only stopped by stopSound
-		PlaybackSound* playSound(_Sound* sound, float volume, float panning, unsigned int loopCount) // [!] TODO: Add Volume and Pan
-		{
-			std::mutex& soundMutex = m_SamplerPassInInfo.activeSounds.getMutex();
-			PlaybackSound* pbSound = new PlaybackSound(sound, volume, panning, loopCount);
+		unsigned int getSampleRate() const { return m_SampleRate; };
 
-			soundMutex.lock();
-			m_SamplerPassInInfo.activeSounds.getWriteRef().push_back(pbSound);
-			m_SamplerPassInInfo.activeSounds.forceDirty();
-			soundMutex.unlock();
+		void setResampleQuality(ResampleQuality quality) { m_ResampleQuality = quality; };
+		ResampleQuality getResampleQuality() const { return m_ResampleQuality; };
 
-			return pbSound;
+		void setMaxVoices(unsigned int count)
+		{
+			m_MaxVoices = count < 1 ? 1 : (count > s_MaxVoices ? s_MaxVoices : count);
 		}
 
-		void stopSound(const PlaybackSound* sound)
+		unsigned int getMaxVoices() const { return m_MaxVoices; };
+		
+		// Loopcount - when UINT_MAX / -1 - will cause the sound to loop forever, only stopped by stopSound
+		VoiceHandle playSound(_Sound* sound, float volume, float panning, unsigned int loopCount, int priority)
 		{
-			std::mutex& soundMutex = m_SamplerPassInInfo.activeSounds.getMutex();
-
-			unsigned int location = -1;
-			PlaybackSound* ref = nullptr;
-			std::vector<PlaybackSound*>& writeRef = m_SamplerPassInInfo.activeSounds.getWriteRef();
-			for (int i = 0; i < writeRef.size(); i++)
+			unsigned int voice = findFreeVoice();
+			if (voice == s_MaxVoices)
+				voice = findVoiceToSteal(volume, priority);
+			if (voice == s_MaxVoices)
 			{
-				if (writeRef.at(i) == sound)
-				{
-					location = i;
-					ref = writeRef.at(i);
-					break;
-				}
+				debugLog("Tried to play a sound with every voice in use by louder or more important sounds (" + std::to_string(m_MaxVoices) + "), the sound was skipped", LOST_LOG_WARNING_NO_NOTE);
+				return 0;
 			}
 
-			if (ref)
-			{
-				m_GarbageSounds.push_back({ 0.0, ref });
-				soundMutex.lock();
-				writeRef.erase(writeRef.begin() + location);
-				m_SamplerPassInInfo.activeSounds.forceDirty();
-				soundMutex.unlock();
-			}
+			const _SoundInfo& soundInfo = sound->_getSoundInfo();
+
+			_AudioCommand command = {};
+			command.type = _AudioCommand::PlayVoice;
+			command.volume = volume;
+			command.panning = fmaxf(fminf(panning, 1.0f), -1.0f);
+			command.playback.currentByte = 0;
+			command.playback.dataCount = sound->getDataSize();
+			command.playback.bytesPerSample = soundInfo.sampleSize / soundInfo.channelCount;
+			command.playback.data = sound->getData();
+			command.playback.formatFactor = (int)soundInfo.format - (int)(log2(m_Format) + 1);
+			command.playback.format = soundInfo.format;
+			command.playback.channelCount = soundInfo.channelCount;
+			command.playback.sampleRate = soundInfo.sampleRate;
+			command.playback.loopCount = loopCount;
+			command.rate = 1.0f;
+			command.quality = m_ResampleQuality;
+
+			return startVoice(voice, sound, nullptr, volume, priority, command);
+		}
+
+		void stopSound(VoiceHandle handle)
+		{
+			unsigned int voice = findVoice(handle);
+			if (voice != s_MaxVoices && !m_Voices[voice].stream)
+				stopVoice(voice);
 			else
-			{
 				debugLog("Tried to stop a sound that had already finished playing or doesn't exist", LOST_LOG_WARNING_NO_NOTE);
-			}
 		}
 
 		void stopSounds(const _Sound* sound)
 		{
-			std::mutex& soundMutex = m_SamplerPassInInfo.activeSounds.getMutex();
+			for (unsigned int i = 0; i < s_MaxVoices; i++)
+				if (m_Voices[i].state == VoiceSlot::Playing && m_Voices[i].sound == sound)
+					stopVoice(i);
+		}
 
-			unsigned int location = -1;
-			PlaybackSound* ref = nullptr;
-			std::vector<PlaybackSound*>& writeRef = m_SamplerPassInInfo.activeSounds.getWriteRef();
-			for (int i = writeRef.size() - 1; i >= 0; i--)
-			{
-				if (writeRef.at(i)->getParentSound() == sound)
-				{
-					location = i;
-					ref = writeRef.at(i);
-
-					m_GarbageSounds.push_back({ 0.0, ref });
-					soundMutex.lock();
-					writeRef.erase(writeRef.begin() + location);
-					m_SamplerPassInInfo.activeSounds.forceDirty();
-					soundMutex.unlock();
-				}
-			}
+		bool isSoundPlaying(VoiceHandle handle) const
+		{
+			unsigned int voice = findVoice(handle);
+			return voice != s_MaxVoices && !m_Voices[voice].stream;
 		}
 
-		void endSounds(float deltaTime)
+		void setSoundVolume(VoiceHandle handle, float volume)
 		{
-			std::mutex& soundMutex = m_SamplerPassInInfo.activeSounds.getMutex();
-			std::vector<PlaybackSound*>& writeRef = m_SamplerPassInInfo.activeSounds.getWriteRef();
-			for (int i = writeRef.size() - 1; i >= 0; i--)
-			{
-				if (!writeRef.at(i)->isPlaying())
-				{
-					m_GarbageSounds.push_back({ 0.0, writeRef.at(i) });
-					soundMutex.lock();
-					writeRef.erase(writeRef.begin() + i);
-					m_SamplerPassInInfo.activeSounds.forceDirty();
-					soundMutex.unlock();
-				}
-			}
+			unsigned int voice = findVoice(handle);
+			if (voice == s_MaxVoices || m_Voices[voice].stream)
+				return;
 
-			for (int i = m_GarbageSounds.size() - 1; i >= 0; i--)
-			{
-				m_GarbageSounds.at(i).first += deltaTime;
-				if (m_GarbageSounds.at(i).first >= m_CullTime)
-				{
-					delete m_GarbageSounds.at(i).second;
-					m_GarbageSounds.erase(m_GarbageSounds.begin() + i);
-				}
-			}
+			m_Voices[voice].volume = volume;
+			sendVoiceCommand(_AudioCommand::SetVoiceVolume, voice, volume, 0.0f);
 		}
 
-		bool hasSound(const PlaybackSound* sound)
+		void setSoundPanning(VoiceHandle handle, float panning)
 		{
-			std::vector<PlaybackSound*>& writeRef = m_SamplerPassInInfo.activeSounds.getWriteRef();
-			for (int i = 0; i < writeRef.size(); i++)
-			{
-				if (writeRef.at(i) == sound)
-					return true;
-			}
-			return false;
+			unsigned int voice = findVoice(handle);
+			if (voice == s_MaxVoices || m_Voices[voice].stream)
+				return;
+
+			sendVoiceCommand(_AudioCommand::SetVoicePanning, voice, 0.0f, fmaxf(fminf(panning, 1.0f), -1.0f));
+		}
+
+		void setSoundPaused(VoiceHandle handle, bool paused)
+		{
+			unsigned int voice = findVoice(handle);
+			if (voice == s_MaxVoices || m_Voices[voice].stream)
+				return;
+
+			_AudioCommand command = {};
+			command.type = _AudioCommand::SetVoicePaused;
+			command.voice = voice;
+			command.generation = m_Voices[voice].generation;
+			command.paused = paused;
+			sendCommand(command);
+		}
+
+		void setSoundPlaybackRate(VoiceHandle handle, float rate)
+		{
+			unsigned int voice = findVoice(handle);
+			if (voice == s_MaxVoices || m_Voices[voice].stream)
+				return;
+
+			_AudioCommand command = {};
+			command.type = _AudioCommand::SetVoiceRate;
+			command.voice = voice;
+			command.generation = m_Voices[voice].generation;
+			command.rate = rate;
+			sendCommand(command);
 		}
 
 		bool hasSoundStream(const SoundStream sound)
 		{
-			std::vector<_SoundStream*>& writeRef = m_SamplerPassInInfo.activeStreams.getWriteRef();
-			for (int i = 0; i < writeRef.size(); i++)
-			{
-				if (writeRef.at(i) == sound)
-					return true;
-			}
-			return false;
+			return findStreamVoice(sound) != s_MaxVoices;
 		}
 
 		void playSoundStream(_SoundStream* soundStream, float volume, float panning, unsigned int loopCount)
 		{
-			std::mutex& streamMutex = m_SamplerPassInInfo.activeStreams.getMutex();
+			// Streams are never stolen, so they can only take a free voice
+			unsigned int voice = findFreeVoice();
+			if (voice == s_MaxVoices)
+			{
+				debugLog("Tried to play a sound stream with every voice in use (" + std::to_string(m_MaxVoices) + "), the stream was skipped", LOST_LOG_WARNING_NO_NOTE);
+				return;
+			}
 
-			soundStream->_prepareStartPlay(volume, panning, loopCount);
+			// The stream isn't being read by the audio thread, as it's only played again once the audio thread has finished with it
+			soundStream->_prepareStartPlay(loopCount);
 			soundStream->_setActive(true);
 			soundStream->_setIsPlaying(true);
 
-			streamMutex.lock();
-			m_SamplerPassInInfo.activeStreams.getWriteRef().push_back(soundStream);
-			m_SamplerPassInInfo.activeStreams.forceDirty();
-			streamMutex.unlock();
+			_AudioCommand command = {};
+			command.type = _AudioCommand::PlayVoice;
+			command.volume = volume;
+			command.panning = fmaxf(fminf(panning, 1.0f), -1.0f);
+			command.stream = soundStream;
+			command.playback.sampleRate = soundStream->_getSoundInfo().sampleRate;
+			command.rate = 1.0f;
+			command.quality = m_ResampleQuality;
+			startVoice(voice, nullptr, soundStream, volume, 0, command);
 		}
 
 		void stopSoundStream(_SoundStream* soundStream)
 		{
-			std::mutex& streamMutex = m_SamplerPassInInfo.activeStreams.getMutex();
-
-			unsigned int location = -1;
-			_SoundStream* ref = nullptr;
-			std::vector<_SoundStream*>& writeRef = m_SamplerPassInInfo.activeStreams.getWriteRef();
-			for (int i = 0; i < writeRef.size(); i++)
-			{
-				if (writeRef.at(i) == soundStream)
-				{
-					location = i;
-					ref = writeRef.at(i);
-					break;
-				}
-			}
-
-			if (ref)
-			{
-				m_GarbageStreams.push_back({ 0.0, ref });
-				streamMutex.lock();
-				writeRef.erase(writeRef.begin() + location);
-				m_SamplerPassInInfo.activeStreams.forceDirty();
-				streamMutex.unlock();
-			}
+			unsigned int voice = findStreamVoice(soundStream);
+			if (voice != s_MaxVoices)
+				stopVoice(voice);
 			else
-			{
 				debugLog("Tried to stop a sound stream that had already finished playing or doesn't exist", LOST_LOG_WARNING_NO_NOTE);
-			}
 		}
 
-		void endSoundStreams(float deltaTime)
+		void setSoundStreamVolume(_SoundStream* soundStream, float volume)
 		{
-			std::mutex& streamMutex = m_SamplerPassInInfo.activeStreams.getMutex();
-			std::vector<_SoundStream*>& writeRef = m_SamplerPassInInfo.activeStreams.getWriteRef();
-			for (int i = writeRef.size() - 1; i >= 0; i--)
-			{
-				if (!writeRef.at(i)->isPlaying())
-				{
-					m_GarbageStreams.push_back({ 0.0, writeRef.at(i) });
-					streamMutex.lock();
-					writeRef.erase(writeRef.begin() + i);
-					m_SamplerPassInInfo.activeStreams.forceDirty();
-					streamMutex.unlock();
-				}
-			}
+			unsigned int voice = findStreamVoice(soundStream);
+			if (voice == s_MaxVoices)
+				return;
 
-			for (int i = m_GarbageStreams.size() - 1; i >= 0; i--)
-			{
-				m_GarbageStreams.at(i).first += deltaTime;
-				if (m_GarbageStreams.at(i).first >= m_CullTime)
-				{
-					m_GarbageStreams.at(i).second->_setActive(false);
-					m_GarbageStreams.erase(m_GarbageStreams.begin() + i);
-				}
-			}
+			m_Voices[voice].volume = volume;
+			sendVoiceCommand(_AudioCommand::SetVoiceVolume, voice, volume, 0.0f);
 		}
 
-		void update(float deltaTime)
+		void setSoundStreamPanning(_SoundStream* soundStream, float panning)
 		{
-			endSounds(deltaTime);
-			endSoundStreams(deltaTime);
+			unsigned int voice = findStreamVoice(soundStream);
+			if (voice != s_MaxVoices)
+				sendVoiceCommand(_AudioCommand::SetVoicePanning, voice, 0.0f, fmaxf(fminf(panning, 1.0f), -1.0f));
+		}
+
+		void update()
+		{
+			sendPendingCommands();
+			collectFinishedVoices();
 		}
 
 		void setMasterVolume(float volume)
 		{
-			a_MasterVolume.write(volume);
+			m_MasterVolume = volume;
+
+			_AudioCommand command = {};
+			command.type = _AudioCommand::SetMasterVolume;
+			command.volume = volume;
+			sendCommand(command);
 		}
 
 		float getMasterVolume()
 		{
-			return a_MasterVolume.read();
+			return m_MasterVolume;
 		}
 
 	private:
+		// The main thread's view of a voice, mirroring the audio thread's voice of the same index
+		struct VoiceSlot
+		{
+			enum State : unsigned char
+			{
+				Free,
+				Playing,
+				Stopping // A stopped sound stream, waiting for the audio thread to let go of it
+			};
+
+			State state = Free;
+			unsigned int generation = 0;
+			_Sound* sound = nullptr;
+			_SoundStream* stream = nullptr;
+			float volume = 1.0f;
+			int priority = 0;
+		};
+
+		unsigned int findFreeVoice() const
+		{
+			for (unsigned int i = 0; i < m_MaxVoices; i++)
+				if (m_Voices[i].state == VoiceSlot::Free)
+					return i;
+			return s_MaxVoices;
+		}
+
+		// Picks the least important sound to make room for a new one, the lowest priority goes first then the quietest
+		// Returns s_MaxVoices if every sound playing is more important than the new one
+		unsigned int findVoiceToSteal(float volume, int priority) const
+		{
+			unsigned int quietest = s_MaxVoices;
+			for (unsigned int i = 0; i < m_MaxVoices; i++)
+			{
+				const VoiceSlot& slot = m_Voices[i];
+				if (slot.state != VoiceSlot::Playing || slot.stream)
+					continue;
+
+				if (quietest == s_MaxVoices || slot.priority < m_Voices[quietest].priority ||
+					(slot.priority == m_Voices[quietest].priority && slot.volume < m_Voices[quietest].volume))
+					quietest = i;
+			}
+
+			if (quietest == s_MaxVoices)
+				return s_MaxVoices;
+
+			const VoiceSlot& slot = m_Voices[quietest];
+			if (slot.priority > priority || (slot.priority == priority && slot.volume > volume))
+				return s_MaxVoices;
+			return quietest;
+		}
+
+		// Finds the voice a handle points to, returns s_MaxVoices if it has finished or been stolen
+		unsigned int findVoice(VoiceHandle handle) const
+		{
+			unsigned int voice = handle & 0xFFFF;
+			if (handle == 0 || voice >= s_MaxVoices)
+				return s_MaxVoices;
+
+			const VoiceSlot& slot = m_Voices[voice];
+			if (slot.state != VoiceSlot::Playing || slot.generation != (handle >> 16))
+				return s_MaxVoices;
+
+			// The audio thread may have finished it since the last update
+			if (m_SamplerPassInInfo.finishedVoices[voice].load(std::memory_order_acquire) == slot.generation)
+				return s_MaxVoices;
+			return voice;
+		}
+
+		unsigned int findStreamVoice(const _SoundStream* stream) const
+		{
+			for (unsigned int i = 0; i < s_MaxVoices; i++)
+				if (m_Voices[i].state == VoiceSlot::Playing && m_Voices[i].stream == stream)
+					return i;
+			return s_MaxVoices;
+		}
+
+		VoiceHandle startVoice(unsigned int voice, _Sound* sound, _SoundStream* stream, float volume, int priority, _AudioCommand& command)
+		{
+			VoiceSlot& slot = m_Voices[voice];
+
+			// Generation 0 means a free voice on the audio thread, so it's skipped when wrapping around
+			// Handles only keep 16 bits of it
+			slot.generation = (slot.generation + 1) & 0xFFFF;
+			if (slot.generation == 0)
+				slot.generation = 1;
+			slot.state = VoiceSlot::Playing;
+			slot.sound = sound;
+			slot.stream = stream;
+			slot.volume = volume;
+			slot.priority = priority;
+
+			// Playing over a stolen voice replaces it on the audio thread, as the commands arrive in order
+			command.voice = voice;
+			command.generation = slot.generation;
+			sendCommand(command);
+
+			return (slot.generation << 16) | voice;
+		}
+
+		void stopVoice(unsigned int voice)
+		{
+			VoiceSlot& slot = m_Voices[voice];
+
+			_AudioCommand command = {};
+			command.type = _AudioCommand::StopVoice;
+			command.voice = voice;
+			command.generation = slot.generation;
+			sendCommand(command);
+
+			// Sounds don't give the audio thread anything to let go of, so their voice can be reused straight away
+			// Sound streams wait until the audio thread has stopped reading them
+			slot.state = slot.stream ? VoiceSlot::Stopping : VoiceSlot::Free;
+			slot.sound = nullptr;
+		}
+
+		void sendVoiceCommand(_AudioCommand::Type type, unsigned int voice, float volume, float panning)
+		{
+			_AudioCommand command = {};
+			command.type = type;
+			command.voice = voice;
+			command.generation = m_Voices[voice].generation;
+			command.volume = volume;
+			command.panning = panning;
+			sendCommand(command);
+		}
+
+		void sendCommand(const _AudioCommand& command)
+		{
+			// Commands have to reach the audio thread in order, so once one is held back every command after it is too
+			if (!m_PendingCommands.empty() || !m_SamplerPassInInfo.commands.push(command))
+				m_PendingCommands.push_back(command);
+		}
+
+		void sendPendingCommands()
+		{
+			unsigned int sent = 0;
+			while (sent < m_PendingCommands.size() && m_SamplerPassInInfo.commands.push(m_PendingCommands[sent]))
+				sent++;
+			m_PendingCommands.erase(m_PendingCommands.begin(), m_PendingCommands.begin() + sent);
+		}
+
+		// Frees every voice the audio thread has finished with
+		void collectFinishedVoices()
+		{
+			for (unsigned int i = 0; i < s_MaxVoices; i++)
+			{
+				VoiceSlot& slot = m_Voices[i];
+				if (slot.state == VoiceSlot::Free || m_SamplerPassInInfo.finishedVoices[i].load(std::memory_order_acquire) != slot.generation)
+					continue;
+
+				if (slot.stream)
+				{
+					slot.stream->_setIsPlaying(false);
+					slot.stream->_setActive(false);
+				}
+
+				slot.state = VoiceSlot::Free;
+				slot.sound = nullptr;
+				slot.stream = nullptr;
+			}
+		}
+
 		RtAudio m_Dac;
 		RtAudio::StreamParameters m_OutputParameters;
 		std::string m_CurrentDeviceName;
@@ -515,43 +916,20 @@ namespace lost
 		// Audio stream settings
 		RtAudioFormat m_Format;
 		unsigned int m_BufferFrames = 1024;
+		unsigned int m_SampleRate = s_FallbackSampleRate;
+		ResampleQuality m_ResampleQuality = LOST_RESAMPLE_SINC;
 
-		_HaltWrite<float> a_MasterVolume = 1.0f;
-
-		// lifetime + playbackSound*
-		std::vector<std::pair<double, PlaybackSound*>> m_GarbageSounds;
-		std::vector<std::pair<double, _SoundStream*>> m_GarbageStreams;
-		double m_CullTime = 100.0;
+		VoiceSlot m_Voices[s_MaxVoices];
+		unsigned int m_MaxVoices = s_MaxVoices; // The amount of voices new sounds can use, voices past it finish playing as normal
+		std::vector<_AudioCommand> m_PendingCommands; // Commands waiting for space on the ring, in order
+		float m_MasterVolume = 1.0f;
 	};
 
 	AudioHandler _audioHandler;
 
-	PlaybackSound::PlaybackSound(_Sound* soundPlaying, float volume, float panning, unsigned int loopCount)
-		: a_Playing{ true }
-		, a_Volume{ volume }
-		, a_Panning{ fmaxf(fminf(panning, 1.0f), -1.0f) }
-	{
-		// Bytes per channel's samples
-		unsigned int soundFormat = soundPlaying->_getSoundInfo().format;
-		// The bit selected is the amount of bytes per channel sample
-		unsigned int audioFormat = _audioHandler.getAudioFormat();
-
-		m_FormatFactor = soundFormat - (log2(audioFormat) + 1);
-
-		a_PlaybackData.currentByte = 0;
-		a_PlaybackData.dataCount = soundPlaying->getDataSize();
-		a_PlaybackData.bytesPerSample = soundPlaying->_getSoundInfo().sampleSize / soundPlaying->_getSoundInfo().channelCount;
-		a_PlaybackData.data = soundPlaying->getData();
-		a_PlaybackData.formatFactor = m_FormatFactor;
-		a_PlaybackData.format = soundPlaying->_getSoundInfo().format;
-		a_PlaybackData.channelCount = soundPlaying->_getSoundInfo().channelCount;
-		a_PlaybackData.loopCount = loopCount;
-
-		m_ParentSound = soundPlaying;
-	}
-
 	void _initAudio()
 	{
+		_startStreamLoader();
 		_audioHandler.init();
 		_initAudioRMs();
 	}
@@ -559,12 +937,13 @@ namespace lost
 	void _exitAudio()
 	{
 		_audioHandler.exit();
+		_stopStreamLoader();
 		_destroyAudioRMs();
 	}
 
 	void _updateAudio()
 	{
-		_audioHandler.update(getDeltaTime());
+		_audioHandler.update();
 	}
 
 	unsigned int _getAudioHandlerFormat()
@@ -577,6 +956,11 @@ namespace lost
 		return _audioHandler.getBufferFrameCount();
 	}
 
+	unsigned int _getAudioHandlerSampleRate()
+	{
+		return _audioHandler.getSampleRate();
+	}
+
 	void setMasterVolume(float volume)
 	{
 		_audioHandler.setMasterVolume(fmaxf(volume, 0.0f));
@@ -587,38 +971,71 @@ namespace lost
 		return _audioHandler.getMasterVolume();
 	}
 
-	PlaybackSound* playSound(Sound sound, float volume, float panning, unsigned int loopCount)
+	void setMaxVoices(unsigned int count)
+	{
+		_audioHandler.setMaxVoices(count);
+	}
+
+	unsigned int getMaxVoices()
+	{
+		return _audioHandler.getMaxVoices();
+	}
+
+	unsigned int getAudioSampleRate()
+	{
+		return _audioHandler.getSampleRate();
+	}
+
+	void setResampleQuality(ResampleQuality quality)
+	{
+		_audioHandler.setResampleQuality(quality);
+	}
+
+	ResampleQuality getResampleQuality()
+	{
+		return _audioHandler.getResampleQuality();
+	}
+
+	VoiceHandle playSound(Sound sound, float volume, float panning, unsigned int loopCount, int priority)
 	{
 		if (sound->isFunctional())
-			return _audioHandler.playSound(sound, volume, panning, loopCount);
-		return nullptr;
+			return _audioHandler.playSound(sound, volume, panning, loopCount, priority);
+		return 0;
 	}
 
-	void stopSound(const PlaybackSound* sound)
+	void stopSound(VoiceHandle sound)
 	{
 		return _audioHandler.stopSound(sound);
 	}
 
-	void stopSound(Sound sound)
+	void stopSounds(Sound sound)
 	{
 		return _audioHandler.stopSounds(sound);
 	}
 
-	void setSoundVolume(PlaybackSound* sound, float volume)
+	void setSoundPaused(VoiceHandle sound, bool paused)
 	{
-		sound->_setVolume(volume);
+		_audioHandler.setSoundPaused(sound, paused);
 	}
 
-	void setSoundPanning(PlaybackSound* sound, float panning)
+	void setSoundVolume(VoiceHandle sound, float volume)
 	{
-		sound->_setPanning(panning);
+		_audioHandler.setSoundVolume(sound, volume);
 	}
 
-	bool isSoundPlaying(PlaybackSound* sound)
+	void setSoundPanning(VoiceHandle sound, float panning)
 	{
-		if (!_audioHandler.hasSound(sound))
-			return false;
-		return sound->isPlaying();
+		_audioHandler.setSoundPanning(sound, panning);
+	}
+
+	void setSoundPlaybackRate(VoiceHandle sound, float rate)
+	{
+		_audioHandler.setSoundPlaybackRate(sound, rate);
+	}
+
+	bool isSoundPlaying(VoiceHandle sound)
+	{
+		return _audioHandler.isSoundPlaying(sound);
 	}
 
 	void playSoundStream(SoundStream soundStream, float volume, float panning, unsigned int loopCount)
@@ -643,11 +1060,11 @@ namespace lost
 	}
 	void setSoundStreamVolume(SoundStream sound, float volume)
 	{
-		sound->_setVolume(volume);
+		_audioHandler.setSoundStreamVolume(sound, volume);
 	}
 
 	void setSoundStreamPanning(SoundStream sound, float panning)
 	{
-		sound->_setPanning(panning);
+		_audioHandler.setSoundStreamPanning(sound, panning);
 	}
-}
\ No newline at end of file
+}
@@ -4,6 +4,13 @@
 
 #include "External/RtAudio.h"
 #include "ThreadSafeTemplate.h"
+#include "Mixer.h"
+
+#include <cstdint>
+
+#ifndef LOST_MAX_VOICES
+#define LOST_MAX_VOICES 64 // The most sounds and sound streams that can play at once, handles can address up to 65535
+#endif
 
 
 namespace lost
@@ -19,49 +26,23 @@ namespace lost
 		int			 formatFactor;   // The amount of bits to shift the playback of this sound
 		unsigned int bytesPerSample; // The amount of bytes in one channel's sample
 		unsigned int channelCount;   // The amount of channels
+		unsigned int sampleRate;     // The rate the sound was recorded at, it's resampled to the device's rate while playing
 		const char* data; // This is not normalized audio, it is the bit representation of the audio, not caring for format
 
 		void* extraData = nullptr;
 	};
 
-	// Returned whenever a sound object is played
-	class PlaybackSound
-	{
-	public:
-		PlaybackSound(_Sound* soundPlaying, float volume = 1.0f, float panning = 0.0f, unsigned int loopCount = 0); // if loop count is -1 or UINT_MAX it will loop forever
-
-		inline bool isPlaying() { return a_Playing.read(); };
-
-		inline void _setIsPlaying() { a_Playing.write(false); };
-		inline _PlaybackData& _getPlaybackData() { return a_PlaybackData; };
-
-		inline float _getVolume() { return a_Volume.read(); };
-		inline void _setVolume(float volume) { a_Volume.write(volume); }
-
-		inline float _getPanning() { return a_Panning.read(); };
-		inline void _setPanning(float panning) { a_Panning.write(fminf(fmaxf(panning, -1.0f), 1.0f)); }
-
-		inline _Sound* getParentSound() const { return m_ParentSound; };
-	private:
-		// Any variables marked with a_ are accessed by the audio thread, otherwise they are main thread only
-		_PlaybackData a_PlaybackData; // Read only
-		// Halt read is used here so that the main thread waits for the audio thread to finish processing
-		_HaltRead<bool> a_Playing; // Read/Write
-
-		_HaltWrite<float> a_Volume;
-		_HaltWrite<float> a_Panning;
-
-		// Playback data
-		int m_FormatFactor;
-
-		_Sound* m_ParentSound;
-	};
+	// A generation checked reference to a sound being played, returned by playSound()
+	// The low 16 bits are the voice playing it, the high 16 bits change every time the voice is reused
+	// It stops being valid once the sound finishes, is stopped or has it's voice stolen, 0 is never valid
+	typedef uint32_t VoiceHandle;
 
 	void _initAudio();
 	void _exitAudio();
 	void _updateAudio();
 	unsigned int _getAudioHandlerFormat();
 	unsigned int _getAudioHandlerBufferSize(); // Returns the size of the nBufferSize of the audio buffer
+	unsigned int _getAudioHandlerSampleRate(); // Returns the rate the audio device was opened at
 
 	// [!] TODO: Docs
 
@@ -69,31 +50,50 @@ namespace lost
 	void setMasterVolume(float volume);
 	float getMasterVolume();
 
+	// Sets the amount of sounds and sound streams that can play at once, up to LOST_MAX_VOICES
+	// Once every voice is in use, new sounds take the voice of the least important sound playing (lowest priority then quietest)
+	// Sound streams are never stolen
+	void setMaxVoices(unsigned int count);
+	unsigned int getMaxVoices();
+
+	// The sample rate the audio device was opened at, sounds recorded at other rates are resampled to it
+	unsigned int getAudioSampleRate();
+
+	// Sets how sounds played from now on are resampled, sounds already playing keep the quality they started with
+	void setResampleQuality(ResampleQuality quality);
+	ResampleQuality getResampleQuality();
+
 	// [==========================]
 	//       Sound Functions
 	// [==========================]
 
 	/// <summary>
-	/// Returns a pointer to the sound being played, you can check if the sound has finished playing or not by running isSoundPlaying()
+	/// Returns a handle to the sound being played, you can check if the sound has finished playing or not by running isSoundPlaying()
 	/// </summary>
 	/// <param name="sound">The sound to play</param>
 	/// <param name="volume">The volume of the sound</param>
 	/// <param name="panning">The panning of the sound -1.0f is left ear, 1.0f is right ear, 0.0f is center</param>
 	/// <param name="loopCount">The amount of times to loop, setting this as -1 or UINT_MAX loops it forever. It can be stopped with stopSound</param>
-	/// <returns></returns>
-	PlaybackSound* playSound(Sound sound, float volume = 1.0f, float panning = 0.0f, unsigned int loopCount = 0); // [!] TODO: Volume and Panning 
+	/// <param name="priority">When every voice is in use, sounds with a higher priority are stolen last</param>
+	/// <returns>0 if every voice is in use by sounds that are more important</returns>
+	VoiceHandle playSound(Sound sound, float volume = 1.0f, float panning = 0.0f, unsigned int loopCount = 0, int priority = 0);
 	
 	// Stops the sound being played
-	void stopSound(const PlaybackSound* sound);
-	// Stops the all sounds playing that are using this sound, use the PlaybackSound return to manage individual ones
-	void stopSound(Sound sound);
-	void setSoundPaused(const PlaybackSound* sound, bool paused);
-
-	void setSoundVolume(PlaybackSound* sound, float volume);
+	void stopSound(VoiceHandle sound);
+	// Stops every sound playing that is using this sound, use the VoiceHandle return to manage individual ones
+	// Named apart from stopSound() so a VoiceHandle of 0 can never be mistaken for a sound
+	void stopSounds(Sound sound);
+	// Paused sounds keep their place and their voice, carrying on from where they were once unpaused
+	void setSoundPaused(VoiceHandle sound, bool paused);
+
+	void setSoundVolume(VoiceHandle sound, float volume);
 	// The panning of the sound -1.0f is left ear, 1.0f is right ear, 0.0f is center
-	void setSoundPanning(PlaybackSound* sound, float panning);
+	void setSoundPanning(VoiceHandle sound, float panning);
+	// Speeds up or slows down the sound, changing it's pitch with it, 1.0f is the speed it was recorded at
+	// Clamped so the sound never moves through more than 8 of it's samples per sample played
+	void setSoundPlaybackRate(VoiceHandle sound, float rate);
 
-	bool isSoundPlaying(PlaybackSound* sound);
+	bool isSoundPlaying(VoiceHandle sound);
 
 	// [==========================]
 	//    Sound Stream Functions
@@ -0,0 +1,548 @@
+#include "Mixer.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define LOST_MIX_SSE
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define LOST_MIX_AVX
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define LOST_MIX_NEON
+#include <arm_neon.h>
+#endif
+
+namespace lost
+{
+
+	// Every kernel can use aligned loads on buffers from _MixBuffer, 32 bytes covers AVX
+	static const uintptr_t s_MixAlignment = 32;
+	static const float s_HalfPi = 1.57079632679f;
+
+	// The sinc filter is stored for 256 positions between source frames, the nearest one is used
+	static const unsigned int s_ResamplePhaseBits = 8;
+	static const unsigned int s_ResamplePhases = 1 << s_ResamplePhaseBits;
+	// Slightly under the source's nyquist frequency, so the filter has room to roll off
+	static const double s_ResampleCutoff = 0.92;
+	static const double s_Pi = 3.14159265358979323846;
+	alignas(16) static float s_SincMono[s_ResamplePhases][_ResamplerHalfTaps * 2];
+	alignas(16) static float s_SincStereo[s_ResamplePhases][_ResamplerHalfTaps * 4]; // Each coefficient twice, for interleaved left and right
+
+	void _MixBuffer::resize(unsigned int floatCount)
+	{
+		m_Storage.assign(floatCount + s_MixAlignment / sizeof(float), 0.0f);
+		m_Data = (float*)(((uintptr_t)m_Storage.data() + s_MixAlignment - 1) & ~(s_MixAlignment - 1));
+		m_Size = floatCount;
+	}
+
+	void _decodeSamples(const char* data, unsigned int bytesPerSample, unsigned int count, float* out)
+	{
+		unsigned int i = 0;
+
+		switch (bytesPerSample)
+		{
+		case 2:
+		{
+			const float scale = 1.0f / 32768.0f;
+#if defined(LOST_MIX_SSE)
+			const __m128 scale4 = _mm_set1_ps(scale);
+			for (; i + 8 <= count; i += 8)
+			{
+				// Pairing each sample with itself then shifting back down sign extends it to 32 bits
+				__m128i samples = _mm_loadu_si128((const __m128i*)(data + i * 2));
+				__m128i low  = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+				__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+				_mm_storeu_ps(out + i,     _mm_mul_ps(_mm_cvtepi32_ps(low),  scale4));
+				_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale4));
+			}
+#elif defined(LOST_MIX_NEON)
+			for (; i + 8 <= count; i += 8)
+			{
+				int16x8_t samples = vld1q_s16((const int16_t*)(data + i * 2));
+				vst1q_f32(out + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))),  scale));
+				vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+			}
+#endif
+			for (; i < count; i++)
+			{
+				int16_t sample;
+				memcpy(&sample, data + i * 2, sizeof(int16_t));
+				out[i] = sample * scale;
+			}
+			break;
+		}
+		case 3:
+		{
+			// Packed 24 bit samples don't line up with any vector width, this is only a shift and convert per sample anyway
+			const float scale = 1.0f / 8388608.0f;
+			for (; i < count; i++)
+			{
+				const unsigned char* bytes = (const unsigned char*)data + i * 3;
+				int32_t sample = (int32_t)(((uint32_t)bytes[0] << 8) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 24)) >> 8;
+				out[i] = sample * scale;
+			}
+			break;
+		}
+		case 4:
+		{
+			const float scale = 1.0f / 2147483648.0f;
+#if defined(LOST_MIX_SSE)
+			const __m128 scale4 = _mm_set1_ps(scale);
+			for (; i + 4 <= count; i += 4)
+				_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(data + i * 4))), scale4));
+#elif defined(LOST_MIX_NEON)
+			for (; i + 4 <= count; i += 4)
+				vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32((const int32_t*)(data + i * 4))), scale));
+#endif
+			for (; i < count; i++)
+			{
+				int32_t sample;
+				memcpy(&sample, data + i * 4, sizeof(int32_t));
+				out[i] = sample * scale;
+			}
+			break;
+		}
+		default:
+			memset(out, 0, count * sizeof(float));
+			break;
+		}
+	}
+
+	void _calculatePanGains(float volume, float panning, float gains[4])
+	{
+		panning = fmaxf(fminf(panning, 1.0f), -1.0f);
+
+		// Panning left moves the right channel into the left ear, and the other way around
+		float angle = fabsf(panning) * s_HalfPi;
+		float moved = sinf(angle);
+		float kept = cosf(angle);
+
+		gains[0] = (panning <= 0.0f ? 1.0f  : kept)  * volume; // Left into left
+		gains[1] = (panning <= 0.0f ? moved : 0.0f)  * volume; // Right into left
+		gains[2] = (panning <= 0.0f ? 0.0f  : moved) * volume; // Left into right
+		gains[3] = (panning <= 0.0f ? kept  : 1.0f)  * volume; // Right into right
+	}
+
+	void _mixIntoBus(float* bus, const float* samples, unsigned int frameCount, unsigned int channelCount, const float gains[4])
+	{
+		unsigned int frame = 0;
+
+		if (channelCount == 1)
+		{
+			// Mono voices are the same sample in both channels, so the gains into each ear collapse into one
+			float leftGain = gains[0] + gains[1];
+			float rightGain = gains[2] + gains[3];
+
+#if defined(LOST_MIX_AVX)
+			const __m256 gain8 = _mm256_setr_ps(leftGain, rightGain, leftGain, rightGain, leftGain, rightGain, leftGain, rightGain);
+			for (; frame + 8 <= frameCount; frame += 8)
+			{
+				__m256 mono = _mm256_load_ps(samples + frame);
+				// unpack works within each 128 bit half, so the halves are swapped into place afterwards
+				__m256 low  = _mm256_unpacklo_ps(mono, mono);
+				__m256 high = _mm256_unpackhi_ps(mono, mono);
+				__m256 first  = _mm256_permute2f128_ps(low, high, 0x20);
+				__m256 second = _mm256_permute2f128_ps(low, high, 0x31);
+				_mm256_store_ps(bus + frame * 2,     _mm256_add_ps(_mm256_load_ps(bus + frame * 2),     _mm256_mul_ps(first,  gain8)));
+				_mm256_store_ps(bus + frame * 2 + 8, _mm256_add_ps(_mm256_load_ps(bus + frame * 2 + 8), _mm256_mul_ps(second, gain8)));
+			}
+#endif
+#if defined(LOST_MIX_SSE)
+			const __m128 gain4 = _mm_setr_ps(leftGain, rightGain, leftGain, rightGain);
+			for (; frame + 4 <= frameCount; frame += 4)
+			{
+				__m128 mono = _mm_load_ps(samples + frame);
+				_mm_store_ps(bus + frame * 2,     _mm_add_ps(_mm_load_ps(bus + frame * 2),     _mm_mul_ps(_mm_unpacklo_ps(mono, mono), gain4)));
+				_mm_store_ps(bus + frame * 2 + 4, _mm_add_ps(_mm_load_ps(bus + frame * 2 + 4), _mm_mul_ps(_mm_unpackhi_ps(mono, mono), gain4)));
+			}
+#elif defined(LOST_MIX_NEON)
+			const float gainValues[4] = { leftGain, rightGain, leftGain, rightGain };
+			const float32x4_t gain4 = vld1q_f32(gainValues);
+			for (; frame + 4 <= frameCount; frame += 4)
+			{
+				float32x4x2_t mono = vzipq_f32(vld1q_f32(samples + frame), vld1q_f32(samples + frame));
+				vst1q_f32(bus + frame * 2,     vmlaq_f32(vld1q_f32(bus + frame * 2),     mono.val[0], gain4));
+				vst1q_f32(bus + frame * 2 + 4, vmlaq_f32(vld1q_f32(bus + frame * 2 + 4), mono.val[1], gain4));
+			}
+#endif
+			for (; frame < frameCount; frame++)
+			{
+				bus[frame * 2]     += samples[frame] * leftGain;
+				bus[frame * 2 + 1] += samples[frame] * rightGain;
+			}
+			return;
+		}
+
+		// Stereo, each ear gets it's own channel plus whatever is panned across from the other one
+#if defined(LOST_MIX_AVX)
+		const __m256 direct8 = _mm256_setr_ps(gains[0], gains[3], gains[0], gains[3], gains[0], gains[3], gains[0], gains[3]);
+		const __m256 cross8  = _mm256_setr_ps(gains[1], gains[2], gains[1], gains[2], gains[1], gains[2], gains[1], gains[2]);
+		for (; frame + 4 <= frameCount; frame += 4)
+		{
+			__m256 stereo = _mm256_load_ps(samples + frame * 2);
+			__m256 swapped = _mm256_permute_ps(stereo, _MM_SHUFFLE(2, 3, 0, 1));
+			__m256 mixed = _mm256_add_ps(_mm256_mul_ps(stereo, direct8), _mm256_mul_ps(swapped, cross8));
+			_mm256_store_ps(bus + frame * 2, _mm256_add_ps(_mm256_load_ps(bus + frame * 2), mixed));
+		}
+#endif
+#if defined(LOST_MIX_SSE)
+		const __m128 direct4 = _mm_setr_ps(gains[0], gains[3], gains[0], gains[3]);
+		const __m128 cross4  = _mm_setr_ps(gains[1], gains[2], gains[1], gains[2]);
+		for (; frame + 2 <= frameCount; frame += 2)
+		{
+			__m128 stereo = _mm_load_ps(samples + frame * 2);
+			__m128 swapped = _mm_shuffle_ps(stereo, stereo, _MM_SHUFFLE(2, 3, 0, 1));
+			__m128 mixed = _mm_add_ps(_mm_mul_ps(stereo, direct4), _mm_mul_ps(swapped, cross4));
+			_mm_store_ps(bus + frame * 2, _mm_add_ps(_mm_load_ps(bus + frame * 2), mixed));
+		}
+#elif defined(LOST_MIX_NEON)
+		const float directValues[4] = { gains[0], gains[3], gains[0], gains[3] };
+		const float crossValues[4]  = { gains[1], gains[2], gains[1], gains[2] };
+		const float32x4_t direct4 = vld1q_f32(directValues);
+		const float32x4_t cross4  = vld1q_f32(crossValues);
+		for (; frame + 2 <= frameCount; frame += 2)
+		{
+			float32x4_t stereo = vld1q_f32(samples + frame * 2);
+			float32x4_t swapped = vrev64q_f32(stereo);
+			vst1q_f32(bus + frame * 2, vmlaq_f32(vmlaq_f32(vld1q_f32(bus + frame * 2), stereo, direct4), swapped, cross4));
+		}
+#endif
+		for (; frame < frameCount; frame++)
+		{
+			float left = samples[frame * 2];
+			float right = samples[frame * 2 + 1];
+			bus[frame * 2]     += left * gains[0] + right * gains[1];
+			bus[frame * 2 + 1] += left * gains[2] + right * gains[3];
+		}
+	}
+
+	void _mixIntoBusRamped(float* bus, const float* samples, unsigned int frameCount, unsigned int channelCount, _VoiceGains& voiceGains, const float targetGains[4])
+	{
+		const float* from = voiceGains.gains;
+		bool changed = from[0] != targetGains[0] || from[1] != targetGains[1] || from[2] != targetGains[2] || from[3] != targetGains[3];
+
+		if (!voiceGains.started || !changed || frameCount == 0)
+		{
+			_mixIntoBus(bus, samples, frameCount, channelCount, targetGains);
+			memcpy(voiceGains.gains, targetGains, sizeof(float) * 4);
+			voiceGains.started = true;
+			return;
+		}
+
+		// Frame "f" is mixed with from + step * (f + 1), so the last frame of the block lands exactly on the target
+		// Working from the frame index rather than adding the step up each frame keeps rounding from building up
+		float step[4];
+		for (int i = 0; i < 4; i++)
+			step[i] = (targetGains[i] - from[i]) / frameCount;
+
+		unsigned int frame = 0;
+
+		if (channelCount == 1)
+		{
+			float leftFrom = from[0] + from[1], leftStep = step[0] + step[1];
+			float rightFrom = from[2] + from[3], rightStep = step[2] + step[3];
+
+#if defined(LOST_MIX_SSE)
+			const __m128 from4 = _mm_setr_ps(leftFrom, rightFrom, leftFrom, rightFrom);
+			const __m128 step4 = _mm_setr_ps(leftStep, rightStep, leftStep, rightStep);
+			for (; frame + 4 <= frameCount; frame += 4)
+			{
+				float index = (float)(frame + 1);
+				__m128 lowGains  = _mm_add_ps(from4, _mm_mul_ps(step4, _mm_setr_ps(index, index, index + 1.0f, index + 1.0f)));
+				__m128 highGains = _mm_add_ps(from4, _mm_mul_ps(step4, _mm_setr_ps(index + 2.0f, index + 2.0f, index + 3.0f, index + 3.0f)));
+				__m128 mono = _mm_load_ps(samples + frame);
+				_mm_store_ps(bus + frame * 2,     _mm_add_ps(_mm_load_ps(bus + frame * 2),     _mm_mul_ps(_mm_unpacklo_ps(mono, mono), lowGains)));
+				_mm_store_ps(bus + frame * 2 + 4, _mm_add_ps(_mm_load_ps(bus + frame * 2 + 4), _mm_mul_ps(_mm_unpackhi_ps(mono, mono), highGains)));
+			}
+#elif defined(LOST_MIX_NEON)
+			const float fromValues[4] = { leftFrom, rightFrom, leftFrom, rightFrom };
+			const float stepValues[4] = { leftStep, rightStep, leftStep, rightStep };
+			const float32x4_t from4 = vld1q_f32(fromValues);
+			const float32x4_t step4 = vld1q_f32(stepValues);
+			for (; frame + 4 <= frameCount; frame += 4)
+			{
+				float index = (float)(frame + 1);
+				const float lowIndex[4]  = { index, index, index + 1.0f, index + 1.0f };
+				const float highIndex[4] = { index + 2.0f, index + 2.0f, index + 3.0f, index + 3.0f };
+				float32x4x2_t mono = vzipq_f32(vld1q_f32(samples + frame), vld1q_f32(samples + frame));
+				vst1q_f32(bus + frame * 2,     vmlaq_f32(vld1q_f32(bus + frame * 2),     mono.val[0], vmlaq_f32(from4, step4, vld1q_f32(lowIndex))));
+				vst1q_f32(bus + frame * 2 + 4, vmlaq_f32(vld1q_f32(bus + frame * 2 + 4), mono.val[1], vmlaq_f32(from4, step4, vld1q_f32(highIndex))));
+			}
+#endif
+			for (; frame < frameCount; frame++)
+			{
+				float index = (float)(frame + 1);
+				bus[frame * 2]     += samples[frame] * (leftFrom + leftStep * index);
+				bus[frame * 2 + 1] += samples[frame] * (rightFrom + rightStep * index);
+			}
+		}
+		else
+		{
+#if defined(LOST_MIX_SSE)
+			const __m128 directFrom4 = _mm_setr_ps(from[0], from[3], from[0], from[3]);
+			const __m128 directStep4 = _mm_setr_ps(step[0], step[3], step[0], step[3]);
+			const __m128 crossFrom4  = _mm_setr_ps(from[1], from[2], from[1], from[2]);
+			const __m128 crossStep4  = _mm_setr_ps(step[1], step[2], step[1], step[2]);
+			for (; frame + 2 <= frameCount; frame += 2)
+			{
+				float index = (float)(frame + 1);
+				__m128 index4 = _mm_setr_ps(index, index, index + 1.0f, index + 1.0f);
+				__m128 direct = _mm_add_ps(directFrom4, _mm_mul_ps(directStep4, index4));
+				__m128 cross  = _mm_add_ps(crossFrom4,  _mm_mul_ps(crossStep4,  index4));
+				__m128 stereo = _mm_load_ps(samples + frame * 2);
+				__m128 swapped = _mm_shuffle_ps(stereo, stereo, _MM_SHUFFLE(2, 3, 0, 1));
+				__m128 mixed = _mm_add_ps(_mm_mul_ps(stereo, direct), _mm_mul_ps(swapped, cross));
+				_mm_store_ps(bus + frame * 2, _mm_add_ps(_mm_load_ps(bus + frame * 2), mixed));
+			}
+#elif defined(LOST_MIX_NEON)
+			const float directFromValues[4] = { from[0], from[3], from[0], from[3] };
+			const float directStepValues[4] = { step[0], step[3], step[0], step[3] };
+			const float crossFromValues[4]  = { from[1], from[2], from[1], from[2] };
+			const float crossStepValues[4]  = { step[1], step[2], step[1], step[2] };
+			const float32x4_t directFrom4 = vld1q_f32(directFromValues);
+			const float32x4_t directStep4 = vld1q_f32(directStepValues);
+			const float32x4_t crossFrom4  = vld1q_f32(crossFromValues);
+			const float32x4_t crossStep4  = vld1q_f32(crossStepValues);
+			for (; frame + 2 <= frameCount; frame += 2)
+			{
+				float index = (float)(frame + 1);
+				const float indexValues[4] = { index, index, index + 1.0f, index + 1.0f };
+				float32x4_t index4 = vld1q_f32(indexValues);
+				float32x4_t stereo = vld1q_f32(samples + frame * 2);
+				float32x4_t mixed = vmlaq_f32(vld1q_f32(bus + frame * 2), stereo, vmlaq_f32(directFrom4, directStep4, index4));
+				vst1q_f32(bus + frame * 2, vmlaq_f32(mixed, vrev64q_f32(stereo), vmlaq_f32(crossFrom4, crossStep4, index4)));
+			}
+#endif
+			for (; frame < frameCount; frame++)
+			{
+				float index = (float)(frame + 1);
+				float left = samples[frame * 2];
+				float right = samples[frame * 2 + 1];
+				bus[frame * 2]     += left * (from[0] + step[0] * index) + right * (from[1] + step[1] * index);
+				bus[frame * 2 + 1] += left * (from[2] + step[2] * index) + right * (from[3] + step[3] * index);
+			}
+		}
+
+		memcpy(voiceGains.gains, targetGains, sizeof(float) * 4);
+	}
+
+#if defined(LOST_MIX_NEON)
+	// vcvtq_s32_f32 truncates towards zero, rounded here to match the lrintf used by the scalar tail
+	static inline int32x4_t roundToInt(float32x4_t value)
+	{
+#if defined(__aarch64__) || defined(_M_ARM64)
+		return vcvtnq_s32_f32(value);
+#else
+		// ARMv7 has no rounding convert, so add 0.5 with the sample's sign before truncating
+		const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(value), vdupq_n_u32(0x80000000u));
+		const float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+		return vcvtq_s32_f32(vaddq_f32(value, half));
+#endif
+	}
+#endif
+
+	void _writeBus(const float* bus, unsigned int sampleCount, float gain, void* out, RtAudioFormat format)
+	{
+		unsigned int i = 0;
+
+		switch (format)
+		{
+		case RTAUDIO_SINT16:
+		{
+			int16_t* out16 = (int16_t*)out;
+			const float scale = gain * 32767.0f;
+#if defined(LOST_MIX_SSE)
+			// Clamped before converting as out of range floats convert to INT_MIN, the pack then saturates to 16 bits
+			const __m128 scale4 = _mm_set1_ps(scale);
+			const __m128 minimum = _mm_set1_ps(-32768.0f);
+			const __m128 maximum = _mm_set1_ps(32767.0f);
+			for (; i + 8 <= sampleCount; i += 8)
+			{
+				__m128 low  = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_load_ps(bus + i),     scale4), minimum), maximum);
+				__m128 high = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_load_ps(bus + i + 4), scale4), minimum), maximum);
+				_mm_storeu_si128((__m128i*)(out16 + i), _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+			}
+#elif defined(LOST_MIX_NEON)
+			for (; i + 8 <= sampleCount; i += 8)
+			{
+				int32x4_t low  = roundToInt(vmulq_n_f32(vld1q_f32(bus + i),     scale));
+				int32x4_t high = roundToInt(vmulq_n_f32(vld1q_f32(bus + i + 4), scale));
+				vst1q_s16(out16 + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+			}
+#endif
+			for (; i < sampleCount; i++)
+				out16[i] = (int16_t)lrintf(fminf(fmaxf(bus[i] * scale, -32768.0f), 32767.0f));
+			break;
+		}
+		case RTAUDIO_SINT24:
+		{
+			unsigned char* out24 = (unsigned char*)out;
+			const float scale = gain * 8388607.0f;
+			for (; i < sampleCount; i++)
+			{
+				int32_t sample = (int32_t)lrintf(fminf(fmaxf(bus[i] * scale, -8388608.0f), 8388607.0f));
+				out24[i * 3]     = (unsigned char)(sample);
+				out24[i * 3 + 1] = (unsigned char)(sample >> 8);
+				out24[i * 3 + 2] = (unsigned char)(sample >> 16);
+			}
+			break;
+		}
+		case RTAUDIO_SINT32:
+		{
+			int32_t* out32 = (int32_t*)out;
+			// Doubles as floats can't hold INT_MAX exactly, so clamping to it in float would overflow the convert
+			const double scale = gain * 2147483647.0;
+			for (; i < sampleCount; i++)
+				out32[i] = (int32_t)llrint(fmin(fmax(bus[i] * scale, -2147483648.0), 2147483647.0));
+			break;
+		}
+		case RTAUDIO_FLOAT32:
+		{
+			float* outFloat = (float*)out;
+			for (; i < sampleCount; i++)
+				outFloat[i] = fminf(fmaxf(bus[i] * gain, -1.0f), 1.0f);
+			break;
+		}
+		default:
+			memset(out, 0, sampleCount * _getFormatByteSize(format));
+			break;
+		}
+	}
+
+	void _initResampler()
+	{
+		const int taps = _ResamplerHalfTaps * 2;
+		for (unsigned int phase = 0; phase < s_ResamplePhases; phase++)
+		{
+			float fraction = (float)phase / s_ResamplePhases;
+
+			float sum = 0.0f;
+			float coefficients[_ResamplerHalfTaps * 2];
+			for (int tap = 0; tap < taps; tap++)
+			{
+				// Distance from the point being played to this tap's source frame
+				double x = (tap - ((int)_ResamplerHalfTaps - 1)) - fraction;
+				double sinc = x == 0.0 ? 1.0 : sin(s_Pi * x * s_ResampleCutoff) / (s_Pi * x * s_ResampleCutoff);
+				// Blackman window over the width of the filter
+				double window = 0.42 + 0.5 * cos(s_Pi * x / _ResamplerHalfTaps) + 0.08 * cos(2.0 * s_Pi * x / _ResamplerHalfTaps);
+				coefficients[tap] = (float)(sinc * (window > 0.0 ? window : 0.0));
+				sum += coefficients[tap];
+			}
+
+			// Normalized so every phase passes a constant signal through at the same volume
+			for (int tap = 0; tap < taps; tap++)
+			{
+				s_SincMono[phase][tap] = coefficients[tap] / sum;
+				s_SincStereo[phase][tap * 2] = s_SincStereo[phase][tap * 2 + 1] = coefficients[tap] / sum;
+			}
+		}
+	}
+
+	void _resample(const float* window, unsigned int channelCount, uint32_t fraction, uint64_t step, unsigned int frameCount, float* out, ResampleQuality quality)
+	{
+		const float fractionScale = 1.0f / 4294967296.0f;
+		uint64_t position = fraction;
+
+		if (quality == LOST_RESAMPLE_LINEAR)
+		{
+			for (unsigned int frame = 0; frame < frameCount; frame++, position += step)
+			{
+				const float* source = window + ((position >> 32) + _ResamplerHalfTaps - 1) * channelCount;
+				float t = (uint32_t)position * fractionScale;
+
+				if (channelCount == 1)
+				{
+					out[frame] = source[0] + (source[1] - source[0]) * t;
+					continue;
+				}
+#if defined(LOST_MIX_SSE)
+				// Both channels of this frame and the next in one load, blended as a pair
+				__m128 current = _mm_loadu_ps(source);
+				__m128 next = _mm_movehl_ps(current, current);
+				__m128 blended = _mm_add_ps(current, _mm_mul_ps(_mm_sub_ps(next, current), _mm_set1_ps(t)));
+				_mm_storel_pi((__m64*)(out + frame * 2), blended);
+#else
+				out[frame * 2]     = source[0] + (source[2] - source[0]) * t;
+				out[frame * 2 + 1] = source[1] + (source[3] - source[1]) * t;
+#endif
+			}
+			return;
+		}
+
+		for (unsigned int frame = 0; frame < frameCount; frame++, position += step)
+		{
+			// Rounded to the nearest phase, rounding up past the last one lands on the next frame's first phase
+			uint64_t rounded = position + (1ull << (31 - s_ResamplePhaseBits));
+			const float* source = window + (rounded >> 32) * channelCount;
+			unsigned int phase = (uint32_t)rounded >> (32 - s_ResamplePhaseBits);
+
+			if (channelCount == 1)
+			{
+				const float* coefficients = s_SincMono[phase];
+#if defined(LOST_MIX_SSE)
+				__m128 sum = _mm_mul_ps(_mm_loadu_ps(source), _mm_load_ps(coefficients));
+				for (unsigned int tap = 4; tap < _ResamplerHalfTaps * 2; tap += 4)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(source + tap), _mm_load_ps(coefficients + tap)));
+				sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+				sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+				out[frame] = _mm_cvtss_f32(sum);
+#elif defined(LOST_MIX_NEON)
+				float32x4_t sum = vmulq_f32(vld1q_f32(source), vld1q_f32(coefficients));
+				for (unsigned int tap = 4; tap < _ResamplerHalfTaps * 2; tap += 4)
+					sum = vmlaq_f32(sum, vld1q_f32(source + tap), vld1q_f32(coefficients + tap));
+				float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+				out[frame] = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#else
+				float sum = 0.0f;
+				for (unsigned int tap = 0; tap < _ResamplerHalfTaps * 2; tap++)
+					sum += source[tap] * coefficients[tap];
+				out[frame] = sum;
+#endif
+				continue;
+			}
+
+			// Stereo uses the table with every coefficient doubled up, so the interleaved frames are used as they are
+			const float* coefficients = s_SincStereo[phase];
+#if defined(LOST_MIX_SSE)
+			__m128 sum = _mm_mul_ps(_mm_loadu_ps(source), _mm_load_ps(coefficients));
+			for (unsigned int tap = 4; tap < _ResamplerHalfTaps * 4; tap += 4)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(source + tap), _mm_load_ps(coefficients + tap)));
+			// Lanes are left, right, left, right
+			_mm_storel_pi((__m64*)(out + frame * 2), _mm_add_ps(sum, _mm_movehl_ps(sum, sum)));
+#elif defined(LOST_MIX_NEON)
+			float32x4_t sum = vmulq_f32(vld1q_f32(source), vld1q_f32(coefficients));
+			for (unsigned int tap = 4; tap < _ResamplerHalfTaps * 4; tap += 4)
+				sum = vmlaq_f32(sum, vld1q_f32(source + tap), vld1q_f32(coefficients + tap));
+			vst1_f32(out + frame * 2, vadd_f32(vget_low_f32(sum), vget_high_f32(sum)));
+#else
+			float left = 0.0f, right = 0.0f;
+			for (unsigned int tap = 0; tap < _ResamplerHalfTaps * 2; tap++)
+			{
+				left  += source[tap * 2]     * coefficients[tap * 2];
+				right += source[tap * 2 + 1] * coefficients[tap * 2];
+			}
+			out[frame * 2] = left;
+			out[frame * 2 + 1] = right;
+#endif
+		}
+	}
+
+	unsigned int _getFormatByteSize(RtAudioFormat format)
+	{
+		switch (format)
+		{
+		case RTAUDIO_SINT8:   return 1;
+		case RTAUDIO_SINT16:  return 2;
+		case RTAUDIO_SINT24:  return 3;
+		case RTAUDIO_SINT32:  return 4;
+		case RTAUDIO_FLOAT32: return 4;
+		case RTAUDIO_FLOAT64: return 8;
+		default:              return 0;
+		}
+	}
+
+}
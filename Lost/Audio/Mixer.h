@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+
+#include <stdint.h>
+
+#include "External/RtAudio.h"
+
+// How sounds are resampled when their sample rate or playback rate doesn't match the audio device
+enum ResampleQuality
+{
+	// Blends between the 2 nearest samples, cheap but dulls high frequencies and aliases a little
+	LOST_RESAMPLE_LINEAR,
+
+	// This is the DEFAULT setting Lost uses on start up
+	// 16 tap windowed sinc filter, keeps the sound clean at a few times the cost of linear
+	LOST_RESAMPLE_SINC
+};
+
+namespace lost
+{
+
+	// The amount of source frames each side of a resampled frame that the sinc filter reads
+	// The window given to _resample() must start this many frames minus 1 before the first frame played
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	const unsigned int _ResamplerHalfTaps = 8;
+
+	// A float buffer aligned for the mixing kernels, sized up front so the audio thread never allocates
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _MixBuffer
+	{
+	public:
+		void resize(unsigned int floatCount);
+
+		inline float* data() { return m_Data; };
+		inline unsigned int size() const { return m_Size; };
+	private:
+		std::vector<float> m_Storage;
+		float* m_Data = nullptr;
+		unsigned int m_Size = 0;
+	};
+
+	// Converts "count" signed PCM samples of "bytesPerSample" bytes (2, 3 or 4) into floats between -1 and 1
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _decodeSamples(const char* data, unsigned int bytesPerSample, unsigned int count, float* out);
+
+	// Works out the gains a voice is mixed into the stereo bus with, as { leftToLeft, rightToLeft, leftToRight, rightToRight }
+	// Panning moves the opposite channel across with a constant power curve, mono voices use both of their gains
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _calculatePanGains(float volume, float panning, float gains[4]);
+
+	// Adds "frameCount" frames of mono or stereo samples into the interleaved stereo bus
+	// Both buffers must be aligned like _MixBuffer's
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _mixIntoBus(float* bus, const float* samples, unsigned int frameCount, unsigned int channelCount, const float gains[4]);
+
+	// The gains a voice was last mixed with, so changes to it's volume or panning can be ramped across a block
+	// Only ever touched by the audio thread
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	struct _VoiceGains
+	{
+		float gains[4];
+		bool started = false;
+	};
+
+	// Same as _mixIntoBus() but moves linearly from the voice's last gains to "targetGains" across the block, which stops zipper noise
+	// A voice's first block starts straight at it's target, "voiceGains" is left at the target afterwards
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _mixIntoBusRamped(float* bus, const float* samples, unsigned int frameCount, unsigned int channelCount, _VoiceGains& voiceGains, const float targetGains[4]);
+
+	// Scales the bus by "gain" and converts it into the device's format, saturating anything outside of -1 to 1
+	// Supports RTAUDIO_SINT16, RTAUDIO_SINT24, RTAUDIO_SINT32 and RTAUDIO_FLOAT32
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _writeBus(const float* bus, unsigned int sampleCount, float gain, void* out, RtAudioFormat format);
+
+	// Builds the sinc filter's tables, ran once before the audio stream starts
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _initResampler();
+
+	// Resamples "frameCount" frames from "window" into "out", moving "step" source frames per frame (32.32 fixed point)
+	// "fraction" is how far between source frames the first frame is, which sits at window frame _ResamplerHalfTaps - 1
+	// The window must hold _ResamplerHalfTaps + 1 frames after the last source frame reached, as the sinc filter rounds it's phase up
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _resample(const float* window, unsigned int channelCount, uint32_t fraction, uint64_t step, unsigned int frameCount, float* out, ResampleQuality quality);
+
+	// The amount of bytes a sample takes in the format given
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned int _getFormatByteSize(RtAudioFormat format);
+
+}
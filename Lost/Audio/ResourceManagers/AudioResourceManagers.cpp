@@ -5,6 +5,7 @@
 #include <algorithm>
 
 #include "../Audio.h"
+#include "../../AsyncLoader.h"
 
 template <typename Out>
 static void split(const std::string& s, char delim, Out result) {
@@ -90,11 +91,55 @@ namespace lost
 		return sound;
 	}
 
+	// The sound read on a worker thread, handed to the sound given out once it's back on the main thread
+	class SoundLoad : public _AsyncLoad
+	{
+	public:
+		SoundLoad(Sound sound, const char* soundLoc) : _AsyncLoad(sound), m_Location(soundLoc) {};
+
+		void load() override
+		{
+			m_Sound._initializeWithFile(m_Location.c_str());
+		}
+
+		void finish() override
+		{
+			((Sound)getTarget())->_takeData(m_Sound);
+		}
+	private:
+		std::string m_Location;
+		_Sound m_Sound;
+	};
+
+	Sound loadSoundAsync(const char* soundLoc, const char* id)
+	{
+		lost::Sound sound = nullptr;
+
+		// If "id" is nullptr set it to the filename
+		if (!id) id = soundLoc;
+
+		if (!_soundRM->hasValue(id))
+		{
+			sound = new _Sound();
+			_queueAsyncLoad(new SoundLoad(sound, soundLoc));
+		}
+		else
+			sound = _soundRM->getValue(id);
+
+		_soundRM->addValue(sound, id);
+		return sound;
+	}
+
 	Sound getSound(const char* id)
 	{
 		return _soundRM->getValue(id);
 	}
 
+	Sound getSound(ResourceID id)
+	{
+		return _soundRM->getValue(id);
+	}
+
 	void unloadSound(const char* id)
 	{
 		_soundRM->destroyValue(id);
@@ -139,6 +184,11 @@ namespace lost
 		return _streamRM->getValue(id);
 	}
 
+	SoundStream getSoundStream(ResourceID id)
+	{
+		return _streamRM->getValue(id);
+	}
+
 	void unloadSoundStream(const char* id)
 	{
 		_streamRM->destroyValue(id);
@@ -17,7 +17,10 @@ namespace lost
 
 	// Sound Load Functions
 	Sound loadSound(const char* soundLoc, const char* id = nullptr);
+	// Returns straight away, the sound plays nothing until it has loaded in the background
+	Sound loadSoundAsync(const char* soundLoc, const char* id = nullptr);
 	Sound getSound(const char* id);
+	Sound getSound(ResourceID id);
 	void  unloadSound(const char* id);
 	void  unloadSound(Sound& sound);
 	void  forceUnloadSound(const char* id);
@@ -26,6 +29,7 @@ namespace lost
 	// Stream Load Functions
 	SoundStream loadSoundStream(const char* soundLoc, const char* id = nullptr);
 	SoundStream getSoundStream(const char* id);
+	SoundStream getSoundStream(ResourceID id);
 	void		unloadSoundStream(const char* id);
 	void		unloadSoundStream(SoundStream& sound);
 	void		forceUnloadSoundStream(const char* id);
@@ -1,10 +1,21 @@
 #include "Sounds.h"
 #include "../Log.h"
+#include "../AsyncLoader.h"
 
 #include "Audio.h"
 
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <thread>
-#include <mutex>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <semaphore.h>
+#endif
 
 namespace lost
 {
@@ -110,12 +121,14 @@ namespace lost
 
 	_Sound::_Sound()
 		: m_SoundInfo{ 0, 0, 0, 0, 0, 0 }
+		, m_Data(nullptr)
 		, m_Functional(false)
 	{
 	}
 
 	_Sound::~_Sound()
 	{
+		_cancelAsyncLoads(this);
 		_destroy();
 	}
 
@@ -152,6 +165,18 @@ namespace lost
 		}
 	}
 
+	void _Sound::_takeData(_Sound& other)
+	{
+		_destroy();
+
+		m_SoundInfo = other.m_SoundInfo;
+		m_Data = other.m_Data;
+		m_Functional = other.m_Functional;
+
+		other.m_Data = nullptr;
+		other.m_Functional = false;
+	}
+
 	void _Sound::_destroy()
 	{
 		if (m_Data)
@@ -162,17 +187,98 @@ namespace lost
 		m_Functional = false;
 	}
 
+#pragma region Sound stream loading
+
+	// Streams waiting for a refill, pushed by the audio thread and popped by the stream loader thread
+	// Full queues are retried on the stream's next block, see _SoundStream::requestRefill()
+	static const unsigned int s_StreamRefillCapacity = 256;
+	static _WaitFreeQueue<_SoundStream*, s_StreamRefillCapacity> s_StreamRefills;
+
+	static std::thread s_StreamLoaderThread;
+	static std::atomic<bool> s_StreamLoaderRunning(false);
+
+	// Posted once per push, the loader sleeps on it so nothing runs while no stream is playing
+	// A semaphore post never waits on another thread, which is what makes it safe to do from the audio thread (unlike a condition variable)
+#ifdef _WIN32
+	static HANDLE s_StreamLoaderWake = NULL;
+#else
+	static sem_t s_StreamLoaderWake;
+#endif
+
+	static void wakeStreamLoader()
+	{
+		// A post past the maximum count is dropped, the loader is already awake and drains the whole queue either way
+#ifdef _WIN32
+		ReleaseSemaphore(s_StreamLoaderWake, 1, NULL);
+#else
+		sem_post(&s_StreamLoaderWake);
+#endif
+	}
+
+	static void streamLoaderLoop()
+	{
+		_SoundStream* stream;
+		while (true)
+		{
+#ifdef _WIN32
+			WaitForSingleObject(s_StreamLoaderWake, INFINITE);
+#else
+			while (sem_wait(&s_StreamLoaderWake) != 0) {} // Only fails when interrupted
+#endif
+			if (!s_StreamLoaderRunning.load(std::memory_order_acquire))
+				break;
+
+			while (s_StreamRefills.pop(stream))
+				stream->_fillBuffer();
+		}
+	}
+
+	void _startStreamLoader()
+	{
+		if (s_StreamLoaderRunning.exchange(true))
+			return;
+#ifdef _WIN32
+		// One count per queue slot, plus one for the stop
+		s_StreamLoaderWake = CreateSemaphore(NULL, 0, s_StreamRefillCapacity + 1, NULL);
+#else
+		sem_init(&s_StreamLoaderWake, 0, 0);
+#endif
+		s_StreamLoaderThread = std::thread(&streamLoaderLoop);
+	}
+
+	void _stopStreamLoader()
+	{
+		if (!s_StreamLoaderRunning.exchange(false))
+			return;
+		wakeStreamLoader();
+		s_StreamLoaderThread.join();
+#ifdef _WIN32
+		CloseHandle(s_StreamLoaderWake);
+		s_StreamLoaderWake = NULL;
+#else
+		sem_destroy(&s_StreamLoaderWake);
+#endif
+
+		// Nothing is pushed once the audio stream is closed, finishing these lets the streams be destroyed
+		_SoundStream* stream;
+		while (s_StreamRefills.pop(stream))
+			stream->_fillBuffer();
+	}
+
+#pragma endregion
+
 	_SoundStream::_SoundStream(unsigned int bufferSize)
 		: m_BufferSize(bufferSize)
 		, a_UsingBBuffer(false)
 		, m_File(nullptr)
 		, m_Functional(false)
 		, m_SoundInfo{ 0, 0, 0, 0, 0, 0 }
-		, a_Playing{ false }
+		, m_Playing(false)
 		, m_Active(false)
 		, a_LoopCount(0)
-		, a_Volume{ 1.0f }
-		, a_Panning{ 0.0f }
+		, a_BufferState(BufferReady)
+		, a_WindowFrames(0)
+		, a_WindowEnd(UINT_MAX)
 	{
 		a_Buffer = nullptr;
 		a_CurrentByte = 0;
@@ -200,8 +306,16 @@ namespace lost
 
 			m_File = waveData.loadedFile;
 
+			// Blocks cover every source frame one callback can resample from, so the loader only ever has to stay one block ahead
+			unsigned int deviceRate = _getAudioHandlerSampleRate();
+			if (deviceRate != 0 && m_SoundInfo.sampleRate != 0)
+				m_BufferSize = (unsigned int)ceil((double)m_BufferSize * m_SoundInfo.sampleRate / deviceRate);
+			m_BufferSize += _ResamplerHalfTaps * 2 + 2;
+
 			m_ByteSize = m_BufferSize * m_SoundInfo.channelCount * (m_SoundInfo.bitsPerSample / 8);
 			a_Buffer = new char[m_ByteSize * 2]; // * 2 because we are dual buffering, this just helps with "hot-memory"
+			a_Window.resize(m_BufferSize * 2 * m_SoundInfo.channelCount);
+			resetWindow();
 
 			// Bytes per channel's samples
 			unsigned int soundFormat = m_SoundInfo.format;
@@ -218,6 +332,10 @@ namespace lost
 
 	void _SoundStream::_destroy()
 	{
+		// The stream loader may still be filling the buffer
+		while (a_BufferState.load(std::memory_order_acquire) == BufferFilling)
+			std::this_thread::yield();
+
 		if (a_Buffer)
 		{
 			delete[] a_Buffer;
@@ -261,12 +379,18 @@ namespace lost
 
 	const char* _SoundStream::_getNextDataBlock()
 	{
-		// Check if the other buffer is currently being filled
+		// Nothing here locks or allocates, the file is only read on the stream loader thread
 
-		if (a_FillingBufferMutex.try_lock())
+		unsigned char bufferState = a_BufferState.load(std::memory_order_acquire);
+		if (bufferState == BufferRequested)
 		{
-			// If it isn't be immediately unlock it and start a _fillBuffer thread
-			// which then locks it until it's filled the other buffer
+			// The loader's queue was full last time
+			requestRefill();
+			return nullptr;
+		}
+		else if (bufferState == BufferReady)
+		{
+			// The other buffer has been filled, swap to it and hand this one over to be refilled
 
 			// Increase current byte by buffer size
 			if (m_SoundInfo.byteCount > a_CurrentByte + m_ByteSize)
@@ -286,35 +410,110 @@ namespace lost
 					a_CurrentByte = m_SoundInfo.byteCount;
 			}
 
-			// Swap buffers and start a fill buffer thread
+			// Swap buffers and request a refill
 			a_UsingBBuffer = !a_UsingBBuffer;
-
-			a_FillingBufferMutex.unlock();
-			a_FillingBufferThread = std::thread(&_SoundStream::_fillBuffer, this);
-			a_FillingBufferThread.detach();
+			requestRefill();
 		}
 
-		// If it is we reuse the old data, this does cause audio glitching
+		else
+		{
+			// Still being filled, the caller plays what it already has
+			return nullptr;
+		}
 
 		// If using B buffer return B buffer, otherwise return A buffer
 		return a_UsingBBuffer ? a_Buffer + m_ByteSize : a_Buffer;
 	}
 
-	void _SoundStream::_prepareStartPlay(float volume, float panning, unsigned int loopCount)
+	void _SoundStream::_fillWindow(unsigned int frameCount)
 	{
+		const unsigned int channelCount = m_SoundInfo.channelCount;
+		const unsigned int bytesPerSample = m_SoundInfo.bitsPerSample / 8;
+		const unsigned int capacity = a_Window.size() / channelCount;
+		if (frameCount > capacity)
+			frameCount = capacity;
+
+		while (a_WindowFrames < frameCount)
+		{
+			float* out = a_Window.data() + a_WindowFrames * channelCount;
+			if (a_WindowEnd != UINT_MAX)
+			{
+				// Past the end of the data the filter reads silence
+				memset(out, 0, (frameCount - a_WindowFrames) * channelCount * sizeof(float));
+				a_WindowFrames = frameCount;
+				break;
+			}
+
+			if (a_WindowFrames + m_BufferSize > capacity)
+				break;
+
+			// Taking the block moves on to the next one, so what's left is read first
+			unsigned int bytesLeft = _getBytesLeftToPlay();
+			const char* block = _getNextDataBlock();
+			if (!block)
+				break;
+
+			unsigned int blockFrames = m_BufferSize;
+			if (bytesLeft <= m_ByteSize)
+			{
+				blockFrames = bytesLeft / (bytesPerSample * channelCount);
+				a_WindowEnd = a_WindowFrames + blockFrames;
+			}
+
+			_decodeSamples(block, bytesPerSample, blockFrames * channelCount, out);
+			a_WindowFrames += blockFrames;
+		}
+	}
+
+	void _SoundStream::_consumeWindow(unsigned int frameCount)
+	{
+		if (frameCount > a_WindowFrames)
+			frameCount = a_WindowFrames;
+		if (frameCount == 0)
+			return;
+
+		const unsigned int channelCount = m_SoundInfo.channelCount;
+		memmove(a_Window.data(), a_Window.data() + frameCount * channelCount, (a_WindowFrames - frameCount) * channelCount * sizeof(float));
+		a_WindowFrames -= frameCount;
+		if (a_WindowEnd != UINT_MAX)
+			a_WindowEnd = a_WindowEnd > frameCount ? a_WindowEnd - frameCount : 0;
+	}
+
+	void _SoundStream::resetWindow()
+	{
+		// The filter reads before the first frame, which is silent
+		a_WindowFrames = _ResamplerHalfTaps - 1;
+		a_WindowEnd = UINT_MAX;
+		memset(a_Window.data(), 0, a_WindowFrames * m_SoundInfo.channelCount * sizeof(float));
+	}
+
+	void _SoundStream::requestRefill()
+	{
+		// Marked first, as the loader can finish the refill as soon as it's pushed
+		a_BufferState.store(BufferFilling, std::memory_order_relaxed);
+		if (s_StreamRefills.push(this))
+			wakeStreamLoader();
+		else
+			a_BufferState.store(BufferRequested, std::memory_order_relaxed);
+	}
+
+	void _SoundStream::_prepareStartPlay(unsigned int loopCount)
+	{
+		// The audio thread is done with the stream, but the loader may still be refilling it from the last play
+		while (a_BufferState.load(std::memory_order_acquire) == BufferFilling)
+			std::this_thread::yield();
+		a_BufferState.store(BufferReady, std::memory_order_relaxed);
+
 		fseek(m_File, 44, SEEK_SET);
 		fread_s(a_Buffer, m_ByteSize, sizeof(char), m_ByteSize, m_File);
 		a_CurrentByte = 0;
 		a_UsingBBuffer = true;
 		a_LoopCount = loopCount;
-		a_Volume.write(volume);
-		a_Panning.write(panning);
+		resetWindow();
 	}
 
 	void _SoundStream::_fillBuffer()
 	{
-		a_FillingBufferMutex.lock();
-
 		// This just gets the start byte of the buffer to start writing in (The opposite of the get function)
 		char* writeStartByte = a_UsingBBuffer ? a_Buffer : a_Buffer + m_ByteSize;
 
@@ -331,7 +530,8 @@ namespace lost
 			fread_s(writeStartByte + readCount, m_ByteSize - readCount, sizeof(char), m_ByteSize - readCount, m_File);
 		}
 
-		a_FillingBufferMutex.unlock();
+		// Releases the buffer back to the audio thread
+		a_BufferState.store(BufferReady, std::memory_order_release);
 	}
 
 }
\ No newline at end of file
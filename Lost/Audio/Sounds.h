@@ -2,6 +2,7 @@
 
 #include "External/RtAudio.h"
 #include "ThreadSafeTemplate.h"
+#include "Mixer.h"
 
 namespace lost
 {
@@ -29,6 +30,8 @@ namespace lost
 
 		void _initializeWithFile(const char* fileLocation);
 		void _initializeWithRaw(void* data, size_t dataSize);
+		// Takes the data of a sound loaded on another thread, leaving "other" empty
+		void _takeData(_Sound& other);
 
 		void _destroy();
 
@@ -69,21 +72,40 @@ namespace lost
 		unsigned int _getBytesLeftToPlay() const;
 		unsigned int _getFormatFactor() const;
 		unsigned int _getLoopCount() const;
-		inline float _getVolume() { return a_Volume.read(); };
-		inline float _getPanning() { return a_Panning.read(); };
-		inline void  _setVolume(float volume) { a_Volume.write(volume); };
-		inline void  _setPanning(float panning) { a_Panning.write(panning); };
-		const char* _getNextDataBlock();
+		const char* _getNextDataBlock(); // Returns nullptr if the stream loader hasn't filled the next block yet
 
-		inline bool isPlaying()					{ return a_Playing.read();  };
-		inline void _setIsPlaying(bool playing) { a_Playing.write(playing); };
+		// Ran by the audio thread, the stream decoded into floats so it can be resampled across blocks
+		// The window starts _ResamplerHalfTaps - 1 frames before the frame being played, as _resample() expects
+		void _fillWindow(unsigned int frameCount);    // Decodes blocks until the window holds "frameCount" frames, or the loader falls behind
+		void _consumeWindow(unsigned int frameCount); // Drops frames from the start of the window once the filter can't reach them
+		inline const float* _getWindow() { return a_Window.data(); };
+		inline unsigned int _getWindowFrames() const { return a_WindowFrames; };
+		inline unsigned int _getWindowEnd() const { return a_WindowEnd; }; // The window frame the stream's data ends at, UINT_MAX until it's been read
 
-		void _prepareStartPlay(float volume, float panning, unsigned int loopCount);
+		// Only used by main thread
+		inline bool isPlaying() const			{ return m_Playing; };
+		inline void _setIsPlaying(bool playing) { m_Playing = playing; };
+
+		// Only used by main thread, while the audio thread isn't playing the stream
+		void _prepareStartPlay(unsigned int loopCount);
 
 		inline bool isFunctional() { return m_Functional; };
-		// Ran by the file load thread (NOT MAIN)
+		// Ran by the stream loader thread (NOT MAIN), fills the buffer the audio thread isn't reading
 		void _fillBuffer();
 	private:
+		// Ran by the audio thread, hands the buffer it just finished with to the stream loader thread
+		void requestRefill();
+		// Empties the window back to the silence before the stream starts
+		void resetWindow();
+
+		// Who owns the buffer the audio thread isn't reading
+		enum BufferState : unsigned char
+		{
+			BufferReady,     // Filled, the audio thread can swap to it
+			BufferRequested, // Waiting for space in the stream loader's queue, only the audio thread knows about it
+			BufferFilling    // With the stream loader thread
+		};
+
 		FILE* m_File;
 
 		// Anything marked with an "a" at the start is used by the audio thread
@@ -95,21 +117,21 @@ namespace lost
 
 		unsigned int a_CurrentByte;
 
-		_HaltWrite<bool> a_Playing; // Actively being used by the audio thread
-		bool m_Active;              // True even if it's in garbage
+		bool m_Playing;             // Cleared once it's been stopped or has finished
+		bool m_Active;              // True until the audio thread has finished with it
 		unsigned int a_LoopCount;
 
-		_HaltWrite<float> a_Volume;
-		_HaltWrite<float> a_Panning;
-
-		std::mutex a_FillingBufferMutex;
-		std::thread a_FillingBufferThread;
+		std::atomic<unsigned char> a_BufferState;
 
 		bool a_UsingBBuffer;
 		unsigned int m_BufferSize; // The amount of samples in the buffer
 		unsigned int m_ByteSize;   // The size of the buffer in bytes
 		char* a_Buffer; // Twice the length of bufferSize, using dual buffering
 
+		_MixBuffer a_Window; // Two blocks of frames, never more than one block is left over when the next is decoded
+		unsigned int a_WindowFrames;
+		unsigned int a_WindowEnd;
+
 		// Local
 		bool m_Functional;
 	};
@@ -117,4 +139,11 @@ namespace lost
 	typedef _Sound* Sound;
 	typedef _SoundStream* SoundStream;
 
+	// Starts the thread sound streams are refilled on, the audio thread only ever swaps to buffers it has filled
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _startStreamLoader();
+	// Stops the stream loader thread, ran once the audio stream is closed, finishing any refills still waiting
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _stopStreamLoader();
+
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mutex>
+#include <atomic>
 
 namespace lost
 {
@@ -55,6 +56,33 @@ namespace lost
 		std::mutex m_Mutex;
 	};
 
+	// A wait-free ring of messages from a single producer thread to a single consumer thread
+	// Eg. the main thread pushes commands and the audio thread pops them at the start of every callback
+	// Neither side ever locks or allocates, push fails instead when the ring is full
+	// "Capacity" must be a power of 2
+	template <typename T, unsigned int Capacity>
+	class _WaitFreeQueue
+	{
+	public:
+		static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "_WaitFreeQueue capacity must be a power of 2");
+
+		_WaitFreeQueue();
+
+		// Producer thread only
+		bool push(const T& in);
+		// Consumer thread only
+		bool pop(T& out);
+	private:
+		// The indices only ever increase and wrap around naturally, head == tail is empty and tail - head == Capacity is full
+		// Each is kept on it's own cache line so the two threads don't fight over it
+		std::atomic<unsigned int> m_Head; // Written by the consumer
+		char m_HeadPadding[64 - sizeof(std::atomic<unsigned int>)];
+		std::atomic<unsigned int> m_Tail; // Written by the producer
+		char m_TailPadding[64 - sizeof(std::atomic<unsigned int>)];
+
+		T m_Items[Capacity];
+	};
+
 	template<typename T>
 	inline _HaltWrite<T>::_HaltWrite(const T& in)
 		: m_WriteIndex(0)
@@ -130,4 +158,36 @@ namespace lost
 		m_Mutex.unlock();
 		return ret;
 	}
+
+	template<typename T, unsigned int Capacity>
+	inline _WaitFreeQueue<T, Capacity>::_WaitFreeQueue()
+		: m_Head(0)
+		, m_Tail(0)
+	{
+	}
+
+	template<typename T, unsigned int Capacity>
+	inline bool _WaitFreeQueue<T, Capacity>::push(const T& in)
+	{
+		unsigned int tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_Head.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		m_Items[tail & (Capacity - 1)] = in;
+		// Release so the item (and anything written before pushing it) is visible before the consumer sees the new tail
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T, unsigned int Capacity>
+	inline bool _WaitFreeQueue<T, Capacity>::pop(T& out)
+	{
+		unsigned int head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_Tail.load(std::memory_order_acquire))
+			return false;
+
+		out = m_Items[head & (Capacity - 1)];
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "CommandList.h"
+
+namespace lost
+{
+
+	_CommandList::_CommandList()
+	{
+	}
+
+	_CommandList::~_CommandList()
+	{
+	}
+
+	void _CommandList::begin(const glm::mat4x4& pvTransform, bool frustumCulling, float cullDistance)
+	{
+		m_PVTransform = pvTransform;
+		m_FrustumCulling = frustumCulling;
+		m_CullDistance = cullDistance;
+
+		m_Packets.clear();
+		m_Materials.clear();
+		m_CulledCount = 0;
+		m_InvalidCount = 0;
+	}
+
+	void _CommandList::record(Mesh mesh, const Material* materials, unsigned int materialCount, const glm::mat4x4& transform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode)
+	{
+		// Meshes still loading are skipped, they don't know how many materials they have yet
+		if (mesh != nullptr && ((CompiledMeshData*)mesh)->loading)
+			return;
+
+		// This can be ran on any thread, so nothing is logged here
+		if (mesh == nullptr || ((CompiledMeshData*)mesh)->materialSlotIndicies.size() != materialCount)
+		{
+			m_InvalidCount++;
+			return;
+		}
+
+		glm::mat4x4 mvpTransform = m_PVTransform * transform;
+
+		// Raw meshes have no bounds so are always kept
+		float depthVal = 0.0f;
+		const MeshBounds& bounds = ((CompiledMeshData*)mesh)->bounds;
+		if (bounds.valid && !_testMeshBounds(bounds, mvpTransform, m_CullDistance, depthVal) && m_FrustumCulling)
+		{
+			m_CulledCount++;
+			return;
+		}
+
+		Packet packet;
+		packet.mesh = mesh;
+		packet.materialStart = (unsigned int)m_Materials.size();
+		packet.materialCount = materialCount;
+		packet.depthVal = depthVal;
+		packet.mvpTransform = mvpTransform;
+		packet.modelTransform = transform;
+		packet.depthTestFuncOverride = depthTestFuncOverride;
+		packet.depthWrite = depthWrite;
+		packet.shaderOverride = shaderOverride;
+		packet.invertCullMode = invertCullMode;
+
+		m_Materials.insert(m_Materials.end(), materials, materials + materialCount);
+		m_Packets.push_back(packet);
+	}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+#include "Mesh/Mesh.h"
+#include "Shaders/Shader.h"
+
+namespace lost
+{
+
+	// Records meshes to be rendered, which can be done from any thread
+	// Each thread recording at the same time needs it's own command list, recording only ever touches the list itself
+	// Meshes are transformed and culled as they are recorded, so the main thread only has to queue them
+	class _CommandList
+	{
+	public:
+		// A single recorded mesh, which has already been transformed and culled
+		struct Packet
+		{
+			Mesh mesh;
+			unsigned int materialStart; // Where the mesh's materials start inside of the command list's material array
+			unsigned int materialCount;
+
+			float depthVal; // The view depth from the bounds test, carried into the queue's sort keys when merged
+			glm::mat4x4 mvpTransform;
+			glm::mat4x4 modelTransform;
+
+			unsigned int depthTestFuncOverride;
+			bool depthWrite;
+			Shader shaderOverride;
+			bool invertCullMode;
+		};
+
+		_CommandList();
+		~_CommandList();
+
+		// Clears every recorded mesh and sets the view meshes are recorded with
+		// Must be ran on the main thread, before any thread starts recording into the list
+		void begin(const glm::mat4x4& pvTransform, bool frustumCulling, float cullDistance);
+
+		// Transforms the mesh into clip space and culls it against the view, storing it if it's visible
+		// Meshes with the wrong amount of materials are skipped and counted, they are reported when the list is submitted
+		void record(Mesh mesh, const Material* materials, unsigned int materialCount, const glm::mat4x4& transform, unsigned int depthTestFuncOverride = LOST_DEPTH_TEST_AUTO, bool depthWrite = true, Shader shaderOverride = nullptr, bool invertCullMode = false);
+
+		inline const std::vector<Packet>& getPackets() const { return m_Packets; };
+		inline const Material* getMaterials(const Packet& packet) const { return m_Materials.data() + packet.materialStart; };
+
+		inline unsigned int getCulledCount()  const { return m_CulledCount; };
+		inline unsigned int getInvalidCount() const { return m_InvalidCount; };
+	private:
+		glm::mat4x4 m_PVTransform = glm::mat4x4(1.0f);
+		bool m_FrustumCulling = true;
+		float m_CullDistance = 0.0f;
+
+		std::vector<Packet> m_Packets; // Kept between frames to avoid reallocating
+		std::vector<Material> m_Materials; // Every packet's materials stored back to back, so recording doesn't allocate per mesh
+
+		unsigned int m_CulledCount = 0;  // The amount of meshes skipped for being off screen since the list was began
+		unsigned int m_InvalidCount = 0; // The amount of meshes skipped for being null or having the wrong amount of materials
+	};
+
+	// A reference to a command list
+	typedef _CommandList* CommandList;
+
+}
@@ -0,0 +1,91 @@
+#include "DeferredDestroy.h"
+
+#include <glad/glad.h>
+#include <deque>
+#include <vector>
+
+namespace lost
+{
+
+	struct DeferredDestroy
+	{
+		void (*destroy)(void*);
+		void* value;
+	};
+
+	// Everything unloaded in one frame, destroyed together once the fence placed at the end of that frame is signaled
+	struct DestroyBatch
+	{
+		std::vector<DeferredDestroy> values;
+		GLsync fence;
+	};
+
+	static std::vector<DeferredDestroy> s_PendingDestroys; // Unloaded this frame, not fenced yet
+	static std::deque<DestroyBatch> s_DestroyBatches;
+	static unsigned int s_PendingDestroyCount = 0;
+
+	static void destroyBatch(DestroyBatch& batch)
+	{
+		for (const DeferredDestroy& deferred : batch.values)
+			deferred.destroy(deferred.value);
+
+		s_PendingDestroyCount -= (unsigned int)batch.values.size();
+		if (batch.fence != nullptr)
+			glDeleteSync(batch.fence);
+	}
+
+	void _deferDestroy(void (*destroy)(void*), void* value)
+	{
+		s_PendingDestroys.push_back({ destroy, value });
+		s_PendingDestroyCount++;
+	}
+
+	void _updateDeferredDestroys()
+	{
+		if (!s_PendingDestroys.empty())
+		{
+			s_DestroyBatches.push_back({ {}, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+			s_DestroyBatches.back().values.swap(s_PendingDestroys);
+		}
+
+		// Fences are signaled in order, so stop at the first one the GPU hasn't reached
+		while (!s_DestroyBatches.empty())
+		{
+			GLenum result = glClientWaitSync(s_DestroyBatches.front().fence, 0, 0);
+			if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+				break;
+
+			// Popped first as destroying a resource may unload others
+			DestroyBatch batch;
+			batch.values.swap(s_DestroyBatches.front().values);
+			batch.fence = s_DestroyBatches.front().fence;
+			s_DestroyBatches.pop_front();
+			destroyBatch(batch);
+		}
+	}
+
+	void _flushDeferredDestroys()
+	{
+		// Destroying may unload more, so keep going until nothing is left
+		while (!s_DestroyBatches.empty() || !s_PendingDestroys.empty())
+		{
+			DestroyBatch batch = { {}, nullptr };
+			if (!s_DestroyBatches.empty())
+			{
+				batch.values.swap(s_DestroyBatches.front().values);
+				batch.fence = s_DestroyBatches.front().fence;
+				s_DestroyBatches.pop_front();
+			}
+			else
+				batch.values.swap(s_PendingDestroys);
+
+			destroyBatch(batch);
+		}
+	}
+
+	unsigned int getPendingDestroyCount()
+	{
+		return s_PendingDestroyCount;
+	}
+
+}
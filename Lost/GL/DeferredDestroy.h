@@ -0,0 +1,37 @@
+#pragma once
+#include "../ResourceManager.h"
+
+namespace lost
+{
+
+	// Queues the value to be destroyed by "destroy" once the GPU has finished the frame it was unloaded in
+	// Queued draws and uploads made before then can still use it, so unloading never needs the render queue to be flushed first
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _deferDestroy(void (*destroy)(void*), void* value);
+
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	template <typename T>
+	inline void _destroyDeferredResource(void* value)
+	{
+		_destroyResource<T>((T)value);
+	}
+
+	// Given to resource managers holding GL resources, so values they destroy go through _deferDestroy()
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	template <typename T>
+	inline void _deferResourceDestroy(T value)
+	{
+		_deferDestroy(&_destroyDeferredResource<T>, (void*)value);
+	}
+
+	// Fences everything unloaded this frame and destroys anything unloaded in frames the GPU has finished, ran at the end of every frame
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _updateDeferredDestroys();
+	// Destroys everything still queued straight away
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _flushDeferredDestroys();
+
+	// The amount of resources unloaded but not destroyed yet
+	unsigned int getPendingDestroyCount();
+
+}
@@ -0,0 +1,339 @@
+#include "GLStateCache.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <map>
+
+namespace lost
+{
+
+	static GLStateStats s_CurrentStats;
+	static GLStateStats s_LastStats;
+
+	// Used while no context is active, so _glState is never null
+	static _GLStateCache s_DetachedCache;
+	static std::map<GLFWwindow*, _GLStateCache> s_ContextCaches;
+
+	_GLStateCache* _glState = &s_DetachedCache;
+
+	// Updates the cached value, returning true if OpenGL needs to be told about the change
+	static inline bool updateState(unsigned int& cached, unsigned int value)
+	{
+		if (cached == value)
+		{
+			s_CurrentStats.callsSaved++;
+			return false;
+		}
+
+		cached = value;
+		s_CurrentStats.callsMade++;
+		return true;
+	}
+
+	_GLStateCache::_GLStateCache()
+	{
+		invalidate();
+	}
+
+	_GLStateCache::~_GLStateCache()
+	{
+	}
+
+	void _GLStateCache::invalidate()
+	{
+		m_Program = s_Unknown;
+		m_VertexArray = s_Unknown;
+		for (unsigned int i = 0; i < s_BufferTargets; i++)
+			m_Buffers[i] = s_Unknown;
+
+		m_ActiveTextureUnit = s_Unknown;
+		for (unsigned int unit = 0; unit < s_MaxTextureUnits; unit++)
+			for (unsigned int i = 0; i < s_TextureTargets; i++)
+				m_Textures[unit][i] = s_Unknown;
+
+		m_Framebuffer = s_Unknown;
+
+		m_Blend = s_Unknown;
+		m_DepthTest = s_Unknown;
+		m_CullFace = s_Unknown;
+		m_DepthFunc = s_Unknown;
+		m_DepthMask = s_Unknown;
+		m_CullFaceMode = s_Unknown;
+		m_BlendSource = s_Unknown;
+		m_BlendDestination = s_Unknown;
+		m_ViewportKnown = false;
+	}
+
+	int _GLStateCache::getBufferSlot(unsigned int target)
+	{
+		switch (target)
+		{
+		case GL_ARRAY_BUFFER:         return 0;
+		case GL_ELEMENT_ARRAY_BUFFER: return 1;
+		case GL_DRAW_INDIRECT_BUFFER: return 2;
+		case GL_COPY_READ_BUFFER:     return 3;
+		case GL_COPY_WRITE_BUFFER:    return 4;
+		case GL_PIXEL_PACK_BUFFER:    return 5;
+		case GL_PIXEL_UNPACK_BUFFER:  return 6;
+		case GL_UNIFORM_BUFFER:       return 7;
+		default:                      return -1;
+		}
+	}
+
+	int _GLStateCache::getTextureSlot(unsigned int target)
+	{
+		switch (target)
+		{
+		case GL_TEXTURE_2D:       return 0;
+		case GL_TEXTURE_2D_ARRAY: return 1;
+		case GL_TEXTURE_CUBE_MAP: return 2;
+		default:                  return -1;
+		}
+	}
+
+	void _GLStateCache::useProgram(unsigned int program)
+	{
+		if (updateState(m_Program, program))
+			glUseProgram(program);
+	}
+
+	void _GLStateCache::bindVertexArray(unsigned int vertexArray)
+	{
+		if (updateState(m_VertexArray, vertexArray))
+		{
+			glBindVertexArray(vertexArray);
+			m_Buffers[getBufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = s_Unknown;
+		}
+	}
+
+	void _GLStateCache::bindBuffer(unsigned int target, unsigned int buffer)
+	{
+		int slot = getBufferSlot(target);
+		if (slot == -1 || updateState(m_Buffers[slot], buffer))
+			glBindBuffer(target, buffer);
+	}
+
+	void _GLStateCache::bindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+	{
+		if (updateState(m_ActiveTextureUnit, unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+
+		int slot = getTextureSlot(target);
+		if (slot == -1 || unit >= s_MaxTextureUnits || updateState(m_Textures[unit][slot], texture))
+			glBindTexture(target, texture);
+	}
+
+	void _GLStateCache::bindFramebuffer(unsigned int framebuffer)
+	{
+		if (updateState(m_Framebuffer, framebuffer))
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	}
+
+	void _GLStateCache::setCapability(unsigned int capability, bool enabled)
+	{
+		unsigned int* cached =
+			capability == GL_BLEND      ? &m_Blend :
+			capability == GL_DEPTH_TEST ? &m_DepthTest :
+			capability == GL_CULL_FACE  ? &m_CullFace : nullptr;
+
+		if (cached != nullptr && !updateState(*cached, enabled ? 1 : 0))
+			return;
+
+		if (enabled)
+			glEnable(capability);
+		else
+			glDisable(capability);
+	}
+
+	void _GLStateCache::setDepthFunc(unsigned int depthFunc)
+	{
+		if (updateState(m_DepthFunc, depthFunc))
+			glDepthFunc(depthFunc);
+	}
+
+	void _GLStateCache::setDepthMask(bool depthWrite)
+	{
+		if (updateState(m_DepthMask, depthWrite ? 1 : 0))
+			glDepthMask(depthWrite);
+	}
+
+	void _GLStateCache::setCullFace(unsigned int cullFace)
+	{
+		if (updateState(m_CullFaceMode, cullFace))
+			glCullFace(cullFace);
+	}
+
+	void _GLStateCache::setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor)
+	{
+		// Both factors are set by the same call, so both need to match to skip it
+		bool sourceChanged = updateState(m_BlendSource, sourceFactor);
+		bool destinationChanged = updateState(m_BlendDestination, destinationFactor);
+		if (sourceChanged || destinationChanged)
+			glBlendFunc(sourceFactor, destinationFactor);
+	}
+
+	void _GLStateCache::setViewport(int x, int y, int width, int height)
+	{
+		if (m_ViewportKnown && m_Viewport[0] == x && m_Viewport[1] == y && m_Viewport[2] == width && m_Viewport[3] == height)
+		{
+			s_CurrentStats.callsSaved++;
+			return;
+		}
+
+		m_Viewport[0] = x;
+		m_Viewport[1] = y;
+		m_Viewport[2] = width;
+		m_Viewport[3] = height;
+		m_ViewportKnown = true;
+
+		s_CurrentStats.callsMade++;
+		glViewport(x, y, width, height);
+	}
+
+	unsigned int _GLStateCache::getProgram()
+	{
+		if (m_Program == s_Unknown)
+		{
+			int program = 0;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+			m_Program = (unsigned int)program;
+		}
+
+		return m_Program;
+	}
+
+	unsigned int _GLStateCache::getFramebuffer()
+	{
+		if (m_Framebuffer == s_Unknown)
+		{
+			int framebuffer = 0;
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+			m_Framebuffer = (unsigned int)framebuffer;
+		}
+
+		return m_Framebuffer;
+	}
+
+	void _GLStateCache::forgetProgram(unsigned int program)
+	{
+		if (m_Program == program)
+			m_Program = s_Unknown;
+	}
+
+	void _GLStateCache::forgetVertexArray(unsigned int vertexArray)
+	{
+		if (m_VertexArray == vertexArray)
+		{
+			m_VertexArray = s_Unknown;
+			m_Buffers[getBufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = s_Unknown;
+		}
+	}
+
+	void _GLStateCache::forgetBuffer(unsigned int buffer)
+	{
+		for (unsigned int i = 0; i < s_BufferTargets; i++)
+		{
+			if (m_Buffers[i] == buffer)
+				m_Buffers[i] = s_Unknown;
+		}
+	}
+
+	void _GLStateCache::forgetTexture(unsigned int texture)
+	{
+		for (unsigned int unit = 0; unit < s_MaxTextureUnits; unit++)
+		{
+			for (unsigned int i = 0; i < s_TextureTargets; i++)
+			{
+				if (m_Textures[unit][i] == texture)
+					m_Textures[unit][i] = s_Unknown;
+			}
+		}
+	}
+
+	void _GLStateCache::forgetFramebuffer(unsigned int framebuffer)
+	{
+		if (m_Framebuffer == framebuffer)
+			m_Framebuffer = s_Unknown;
+	}
+
+	void _makeContextCurrent(GLFWwindow* window)
+	{
+		glfwMakeContextCurrent(window);
+
+		if (window == nullptr)
+		{
+			s_DetachedCache.invalidate();
+			_glState = &s_DetachedCache;
+			return;
+		}
+
+		// A new cache starts with every state unknown
+		_glState = &s_ContextCaches[window];
+	}
+
+	void _destroyGLStateCache(GLFWwindow* window)
+	{
+		auto cache = s_ContextCaches.find(window);
+		if (cache == s_ContextCaches.end())
+			return;
+
+		if (_glState == &cache->second)
+			_glState = &s_DetachedCache;
+
+		s_ContextCaches.erase(cache);
+	}
+
+	// Runs the function given on the cache of every context, including the detached one
+	template <typename Function>
+	static void forEachCache(Function function)
+	{
+		function(s_DetachedCache);
+		for (auto& context : s_ContextCaches)
+			function(context.second);
+	}
+
+	void _deleteGLProgram(unsigned int program)
+	{
+		forEachCache([&](_GLStateCache& cache) { cache.forgetProgram(program); });
+		glDeleteProgram(program);
+	}
+
+	void _deleteGLVertexArrays(unsigned int count, const unsigned int* vertexArrays)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			forEachCache([&](_GLStateCache& cache) { cache.forgetVertexArray(vertexArrays[i]); });
+		glDeleteVertexArrays(count, vertexArrays);
+	}
+
+	void _deleteGLBuffers(unsigned int count, const unsigned int* buffers)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			forEachCache([&](_GLStateCache& cache) { cache.forgetBuffer(buffers[i]); });
+		glDeleteBuffers(count, buffers);
+	}
+
+	void _deleteGLTextures(unsigned int count, const unsigned int* textures)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			forEachCache([&](_GLStateCache& cache) { cache.forgetTexture(textures[i]); });
+		glDeleteTextures(count, textures);
+	}
+
+	void _deleteGLFramebuffers(unsigned int count, const unsigned int* framebuffers)
+	{
+		for (unsigned int i = 0; i < count; i++)
+			forEachCache([&](_GLStateCache& cache) { cache.forgetFramebuffer(framebuffers[i]); });
+		glDeleteFramebuffers(count, framebuffers);
+	}
+
+	void _endGLStateFrame()
+	{
+		s_LastStats = s_CurrentStats;
+		s_CurrentStats = {};
+	}
+
+	GLStateStats getGLStateStats()
+	{
+		return s_LastStats;
+	}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+
+struct GLFWwindow;
+
+namespace lost
+{
+
+	// How many state changes went through the state cache during a frame
+	struct GLStateStats
+	{
+		unsigned int callsMade = 0;  // State changes given to OpenGL
+		unsigned int callsSaved = 0; // State changes skipped as OpenGL was already in that state
+	};
+
+	// A shadow copy of the state of a single OpenGL context, every state change Lost makes goes through one of these
+	// Changes to a state which is already set are skipped, and the current state can be read without querying OpenGL
+	// State which isn't known yet (after creation or invalidate()) is always set, and only queried from OpenGL once
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _GLStateCache
+	{
+	public:
+		_GLStateCache();
+		~_GLStateCache();
+
+		// Forgets every cached state, needs to be ran after anything outside of Lost has changed the context's state
+		void invalidate();
+
+		void useProgram(unsigned int program);
+		// The element array buffer binding is part of the VAO, so it's forgotten whenever a different VAO is bound
+		void bindVertexArray(unsigned int vertexArray);
+		void bindBuffer(unsigned int target, unsigned int buffer);
+		// Makes the texture unit active and binds the texture to it
+		void bindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+		// Binds the framebuffer as both the draw and read framebuffer
+		void bindFramebuffer(unsigned int framebuffer);
+
+		// Only GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE are cached, anything else is always set
+		void setCapability(unsigned int capability, bool enabled);
+		void setDepthFunc(unsigned int depthFunc);
+		void setDepthMask(bool depthWrite);
+		void setCullFace(unsigned int cullFace);
+		void setBlendFunc(unsigned int sourceFactor, unsigned int destinationFactor);
+		void setViewport(int x, int y, int width, int height);
+
+		unsigned int getProgram();
+		unsigned int getFramebuffer();
+
+		// Unbinds the object from the cache if it's bound, OpenGL can reuse the names of deleted objects
+		void forgetProgram(unsigned int program);
+		void forgetVertexArray(unsigned int vertexArray);
+		void forgetBuffer(unsigned int buffer);
+		void forgetTexture(unsigned int texture);
+		void forgetFramebuffer(unsigned int framebuffer);
+	private:
+		// Returns the slot the target given is cached in, or -1 if it isn't cached
+		static int getBufferSlot(unsigned int target);
+		static int getTextureSlot(unsigned int target);
+
+		// The value given to any state which isn't known
+		static const unsigned int s_Unknown = 0xFFFFFFFF;
+		static const unsigned int s_MaxTextureUnits = 32;
+		static const unsigned int s_BufferTargets = 8;
+		static const unsigned int s_TextureTargets = 3;
+
+		unsigned int m_Program;
+		unsigned int m_VertexArray;
+		unsigned int m_Buffers[s_BufferTargets];
+		unsigned int m_ActiveTextureUnit;
+		unsigned int m_Textures[s_MaxTextureUnits][s_TextureTargets];
+		unsigned int m_Framebuffer;
+
+		unsigned int m_Blend;     // 0 or 1, or s_Unknown
+		unsigned int m_DepthTest; // 0 or 1, or s_Unknown
+		unsigned int m_CullFace;  // 0 or 1, or s_Unknown
+		unsigned int m_DepthFunc;
+		unsigned int m_DepthMask;
+		unsigned int m_CullFaceMode;
+		unsigned int m_BlendSource;
+		unsigned int m_BlendDestination;
+		int m_Viewport[4];
+		bool m_ViewportKnown;
+	};
+
+	// The state cache of the OpenGL context which is currently active
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	extern _GLStateCache* _glState;
+
+	// Makes the window's context current and switches _glState over to that context's state cache
+	// Every context switch in Lost must go through this, otherwise the cache would describe the wrong context
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _makeContextCurrent(GLFWwindow* window);
+	// Removes the state cache of the window's context, ran when the window is destroyed
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _destroyGLStateCache(GLFWwindow* window);
+
+	// Deletes the objects, forgetting them in the state cache of every context first
+	// Programs, buffers and textures are shared between contexts, so deleting them can effect every cache
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _deleteGLProgram(unsigned int program);
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _deleteGLVertexArrays(unsigned int count, const unsigned int* vertexArrays);
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _deleteGLBuffers(unsigned int count, const unsigned int* buffers);
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _deleteGLTextures(unsigned int count, const unsigned int* textures);
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _deleteGLFramebuffers(unsigned int count, const unsigned int* framebuffers);
+
+	// Stores the counters of the frame which just finished and starts counting again, ran at the end of every frame
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _endGLStateFrame();
+
+	// Returns how many state changes were made and how many were skipped by the state cache during the last frame
+	GLStateStats getGLStateStats();
+
+}
@@ -4,8 +4,13 @@
 #include <vector>
 #include <stack>
 #include <iostream>
+#include "../AsyncLoader.h"
 #include "../DeltaTime.h"
+#include "PixelTransfer.h"
 #include "Text/Text.h"
+#include "Texture/TextureAtlas.h"
+#include "Texture/TexturePages.h"
+#include "Texture/TextureStreaming.h"
 #include "../Input/Input.h"
 #include "../Audio/Audio.h"
 
@@ -55,6 +60,7 @@ namespace lost
 		_glfwInitialized = true;
 
 		_initOpenGL();
+		_initPixelTransfers();
 		_initRMs();
 		_initRenderer(rendererMode);
 		_initTextRendering();
@@ -75,7 +81,7 @@ namespace lost
 		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // Then makes the window invisible
 
 		GLFWwindow* invisibleGLFWContext = glfwCreateWindow(1000, 1000, "a", NULL, NULL); // Creates the window with the hints given
-		glfwMakeContextCurrent(invisibleGLFWContext);
+		_makeContextCurrent(invisibleGLFWContext);
 
 		_invisibleContext = new WindowContext(invisibleGLFWContext);
 
@@ -108,8 +114,13 @@ namespace lost
 	{
 		_destroyTextRendering();
 
+		// Anything unloaded but not destroyed yet goes first, as it may use things destroyed below
+		_flushDeferredDestroys();
 		_destroyRMs();
+		_destroyTextureAtlas();
+		_destroyPixelTransfers();
 		_destroyRenderer();
+		_destroyTexturePages();
 
 		glfwTerminate();
 		for (Window context : _windowContexts)
@@ -126,6 +137,12 @@ namespace lost
 	void _updateGL()
 	{
 		_pollInputs();
+
+		// Anything loaded in the background since last frame is uploaded before the frame starts using it
+		_finishAsyncLoads();
+
+		// Levels asked for while drawing last frame
+		_updateTextureStreaming();
 	}
 
 	void _windowResizeCallback(GLFWwindow* window, int width, int height)
@@ -184,7 +201,7 @@ namespace lost
 			setGLFWWindowHints(); // Sets the window hints for the to be created window
 			GLFWwindow* window = glfwCreateWindow(width, height, title, NULL, _invisibleContext->glfwWindow);
 			
-			glfwMakeContextCurrent(window);
+			_makeContextCurrent(window);
 
 			glfwSetWindowSizeCallback(window, _windowResizeCallback);
 			glfwSetKeyCallback(window, _windowKeyCallback);
@@ -193,15 +210,15 @@ namespace lost
 			glfwSetScrollCallback(window, _mouseScrollCallback);
 
 			// Initialize this window contexts OpenGL context settings
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			_glState->setCapability(GL_BLEND, true);
+			_glState->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-			glEnable(GL_DEPTH_TEST);
-			glDepthFunc(GL_LESS);
+			_glState->setCapability(GL_DEPTH_TEST, true);
+			_glState->setDepthFunc(GL_LESS);
 
 			// Enable backface culling
-			glEnable(GL_CULL_FACE);
-			glCullFace(GL_BACK);
+			_glState->setCapability(GL_CULL_FACE, true);
+			_glState->setCullFace(GL_BACK);
 
 #ifdef LOST_DEBUG_MODE // Debug
 			glEnable(GL_DEBUG_OUTPUT);
@@ -222,7 +239,7 @@ namespace lost
 			// Generate a VAO needed for the renderer
 			_generateNewVAO();
 
-			glfwMakeContextCurrent(_invisibleContext->glfwWindow);
+			_makeContextCurrent(_invisibleContext->glfwWindow);
 			return windowContext;
 		}
 
@@ -252,7 +269,7 @@ namespace lost
 	void _setWindow(unsigned int id)
 	{
 		_currentContextID = id;
-		glfwMakeContextCurrent(_windowContexts[id]->glfwWindow);
+		_makeContextCurrent(_windowContexts[id]->glfwWindow);
 	}
 
 	unsigned int getCurrentWindowID()
@@ -282,9 +299,9 @@ namespace lost
 
 		_currentContextID = popVal;
 		if (popVal != -1)
-			glfwMakeContextCurrent(_windowContexts[popVal]->glfwWindow);
+			_makeContextCurrent(_windowContexts[popVal]->glfwWindow);
 		else
-			glfwMakeContextCurrent(_invisibleContext->glfwWindow);
+			_makeContextCurrent(_invisibleContext->glfwWindow);
 	}
 
 	bool windowOpen()
@@ -318,6 +335,7 @@ namespace lost
 				// Destroy any window VAO which was bound to this context
 				_destroyWindowVAO(i);
 
+				_destroyGLStateCache(context->glfwWindow);
 				glfwDestroyWindow(context->glfwWindow);
 
 				// Remove window context from _windowContexts
@@ -568,7 +586,7 @@ namespace lost
 		pushWindow();
 		if (context != nullptr)
 		{
-			glfwMakeContextCurrent(context->glfwWindow);
+			_makeContextCurrent(context->glfwWindow);
 		}
 		else
 		{
@@ -578,11 +596,11 @@ namespace lost
 			else
 			{
 				context = _windowContexts[0];
-				glfwMakeContextCurrent(context->glfwWindow);
+				_makeContextCurrent(context->glfwWindow);
 			}
 #else
 			context = _windowContexts[0];
-			glfwMakeContextCurrent(context->glfwWindow);
+			_makeContextCurrent(context->glfwWindow);
 #endif
 		}
 
@@ -657,16 +675,16 @@ namespace lost
 					debugLogIf(i == _windowContexts.size() - 1, "Tried to start frame on window that has been destroyed", LOST_LOG_FATAL);
 #endif
 				}
-				glfwMakeContextCurrent(context->glfwWindow);
+				_makeContextCurrent(context->glfwWindow);
 			}
 			else // No context was given, use the first window created
 			{
 				context = _windowContexts[0];
-				glfwMakeContextCurrent(context->glfwWindow);
+				_makeContextCurrent(context->glfwWindow);
 				_currentContextID = 0;
 			}
 
-			glViewport(0, 0, context->width, context->height);
+			_glState->setViewport(0, 0, context->width, context->height);
 		}
 
 		if (_currentContextID == 0)
@@ -680,6 +698,14 @@ namespace lost
 
 		lost::_finalizeRender();
 
+		// Everything has been drawn, so readbacks asked for this frame see all of it
+		_updatePixelTransfers();
+
+		// Unloads from this frame are fenced after everything using them, earlier ones are destroyed once the GPU is done
+		_updateDeferredDestroys();
+
 		glfwSwapBuffers(glfwGetCurrentContext());
+
+		_endGLStateFrame();
 	}
 }
\ No newline at end of file
@@ -2,11 +2,14 @@
 #include <glad/glad.h>
 #include <vector>
 #include "Structs.h"
+#include "GLStateCache.h"
 #include "Shaders/Shader.h"
 #include "WindowContext.h"
 #include "Renderer.h"
 #include "ResourceManagers/GLResourceManagers.h"
 #include "Camera.h"
+#include "PixelTransfer.h"
+#include "DeferredDestroy.h"
 
 namespace lost
 {
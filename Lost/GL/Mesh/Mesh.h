@@ -2,6 +2,8 @@
 #include <vector>
 #include "../Vector.h"
 #include "../Texture/Material.h"
+#include "VertexLayout.h"
+#include "MeshBounds.h"
 
 // Mesh rendering method, given to OpenGL
 enum MeshRenderMethod
@@ -59,6 +61,25 @@ namespace lost
 		std::vector<unsigned int> materialSlotIndicies;
 		std::vector<unsigned int> indexData;
 		unsigned int meshRenderMode = LOST_MESH_TRIANGLES;
+		unsigned int vertexLayout = LOST_VERTEX_LAYOUT_FULL; // The layout the verticies are packed into on the GPU, follows the VertexLayout enum
+		MeshBounds bounds; // Used to cull the mesh when it's off screen, calculated when the mesh is made
+
+		// GPU residency, set by the renderer when the mesh gets uploaded
+		// Meshes which aren't resident (raw meshes) get streamed into the renderer's stream buffers every frame
+		bool resident = false;
+		unsigned int baseVertex = 0; // The first vertex of the mesh inside of the buffer it was uploaded to, in verticies of it's layout
+		unsigned int firstIndex = 0; // The first index of the mesh inside of the buffer it was uploaded to
+
+		// Raw meshes made by the renderer are written straight into it's stream buffers, leaving vertexData and indexData empty
+		bool streamed = false;
+		unsigned int streamIndexCount = 0; // The amount of indicies a streamed mesh has written
+
+		// Meshes loaded asynchronously are empty until their data arrives, they're skipped when rendering until then
+		bool loading = false;
+
+		_OwnedHandle<CompiledMeshData*> handle; // See getMeshHandle()
+
+		inline unsigned int getIndexCount() const { return streamed ? streamIndexCount : (unsigned int)indexData.size(); };
 	};
 
 	union Vertex {
@@ -88,6 +109,10 @@ namespace lost
 		// The method which the render will use to fill in the faces, by default LOST_MESH_TRIANGLES
 		// Follows the MeshRenderMethod enum
 		unsigned int meshFaceMethod = LOST_MESH_TRIANGLES;
+
+		// The layout the verticies are stored in on the GPU, by default LOST_VERTEX_LAYOUT_FULL
+		// Follows the VertexLayout enum
+		unsigned int vertexLayout = LOST_VERTEX_LAYOUT_FULL;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "MeshArena.h"
+#include <glad/glad.h>
+#include <iterator>
+#include <string>
+#include "../GLStateCache.h"
+#include "../../Log.h"
+
+namespace lost
+{
+
+	_MeshArena::_MeshArena()
+	{
+	}
+
+	_MeshArena::~_MeshArena()
+	{
+		if (m_VertexBuffer)
+			_deleteGLBuffers(1, &m_VertexBuffer);
+		if (m_IndexBuffer)
+			_deleteGLBuffers(1, &m_IndexBuffer);
+	}
+
+	void _MeshArena::init(unsigned int vertexCapacity, unsigned int indexCapacity)
+	{
+		m_VertexCapacity = vertexCapacity;
+		m_IndexCapacity = indexCapacity;
+
+		// Allocate the storage of both buffers, the data is filled in as meshes are uploaded
+		// GL_COPY_WRITE_BUFFER is used so we don't mess with the currently bound VAO
+		glGenBuffers(1, &m_VertexBuffer);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, m_VertexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)m_VertexCapacity, nullptr, GL_STATIC_DRAW);
+
+		glGenBuffers(1, &m_IndexBuffer);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, m_IndexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)m_IndexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		m_FreeVerticies.clear();
+		m_FreeIndicies.clear();
+		m_FreeVerticies[0] = m_VertexCapacity;
+		m_FreeIndicies[0] = m_IndexCapacity;
+	}
+
+	bool _MeshArena::upload(CompiledMeshData* mesh)
+	{
+		if (mesh->resident)
+			release(mesh);
+
+		unsigned int vertexCount = mesh->vertexData.size() / 16;
+		unsigned int indexCount = mesh->indexData.size();
+
+		if (vertexCount == 0 || indexCount == 0)
+		{
+			debugLog("Tried to upload an empty mesh to the GPU", LOST_LOG_WARNING);
+			return false;
+		}
+
+		// Pack the verticies into the mesh's layout, reusing the same memory for every upload
+		_packVerticies(mesh->vertexData, mesh->vertexLayout, m_PackedVerticies);
+		unsigned int stride = _getVertexStride(mesh->vertexLayout);
+		unsigned int vertexBytes = m_PackedVerticies.size();
+
+		unsigned int vertexOffset = allocate(m_FreeVerticies, vertexBytes, stride);
+		if (vertexOffset == -1)
+		{
+			grow(m_VertexBuffer, m_VertexCapacity, 1, vertexBytes + stride, m_FreeVerticies);
+			vertexOffset = allocate(m_FreeVerticies, vertexBytes, stride);
+		}
+
+		unsigned int firstIndex = allocate(m_FreeIndicies, indexCount);
+		if (firstIndex == -1)
+		{
+			grow(m_IndexBuffer, m_IndexCapacity, sizeof(unsigned int), indexCount, m_FreeIndicies);
+			firstIndex = allocate(m_FreeIndicies, indexCount);
+		}
+
+		// Upload the data, this is the only time the mesh's data is sent to the GPU
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, m_VertexBuffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)vertexOffset, (GLsizeiptr)vertexBytes, m_PackedVerticies.data());
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, m_IndexBuffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)firstIndex * sizeof(unsigned int), (GLsizeiptr)indexCount * sizeof(unsigned int), mesh->indexData.data());
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		// The buffers are shared between every window's context, flush so the other contexts see the new data
+		glFlush();
+
+		m_UsedVertexBytes += vertexBytes;
+		m_UsedIndicies += indexCount;
+
+		mesh->baseVertex = vertexOffset / stride;
+		mesh->firstIndex = firstIndex;
+		mesh->resident = true;
+
+		return true;
+	}
+
+	void _MeshArena::release(CompiledMeshData* mesh)
+	{
+		if (!mesh->resident)
+			return;
+
+		unsigned int stride = _getVertexStride(mesh->vertexLayout);
+		unsigned int vertexBytes = mesh->vertexData.size() / 16 * stride;
+		unsigned int indexCount = mesh->indexData.size();
+
+		deallocate(m_FreeVerticies, mesh->baseVertex * stride, vertexBytes);
+		deallocate(m_FreeIndicies, mesh->firstIndex, indexCount);
+
+		m_UsedVertexBytes -= vertexBytes;
+		m_UsedIndicies -= indexCount;
+
+		mesh->resident = false;
+		mesh->baseVertex = 0;
+		mesh->firstIndex = 0;
+	}
+
+	unsigned int _MeshArena::allocate(std::map<unsigned int, unsigned int>& freeList, unsigned int count, unsigned int alignment)
+	{
+		// First fit, meshes are usually loaded once and rarely unloaded so fragmentation is low
+		for (std::map<unsigned int, unsigned int>::iterator it = freeList.begin(); it != freeList.end(); it++)
+		{
+			unsigned int rangeStart = it->first;
+			unsigned int rangeCount = it->second;
+
+			// Skip forward to the first aligned offset in the range
+			unsigned int padding = (alignment - rangeStart % alignment) % alignment;
+			if (rangeCount < count + padding)
+				continue;
+
+			unsigned int offset = rangeStart + padding;
+			unsigned int remaining = rangeCount - count - padding;
+			freeList.erase(it);
+
+			// The padding stays free, it may fit something with a different alignment
+			if (padding > 0)
+				freeList[rangeStart] = padding;
+			if (remaining > 0)
+				freeList[offset + count] = remaining;
+
+			return offset;
+		}
+
+		return -1;
+	}
+
+	void _MeshArena::deallocate(std::map<unsigned int, unsigned int>& freeList, unsigned int offset, unsigned int count)
+	{
+		std::map<unsigned int, unsigned int>::iterator it = freeList.insert({ offset, count }).first;
+
+		// Merge with the range after
+		std::map<unsigned int, unsigned int>::iterator next = std::next(it);
+		if (next != freeList.end() && it->first + it->second == next->first)
+		{
+			it->second += next->second;
+			freeList.erase(next);
+		}
+
+		// Merge with the range before
+		if (it != freeList.begin())
+		{
+			std::map<unsigned int, unsigned int>::iterator prev = std::prev(it);
+			if (prev->first + prev->second == it->first)
+			{
+				prev->second += it->second;
+				freeList.erase(it);
+			}
+		}
+	}
+
+	void _MeshArena::grow(unsigned int buffer, unsigned int& capacity, unsigned int elementSize, unsigned int count, std::map<unsigned int, unsigned int>& freeList)
+	{
+		unsigned int newCapacity = capacity * 2;
+		while (newCapacity < capacity + count)
+			newCapacity *= 2;
+
+		// Copy the old data out, reallocate the buffer under the same name then copy it back in
+		unsigned int tempBuffer;
+		glGenBuffers(1, &tempBuffer);
+
+		_glState->bindBuffer(GL_COPY_READ_BUFFER, buffer);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, tempBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * elementSize, nullptr, GL_STREAM_COPY);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)capacity * elementSize);
+
+		_glState->bindBuffer(GL_COPY_READ_BUFFER, tempBuffer);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newCapacity * elementSize, nullptr, GL_STATIC_DRAW);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)capacity * elementSize);
+
+		_glState->bindBuffer(GL_COPY_READ_BUFFER, 0);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		_deleteGLBuffers(1, &tempBuffer);
+
+		// Add the new space to the free list
+		deallocate(freeList, capacity, newCapacity - capacity);
+
+		debugLog("Mesh arena grew from " + std::to_string(capacity) + " to " + std::to_string(newCapacity) + " elements", LOST_LOG_INFO);
+
+		capacity = newCapacity;
+	}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <map>
+#include <vector>
+#include "Mesh.h"
+
+namespace lost
+{
+
+	// A pair of persistent GPU buffers which every loaded mesh is sub-allocated from
+	// Meshes are uploaded once when they are created, the renderer then only binds offsets into these buffers
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _MeshArena
+	{
+	public:
+		_MeshArena();
+		~_MeshArena();
+
+		// Creates the buffers used by the arena, must be ran while a context is active
+		// "vertexCapacity" is in bytes as meshes can use different vertex layouts
+		void init(unsigned int vertexCapacity, unsigned int indexCapacity);
+
+		// Uploads the mesh into the arena packed into it's vertex layout, setting it's baseVertex and firstIndex
+		// Returns false if the mesh could not be uploaded
+		bool upload(CompiledMeshData* mesh);
+		// Frees the space taken up by the mesh, the mesh will have to be streamed if it is rendered again
+		// Must be ran before the mesh's vertex layout is changed
+		void release(CompiledMeshData* mesh);
+
+		inline unsigned int getVertexBuffer() const { return m_VertexBuffer; };
+		inline unsigned int getIndexBuffer()  const { return m_IndexBuffer;  };
+
+		// Returns the amount of vertex bytes stored inside of the arena
+		inline unsigned int getUsedVertexBytes()    const { return m_UsedVertexBytes; };
+		// Returns the amount of vertex bytes the arena can hold before it has to grow
+		inline unsigned int getVertexCapacity()     const { return m_VertexCapacity; };
+		// Returns the amount of indicies stored inside of the arena
+		inline unsigned int getUsedIndexCount()     const { return m_UsedIndicies; };
+		// Returns the amount of indicies the arena can hold before it has to grow
+		inline unsigned int getIndexCapacity()      const { return m_IndexCapacity; };
+	private:
+		// Finds space for "count" elements in the free list given starting on a multiple of "alignment", returns -1 if there is no space
+		// Vertex data is aligned to the stride of it's layout, so baseVertex can be given in verticies of that layout
+		unsigned int allocate(std::map<unsigned int, unsigned int>& freeList, unsigned int count, unsigned int alignment = 1);
+		// Returns the range given back to the free list, merging it with it's neighbours
+		void deallocate(std::map<unsigned int, unsigned int>& freeList, unsigned int offset, unsigned int count);
+		// Resizes the buffer given so it can fit at least "count" more elements, plus any padding needed to align them, keeping the data already inside of it
+		// The buffer keeps the same name so VAOs referencing it stay valid
+		void grow(unsigned int buffer, unsigned int& capacity, unsigned int elementSize, unsigned int count, std::map<unsigned int, unsigned int>& freeList);
+
+		unsigned int m_VertexBuffer = 0;
+		unsigned int m_IndexBuffer = 0;
+
+		unsigned int m_VertexCapacity = 0;
+		unsigned int m_IndexCapacity = 0;
+		unsigned int m_UsedVertexBytes = 0;
+		unsigned int m_UsedIndicies = 0;
+
+		// Free ranges of the buffers, stored as { offset, count }, the vertex ranges are in bytes
+		std::map<unsigned int, unsigned int> m_FreeVerticies;
+		std::map<unsigned int, unsigned int> m_FreeIndicies;
+
+		std::vector<char> m_PackedVerticies; // Reused every upload to avoid reallocating
+	};
+
+}
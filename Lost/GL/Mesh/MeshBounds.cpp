@@ -0,0 +1,120 @@
+#include "MeshBounds.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define LOST_BOUNDS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace lost
+{
+
+	MeshBounds _calculateMeshBounds(const std::vector<float>& vertexData)
+	{
+		MeshBounds bounds = {};
+
+		size_t vertexCount = vertexData.size() / 16;
+		if (vertexCount == 0)
+			return bounds;
+
+		float minimum[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+		float maximum[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const float* position = vertexData.data() + i * 16;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				minimum[axis] = position[axis] < minimum[axis] ? position[axis] : minimum[axis];
+				maximum[axis] = position[axis] > maximum[axis] ? position[axis] : maximum[axis];
+			}
+		}
+
+		bounds.center  = { (minimum[0] + maximum[0]) * 0.5f, (minimum[1] + maximum[1]) * 0.5f, (minimum[2] + maximum[2]) * 0.5f };
+		bounds.extents = { (maximum[0] - minimum[0]) * 0.5f, (maximum[1] - minimum[1]) * 0.5f, (maximum[2] - minimum[2]) * 0.5f };
+		bounds.valid = true;
+
+		return bounds;
+	}
+
+	bool _testMeshBounds(const MeshBounds& bounds, const glm::mat4x4& mvpTransform, float maxDepth, float& viewDepth)
+	{
+		// The box's center is projected into clip space, and the extents are projected using the absolute of the transform
+		// This gives a box in clip space which contains the original one, the box is outside of the frustum when
+		// |center| - extent > w + w extent on any axis, which is the same as being behind one of the 6 frustum planes
+#ifdef LOST_BOUNDS_SSE
+		const float* matrix = &mvpTransform[0][0];
+		__m128 column0 = _mm_loadu_ps(matrix);
+		__m128 column1 = _mm_loadu_ps(matrix + 4);
+		__m128 column2 = _mm_loadu_ps(matrix + 8);
+		__m128 column3 = _mm_loadu_ps(matrix + 12);
+
+		__m128 center = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(bounds.center.x)), _mm_mul_ps(column1, _mm_set1_ps(bounds.center.y))),
+			_mm_add_ps(_mm_mul_ps(column2, _mm_set1_ps(bounds.center.z)), column3));
+
+		// Clearing the sign bit gives the absolute value
+		__m128 signMask = _mm_set1_ps(-0.0f);
+		__m128 extents = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, column0), _mm_set1_ps(bounds.extents.x)), _mm_mul_ps(_mm_andnot_ps(signMask, column1), _mm_set1_ps(bounds.extents.y))),
+			_mm_mul_ps(_mm_andnot_ps(signMask, column2), _mm_set1_ps(bounds.extents.z)));
+
+		float clipCenter[4], clipExtents[4];
+		_mm_storeu_ps(clipCenter, center);
+		_mm_storeu_ps(clipExtents, extents);
+
+		__m128 distance = _mm_sub_ps(_mm_andnot_ps(signMask, center), extents);
+		__m128 limit = _mm_set1_ps(clipCenter[3] + clipExtents[3]);
+
+		// Only the x, y and z lanes are planes, w is ignored
+		bool outside = (_mm_movemask_ps(_mm_cmpgt_ps(distance, limit)) & 0x7) != 0;
+#else
+		glm::vec4 center = mvpTransform * glm::vec4(bounds.center.x, bounds.center.y, bounds.center.z, 1.0f);
+		glm::vec4 extents =
+			glm::abs(mvpTransform[0]) * bounds.extents.x +
+			glm::abs(mvpTransform[1]) * bounds.extents.y +
+			glm::abs(mvpTransform[2]) * bounds.extents.z;
+
+		float clipCenter[4] = { center.x, center.y, center.z, center.w };
+		float clipExtents[4] = { extents.x, extents.y, extents.z, extents.w };
+
+		float limit = clipCenter[3] + clipExtents[3];
+		bool outside =
+			fabsf(clipCenter[0]) - clipExtents[0] > limit ||
+			fabsf(clipCenter[1]) - clipExtents[1] > limit ||
+			fabsf(clipCenter[2]) - clipExtents[2] > limit;
+#endif
+
+		// W is the view depth when using a perspective projection
+		viewDepth = clipCenter[3];
+
+		if (outside)
+			return false;
+
+		// Distance culling uses the closest point of the box
+		if (maxDepth > 0.0f && clipCenter[3] - clipExtents[3] > maxDepth)
+			return false;
+
+		return true;
+	}
+
+	float _getMeshScreenSize(const MeshBounds& bounds, const glm::mat4x4& mvpTransform, float viewportHeight)
+	{
+		// The same clip space box as _testMeshBounds(), only ran for meshes which passed culling so it isn't vectorized
+		glm::vec4 center = mvpTransform * glm::vec4(bounds.center.x, bounds.center.y, bounds.center.z, 1.0f);
+		glm::vec4 extents =
+			glm::abs(mvpTransform[0]) * bounds.extents.x +
+			glm::abs(mvpTransform[1]) * bounds.extents.y +
+			glm::abs(mvpTransform[2]) * bounds.extents.z;
+
+		float closestDepth = center.w - extents.w;
+		if (closestDepth <= 0.0f)
+			return FLT_MAX;
+
+		// Normalized device coordinates go from -1 to 1, so the half size in them is the full size as a fraction of the viewport
+		float halfSize = extents.x > extents.y ? extents.x : extents.y;
+		return halfSize / closestDepth * viewportHeight;
+	}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+#include "../Vector.h"
+
+namespace lost
+{
+
+	// An axis aligned bounding box around a mesh, in the mesh's local space
+	struct MeshBounds
+	{
+		Vec3 center;
+		Vec3 extents; // Half of the size of the box on each axis
+		bool valid = false; // Raw meshes and empty meshes have no bounds, so are never culled
+	};
+
+	// Calculates the bounds of the LOST_VERTEX_LAYOUT_FULL vertex data given
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	MeshBounds _calculateMeshBounds(const std::vector<float>& vertexData);
+
+	// Tests the bounds against the view frustum of the MVP transform given, returns false if they are entirely outside of it
+	// The bounds are projected into clip space, which is the same as testing against the planes of the camera's PV in world space
+	// "viewDepth" is set to the depth of the bounds' center, if "maxDepth" is above 0 bounds further away than it are also culled
+	// Uses SSE when it's available, testing every plane at once
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	bool _testMeshBounds(const MeshBounds& bounds, const glm::mat4x4& mvpTransform, float maxDepth, float& viewDepth);
+
+	// Returns roughly how many pixels across the bounds are on screen, using the closest point of the bounds
+	// Returns FLT_MAX if the camera is inside of the bounds, since they could be any size
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	float _getMeshScreenSize(const MeshBounds& bounds, const glm::mat4x4& mvpTransform, float viewportHeight);
+
+}
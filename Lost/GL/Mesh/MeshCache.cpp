@@ -0,0 +1,255 @@
+#include "MeshCache.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include "../../Log.h"
+#include "../../MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+namespace lost
+{
+
+	// Bump this whenever the layout of a cooked mesh changes, so old ones get loaded from source again
+	static const uint32_t s_MeshCacheVersion = 1;
+
+	// Everything in a cooked mesh is 4 bytes wide, so the blobs after the header are always aligned for a straight copy
+	// The file is laid out as: header, vertex data (floats), index data, material slot indicies
+	struct MeshCacheHeader
+	{
+		char magic[8];       // Always "LOSTMESH"
+		uint32_t version;    // s_MeshCacheVersion when the mesh was cooked
+		uint32_t vertexSize; // sizeof(Vertex) when the mesh was cooked
+
+		// The source the mesh was cooked from, if the time changed the contents are hashed to see if they did too
+		uint64_t sourceSize;
+		int64_t  sourceTime;
+		uint64_t sourceHash;
+
+		uint32_t vertexFloatCount;
+		uint32_t indexCount;
+		uint32_t materialSlotCount;
+		uint32_t meshRenderMode;
+
+		float boundsCenter[3];
+		float boundsExtents[3];
+		uint32_t boundsValid;
+		uint32_t padding;
+	};
+
+	static const char s_MeshCacheMagic[8] = { 'L', 'O', 'S', 'T', 'M', 'E', 'S', 'H' };
+
+	// Gets the size and last modified time of the file at fileDir, returns false if it doesn't exist
+	static bool getFileStats(const char* fileDir, uint64_t& size, int64_t& time)
+	{
+#ifdef _WIN32
+		struct _stat64 fileStats;
+		if (_stat64(fileDir, &fileStats) != 0)
+			return false;
+#else
+		struct stat fileStats;
+		if (stat(fileDir, &fileStats) != 0)
+			return false;
+#endif
+
+		size = (uint64_t)fileStats.st_size;
+		time = (int64_t)fileStats.st_mtime;
+		return true;
+	}
+
+	// Moves the file at fromDir over the one at toDir in one step, so readers only ever see a whole file
+	static bool replaceFile(const char* fromDir, const char* toDir)
+	{
+#ifdef _WIN32
+		return MoveFileExA(fromDir, toDir, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return rename(fromDir, toDir) == 0;
+#endif
+	}
+
+	// Checks that every index points at a vertex, and that every material slot starts inside of the index data after the one before it
+	static bool validMeshData(const CompiledMeshData* mesh)
+	{
+		const size_t vertexFloats = sizeof(Vertex) / sizeof(float);
+		if (mesh->vertexData.size() % vertexFloats != 0)
+			return false;
+
+		size_t vertexCount = mesh->vertexData.size() / vertexFloats;
+		for (unsigned int index : mesh->indexData)
+			if (index >= vertexCount)
+				return false;
+
+		unsigned int previousSlot = 0;
+		for (unsigned int slot : mesh->materialSlotIndicies)
+		{
+			if (slot < previousSlot || slot > mesh->indexData.size())
+				return false;
+			previousSlot = slot;
+		}
+		return true;
+	}
+
+	uint64_t _hashMeshSource(const char* data, size_t size)
+	{
+		// Mixes in 8 bytes at a time, which keeps up with the file being paged in
+		uint64_t hash = 0x9E3779B97F4A7C15ull ^ (uint64_t)size;
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			uint64_t word;
+			memcpy(&word, data + i, 8);
+			hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 32;
+		}
+
+		for (; i < size; i++)
+			hash = (hash ^ (unsigned char)data[i]) * 0x100000001B3ull;
+
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	bool _readMeshCache(const char* sourceLoc, CompiledMeshData* mesh)
+	{
+		std::string cacheLoc = std::string(sourceLoc) + LOST_MESH_CACHE_EXTENSION;
+
+		uint64_t sourceSize = 0, cacheSize = 0;
+		int64_t sourceTime = 0, cacheTime = 0;
+		if (!getFileStats(sourceLoc, sourceSize, sourceTime) || !getFileStats(cacheLoc.c_str(), cacheSize, cacheTime))
+			return false;
+		if (cacheSize < sizeof(MeshCacheHeader))
+			return false;
+
+		_MappedFile cacheFile;
+		if (!cacheFile.open(cacheLoc.c_str()))
+			return false;
+
+		MeshCacheHeader header;
+		memcpy(&header, cacheFile.getData(), sizeof(MeshCacheHeader));
+
+		if (memcmp(header.magic, s_MeshCacheMagic, sizeof(s_MeshCacheMagic)) != 0 || header.version != s_MeshCacheVersion ||
+			header.vertexSize != sizeof(Vertex) || header.sourceSize != sourceSize)
+			return false;
+
+		// A cache that was only partly written is too small for what it's header says it holds
+		uint64_t blobSize = ((uint64_t)header.vertexFloatCount + header.indexCount + header.materialSlotCount) * 4;
+		if (sizeof(MeshCacheHeader) + blobSize != cacheFile.getSize())
+			return false;
+
+		// The source was touched since it was cooked, but version control and copying do this without changing it
+		bool sourceTouched = header.sourceTime != sourceTime;
+		// Times are only kept to the second, so an edit in the same second the mesh was cooked keeps the same time
+		// Until the cache is written in a later second than the source was, the contents are always checked
+		bool sameSecond = header.sourceTime >= cacheTime;
+		if (sourceTouched || sameSecond)
+		{
+			_MappedFile sourceFile;
+			if (!sourceFile.open(sourceLoc) || _hashMeshSource(sourceFile.getData(), sourceFile.getSize()) != header.sourceHash)
+				return false;
+		}
+
+		const char* blob = cacheFile.getData() + sizeof(MeshCacheHeader);
+
+		mesh->vertexData.resize(header.vertexFloatCount);
+		memcpy(mesh->vertexData.data(), blob, header.vertexFloatCount * sizeof(float));
+		blob += header.vertexFloatCount * sizeof(float);
+
+		mesh->indexData.resize(header.indexCount);
+		memcpy(mesh->indexData.data(), blob, header.indexCount * sizeof(unsigned int));
+		blob += header.indexCount * sizeof(unsigned int);
+
+		mesh->materialSlotIndicies.resize(header.materialSlotCount);
+		memcpy(mesh->materialSlotIndicies.data(), blob, header.materialSlotCount * sizeof(unsigned int));
+
+		// A cache with the right size can still hold indices past the end of its data, which the GPU would read out of bounds
+		if (!validMeshData(mesh))
+		{
+			mesh->vertexData.clear();
+			mesh->indexData.clear();
+			mesh->materialSlotIndicies.clear();
+			return false;
+		}
+
+		mesh->meshRenderMode = header.meshRenderMode;
+		mesh->bounds.center = { header.boundsCenter[0], header.boundsCenter[1], header.boundsCenter[2] };
+		mesh->bounds.extents = { header.boundsExtents[0], header.boundsExtents[1], header.boundsExtents[2] };
+		mesh->bounds.valid = header.boundsValid != 0;
+
+		cacheFile.close();
+
+		// The contents are the same, so store the new time to skip hashing the source next time
+		// Writing it also moves the cache's own time on, which is what ends the same second check
+		if (sourceTouched || sameSecond)
+		{
+			std::fstream file(cacheLoc, std::ios::binary | std::ios::in | std::ios::out);
+			file.seekp(offsetof(MeshCacheHeader, sourceTime));
+			file.write((const char*)&sourceTime, sizeof(sourceTime));
+		}
+
+		return true;
+	}
+
+	void _writeMeshCache(const char* sourceLoc, const CompiledMeshData* mesh, uint64_t sourceHash)
+	{
+		std::string cacheLoc = std::string(sourceLoc) + LOST_MESH_CACHE_EXTENSION;
+
+		MeshCacheHeader header = {};
+		memcpy(header.magic, s_MeshCacheMagic, sizeof(s_MeshCacheMagic));
+		header.version = s_MeshCacheVersion;
+		header.vertexSize = sizeof(Vertex);
+
+		if (!getFileStats(sourceLoc, header.sourceSize, header.sourceTime))
+			return;
+		header.sourceHash = sourceHash;
+
+		header.vertexFloatCount = (uint32_t)mesh->vertexData.size();
+		header.indexCount = (uint32_t)mesh->indexData.size();
+		header.materialSlotCount = (uint32_t)mesh->materialSlotIndicies.size();
+		header.meshRenderMode = mesh->meshRenderMode;
+
+		header.boundsCenter[0] = mesh->bounds.center.x;
+		header.boundsCenter[1] = mesh->bounds.center.y;
+		header.boundsCenter[2] = mesh->bounds.center.z;
+		header.boundsExtents[0] = mesh->bounds.extents.x;
+		header.boundsExtents[1] = mesh->bounds.extents.y;
+		header.boundsExtents[2] = mesh->bounds.extents.z;
+		header.boundsValid = mesh->bounds.valid ? 1 : 0;
+
+		// Written to a file of it's own first, so loads of the same mesh on other threads never write over each other
+		static std::atomic<unsigned int> s_TempCount(0);
+		std::string tempLoc = cacheLoc + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "." + std::to_string(s_TempCount++) + ".tmp";
+
+		std::ofstream file(tempLoc, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			debugLog("Couldn't write the cooked mesh \"" + cacheLoc + "\", the mesh will be loaded from source next time", LOST_LOG_WARNING);
+			return;
+		}
+
+		file.write((const char*)&header, sizeof(MeshCacheHeader));
+		file.write((const char*)mesh->vertexData.data(), mesh->vertexData.size() * sizeof(float));
+		file.write((const char*)mesh->indexData.data(), mesh->indexData.size() * sizeof(unsigned int));
+		file.write((const char*)mesh->materialSlotIndicies.data(), mesh->materialSlotIndicies.size() * sizeof(unsigned int));
+		file.close();
+
+		// Whichever load finishes last replaces the cache, both hold the same mesh
+		// Replacing fails while the cache is open elsewhere on Windows, in which case the one there is kept
+		if (!file.good() || !replaceFile(tempLoc.c_str(), cacheLoc.c_str()))
+		{
+			remove(tempLoc.c_str());
+			debugLog("Couldn't finish writing the cooked mesh \"" + cacheLoc + "\", the mesh will be loaded from source next time", LOST_LOG_WARNING);
+		}
+	}
+
+}
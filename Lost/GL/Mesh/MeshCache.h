@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Mesh.h"
+
+namespace lost
+{
+
+	// Cooked meshes are written next to the file they were loaded from, with this added to the end of it's path
+	// eg. "models/cube.obj" is cached in "models/cube.obj.lostmesh"
+	#define LOST_MESH_CACHE_EXTENSION ".lostmesh"
+
+	// Hashes the contents of a mesh's source file, used to tell if a cooked mesh is still valid after the source's time changes
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	uint64_t _hashMeshSource(const char* data, size_t size);
+
+	// Reads the cooked mesh made from the file at sourceLoc into mesh, filling everything but it's vertex layout and GPU residency
+	// Returns false without logging anything if there isn't one, or if it's out of date, in which case the source should be loaded instead
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	bool _readMeshCache(const char* sourceLoc, CompiledMeshData* mesh);
+
+	// Writes mesh next to the file at sourceLoc, so it can be read by _readMeshCache() instead of loading the source again
+	// "sourceHash" is the _hashMeshSource() of the source's contents
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _writeMeshCache(const char* sourceLoc, const CompiledMeshData* mesh, uint64_t sourceHash);
+
+}
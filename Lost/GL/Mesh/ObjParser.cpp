@@ -0,0 +1,508 @@
+#include "ObjParser.h"
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../../Log.h"
+#include "../../Parallel.h"
+
+namespace lost
+{
+
+#pragma region Number Parsing
+
+	static const double s_PowersOf10[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	static inline bool isDigit(char character)
+	{
+		return (unsigned char)(character - '0') < 10;
+	}
+
+	static inline const char* skipSpaces(const char* at, const char* end)
+	{
+		while (at < end && (*at == ' ' || *at == '\t'))
+			at++;
+		return at;
+	}
+
+	// Returns the start of the next line, memchr is vectorized by the CRT so long lines are skipped quickly
+	static inline const char* nextLine(const char* at, const char* end)
+	{
+		const char* newline = (const char*)memchr(at, '\n', end - at);
+		return newline ? newline + 1 : end;
+	}
+
+	// Parses a float written as [sign]digits[.digits][e[sign]digits], returns where the number ended or "at" if there wasn't one
+	// The digits are gathered into an integer and scaled once, which is exact for the 7 or so digits .obj exporters write
+	static const char* parseFloat(const char* at, const char* end, float& value)
+	{
+		const char* start = at;
+
+		bool negative = false;
+		if (at < end && (*at == '-' || *at == '+'))
+			negative = *at++ == '-';
+
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		bool hasDigits = false;
+
+		for (; at < end && isDigit(*at); at++)
+		{
+			// Digits past what the mantissa can hold only change the magnitude
+			if (mantissa < 100000000000000000ull)
+				mantissa = mantissa * 10 + (*at - '0');
+			else
+				exponent++;
+			hasDigits = true;
+		}
+
+		if (at < end && *at == '.')
+		{
+			for (at++; at < end && isDigit(*at); at++)
+			{
+				if (mantissa < 100000000000000000ull)
+				{
+					mantissa = mantissa * 10 + (*at - '0');
+					exponent--;
+				}
+				hasDigits = true;
+			}
+		}
+
+		if (!hasDigits)
+		{
+			value = 0.0f;
+			return start;
+		}
+
+		if (at < end && (*at == 'e' || *at == 'E'))
+		{
+			const char* exponentAt = at + 1;
+			bool negativeExponent = false;
+			if (exponentAt < end && (*exponentAt == '-' || *exponentAt == '+'))
+				negativeExponent = *exponentAt++ == '-';
+
+			if (exponentAt < end && isDigit(*exponentAt))
+			{
+				int writtenExponent = 0;
+				for (; exponentAt < end && isDigit(*exponentAt); exponentAt++)
+				{
+					if (writtenExponent < 1000)
+						writtenExponent = writtenExponent * 10 + (*exponentAt - '0');
+				}
+
+				exponent += negativeExponent ? -writtenExponent : writtenExponent;
+				at = exponentAt;
+			}
+		}
+
+		double result = (double)mantissa;
+		if (mantissa != 0)
+		{
+			for (; exponent > 22; exponent -= 22)
+				result *= 1e22;
+			for (; exponent < -22; exponent += 22)
+				result /= 1e22;
+			result = exponent < 0 ? result / s_PowersOf10[-exponent] : result * s_PowersOf10[exponent];
+		}
+
+		value = (float)(negative ? -result : result);
+		return at;
+	}
+
+	// Parses an integer written as [sign]digits, returns where the number ended or "at" if there wasn't one
+	// Numbers too big for an int are treated as if there wasn't one, leaving their digits unread
+	static const char* parseInt(const char* at, const char* end, int& value)
+	{
+		const char* start = at;
+
+		bool negative = false;
+		if (at < end && (*at == '-' || *at == '+'))
+			negative = *at++ == '-';
+
+		if (at == end || !isDigit(*at))
+		{
+			value = 0;
+			return start;
+		}
+
+		int result = 0;
+		for (; at < end && isDigit(*at); at++)
+		{
+			int digit = *at - '0';
+			if (result > (INT_MAX - digit) / 10)
+			{
+				value = 0;
+				return start;
+			}
+			result = result * 10 + digit;
+		}
+
+		value = negative ? -result : result;
+		return at;
+	}
+
+#pragma endregion
+
+	// Maps each unique combination of position, texcoord and normal index a face uses to the vertex made for it
+	// Open addressing with linear probing, the keys are kept in the table so lookups never leave it
+	class ObjVertexMap
+	{
+	public:
+		ObjVertexMap(size_t expectedVerticies)
+		{
+			size_t capacity = 1024;
+			while (capacity < expectedVerticies * 2)
+				capacity *= 2;
+			m_Slots.resize(capacity);
+			m_Mask = capacity - 1;
+		}
+
+		// Returns the vertex the indicies were given, giving them "newVertex" if they haven't been seen before
+		// Positions start at 1, so a position of 0 marks an empty slot
+		unsigned int findOrAdd(int position, int texcoord, int normal, unsigned int newVertex)
+		{
+			size_t slotIndex = hash(position, texcoord, normal) & m_Mask;
+			while (true)
+			{
+				Slot& slot = m_Slots[slotIndex];
+				if (slot.position == 0)
+				{
+					slot = { position, texcoord, normal, newVertex };
+					if (++m_Count * 2 > m_Slots.size())
+						grow();
+					return newVertex;
+				}
+
+				if (slot.position == position && slot.texcoord == texcoord && slot.normal == normal)
+					return slot.vertex;
+
+				slotIndex = (slotIndex + 1) & m_Mask;
+			}
+		}
+	private:
+		struct Slot
+		{
+			int position = 0;
+			int texcoord = 0;
+			int normal = 0;
+			unsigned int vertex = 0;
+		};
+
+		static inline size_t hash(int position, int texcoord, int normal)
+		{
+			uint64_t value = (uint64_t)(uint32_t)position * 0x9E3779B97F4A7C15ull;
+			value ^= (uint64_t)(uint32_t)texcoord * 0xC2B2AE3D27D4EB4Full;
+			value ^= (uint64_t)(uint32_t)normal * 0x165667B19E3779F9ull;
+			return (size_t)(value ^ (value >> 29));
+		}
+
+		void grow()
+		{
+			std::vector<Slot> oldSlots;
+			oldSlots.swap(m_Slots);
+
+			m_Slots.resize(oldSlots.size() * 2);
+			m_Mask = m_Slots.size() - 1;
+
+			for (Slot& oldSlot : oldSlots)
+			{
+				if (oldSlot.position == 0)
+					continue;
+
+				size_t slotIndex = hash(oldSlot.position, oldSlot.texcoord, oldSlot.normal) & m_Mask;
+				while (m_Slots[slotIndex].position != 0)
+					slotIndex = (slotIndex + 1) & m_Mask;
+				m_Slots[slotIndex] = oldSlot;
+			}
+		}
+
+		std::vector<Slot> m_Slots;
+		size_t m_Mask = 0;
+		size_t m_Count = 0;
+	};
+
+	// Everything read from one chunk of the file, each chunk is read on it's own thread then they are merged in order
+	struct ObjChunk
+	{
+		std::vector<Vec3> positions;
+		std::vector<Vec2> texcoords;
+		std::vector<Vec3> normals;
+
+		// 3 indicies (position, texcoord, normal) per face vertex, see storeIndex() for how they're stored
+		std::vector<int> faceIndicies;
+		std::vector<unsigned int> faceSizes; // The amount of verticies each face has
+		std::vector<size_t> materialStarts;  // The amount of faces read before each usemtl line
+		bool malformed = false;              // If any face couldn't be read and was skipped
+	};
+
+	// Indicies are stored the way the chunk can tell without knowing what came before it:
+	//  - Positive indicies are already global, and are stored as written (1 based)
+	//  - Negative indicies count back from the attributes read so far, which can reach into earlier chunks,
+	//    so they're stored as an index from the start of the chunk (negative if it's in an earlier one) offset by s_RelativeIndex
+	//  - 0 means the index wasn't given, s_InvalidIndex means it points too far back to be stored
+	static const int s_RelativeIndex = INT_MIN / 2;
+	static const int s_InvalidIndex = INT_MIN;
+
+	static inline int storeIndex(int index, size_t chunkCount)
+	{
+		if (index >= 0)
+			return index;
+
+		long long local = (long long)chunkCount + index;
+		return local > s_RelativeIndex && local < -(long long)s_RelativeIndex ? (int)local + s_RelativeIndex : s_InvalidIndex;
+	}
+
+	// Turns a stored index into a 0 based global one, -1 if it wasn't given or -2 if it's out of range
+	static inline int resolveIndex(int stored, size_t chunkBase, size_t totalCount)
+	{
+		if (stored == 0)
+			return -1;
+		if (stored == s_InvalidIndex)
+			return -2;
+
+		long long index = stored > 0 ? (long long)stored - 1 : (long long)chunkBase + (stored - s_RelativeIndex);
+		return index >= 0 && index < (long long)totalCount ? (int)index : -2;
+	}
+
+	// Reads every line in [at, end) into the chunk, the range must start at the start of a line
+	static void parseOBJChunk(const char* at, const char* end, ObjChunk& chunk)
+	{
+		// A line of an .obj file is around 30 to 40 bytes, this only needs to be close enough to avoid most reallocations
+		size_t expectedLines = (end - at) / 32;
+		chunk.positions.reserve(expectedLines / 2);
+		chunk.texcoords.reserve(expectedLines / 2);
+		chunk.normals.reserve(expectedLines / 2);
+		chunk.faceIndicies.reserve(expectedLines * 3);
+		chunk.faceSizes.reserve(expectedLines / 2);
+
+		while (at < end)
+		{
+			at = skipSpaces(at, end);
+			if (at == end)
+				break;
+
+			char first = *at;
+			char second = at + 1 < end ? at[1] : '\n';
+
+			if (first == 'v' && (second == ' ' || second == '\t'))
+			{
+				Vec3 position;
+				at = parseFloat(skipSpaces(at + 1, end), end, position.x);
+				at = parseFloat(skipSpaces(at, end), end, position.y);
+				at = parseFloat(skipSpaces(at, end), end, position.z);
+				chunk.positions.push_back(position);
+			}
+			else if (first == 'v' && second == 't')
+			{
+				Vec2 texture;
+				at = parseFloat(skipSpaces(at + 2, end), end, texture.x);
+				at = parseFloat(skipSpaces(at, end), end, texture.y);
+				chunk.texcoords.push_back(texture);
+			}
+			else if (first == 'v' && second == 'n')
+			{
+				Vec3 normal;
+				at = parseFloat(skipSpaces(at + 2, end), end, normal.x);
+				at = parseFloat(skipSpaces(at, end), end, normal.y);
+				at = parseFloat(skipSpaces(at, end), end, normal.z);
+				chunk.normals.push_back(normal);
+			}
+			else if (first == 'f' && (second == ' ' || second == '\t'))
+			{
+				size_t faceStart = chunk.faceIndicies.size();
+				bool validFace = true;
+
+				at = skipSpaces(at + 1, end);
+				while (at < end && *at != '\n' && *at != '\r' && *at != '#')
+				{
+					int position = 0, texcoord = 0, normal = 0;
+					const char* afterNumber = parseInt(at, end, position);
+					if (afterNumber == at || position == 0)
+					{
+						validFace = false;
+						break;
+					}
+					at = afterNumber;
+
+					// Each vertex is written as "v", "v/vt", "v//vn" or "v/vt/vn"
+					if (at < end && *at == '/')
+					{
+						at = parseInt(at + 1, end, texcoord);
+						if (at < end && *at == '/')
+							at = parseInt(at + 1, end, normal);
+					}
+
+					// Digits left over are an index too big to be read
+					if (at < end && isDigit(*at))
+					{
+						validFace = false;
+						break;
+					}
+
+					chunk.faceIndicies.insert(chunk.faceIndicies.end(), {
+						storeIndex(position, chunk.positions.size()),
+						storeIndex(texcoord, chunk.texcoords.size()),
+						storeIndex(normal, chunk.normals.size())
+					});
+					at = skipSpaces(at, end);
+				}
+
+				size_t faceSize = (chunk.faceIndicies.size() - faceStart) / 3;
+				if (!validFace || faceSize < 3)
+				{
+					chunk.faceIndicies.resize(faceStart);
+					chunk.malformed = true;
+				}
+				else
+					chunk.faceSizes.push_back((unsigned int)faceSize);
+			}
+			else if (end - at > 6 && memcmp(at, "usemtl", 6) == 0 && (at[6] == ' ' || at[6] == '\t'))
+			{
+				// Materials
+				chunk.materialStarts.push_back(chunk.faceSizes.size());
+			}
+
+			// Anything else (comments, groups, smoothing...) isn't used
+			at = nextLine(at, end);
+		}
+	}
+
+	bool _parseOBJ(const char* data, size_t size, const char* objLoc, MeshData& meshData)
+	{
+		const char* end = data + size;
+
+		// Split the file into chunks of at least 1MB each, moving each split forward to the start of the next line
+		unsigned int chunkCount = _parallelRangeCount(size, 1024 * 1024);
+		std::vector<const char*> chunkStarts(chunkCount + 1, end);
+		chunkStarts[0] = data;
+		for (unsigned int i = 1; i < chunkCount; i++)
+		{
+			const char* split = data + size * i / chunkCount;
+			split = split < chunkStarts[i - 1] ? chunkStarts[i - 1] : split;
+			chunkStarts[i] = split > data && split[-1] == '\n' ? split : nextLine(split, end);
+		}
+
+		if (chunkCount > 1)
+			debugLog(std::string("Loading large object (\"") + objLoc + "\") on " + std::to_string(chunkCount) + " threads", LOST_LOG_INFO);
+
+		std::vector<ObjChunk> chunks(chunkCount);
+		_parallelRanges(chunkCount, chunkCount, [&](size_t firstChunk, size_t lastChunk, unsigned int)
+		{
+			for (size_t i = firstChunk; i < lastChunk; i++)
+				parseOBJChunk(chunkStarts[i], chunkStarts[i + 1], chunks[i]);
+		});
+
+		// Every chunk's attributes are joined together, each chunk's local indicies start at it's base
+		std::vector<Vec3> positionData;
+		std::vector<Vec2> textureData;
+		std::vector<Vec3> normalData;
+		std::vector<size_t> positionBases(chunkCount), textureBases(chunkCount), normalBases(chunkCount);
+
+		size_t faceVertexCount = 0;
+		bool malformed = false;
+		for (unsigned int i = 0; i < chunkCount; i++)
+		{
+			positionBases[i] = positionData.size();
+			textureBases[i] = textureData.size();
+			normalBases[i] = normalData.size();
+
+			positionData.insert(positionData.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+			textureData.insert(textureData.end(), chunks[i].texcoords.begin(), chunks[i].texcoords.end());
+			normalData.insert(normalData.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+
+			// Only the faces are needed from now on
+			std::vector<Vec3>().swap(chunks[i].positions);
+			std::vector<Vec2>().swap(chunks[i].texcoords);
+			std::vector<Vec3>().swap(chunks[i].normals);
+
+			faceVertexCount += chunks[i].faceIndicies.size() / 3;
+			malformed |= chunks[i].malformed;
+		}
+
+		ObjVertexMap vertexMap(faceVertexCount / 2);
+		meshData.verticies.reserve(faceVertexCount / 2);
+		meshData.indexArray.reserve(faceVertexCount);
+
+		// The faces are merged in the order they were written, so the verticies and material slots come out the same as reading the file in one go
+		std::vector<unsigned int> faceVerticies; // The verticies of the face being merged, reused for every face
+		for (unsigned int chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+		{
+			const ObjChunk& chunk = chunks[chunkIndex];
+			const int* faceIndex = chunk.faceIndicies.data();
+			size_t nextMaterial = 0;
+
+			for (size_t face = 0; face <= chunk.faceSizes.size(); face++)
+			{
+				while (nextMaterial < chunk.materialStarts.size() && chunk.materialStarts[nextMaterial] == face)
+				{
+					meshData.materialSlotIndicies.push_back(meshData.indexArray.size());
+					nextMaterial++;
+				}
+
+				if (face == chunk.faceSizes.size())
+					break;
+
+				// The whole face is resolved before any verticies are made, so a face pointing out of range doesn't leave any behind
+				unsigned int faceSize = chunk.faceSizes[face];
+				const int* faceEnd = faceIndex + faceSize * 3;
+
+				bool validFace = true;
+				for (const int* index = faceIndex; index < faceEnd; index += 3)
+				{
+					if (resolveIndex(index[0], positionBases[chunkIndex], positionData.size()) < 0 ||
+						resolveIndex(index[1], textureBases[chunkIndex], textureData.size()) == -2 ||
+						resolveIndex(index[2], normalBases[chunkIndex], normalData.size()) == -2)
+						validFace = false;
+				}
+
+				faceVerticies.clear();
+				for (const int* index = faceIndex; validFace && index < faceEnd; index += 3)
+				{
+					int position = resolveIndex(index[0], positionBases[chunkIndex], positionData.size());
+					int texcoord = resolveIndex(index[1], textureBases[chunkIndex], textureData.size());
+					int normal = resolveIndex(index[2], normalBases[chunkIndex], normalData.size());
+
+					unsigned int vertexIndex = vertexMap.findOrAdd(position + 1, texcoord + 1, normal + 1, (unsigned int)meshData.verticies.size());
+					if (vertexIndex == meshData.verticies.size())
+					{
+						Vertex vert = {};
+
+						vert.position = positionData[position];
+						// Check if theres a texCoord included
+						if (texcoord != -1)
+							vert.textureCoord = { textureData[texcoord].x, 1.0f - textureData[texcoord].y };
+						// Check if theres a normal included
+						if (normal != -1)
+							vert.vertexNormal = normalData[normal];
+
+						vert.vertexColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+						meshData.verticies.push_back(vert);
+					}
+
+					faceVerticies.push_back(vertexIndex);
+				}
+
+				if (validFace)
+				{
+					// Triangulate the face as a fan around it's first vertex
+					for (size_t i = 1; i + 1 < faceVerticies.size(); i++)
+						meshData.indexArray.insert(meshData.indexArray.end(), { faceVerticies[0], faceVerticies[i], faceVerticies[i + 1] });
+				}
+				malformed |= !validFace;
+
+				faceIndex = faceEnd;
+			}
+		}
+
+		debugLogIf(malformed, std::string("Malformed .obj file, \"") + objLoc + "\" has faces with less than 3 verticies or indicies out of range, they have been skipped", LOST_LOG_ERROR);
+
+		return !normalData.empty();
+	}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include "Mesh.h"
+
+namespace lost
+{
+
+	// Parses the contents of a .obj file into meshData in a single pass, without copying or splitting it up first
+	// Faces with more than 3 verticies are triangulated as fans, "objLoc" is only used when logging
+	// Returns true if the file contained any normals
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	bool _parseOBJ(const char* data, size_t size, const char* objLoc, MeshData& meshData);
+
+}
@@ -0,0 +1,130 @@
+#include "VertexLayout.h"
+#include <cstring>
+#include <cmath>
+#include "../../Log.h"
+
+namespace lost
+{
+
+	unsigned int _getVertexStride(unsigned int vertexLayout)
+	{
+		switch (vertexLayout)
+		{
+		case LOST_VERTEX_LAYOUT_FULL:
+			return 16 * sizeof(float);
+		case LOST_VERTEX_LAYOUT_COMPACT:
+			return sizeof(CompactVertex);
+		case LOST_VERTEX_LAYOUT_2D:
+			return sizeof(Vertex2D);
+		default:
+			debugLog("Vertex layout enum out of bounds", LOST_LOG_WARNING);
+			return 16 * sizeof(float);
+		}
+	}
+
+	unsigned short _packHalf(float value)
+	{
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(float));
+
+		unsigned short sign = (bits >> 16) & 0x8000;
+		int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+		unsigned int mantissa = bits & 0x7FFFFF;
+
+		// Infinity and NaN
+		if (((bits >> 23) & 0xFF) == 0xFF)
+			return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+
+		// Too large, becomes infinity
+		if (exponent >= 31)
+			return sign | 0x7C00;
+
+		// Too small for a normal half float
+		if (exponent <= 0)
+		{
+			if (exponent < -10)
+				return sign;
+
+			mantissa |= 0x800000;
+			unsigned int shift = 14 - exponent;
+			unsigned short half = (unsigned short)(mantissa >> shift);
+			if ((mantissa >> (shift - 1)) & 1)
+				half++;
+
+			return sign | half;
+		}
+
+		unsigned short half = sign | (unsigned short)(exponent << 10) | (unsigned short)(mantissa >> 13);
+
+		// Round to the nearest, a carry into the exponent is still correct
+		if (mantissa & 0x1000)
+			half++;
+
+		return half;
+	}
+
+	unsigned char _packUnorm8(float value)
+	{
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return (unsigned char)(value * 255.0f + 0.5f);
+	}
+
+	unsigned int _packSnorm1010102(float x, float y, float z, float w)
+	{
+		auto packComponent = [](float value, float scale, unsigned int mask) -> unsigned int
+		{
+			value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+			return (unsigned int)(int)roundf(value * scale) & mask;
+		};
+
+		return packComponent(x, 511.0f, 0x3FF)
+			| (packComponent(y, 511.0f, 0x3FF) << 10)
+			| (packComponent(z, 511.0f, 0x3FF) << 20)
+			| (packComponent(w, 1.0f, 0x3) << 30);
+	}
+
+	void _packVerticies(const std::vector<float>& vertexData, unsigned int vertexLayout, std::vector<char>& output)
+	{
+		size_t vertexCount = vertexData.size() / 16;
+		unsigned int stride = _getVertexStride(vertexLayout);
+
+		output.resize(vertexCount * stride);
+
+		if (vertexLayout == LOST_VERTEX_LAYOUT_FULL)
+		{
+			memcpy(output.data(), vertexData.data(), output.size());
+			return;
+		}
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			// { X, Y, Z, U, V, R, G, B, A, NX, NY, NZ, TX, TY, TZ, TW }
+			const float* vertex = vertexData.data() + i * 16;
+
+			if (vertexLayout == LOST_VERTEX_LAYOUT_COMPACT)
+			{
+				CompactVertex* packed = (CompactVertex*)output.data() + i;
+				packed->position[0] = vertex[0];
+				packed->position[1] = vertex[1];
+				packed->position[2] = vertex[2];
+				packed->textureCoord[0] = _packHalf(vertex[3]);
+				packed->textureCoord[1] = _packHalf(vertex[4]);
+				for (int channel = 0; channel < 4; channel++)
+					packed->color[channel] = _packUnorm8(vertex[5 + channel]);
+				packed->normal = _packSnorm1010102(vertex[9], vertex[10], vertex[11], 0.0f);
+				packed->tangent = _packSnorm1010102(vertex[12], vertex[13], vertex[14], vertex[15] < 0.0f ? -1.0f : 1.0f);
+			}
+			else
+			{
+				Vertex2D* packed = (Vertex2D*)output.data() + i;
+				packed->position[0] = vertex[0];
+				packed->position[1] = vertex[1];
+				packed->textureCoord[0] = vertex[3];
+				packed->textureCoord[1] = vertex[4];
+				for (int channel = 0; channel < 4; channel++)
+					packed->color[channel] = _packUnorm8(vertex[5 + channel]);
+			}
+		}
+	}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+
+// The layout a mesh's verticies are stored in on the GPU
+// Meshes are always stored as LOST_VERTEX_LAYOUT_FULL on the CPU, they are only packed when uploaded
+// Every layout is read by shaders the same way, so no shader needs to know which one a mesh uses
+enum VertexLayout
+{
+	// This is the DEFAULT layout meshes use
+	// 64 bytes, every attribute is stored as floats
+	// { X, Y, Z, U, V, R, G, B, A, NX, NY, NZ, TX, TY, TZ, TW }
+	LOST_VERTEX_LAYOUT_FULL,
+
+	// 28 bytes, the position is stored as floats, texture coordinates as half floats, the color as 8 bits per channel
+	// and the normal and tangent as 10 bits per axis
+	// Half float texture coordinates lose precision past +-2048, so meshes with large tiling values should use LOST_VERTEX_LAYOUT_FULL
+	LOST_VERTEX_LAYOUT_COMPACT,
+
+	// 20 bytes, a 2D position and texture coordinates stored as floats, the color as 8 bits per channel
+	// The normal and tangent aren't stored, every vertex faces the screen with a normal of { 0, 0, -1 } and a tangent of { 0, 1, 0, 1 }
+	// Used by the renderer for every rect, circle, line and character
+	LOST_VERTEX_LAYOUT_2D,
+
+	// The amount of vertex layouts, not a layout
+	LOST_VERTEX_LAYOUT_COUNT
+};
+
+namespace lost
+{
+
+	struct CompactVertex
+	{
+		float position[3];
+		unsigned short textureCoord[2]; // Half floats
+		unsigned char color[4];
+		unsigned int normal;  // GL_INT_2_10_10_10_REV
+		unsigned int tangent; // GL_INT_2_10_10_10_REV, w is stored as the sign in the top 2 bits
+	};
+
+	struct Vertex2D
+	{
+		float position[2];
+		float textureCoord[2];
+		unsigned char color[4];
+	};
+
+	// Returns the size of a single vertex in the layout given, in bytes
+	unsigned int _getVertexStride(unsigned int vertexLayout);
+
+	// Converts a float to a half float, rounding to the nearest value
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned short _packHalf(float value);
+	// Converts a 0 - 1 float to an 8 bit value, values outside of the range are clamped
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned char _packUnorm8(float value);
+	// Packs a -1 - 1 vector into the GL_INT_2_10_10_10_REV format, values outside of the range are clamped
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned int _packSnorm1010102(float x, float y, float z, float w);
+
+	// Converts the LOST_VERTEX_LAYOUT_FULL vertex data given into the layout given, replacing the contents of "output"
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _packVerticies(const std::vector<float>& vertexData, unsigned int vertexLayout, std::vector<char>& output);
+
+}
@@ -0,0 +1,255 @@
+#include "PixelTransfer.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+#include "LostGL.h"
+#include "GLStateCache.h"
+#include "../Log.h"
+
+namespace lost
+{
+
+	// Enough for a few 2048x2048 RGBA8 textures in flight at once, anything which doesn't fit is uploaded from client memory
+	static const size_t s_PixelUploadBufferSize = 64 * 1024 * 1024;
+	// Uploads start on a multiple of this, which covers every pixel format's alignment
+	static const size_t s_PixelUploadAlignment = 16;
+
+	static unsigned int s_PixelUploadBuffer = 0;
+	static unsigned char* s_PixelUploadData = nullptr;
+
+	// Uploads in the order they were allocated, space is only reused once every upload before it is done
+	// A deque never moves it's elements when adding to the back or taking from the front, so pointers to uploads stay valid
+	static std::deque<_PixelUpload> s_PixelUploads;
+	static std::mutex s_PixelUploadMutex;
+
+	static std::vector<_PixelReadback*> s_QueuedReadbacks; // Waiting for the end of the frame to be issued
+
+	// Returns true if the fence has been signaled, optionally blocking until it is
+	static bool isFenceSignaled(void* fence, bool wait)
+	{
+		GLenum result = glClientWaitSync((GLsync)fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while (wait && result == GL_TIMEOUT_EXPIRED)
+			result = glClientWaitSync((GLsync)fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+
+		return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+	}
+
+	// Frees the space of uploads at the front which the GPU is done with
+	static void reclaimPixelUploads(bool wait)
+	{
+		std::lock_guard<std::mutex> lock(s_PixelUploadMutex);
+		while (!s_PixelUploads.empty())
+		{
+			_PixelUpload& upload = s_PixelUploads.front();
+			if (!upload.done || (upload.fence != nullptr && !isFenceSignaled(upload.fence, wait)))
+				break;
+
+			if (upload.fence != nullptr)
+				glDeleteSync((GLsync)upload.fence);
+			s_PixelUploads.pop_front();
+		}
+	}
+
+	void _initPixelTransfers()
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glCreateBuffers(1, &s_PixelUploadBuffer);
+		glNamedBufferStorage(s_PixelUploadBuffer, (GLsizeiptr)s_PixelUploadBufferSize, nullptr, flags);
+		s_PixelUploadData = (unsigned char*)glMapNamedBufferRange(s_PixelUploadBuffer, 0, (GLsizeiptr)s_PixelUploadBufferSize, flags);
+
+		debugLogIf(s_PixelUploadData == nullptr, "Failed to persistently map the pixel upload buffer, textures will be uploaded from client memory", LOST_LOG_WARNING);
+	}
+
+	void _destroyPixelTransfers()
+	{
+		s_QueuedReadbacks.clear();
+
+		// Any upload not done by now was from a load which never finished, and never will
+		{
+			std::lock_guard<std::mutex> lock(s_PixelUploadMutex);
+			for (_PixelUpload& upload : s_PixelUploads)
+				upload.done = true;
+		}
+		reclaimPixelUploads(true);
+
+		if (s_PixelUploadBuffer == 0)
+			return;
+
+		glUnmapNamedBuffer(s_PixelUploadBuffer);
+		_deleteGLBuffers(1, &s_PixelUploadBuffer);
+		s_PixelUploadBuffer = 0;
+		s_PixelUploadData = nullptr;
+	}
+
+	void _updatePixelTransfers()
+	{
+		for (_PixelReadback* readback : s_QueuedReadbacks)
+			readback->_issue();
+		s_QueuedReadbacks.clear();
+
+		reclaimPixelUploads(false);
+	}
+
+	_PixelUpload* _allocatePixelUpload(size_t size)
+	{
+		if (s_PixelUploadData == nullptr)
+			return nullptr;
+
+		size = ((size + s_PixelUploadAlignment - 1) / s_PixelUploadAlignment) * s_PixelUploadAlignment;
+
+		std::lock_guard<std::mutex> lock(s_PixelUploadMutex);
+
+		// The buffer is used as a ring, new uploads go after the newest one, wrapping back to the start if they don't fit
+		size_t offset = 0;
+		bool fits = size <= s_PixelUploadBufferSize;
+		if (!s_PixelUploads.empty())
+		{
+			const _PixelUpload& oldest = s_PixelUploads.front();
+			const _PixelUpload& newest = s_PixelUploads.back();
+			size_t newestEnd = newest.offset + newest.size;
+
+			if (newest.offset >= oldest.offset)
+			{
+				offset = newestEnd + size <= s_PixelUploadBufferSize ? newestEnd : 0;
+				fits = offset == newestEnd || size <= oldest.offset;
+			}
+			else
+			{
+				offset = newestEnd;
+				fits = newestEnd + size <= oldest.offset;
+			}
+		}
+
+		if (!fits)
+			return nullptr;
+
+		s_PixelUploads.emplace_back();
+		_PixelUpload& upload = s_PixelUploads.back();
+		upload.data = s_PixelUploadData + offset;
+		upload.offset = offset;
+		upload.size = size;
+		return &upload;
+	}
+
+	void _finishPixelUpload(_PixelUpload* upload)
+	{
+		void* fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		std::lock_guard<std::mutex> lock(s_PixelUploadMutex);
+		upload->fence = fence;
+		upload->done = true;
+	}
+
+	void _cancelPixelUpload(_PixelUpload* upload)
+	{
+		std::lock_guard<std::mutex> lock(s_PixelUploadMutex);
+		upload->done = true;
+	}
+
+	unsigned int _getPixelUploadBuffer()
+	{
+		return s_PixelUploadBuffer;
+	}
+
+	_PixelReadback::_PixelReadback(unsigned int openGLTexture, int width, int height)
+		: m_Texture(openGLTexture), m_Width(width), m_Height(height)
+	{
+		s_QueuedReadbacks.push_back(this);
+	}
+
+	_PixelReadback::~_PixelReadback()
+	{
+		s_QueuedReadbacks.erase(std::remove(s_QueuedReadbacks.begin(), s_QueuedReadbacks.end(), this), s_QueuedReadbacks.end());
+
+		if (m_Fence != nullptr)
+			glDeleteSync((GLsync)m_Fence);
+		if (m_Buffer != 0)
+			_deleteGLBuffers(1, &m_Buffer);
+	}
+
+	bool _PixelReadback::isReady()
+	{
+		if (m_Fence != nullptr && isFenceSignaled(m_Fence, false))
+			collect();
+
+		return !m_Pixels.empty();
+	}
+
+	void _PixelReadback::wait()
+	{
+		if (!m_Pixels.empty())
+			return;
+
+		if (m_Buffer == 0)
+		{
+			s_QueuedReadbacks.erase(std::remove(s_QueuedReadbacks.begin(), s_QueuedReadbacks.end(), this), s_QueuedReadbacks.end());
+			_issue();
+		}
+
+		isFenceSignaled(m_Fence, true);
+		collect();
+	}
+
+	void _PixelReadback::_issue()
+	{
+		size_t size = (size_t)m_Width * m_Height * 4;
+
+		glCreateBuffers(1, &m_Buffer);
+		glNamedBufferStorage(m_Buffer, (GLsizeiptr)size, nullptr, GL_MAP_READ_BIT);
+
+		// With a pixel pack buffer bound the copy is written into it on the GPU's timeline, rather than waited on
+		_glState->bindBuffer(GL_PIXEL_PACK_BUFFER, m_Buffer);
+		glGetTextureImage(m_Texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)size, nullptr);
+		_glState->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		m_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	void _PixelReadback::collect()
+	{
+		size_t size = (size_t)m_Width * m_Height * 4;
+
+		const unsigned char* data = (const unsigned char*)glMapNamedBufferRange(m_Buffer, 0, (GLsizeiptr)size, GL_MAP_READ_BIT);
+		if (data != nullptr)
+		{
+			m_Pixels.assign(data, data + size);
+			glUnmapNamedBuffer(m_Buffer);
+		}
+		else
+			debugLog("Failed to map a pixel readback's buffer", LOST_LOG_ERROR);
+
+		glDeleteSync((GLsync)m_Fence);
+		m_Fence = nullptr;
+		_deleteGLBuffers(1, &m_Buffer);
+		m_Buffer = 0;
+	}
+
+	PixelReadback readTextureAsync(Texture texture)
+	{
+		return readTextureAsync(texture->getTexture());
+	}
+
+	PixelReadback readTextureAsync(unsigned int openGLTexture)
+	{
+		int width = 0, height = 0;
+		glGetTextureLevelParameteriv(openGLTexture, 0, GL_TEXTURE_WIDTH, &width);
+		glGetTextureLevelParameteriv(openGLTexture, 0, GL_TEXTURE_HEIGHT, &height);
+
+		return new _PixelReadback(openGLTexture, width, height);
+	}
+
+	PixelReadback readRenderTextureAsync(unsigned int pass, unsigned int windowID)
+	{
+		return readTextureAsync(getRenderTexture(pass, windowID));
+	}
+
+	void destroyPixelReadback(PixelReadback readback)
+	{
+		delete readback;
+	}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Texture/Texture.h"
+
+namespace lost
+{
+
+	// Space in the pixel upload buffer, a persistently mapped pixel unpack buffer (PBO)
+	// Any thread can allocate space and write pixels into it, then the main thread uploads them using it's offset
+	// so the driver copies them to the GPU in the background, rather than from client memory during the call
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	struct _PixelUpload
+	{
+		unsigned char* data = nullptr; // Where to write the pixels
+		size_t offset = 0;             // Where the pixels are inside of the buffer, passed in place of a pointer while it's bound
+		size_t size = 0;
+
+		void* fence = nullptr; // GLsync, signaled once the GPU is done reading the pixels
+		bool done = false;     // Finished or cancelled, the space is reused once it's fence is signaled
+	};
+
+	// Creates and maps the pixel upload buffer, must be ran while a context is active
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _initPixelTransfers();
+	// Waits for the GPU to finish with every upload and readback, then deletes their buffers
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _destroyPixelTransfers();
+	// Issues readbacks requested this frame and frees upload space the GPU is done with, ran at the end of every frame
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _updatePixelTransfers();
+
+	// Allocates space for size bytes of pixels, can be ran from any thread
+	// Returns nullptr if there isn't enough space free, in which case upload from client memory instead
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	_PixelUpload* _allocatePixelUpload(size_t size);
+	// Fences the upload after the calls reading from it have been made, must be ran on the main thread
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _finishPixelUpload(_PixelUpload* upload);
+	// Gives back space which was never uploaded from, can be ran from any thread
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _cancelPixelUpload(_PixelUpload* upload);
+	// The OpenGL buffer uploads are in, bind it to GL_PIXEL_UNPACK_BUFFER before uploading and unbind it afterwards
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned int _getPixelUploadBuffer();
+
+	// A copy of a texture's pixels read back from the GPU without waiting for it, the pixels are ready a frame or two later
+	// The copy is made at the end of the frame it was requested in, so it holds everything drawn that frame
+	class _PixelReadback
+	{
+	public:
+		_PixelReadback(unsigned int openGLTexture, int width, int height);
+		~_PixelReadback();
+
+		// Returns true once the pixels have arrived, never blocks
+		bool isReady();
+		// Blocks until the pixels have arrived, issuing the copy first if the frame hasn't ended yet
+		void wait();
+
+		// RGBA8 pixels with the bottom row first as OpenGL stores them, nullptr until isReady() returns true
+		inline const unsigned char* getPixels() const { return m_Pixels.empty() ? nullptr : m_Pixels.data(); };
+		inline int getWidth() const { return m_Width; };
+		inline int getHeight() const { return m_Height; };
+
+		// Copies the texture into the readback's buffer and fences it
+		// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+		void _issue();
+	private:
+		// Copies the pixels out of the buffer once the fence has been signaled
+		void collect();
+
+		unsigned int m_Texture;
+		int m_Width;
+		int m_Height;
+
+		unsigned int m_Buffer = 0;
+		void* m_Fence = nullptr; // GLsync
+		std::vector<unsigned char> m_Pixels;
+	};
+
+	// A reference to a pixel readback
+	typedef _PixelReadback* PixelReadback;
+
+	// Reads the first level of the texture back as RGBA8 pixels, the readback must be destroyed with destroyPixelReadback()
+	// The texture must stay alive until the readback is ready
+	PixelReadback readTextureAsync(Texture texture);
+	PixelReadback readTextureAsync(unsigned int openGLTexture);
+	// Reads back one of the main render pass' textures, see getRenderTexture()
+	PixelReadback readRenderTextureAsync(unsigned int pass, unsigned int windowID = -1);
+	void          destroyPixelReadback(PixelReadback readback);
+
+}
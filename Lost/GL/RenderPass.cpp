@@ -11,15 +11,15 @@ namespace lost
 
 	_RenderPass::~_RenderPass()
 	{
-		glDeleteTextures(textures.size(), textures.data());
-		glDeleteTextures(1, &depthStencilTexture);
-		glDeleteBuffers(1, &FBO);
+		_deleteGLTextures(textures.size(), textures.data());
+		_deleteGLTextures(1, &depthStencilTexture);
+		_deleteGLFramebuffers(1, &FBO);
 	}
 
 	void _RenderPass::makePass(int width, int height, std::vector<RenderBufferData> buffers, Window context)
 	{
 		pushWindow();
-		glfwMakeContextCurrent(context->glfwWindow);
+		_makeContextCurrent(context->glfwWindow);
 
 		storedBuffers = buffers;
 
@@ -27,7 +27,7 @@ namespace lost
 
 		// Generate Frame Buffer
 		glGenFramebuffers(1, &FBO);
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		_glState->bindFramebuffer(FBO);
 
 		// Create color texture
 		textures.resize(buffers.size());
@@ -36,20 +36,25 @@ namespace lost
 		{
 			textureMap[buffers[i].name] = textures[i];
 
-			glBindTexture(GL_TEXTURE_2D, textures[i]);
+			_glState->bindTexture(0, GL_TEXTURE_2D, textures[i]);
 			glTexImage2D(GL_TEXTURE_2D, 0, buffers[i].format, width, height, 0, buffers[i].format, GL_UNSIGNED_BYTE, 0);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, textures[i], 0);
-
-			setClearColor(i, buffers[i].defaultColor);
 		}
 
+		// The draw buffers are part of the framebuffer's state, so they only need to be set once
+		unsigned int drawBuffers[32];
+		unsigned int drawBufferCount = textures.size() < 32 ? textures.size() : 32;
+		for (unsigned int i = 0; i < drawBufferCount; i++)
+			drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+		glDrawBuffers(drawBufferCount, drawBuffers);
+
 		// Create depth stencil
 		glGenTextures(1, &depthStencilTexture);
-		glBindTexture(GL_TEXTURE_2D, depthStencilTexture);
+		_glState->bindTexture(0, GL_TEXTURE_2D, depthStencilTexture);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -57,23 +62,15 @@ namespace lost
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthStencilTexture, 0);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		_glState->bindFramebuffer(0);
 
 		popWindow();
 	}
 
 	void _RenderPass::setClearColor(int passID, lost::Vec4 color)
 	{
-		// Store current frame buffer to return to afterwards
-		int activeFrameBuffer = 0;
-		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &activeFrameBuffer);
-
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-		unsigned int buffers[1] = { GL_COLOR_ATTACHMENT0 + passID };
-		glDrawBuffers(1, buffers);
-		glClearColor(color.x, color.y, color.z, color.w); // Only set the clear color in the active draw buffer
-
-		glBindFramebuffer(GL_FRAMEBUFFER, activeFrameBuffer); // Return back to old frame buffer
+		// Each buffer is cleared with glClearBufferfv using it's stored color, so nothing needs to be given to OpenGL
+		storedBuffers[passID].defaultColor = color;
 	}
 
 	void _RenderPass::resize(int width, int height, Window context)
@@ -81,25 +78,24 @@ namespace lost
 		if (width > 0 && height > 0)
 		{
 			pushWindow();
-			glfwMakeContextCurrent(context->glfwWindow);
+			_makeContextCurrent(context->glfwWindow);
 
-			int activeFrameBuffer = 0;
-			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &activeFrameBuffer);
+			unsigned int activeFrameBuffer = _glState->getFramebuffer();
 
-			glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+			_glState->bindFramebuffer(FBO);
 
 			for (int i = 0; i < textures.size(); i++)
 			{
-				glBindTexture(GL_TEXTURE_2D, textures[i]);
+				_glState->bindTexture(0, GL_TEXTURE_2D, textures[i]);
 				glTexImage2D(GL_TEXTURE_2D, 0, storedBuffers[i].format, width, height, 0, storedBuffers[i].format, GL_UNSIGNED_BYTE, 0);
 				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, textures[i], 0);
 			}
 
-			glBindTexture(GL_TEXTURE_2D, depthStencilTexture);
+			_glState->bindTexture(0, GL_TEXTURE_2D, depthStencilTexture);
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthStencilTexture, 0);
 
-			glBindFramebuffer(GL_FRAMEBUFFER, activeFrameBuffer); // Return back to old frame buffer
+			_glState->bindFramebuffer(activeFrameBuffer); // Return back to old frame buffer
 
 			popWindow();
 		}
@@ -107,15 +103,8 @@ namespace lost
 
 	void _RenderPass::bind()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-
-		std::vector<unsigned int> buffers;
-		buffers.reserve(textures.size());
-		for (int i = 0; i < textures.size(); i++)
-			buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
-		glDrawBuffers(buffers.size(), buffers.data());
-
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		// The draw buffers were set when the pass was made
+		_glState->bindFramebuffer(FBO);
 	}
 
 	std::stack<RenderTexture*> _renderTextureStack;
@@ -198,6 +187,11 @@ namespace lost
 		return m_Textures.at(slot);
 	}
 
+	PixelReadback RenderTexture::readPixelsAsync(int slot) const
+	{
+		return readTextureAsync(m_Textures.at(slot));
+	}
+
 	void RenderTexture::_bindPass()
 	{
 		m_RenderPass.bind();
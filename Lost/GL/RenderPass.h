@@ -9,6 +9,7 @@
 #include "Vector.h"
 
 #include "Texture/Texture.h"
+#include "PixelTransfer.h"
 
 namespace lost
 {
@@ -47,6 +48,8 @@ namespace lost
 		void resize(int width, int height);
 
 		Texture getTexture(int slot) const;
+		// Reads the texture in the slot back without waiting for it, see readTextureAsync()
+		PixelReadback readPixelsAsync(int slot = 0) const;
 		//Material getMaterial() const;
 
 	private:
@@ -9,9 +9,12 @@
 #undef GLM_ENABLE_EXPERIMENTAL
 
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
 #include "../DeltaTime.h"
+#include "Texture/TextureStreaming.h"
 
 // ImGui setup, only active if necessary
 #ifndef IMGUI_DISABLE
@@ -25,6 +28,27 @@ namespace lost
 
 	Renderer* _renderer = nullptr;
 
+	// The most quads a single raw mesh can hold, this is also how many quads the shared quad index pattern covers
+	static const unsigned int s_MaxRawMeshQuads = 16384;
+
+	// Given out to each 3D queue, so materials can tell if they've already been written into the queue's material buffer
+	static unsigned int s_NextBatchStamp = 1;
+
+	// Writes a vertex in the LOST_VERTEX_LAYOUT_2D layout, returning the vertex after it
+	static inline Vertex2D* write2DVertex(Vertex2D* vertex, float x, float y, float u, float v, const Color& color)
+	{
+		vertex->position[0] = x;
+		vertex->position[1] = y;
+		vertex->textureCoord[0] = u;
+		vertex->textureCoord[1] = v;
+		vertex->color[0] = _packUnorm8(color.r);
+		vertex->color[1] = _packUnorm8(color.g);
+		vertex->color[2] = _packUnorm8(color.b);
+		vertex->color[3] = _packUnorm8(color.a);
+
+		return vertex + 1;
+	}
+
 	static glm::mat4x4 get2DScaleMat()
 	{
 		bool flipY = lost::_renderTextureStack.empty();
@@ -74,11 +98,13 @@ namespace lost
 		for (RenderPass renderPass : m_MainRenderPasses)
 			delete renderPass;
 
-		glDeleteVertexArrays(VAOs.size(), VAOs.data());
-		glDeleteVertexArrays(1, &m_EmptyVAO);
-		glDeleteBuffers(1, &VBO);
-		glDeleteBuffers(1, &MBO);
-		glDeleteBuffers(1, &EBO);
+		_deleteGLVertexArrays(VAOs.size(), VAOs.data());
+		_deleteGLVertexArrays(1, &m_EmptyVAO);
+		_deleteGLBuffers(1, &VBO);
+		_deleteGLBuffers(1, &EBO);
+
+		for (CompiledMeshData* mesh : m_RawMeshes)
+			delete mesh;
 	}
 
 	void Renderer::setRenderMode(unsigned int renderMode)
@@ -104,15 +130,57 @@ namespace lost
 		m_CullMode = cullMode;
 	}
 
+	void Renderer::setSubmissionMode(unsigned int submissionMode)
+	{
+		if (submissionMode != LOST_SUBMIT_DIRECT && submissionMode != LOST_SUBMIT_INDIRECT)
+		{
+			debugLog("Submission mode enum out of bounds, keeping the current submission mode", LOST_LOG_WARNING);
+			return;
+		}
+
+		// Draw anything queued with the old mode first
+		renderInstanceQueue();
+		m_SubmissionMode = submissionMode;
+	}
+
 	void Renderer::generateBufferObjects()
 	{
 		glGenVertexArrays(1, &m_EmptyVAO);
-		glBindVertexArray(m_EmptyVAO);
+		_glState->bindVertexArray(m_EmptyVAO);
 
 		glGenBuffers(1, &VBO);
-		glGenBuffers(1, &MBO);
 		glGenBuffers(1, &EBO);
 
+		// Every raw quad uses the same indicies, so they're generated once and kept at the start of the EBO
+		m_QuadPatternSize = s_MaxRawMeshQuads * 6;
+		m_StreamIndexData.reserve(m_QuadPatternSize * 2);
+		for (unsigned int i = 0; i < s_MaxRawMeshQuads; i++)
+		{
+			unsigned int vertex = i * 4;
+			m_StreamIndexData.insert(m_StreamIndexData.end(), { vertex + 2, vertex + 1, vertex, vertex, vertex + 3, vertex + 2 });
+		}
+
+		m_StreamIndexCapacity = m_StreamIndexData.capacity();
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+		glBufferData(GL_COPY_WRITE_BUFFER, m_StreamIndexCapacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, m_QuadPatternSize * sizeof(unsigned int), m_StreamIndexData.data());
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		// Enough space for 16384 raw quads each queue before the vertex arena has to grow
+		m_StreamVertexData.reserve(s_MaxRawMeshQuads * 4 * sizeof(Vertex2D));
+
+		// Triple buffered, 32768 instances per section to start with, grows if a frame needs more
+		m_InstanceRing.init(32768 * sizeof(glm::mat4x4) * 2, 3, sizeof(glm::mat4x4) * 2);
+		// Command buffer for LOST_SUBMIT_INDIRECT, works the same as the instance buffer
+		m_IndirectRing.init(8192 * sizeof(DrawElementsIndirectCommand), 3, sizeof(unsigned int));
+		// Material buffer for shaders using material batching, each queue's materials are bound as a storage buffer so need to be aligned for it
+		int storageAlignment = 16;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+		m_MaterialRing.init(1024 * sizeof(BatchedMaterialData), 3, (size_t)storageAlignment);
+
+		// Enough space for a few medium sized meshes, the arena grows if it needs more
+		m_MeshArena.init(65536 * 16 * sizeof(float), 65536 * 3);
+
 		bindBufferDescriptions();
 	}
 
@@ -128,73 +196,321 @@ namespace lost
 
 	void Renderer::addRawToQueue(CompiledMeshData& meshData, std::vector<Material>& materials, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode)
 	{
-		// Compare this raw mesh to the last one to see if it can be instanced
-		if (m_RawMeshInstance != nullptr && meshData.materialSlotIndicies.size() == 1) // Check if there was a last mesh, only batch if there is one material
+		// Only batch if there is one material, materials are ignored otherwise
+		// [?] Maybe do this?
+		bool batchable = meshData.materialSlotIndicies.size() == 1;
+
+		// A render mode of -1 never matches the last raw mesh, so a new one is always made
+		CompiledMeshData* rawMesh = getRawMesh(batchable ? meshData.meshRenderMode : -1, LOST_VERTEX_LAYOUT_FULL, false, 0, materials.data(), materials.size(), mvpTransform, modelTransform, depthTestFuncOverride, depthWrite, shaderOverride, invertCullMode);
+		if (!batchable)
 		{
-			if (m_RawMeshInstance->meshRenderMode == meshData.meshRenderMode && ( // Make sure render modes are the same
-				meshData.meshRenderMode == LOST_MESH_LINES       // <-
-			 || meshData.meshRenderMode == LOST_MESH_POINTS      //  |- Instancing raw meshes only works with these render types 
-			 || meshData.meshRenderMode == LOST_MESH_TRIANGLES)) // <-
-			{
-				// Nested to save on operating time as this comparator does quite a bit
-				if (m_RawMeshBuffer.compare(materials, mvpTransform, modelTransform, depthTestFuncOverride, depthWrite, shaderOverride, invertCullMode))
-				{
-					// Mesh can be instanced
-					
-					// Append the instanced mesh data to the first one
-					m_RawMeshInstance->vertexData.insert(m_RawMeshInstance->vertexData.end(), meshData.vertexData.begin(), meshData.vertexData.end());
+			rawMesh->meshRenderMode = meshData.meshRenderMode;
+			rawMesh->materialSlotIndicies = meshData.materialSlotIndicies;
+		}
+
+		// We need to offset the index data to fit after the verticies already in the raw mesh
+		unsigned int offset = m_StreamVertexData.size() / (16 * sizeof(float)) - rawMesh->baseVertex;
 
+		const char* vertexData = (const char*)meshData.vertexData.data();
+		m_StreamVertexData.insert(m_StreamVertexData.end(), vertexData, vertexData + meshData.vertexData.size() * sizeof(float));
+		for (unsigned int index : meshData.indexData)
+			m_StreamIndexData.push_back(index + offset);
 
-					// We need to offset the index data and material index data to fit 
-					int offset = m_RawMeshInstance->indexData.size();
+		rawMesh->streamIndexCount += meshData.indexData.size();
+	}
 
-					// Index data
-					m_RawMeshInstance->indexData.reserve(offset + meshData.indexData.size()); // Save memory reallocations
-					for (int index : meshData.indexData)
-						m_RawMeshInstance->indexData.push_back(index + offset); // Account for offset
+	void Renderer::submitCommandList(CommandList commandList)
+	{
+		m_SubmittedCommandLists.push_back(commandList);
+	}
 
-					// Materials are ignored, this only works if there is one material.
-					// [?] Maybe do this?
+	void Renderer::mergeCommandList(CommandList commandList)
+	{
+		for (const _CommandList::Packet& packet : commandList->getPackets())
+		{
+			const Material* materials = commandList->getMaterials(packet);
+			m_MergeMaterials.assign(materials, materials + packet.materialCount);
 
-					return; // Escape, there's no point going further
-				}
+			addMeshToQueue(packet.mesh, m_MergeMaterials, packet.mvpTransform, packet.modelTransform, packet.depthTestFuncOverride, packet.depthWrite, packet.shaderOverride, packet.invertCullMode);
+		}
+	}
+
+	Vertex2D* Renderer::addRawQuads(unsigned int quadCount, Material material, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode)
+	{
+		debugLogIf(quadCount > s_MaxRawMeshQuads, "Tried to add more quads to a raw mesh than the quad index pattern covers, some will not be rendered", LOST_LOG_WARNING);
+
+		CompiledMeshData* rawMesh = getRawMesh(LOST_MESH_TRIANGLES, LOST_VERTEX_LAYOUT_2D, true, quadCount, &material, 1, mvpTransform, modelTransform, depthTestFuncOverride, depthWrite, shaderOverride, invertCullMode);
+		rawMesh->streamIndexCount += std::min(quadCount, s_MaxRawMeshQuads) * 6;
+
+		size_t vertexStart = m_StreamVertexData.size();
+		m_StreamVertexData.resize(vertexStart + quadCount * 4 * sizeof(Vertex2D));
+
+		return (Vertex2D*)(m_StreamVertexData.data() + vertexStart);
+	}
+
+	Vertex2D* Renderer::addRawGeometry(unsigned int renderMode, unsigned int vertexCount, unsigned int indexCount, unsigned int*& indexData, unsigned int& indexBase, Material material, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode)
+	{
+		CompiledMeshData* rawMesh = getRawMesh(renderMode, LOST_VERTEX_LAYOUT_2D, false, 0, &material, 1, mvpTransform, modelTransform, depthTestFuncOverride, depthWrite, shaderOverride, invertCullMode);
+		rawMesh->streamIndexCount += indexCount;
+
+		size_t vertexStart = m_StreamVertexData.size();
+		size_t indexStart = m_StreamIndexData.size();
+		m_StreamVertexData.resize(vertexStart + vertexCount * sizeof(Vertex2D));
+		m_StreamIndexData.resize(indexStart + indexCount);
+
+		indexBase = vertexStart / sizeof(Vertex2D) - rawMesh->baseVertex;
+		indexData = m_StreamIndexData.data() + indexStart;
+
+		return (Vertex2D*)(m_StreamVertexData.data() + vertexStart);
+	}
+
+	CompiledMeshData* Renderer::getRawMesh(unsigned int renderMode, unsigned int vertexLayout, bool quads, unsigned int quadCount, const Material* materials, unsigned int materialCount, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode)
+	{
+		// Compare this raw mesh to the last one to see if it can be instanced
+		if (m_RawMeshInstance != nullptr) // Check if there was a last mesh
+		{
+			if (m_RawMeshInstance->meshRenderMode == renderMode && m_RawMeshInstance->vertexLayout == vertexLayout && m_RawMeshBuffer.quads == quads && ( // Make sure render modes are the same
+				renderMode == LOST_MESH_LINES       // <-
+			 || renderMode == LOST_MESH_POINTS      //  |- Instancing raw meshes only works with these render types 
+			 || renderMode == LOST_MESH_TRIANGLES)) // <-
+			{
+				// Quads can only be appended while the quad index pattern still covers them
+				bool fits = !quads || m_RawMeshInstance->streamIndexCount / 6 + quadCount <= s_MaxRawMeshQuads;
+
+				// Nested to save on operating time as this comparator does quite a bit
+				if (fits && m_RawMeshBuffer.compare(materials, materialCount, mvpTransform, modelTransform, depthTestFuncOverride, depthWrite, shaderOverride, invertCullMode))
+					return m_RawMeshInstance; // Mesh can be instanced, the data gets appended to the last one
 			}
 
 			// Add raw queue to render queue
 			// We only do this if this wasn't a match to the last raw mesh rendered
-
 			addMeshToQueue(m_RawMeshInstance, m_RawMeshBuffer.materials, m_RawMeshBuffer.mvpTransform, m_RawMeshBuffer.modelTransform, m_RawMeshBuffer.depthTestFuncOverride, m_RawMeshBuffer.depthWrite, m_RawMeshBuffer.shaderOverride, m_RawMeshBuffer.invertCullMode);
 		}
 
-		// This code is only ran when a new mesh needs to be created.
-		// The test for instancing and the add for it breaks out of this function once it's finished
+		// This code is only ran when a new mesh needs to be created
+		// Raw meshes are reused between queues, so this only allocates when more raw meshes are used than ever before
+		if (m_RawMeshCount == m_RawMeshes.size())
+		{
+			CompiledMeshData* newMesh = new CompiledMeshData();
+			newMesh->streamed = true;
+			m_RawMeshes.push_back(newMesh);
+		}
+
+		// Pad the stream so the raw mesh starts on a whole vertex of it's layout
+		unsigned int stride = _getVertexStride(vertexLayout);
+		m_StreamVertexData.resize((m_StreamVertexData.size() + stride - 1) / stride * stride);
 
-		// Create raw mesh on the heap to store it for later, creates a lot of memory allocations
-		CompiledMeshData* newMesh = new CompiledMeshData{
-			meshData.vertexData,
-			meshData.materialSlotIndicies,
-			meshData.indexData,
-			meshData.meshRenderMode,
-		};
+		CompiledMeshData* rawMesh = m_RawMeshes[m_RawMeshCount++];
+		rawMesh->meshRenderMode = renderMode;
+		rawMesh->vertexLayout = vertexLayout;
+		rawMesh->materialSlotIndicies.assign(1, 0);
+		rawMesh->baseVertex = m_StreamVertexData.size() / stride;
+		rawMesh->firstIndex = quads ? 0 : m_StreamIndexData.size(); // Quads index into the pattern at the start of the EBO
+		rawMesh->streamIndexCount = 0;
+
+		m_RawMeshInstance = rawMesh;
 
-		m_RawMeshes.push_back(newMesh);
+		// Assigned member by member so the material vector keeps it's memory
+		m_RawMeshBuffer.materials.assign(materials, materials + materialCount);
+		m_RawMeshBuffer.mvpTransform = mvpTransform;
+		m_RawMeshBuffer.modelTransform = modelTransform;
+		m_RawMeshBuffer.depthTestFuncOverride = depthTestFuncOverride;
+		m_RawMeshBuffer.depthWrite = depthWrite;
+		m_RawMeshBuffer.shaderOverride = shaderOverride;
+		m_RawMeshBuffer.invertCullMode = invertCullMode;
+		m_RawMeshBuffer.quads = quads;
 
-		m_RawMeshInstance = newMesh;
-		m_RawMeshBuffer = RawMeshBuffer{ materials, mvpTransform, modelTransform, depthTestFuncOverride, depthWrite, shaderOverride, invertCullMode };
+		return rawMesh;
 	}
 
 	void Renderer::initRenderInstanceQueue()
 	{
 		if (m_RawMeshInstance) // Add the last rendered raw mesh
 			addMeshToQueue(m_RawMeshInstance, m_RawMeshBuffer.materials, m_RawMeshBuffer.mvpTransform, m_RawMeshBuffer.modelTransform, m_RawMeshBuffer.depthTestFuncOverride, m_RawMeshBuffer.depthWrite, m_RawMeshBuffer.shaderOverride, m_RawMeshBuffer.invertCullMode);
+
+		// Add everything recorded on other threads, it gets sorted along with the rest of the queue
+		for (CommandList commandList : m_SubmittedCommandLists)
+			mergeCommandList(commandList);
+		m_SubmittedCommandLists.clear();
+	}
+
+	void Renderer::streamRawMeshes()
+	{
+		if (m_RawMeshCount == 0)
+			return;
+
+		// Vertex Buffer Data
+		_glState->bindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, m_StreamVertexData.size(), m_StreamVertexData.data(), GL_STREAM_DRAW);
+
+		// Element Buffer Data, GL_COPY_WRITE_BUFFER is used so the bound VAO's element buffer is left alone
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+		if (m_StreamIndexData.size() > m_StreamIndexCapacity)
+		{
+			// Out of space, reallocate and send the quad pattern again with everything else
+			m_StreamIndexCapacity = m_StreamIndexData.capacity();
+			glBufferData(GL_COPY_WRITE_BUFFER, m_StreamIndexCapacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, 0, m_StreamIndexData.size() * sizeof(unsigned int), m_StreamIndexData.data());
+		}
+		else if (m_StreamIndexData.size() > m_QuadPatternSize)
+		{
+			// Only the indicies after the quad pattern change
+			glBufferSubData(GL_COPY_WRITE_BUFFER, m_QuadPatternSize * sizeof(unsigned int), (m_StreamIndexData.size() - m_QuadPatternSize) * sizeof(unsigned int), m_StreamIndexData.data() + m_QuadPatternSize);
+		}
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	void Renderer::bindMeshBuffers(const CompiledMeshData* mesh, bool force)
+	{
+		int meshBuffer = mesh->resident ? 1 : 0;
+		if (meshBuffer == m_BoundMeshBuffer && mesh->vertexLayout == m_BoundVertexLayout && !force)
+			return;
+
+		if (mesh->vertexLayout != m_BoundVertexLayout || force)
+			bindVertexLayout(mesh->vertexLayout);
+
+		// The stride is part of the binding, so it's set again even if only the layout changed
+		unsigned int stride = _getVertexStride(mesh->vertexLayout);
+		if (mesh->resident)
+		{
+			glBindVertexBuffer(0, m_MeshArena.getVertexBuffer(), 0, stride);
+			_glState->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_MeshArena.getIndexBuffer());
+		}
+		else
+		{
+			glBindVertexBuffer(0, VBO, 0, stride);
+			_glState->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		}
+
+		m_BoundMeshBuffer = meshBuffer;
+	}
+
+	void Renderer::bindVertexLayout(unsigned int vertexLayout)
+	{
+		switch (vertexLayout)
+		{
+		case LOST_VERTEX_LAYOUT_COMPACT:
+			glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(CompactVertex, position));
+			glVertexAttribFormat(1, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(CompactVertex, textureCoord));
+			glVertexAttribFormat(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(CompactVertex, color));
+			glVertexAttribFormat(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(CompactVertex, normal));
+			glVertexAttribFormat(4, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(CompactVertex, tangent));
+			glEnableVertexAttribArray(3);
+			glEnableVertexAttribArray(4);
+			break;
+		case LOST_VERTEX_LAYOUT_2D:
+			glVertexAttribFormat(0, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex2D, position));
+			glVertexAttribFormat(1, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex2D, textureCoord));
+			glVertexAttribFormat(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Vertex2D, color));
+
+			// The normal and tangent aren't stored, they're read from the constant values instead
+			glDisableVertexAttribArray(3);
+			glDisableVertexAttribArray(4);
+			glVertexAttrib3f(3, 0.0f, 0.0f, -1.0f);
+			glVertexAttrib4f(4, 0.0f, 1.0f, 0.0f, 1.0f);
+			break;
+		default:
+			glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);                 // Position
+			glVertexAttribFormat(1, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float));  // TexCoord
+			glVertexAttribFormat(2, 4, GL_FLOAT, GL_FALSE, 5 * sizeof(float));  // Color
+			glVertexAttribFormat(3, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float));  // Normal
+			glVertexAttribFormat(4, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float)); // Tangent
+			glEnableVertexAttribArray(3);
+			glEnableVertexAttribArray(4);
+			break;
+		}
+
+		m_BoundVertexLayout = vertexLayout;
+	}
+
+	void Renderer::drawMeshInstanced(const CompiledMeshData* mesh, unsigned int startIndex, unsigned int indexCount, unsigned int instanceCount, unsigned int baseInstance)
+	{
+		glDrawElementsInstancedBaseVertexBaseInstance(mesh->meshRenderMode, indexCount, GL_UNSIGNED_INT, (void*)((size_t)(mesh->firstIndex + startIndex) * sizeof(unsigned int)), instanceCount, mesh->baseVertex, baseInstance);
+	}
+
+	void Renderer::submitDraw(const CompiledMeshData* mesh, unsigned int startIndex, unsigned int indexCount, unsigned int instanceCount, unsigned int baseInstance)
+	{
+		if (m_SubmissionMode == LOST_SUBMIT_DIRECT)
+		{
+			drawMeshInstanced(mesh, startIndex, indexCount, instanceCount, baseInstance);
+			return;
+		}
+
+		DrawElementsIndirectCommand command = {};
+		command.count = indexCount;
+		command.instanceCount = instanceCount;
+		command.firstIndex = mesh->firstIndex + startIndex;
+		command.baseVertex = mesh->baseVertex;
+		command.baseInstance = baseInstance;
+
+		m_IndirectCommands.push_back(command);
+		m_IndirectRenderMode = mesh->meshRenderMode;
+	}
+
+	void Renderer::flushDraws()
+	{
+		if (m_IndirectCommands.empty())
+			return;
+
+		if (m_IndirectCommands.size() == 1)
+		{
+			// Not worth going through the indirect buffer for a single draw
+			const DrawElementsIndirectCommand& command = m_IndirectCommands[0];
+			glDrawElementsInstancedBaseVertexBaseInstance(m_IndirectRenderMode, command.count, GL_UNSIGNED_INT, (void*)((size_t)command.firstIndex * sizeof(unsigned int)), command.instanceCount, command.baseVertex, command.baseInstance);
+		}
+		else
+		{
+			// Write the commands straight into the GPU side command buffer and draw them all in one call
+			size_t offset;
+			void* commandData = m_IndirectRing.allocate(m_IndirectCommands.size() * sizeof(DrawElementsIndirectCommand), offset);
+			memcpy(commandData, m_IndirectCommands.data(), m_IndirectCommands.size() * sizeof(DrawElementsIndirectCommand));
+
+			_glState->bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectRing.getBuffer());
+			glMultiDrawElementsIndirect(m_IndirectRenderMode, GL_UNSIGNED_INT, (void*)offset, m_IndirectCommands.size(), 0);
+		}
+
+		m_IndirectCommands.clear();
+	}
+
+	glm::mat4x4* Renderer::allocateInstances(unsigned int instanceCount, unsigned int& baseInstance, unsigned int** materialIndices)
+	{
+		// The material indices are stored straight after the matrices, in the same allocation
+		size_t offset;
+		glm::mat4x4* instanceData = (glm::mat4x4*)m_InstanceRing.allocate(instanceCount * (sizeof(glm::mat4x4) * 2 + sizeof(unsigned int)), offset);
+		baseInstance = offset / (sizeof(glm::mat4x4) * 2);
+
+		unsigned int* indexData = (unsigned int*)(instanceData + instanceCount * 2);
+		if (materialIndices)
+			*materialIndices = indexData;
+		else
+			memset(indexData, 0, instanceCount * sizeof(unsigned int));
+
+		// The ring buffer is recreated when it grows and each window has it's own VAO, so make sure the bound VAO reads from the right one
+		glBindVertexBuffer(1, m_InstanceRing.getBuffer(), 0, sizeof(glm::mat4x4) * 2);
+		// Instance "baseInstance" has to read the first index, so binding 2 starts baseInstance indices before them
+		size_t indexOffset = offset + instanceCount * sizeof(glm::mat4x4) * 2;
+		glBindVertexBuffer(2, m_InstanceRing.getBuffer(), indexOffset - baseInstance * sizeof(unsigned int), sizeof(unsigned int));
+
+		return instanceData;
+	}
+
+	void Renderer::uploadMesh(Mesh mesh)
+	{
+		m_MeshArena.upload((CompiledMeshData*)mesh);
+	}
+
+	void Renderer::releaseMesh(Mesh mesh)
+	{
+		m_MeshArena.release((CompiledMeshData*)mesh);
 	}
 
 	// Ran at the end of every renderer's renderInstanceQueue function
 	void Renderer::renderInstanceQueue()
 	{
-		for (CompiledMeshData* mesh : m_RawMeshes)
-			delete mesh;
-		m_RawMeshes.clear();
+		// The raw meshes and stream buffers are kept for the next queue, only the quad pattern stays in the index data
+		m_RawMeshCount = 0;
+		m_StreamVertexData.clear();
+		m_StreamIndexData.resize(m_QuadPatternSize);
 
 		// Reset the raw mesh instance
 		m_RawMeshInstance = nullptr;
@@ -237,6 +553,8 @@ namespace lost
 			//ImGui::EndFrame();
 			ImGui::Render();
 			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+			// ImGui sets OpenGL's state itself, so the cached state can't be trusted
+			_glState->invalidate();
 
 			//lost::pushWindow();
 			//ImGui::UpdatePlatformWindows();
@@ -244,6 +562,11 @@ namespace lost
 			//lost::popWindow();
 		}
 #endif
+
+		// Everything this frame has been given to OpenGL, fence the sections of the ring buffers that were used
+		m_InstanceRing.advance();
+		m_IndirectRing.advance();
+		m_MaterialRing.advance();
 	}
 
 	unsigned int Renderer::getRenderTexture(unsigned int windowID, unsigned int pass)
@@ -273,13 +596,13 @@ namespace lost
 		VAOs.push_back(0);
 
 		// Generate VAO inside of this context
-		glDeleteVertexArrays(VAOs.size(),VAOs.data());
+		_deleteGLVertexArrays(VAOs.size(),VAOs.data());
 		glGenVertexArrays(VAOs.size(), VAOs.data());
 		for (int i = 0; i < VAOs.size(); i++)
 		{
-			glBindVertexArray(VAOs[i]);
+			_glState->bindVertexArray(VAOs[i]);
 			bindBufferDescriptions();
-			glBindVertexArray(0);
+			_glState->bindVertexArray(0);
 		}
 
 		debugLog("Generated new VAO for new context", LOST_LOG_INFO);
@@ -299,9 +622,9 @@ namespace lost
 		VAOs[id] = 0;
 
 		// Generate VAO inside of this context
-		glDeleteVertexArrays(1, &VAOs[id]);
+		_deleteGLVertexArrays(1, &VAOs[id]);
 		glGenVertexArrays(1, &VAOs[id]);
-		glBindVertexArray(VAOs[id]);
+		_glState->bindVertexArray(VAOs[id]);
 
 		bindBufferDescriptions();
 
@@ -315,68 +638,46 @@ namespace lost
 		delete m_MainRenderPasses[contextIndex];
 		m_MainRenderPasses.erase(m_MainRenderPasses.begin() + contextIndex);
 
-		glDeleteVertexArrays(1, &VAOs[contextIndex]);
+		_deleteGLVertexArrays(1, &VAOs[contextIndex]);
 		VAOs.erase(VAOs.begin() + contextIndex);
 	}
 
 	void Renderer::bindBufferDescriptions()
 	{
-		// Bind vertex buffer
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		// Vertex data is read from binding 0, which is pointed at either the mesh arena or the stream buffer
+		// Using separate formats and bindings means switching between them is a single call
+		glBindVertexBuffer(0, m_MeshArena.getVertexBuffer(), 0, 16 * sizeof(float));
 		// [ VERTEX BUFFER BOUND ]
 
-		// Position
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-
-		// TexCoord
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1); 
-
-		// Color
-		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(5 * sizeof(float)));
-		glEnableVertexAttribArray(2);
-
-		// Normal
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(9 * sizeof(float)));
-		glEnableVertexAttribArray(3);
-
-		// Tangent
-		glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(12 * sizeof(float)));
-		glEnableVertexAttribArray(4);
-
-		// Bind matrix buffer mat4x4's are stored as 4 * vec4's
-		glBindBuffer(GL_ARRAY_BUFFER, MBO);
-		glVertexAttribPointer(5,  4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, 0);
-		glEnableVertexAttribArray(5);
-		glVertexAttribPointer(6,  4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, (void*)(4  * sizeof(float)));
-		glEnableVertexAttribArray(6);
-		glVertexAttribPointer(7,  4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, (void*)(8  * sizeof(float)));
-		glEnableVertexAttribArray(7);
-		glVertexAttribPointer(8,  4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, (void*)(12 * sizeof(float)));
-		glEnableVertexAttribArray(8);
-
-		glVertexAttribPointer(9,  4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, (void*)(16 * sizeof(float)));
-		glEnableVertexAttribArray(9);
-		glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, (void*)(20 * sizeof(float)));
-		glEnableVertexAttribArray(10);
-		glVertexAttribPointer(11, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, (void*)(24 * sizeof(float)));
-		glEnableVertexAttribArray(11);
-		glVertexAttribPointer(12, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4x4) * 2, (void*)(28 * sizeof(float)));
-		glEnableVertexAttribArray(12);
-
-		glVertexAttribDivisor(5, 1); // Make it so this input only updates once per INSTANCE rather than per vertex
-		glVertexAttribDivisor(6, 1);
-		glVertexAttribDivisor(7, 1);
-		glVertexAttribDivisor(8, 1);
-
-		glVertexAttribDivisor(9,  1);
-		glVertexAttribDivisor(10, 1);
-		glVertexAttribDivisor(11, 1);
-		glVertexAttribDivisor(12, 1);
+		// Position, TexCoord, Color, Normal and Tangent, the formats depend on the mesh's vertex layout
+		for (int i = 0; i < 5; i++)
+		{
+			glVertexAttribBinding(i, 0);
+			glEnableVertexAttribArray(i);
+		}
+		bindVertexLayout(LOST_VERTEX_LAYOUT_FULL);
+
+		// Bind matrix buffer to binding 1, mat4x4's are stored as 4 * vec4's
+		glBindVertexBuffer(1, m_InstanceRing.getBuffer(), 0, sizeof(glm::mat4x4) * 2);
+		for (int i = 0; i < 8; i++)
+		{
+			glVertexAttribFormat(5 + i, 4, GL_FLOAT, GL_FALSE, i * 4 * sizeof(float));
+			glVertexAttribBinding(5 + i, 1);
+			glEnableVertexAttribArray(5 + i);
+		}
+
+		glVertexBindingDivisor(1, 1); // Make it so this input only updates once per INSTANCE rather than per vertex
+
+		// Each instance's material index, only read by shaders using material batching, allocateInstances() points it at the right place
+		glBindVertexBuffer(2, m_InstanceRing.getBuffer(), 0, sizeof(unsigned int));
+		glVertexAttribIFormat(13, 1, GL_UNSIGNED_INT, 0);
+		glVertexAttribBinding(13, 2);
+		glEnableVertexAttribArray(13);
+		glVertexBindingDivisor(2, 1);
 
 		// Bind index buffer
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		_glState->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_MeshArena.getIndexBuffer());
+		m_BoundMeshBuffer = 1;
 	}
 
 	void Renderer::fillWindow(Color color)
@@ -405,22 +706,20 @@ namespace lost
 			0.0f, 0.0f, 1.0f, 0.0f,
 			-1.0f, -1.0f, 0.0f, 1.0f
 		);
-		glBindVertexArray(VAOs[getCurrentWindowID()]);
-		// Vertex Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, ((CompiledMeshData*)standardQuad)->vertexData.size() * sizeof(float), ((CompiledMeshData*)standardQuad)->vertexData.data(), GL_STATIC_DRAW);
+		_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
+		// The quad is already inside of the mesh arena, only bind it
+		bindMeshBuffers((CompiledMeshData*)standardQuad, true);
 		// Matrix Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, MBO);
-		glBufferData(GL_ARRAY_BUFFER, 1 * sizeof(glm::mat4x4), &transform, GL_STATIC_DRAW);
-		// Element Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, ((CompiledMeshData*)standardQuad)->indexData.size() * sizeof(int), ((CompiledMeshData*)standardQuad)->indexData.data(), GL_STATIC_DRAW);
+		unsigned int baseInstance;
+		glm::mat4x4* instanceData = allocateInstances(1, baseInstance);
+		instanceData[0] = transform;
+		instanceData[1] = transform;
 
 		// Render the quad with the texture
-		glDisable(GL_DEPTH_TEST);
-		glEnable(GL_CULL_FACE);
-		glDrawElements(GL_TRIANGLES, ((CompiledMeshData*)standardQuad)->indexData.size(), GL_UNSIGNED_INT, 0);
-		glEnable(GL_DEPTH_TEST);
+		_glState->setCapability(GL_DEPTH_TEST, false);
+		_glState->setCapability(GL_CULL_FACE, true);
+		drawMeshInstanced((CompiledMeshData*)standardQuad, 0, ((CompiledMeshData*)standardQuad)->indexData.size(), 1, baseInstance);
+		_glState->setCapability(GL_DEPTH_TEST, true);
 	}
 
 #pragma endregion
@@ -444,6 +743,10 @@ namespace lost
 			return;
 		}
 
+		// Raw meshes are only drawn by the 3D renderer, and meshes still loading have nothing to draw
+		if (((CompiledMeshData*)mesh)->streamed || ((CompiledMeshData*)mesh)->loading)
+			return;
+
 		// Active during LOST_RENDER_MODE_QUEUE and LOST_RENDER_MODE_AUTO_QUEUE
 		// Fulfils the rule of "A non identical mesh is rendered
 
@@ -451,6 +754,7 @@ namespace lost
 			m_CurrentMeshID = mesh;
 
 		m_TransformArray.push_back(mvpTransform);
+		m_TransformArray.push_back(modelTransform);
 		if (m_CurrentMeshID != mesh)
 		{
 			renderInstanceQueue();
@@ -458,6 +762,11 @@ namespace lost
 		}
 	}
 
+	void Renderer2D::submitCommandList(CommandList commandList)
+	{
+		mergeCommandList(commandList);
+	}
+
 	void Renderer2D::addRawToQueue(CompiledMeshData& meshData, std::vector<Material>& materials, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode)
 	{
 	}
@@ -467,19 +776,16 @@ namespace lost
 		if (!m_TransformArray.empty())
 		{
 			// Vertex Array Object
-			glBindVertexArray(VAOs[getCurrentWindowID()]);
+			_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
 
-			// Vertex Buffer Data
-			glBindBuffer(GL_ARRAY_BUFFER, VBO);
-			glBufferData(GL_ARRAY_BUFFER, ((CompiledMeshData*)m_CurrentMeshID)->vertexData.size() * sizeof(float), ((CompiledMeshData*)m_CurrentMeshID)->vertexData.data(), GL_STATIC_DRAW);
+			// Mesh data is already on the GPU, only bind where it is
+			bindMeshBuffers((CompiledMeshData*)m_CurrentMeshID, true);
 			// Matrix Buffer Data
-			glBindBuffer(GL_ARRAY_BUFFER, MBO);
-			glBufferData(GL_ARRAY_BUFFER, m_TransformArray.size() * sizeof(glm::mat4x4), m_TransformArray.data(), GL_STATIC_DRAW);
-			// Element Buffer Data
-			glBindBuffer(GL_ARRAY_BUFFER, EBO);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, ((CompiledMeshData*)m_CurrentMeshID)->indexData.size() * sizeof(int), ((CompiledMeshData*)m_CurrentMeshID)->indexData.data(), GL_STATIC_DRAW);
+			unsigned int baseInstance;
+			glm::mat4x4* instanceData = allocateInstances(m_TransformArray.size() / 2, baseInstance);
+			memcpy(instanceData, m_TransformArray.data(), m_TransformArray.size() * sizeof(glm::mat4x4));
 
-			glDrawElementsInstanced(GL_TRIANGLES, ((CompiledMeshData*)m_CurrentMeshID)->indexData.size(), GL_UNSIGNED_INT, 0, m_TransformArray.size());
+			drawMeshInstanced((CompiledMeshData*)m_CurrentMeshID, 0, ((CompiledMeshData*)m_CurrentMeshID)->indexData.size(), m_TransformArray.size() / 2, baseInstance);
 
 			m_TransformArray.clear();
 			m_CurrentMeshID = nullptr;
@@ -497,26 +803,24 @@ namespace lost
 			0.0f, 0.0f, 0.0f, 1.0f
 		);
 
-		glBindVertexArray(VAOs[getCurrentWindowID()]);
+		_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
 
-		// Vertex Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, ((CompiledMeshData*)standardQuad)->vertexData.size() * sizeof(float), ((CompiledMeshData*)standardQuad)->vertexData.data(), GL_STATIC_DRAW);
+		// The quad is already inside of the mesh arena, only bind it
+		bindMeshBuffers((CompiledMeshData*)standardQuad, true);
 		// Matrix Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, MBO);
-		glBufferData(GL_ARRAY_BUFFER, 1 * sizeof(glm::mat4x4), &transform, GL_STATIC_DRAW);
-		// Element Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, ((CompiledMeshData*)standardQuad)->indexData.size() * sizeof(int), ((CompiledMeshData*)standardQuad)->indexData.data(), GL_STATIC_DRAW);
+		unsigned int baseInstance;
+		glm::mat4x4* instanceData = allocateInstances(1, baseInstance);
+		instanceData[0] = transform;
+		instanceData[1] = transform;
 
-		glBindTexture(GL_TEXTURE_2D, m_MainRenderPasses[getCurrentWindowID()]->textures[0]);
+		_glState->bindTexture(0, GL_TEXTURE_2D, m_MainRenderPasses[getCurrentWindowID()]->textures[0]);
 		//getDefaultWhiteTexture()->bind(0);
 
-		glDisable(GL_CULL_FACE);
-		glDisable(GL_DEPTH_TEST);
-		glDrawElementsInstanced(GL_TRIANGLES, ((CompiledMeshData*)standardQuad)->indexData.size(), GL_UNSIGNED_INT, 0, 1);
-		glEnable(GL_CULL_FACE);
-		glEnable(GL_DEPTH_TEST);
+		_glState->setCapability(GL_CULL_FACE, false);
+		_glState->setCapability(GL_DEPTH_TEST, false);
+		drawMeshInstanced((CompiledMeshData*)standardQuad, 0, ((CompiledMeshData*)standardQuad)->indexData.size(), 1, baseInstance);
+		_glState->setCapability(GL_CULL_FACE, true);
+		_glState->setCapability(GL_DEPTH_TEST, true);
 
 		Renderer::finalize();
 	}
@@ -528,12 +832,14 @@ namespace lost
 
 		if (mesh != nullptr)
 		{
-			glBindVertexArray(VAOs[getCurrentWindowID()]);
-			glDrawElements(GL_TRIANGLES, ((CompiledMeshData*)mesh)->indexData.size(), GL_UNSIGNED_INT, 0);
+			_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
+			bindMeshBuffers((CompiledMeshData*)mesh, true);
+			drawMeshInstanced((CompiledMeshData*)mesh, 0, ((CompiledMeshData*)mesh)->indexData.size(), 1, 0);
 		}
 #else
-		glBindVertexArray(VAOs[getCurrentWindowID()]);
-		glDrawElements(GL_TRIANGLES, ((CompiledMeshData*)mesh)->indexData.size(), GL_UNSIGNED_INT, 0);
+		_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
+		bindMeshBuffers((CompiledMeshData*)mesh, true);
+		drawMeshInstanced((CompiledMeshData*)mesh, 0, ((CompiledMeshData*)mesh)->indexData.size(), 1, 0);
 #endif
 	}
 #pragma endregion
@@ -542,6 +848,7 @@ namespace lost
 	Renderer3D::Renderer3D()
 		: Renderer()
 	{
+		m_BatchStamp = s_NextBatchStamp++;
 		debugLog("Renderer set to 3D Mode, to use 2D put LOST_RENDER_2D in lost::init() or leave it empty", LOST_LOG_INFO);
 	}
 
@@ -558,23 +865,65 @@ namespace lost
 			return;
 		}
 
-		for (int i = 0; i < materials.size(); i++)
+		// Meshes still loading have nothing to draw
+		if (((CompiledMeshData*)mesh)->loading)
+			return;
+
+		// Skip meshes which are off screen before any work is done on them, raw meshes have no bounds so are always queued
+		float depthVal = 0.0f;
+		const MeshBounds& bounds = ((CompiledMeshData*)mesh)->bounds;
+		if (bounds.valid && !_testMeshBounds(bounds, mvpTransform, m_CullDistance, depthVal) && m_FrustumCulling)
+			return;
+
+		queueMesh(mesh, materials.data(), materials.size(), depthVal, mvpTransform, modelTransform, depthTestFuncOverride, depthWrite, shaderOverride, invertCullMode);
+
+		// Active during LOST_RENDER_MODE_QUEUE and LOST_RENDER_MODE_AUTO_QUEUE
+		// Fulfils the rule of "A non identical mesh is rendered"
+	}
+
+	void Renderer3D::mergeCommandList(CommandList commandList)
+	{
+		if (m_RenderMode == LOST_RENDER_MODE_INSTANT)
+			return;
+
+		for (const _CommandList::Packet& packet : commandList->getPackets())
+			queueMesh(packet.mesh, commandList->getMaterials(packet), packet.materialCount, packet.depthVal, packet.mvpTransform, packet.modelTransform, packet.depthTestFuncOverride, packet.depthWrite, packet.shaderOverride, packet.invertCullMode);
+	}
+
+	void Renderer3D::queueMesh(Mesh mesh, const Material* materials, unsigned int materialCount, float depthVal, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode)
+	{
+		// Streamed textures are asked for enough levels to cover the mesh at the size it's drawn
+		const MeshBounds& bounds = ((CompiledMeshData*)mesh)->bounds;
+		if (isTextureStreaming() && bounds.valid)
+		{
+			float screenSize = _getMeshScreenSize(bounds, mvpTransform, (float)getHeight(getCurrentWindow()));
+			for (unsigned int i = 0; i < materialCount; i++)
+				for (Texture texture : materials[i]->getTextures())
+					_requestTextureLevel(texture, screenSize);
+		}
+
+		// Any handle released after this could belong to something in the queue, see dropStaleItems()
+		if (m_QueueItems.empty())
+			m_QueueReleaseCount = _getHandleReleaseCount();
+
+		for (unsigned int i = 0; i < materialCount; i++)
 		{
 			MeshRenderData renderData = {};
 
-			renderData.mesh = mesh;
-			renderData.material = materials[i];
+			Shader shader = shaderOverride ? shaderOverride : materials[i]->getShader();
+
+			renderData.mesh = getMeshHandle(mesh);
+			renderData.material = materials[i]->getHandle();
+			renderData.shader = shader->getHandle();
 			renderData.startIndex = ((CompiledMeshData*)mesh)->materialSlotIndicies[i];
 
 			// Gets the amount of indicies until the next material slot, going to the end of the index
 			// list if there are no more materials
 			renderData.indicies = (i + 1 < ((CompiledMeshData*)mesh)->materialSlotIndicies.size()) ?
 				((CompiledMeshData*)mesh)->materialSlotIndicies[i + 1] - renderData.startIndex :
-				((CompiledMeshData*)mesh)->indexData.size() - renderData.startIndex;
+				((CompiledMeshData*)mesh)->getIndexCount() - renderData.startIndex;
 
-			renderData.depthVal = 0; // [!] TODO
-			renderData.mvpTransform = mvpTransform;
-			renderData.modelTransform = modelTransform;
+			renderData.depthVal = depthVal;
 			renderData.depthMode = (depthTestFuncOverride == LOST_DEPTH_TEST_AUTO ? materials[i]->getDepthTestFunc() : depthTestFuncOverride);
 			renderData.depthWrite = depthWrite && materials[i]->getDepthWrite();
 
@@ -586,16 +935,177 @@ namespace lost
 
 			renderData.cullMode = (m_CullMode == LOST_CULL_AUTO ? materialCullMode : m_CullMode);
 			renderData.renderMode = ((CompiledMeshData*)mesh)->meshRenderMode;
-			renderData.shaderOverride = shaderOverride;
-			renderData.ZSortMode = LOST_ZSORT_NORMAL;
+			renderData.ZSortMode = materials[i]->getZSortMode();
 
 			debugLogIf(renderData.cullMode == LOST_CULL_AUTO, "Material had cull mode LOST_CULL_AUTO. Which shouldn't be used by materials, and only the renderer", LOST_LOG_WARNING);
 
+			// Materials drawn with material batching are written into the queue's material buffer the first time they're queued
+			renderData.batched = shader->usesMaterialBatching();
+			if (renderData.batched && materials[i]->getBatchStamp() != m_BatchStamp)
+			{
+				materials[i]->setBatchIndex(m_BatchStamp, (unsigned int)m_BatchMaterials.size());
+				m_BatchMaterials.emplace_back();
+				materials[i]->prepareBatch(m_BatchMaterials.back());
+			}
+			renderData.batchIndex = renderData.batched ? materials[i]->getBatchIndex() : 0;
+
+			// The key is built now so sorting never has to look at the render data
+			m_QueueItems.push_back({ makeSortKey(renderData, materials[i], i), (unsigned int)m_MainRenderData.size() });
 			m_MainRenderData.push_back(renderData);
+			m_MainTransforms.push_back(mvpTransform);
+			m_MainTransforms.push_back(modelTransform);
 		}
+	}
 
-		// Active during LOST_RENDER_MODE_QUEUE and LOST_RENDER_MODE_AUTO_QUEUE
-		// Fulfils the rule of "A non identical mesh is rendered"
+	// Maps a view depth to 10 bits, 64 steps for every doubling of distance between 1/16 and 4096
+	static uint64_t quantizeSortDepth(float depth)
+	{
+		if (!(depth > 0.0f))
+			return 0;
+
+		// The exponent and top 6 bits of the mantissa go up in even steps per doubling
+		uint32_t depthBits;
+		memcpy(&depthBits, &depth, sizeof(float));
+		int steps = (int)(depthBits >> 17) - ((127 - 4) << 6);
+		return steps < 0 ? 0 : (steps > 0x3FF ? 0x3FF : (uint64_t)steps);
+	}
+
+	uint64_t Renderer3D::makeSortKey(const MeshRenderData& renderData, Material material, unsigned int materialSlot)
+	{
+		// Items which have to be rendered in the order they were queued
+		// [!] TODO: Remove the LOST_DEPTH_TEST_ALWAYS check and replace with LOST_ZSORT_NONE
+		bool ordered = renderData.ZSortMode == LOST_ZSORT_NONE || renderData.depthMode == LOST_DEPTH_TEST_ALWAYS;
+
+		// Start a new segment whenever we switch between ordered and batched items
+		// Segments are sorted separately, which stops batched items from being sorted to either side of the ordered ones
+		if (ordered != m_LastItemOrdered && m_SortSequence > 0)
+			m_SegmentStarts.push_back((unsigned int)m_QueueItems.size());
+		m_LastItemOrdered = ordered;
+
+		uint64_t sequence = m_SortSequence++;
+
+		// Every item in an ordered segment is ordered, so the sequence number can use the whole key
+		if (ordered)
+			return sequence;
+
+		unsigned int queueLevel = material->getQueueLevel();
+		uint64_t key = (uint64_t)(queueLevel < 0xFFF ? queueLevel : 0xFFF) << 52;
+
+		// Render state, ordered from most commonly to least commonly used
+		unsigned int cullBits =
+			renderData.cullMode == LOST_CULL_NONE  ? 0 :
+			renderData.cullMode == LOST_CULL_FRONT ? 1 :
+			renderData.cullMode == LOST_CULL_BACK  ? 2 : 3;
+		key |= (uint64_t)cullBits << 14;
+		key |= (uint64_t)((renderData.depthMode - LOST_DEPTH_TEST_NEVER) & 0x7) << 11;
+		key |= (uint64_t)(renderData.depthWrite ? 1 : 0) << 10;
+
+		if (renderData.ZSortMode == LOST_ZSORT_DEPTH)
+		{
+			// Flip the float's bits so they compare the same as the float would
+			uint32_t depthBits;
+			memcpy(&depthBits, &renderData.depthVal, sizeof(float));
+			depthBits = (depthBits & 0x80000000u) ? ~depthBits : (depthBits | 0x80000000u);
+
+			// Inverted so the furthest items are drawn first, which transparency needs
+			return key | ((uint64_t)~depthBits << 16);
+		}
+
+		// Handle slots are handed out densely, so their low bits are already small ids
+		key |= (uint64_t)(getHandleIndex(renderData.shader) & 0x3FF) << 42;
+		// Batched materials sharing texture pages are drawn together, so they're sorted by their pages instead
+		if (renderData.batched)
+			key |= (uint64_t)(material->getBatchPageHash() & 0x7FF) << 31;
+		else
+			key |= (uint64_t)(getHandleIndex(renderData.material) & 0x7FF) << 31;
+		key |= (uint64_t)(getHandleIndex(renderData.mesh) & 0x7FF) << 20;
+		key |= (uint64_t)(materialSlot < 0xF ? materialSlot : 0xF) << 16;
+
+		// Nearest first within the same state, so depth testing can skip pixels which are covered
+		return key | quantizeSortDepth(renderData.depthVal);
+	}
+
+	void Renderer3D::dropStaleItems()
+	{
+		const _HandleTable<CompiledMeshData*>& meshes = _HandleTable<CompiledMeshData*>::get();
+		const _HandleTable<_Material*>& materials = _HandleTable<_Material*>::get();
+		const _HandleTable<_Shader*>& shaders = _HandleTable<_Shader*>::get();
+
+		size_t kept = 0;
+		size_t segment = 0;
+		for (size_t i = 0; i < m_QueueItems.size(); i++)
+		{
+			// Segments now start wherever their first item ends up once the dropped ones are removed
+			while (segment < m_SegmentStarts.size() && m_SegmentStarts[segment] == i)
+				m_SegmentStarts[segment++] = (unsigned int)kept;
+
+			const MeshRenderData& renderData = m_MainRenderData[m_QueueItems[i].index];
+			if (meshes.isValid(renderData.mesh) && materials.isValid(renderData.material) && shaders.isValid(renderData.shader))
+				m_QueueItems[kept++] = m_QueueItems[i];
+		}
+
+		debugLogIf(kept != m_QueueItems.size(), std::to_string(m_QueueItems.size() - kept) + " queued meshes were dropped as their mesh, material or shader was destroyed before they were rendered", LOST_LOG_WARNING);
+		m_QueueItems.resize(kept);
+	}
+
+	void Renderer3D::sortQueue()
+	{
+		m_QueueScratch.resize(m_QueueItems.size());
+
+		// Each segment is sorted on it's own, items never move past the edges of their segment
+		size_t segmentStart = 0;
+		for (unsigned int segmentEnd : m_SegmentStarts)
+		{
+			sortQueueRange(segmentStart, segmentEnd - segmentStart);
+			segmentStart = segmentEnd;
+		}
+		sortQueueRange(segmentStart, m_QueueItems.size() - segmentStart);
+	}
+
+	void Renderer3D::sortQueueRange(size_t start, size_t itemCount)
+	{
+		if (itemCount < 2)
+			return;
+
+		// Count every byte of every key in one go
+		unsigned int histograms[8][256] = {};
+		for (size_t i = start; i < start + itemCount; i++)
+		{
+			uint64_t key = m_QueueItems[i].key;
+			for (int pass = 0; pass < 8; pass++)
+				histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+		}
+
+		QueueItem* source = m_QueueItems.data() + start;
+		QueueItem* destination = m_QueueScratch.data() + start;
+
+		for (int pass = 0; pass < 8; pass++)
+		{
+			unsigned int* histogram = histograms[pass];
+			unsigned int shift = pass * 8;
+
+			// Every key has the same byte here, this pass wouldn't move anything
+			if (histogram[(source[0].key >> shift) & 0xFF] == itemCount)
+				continue;
+
+			// Turn the counts into the offset each bucket starts at
+			unsigned int offset = 0;
+			for (int bucket = 0; bucket < 256; bucket++)
+			{
+				unsigned int count = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += count;
+			}
+
+			for (size_t i = 0; i < itemCount; i++)
+				destination[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+
+			std::swap(source, destination);
+		}
+
+		// An odd amount of passes were done, the sorted items are in the scratch buffer
+		if (source != m_QueueItems.data() + start)
+			memcpy(m_QueueItems.data() + start, source, itemCount * sizeof(QueueItem));
 	}
 
 	void Renderer3D::renderInstanceQueue()
@@ -604,73 +1114,113 @@ namespace lost
 
 		if (!m_MainRenderData.empty())
 		{
+			// Raw meshes are the only mesh data which gets uploaded every frame, everything else is in the mesh arena
+			streamRawMeshes();
+
+			// Only look through the queue for stale handles if anything was destroyed since it started
+			if (_getHandleReleaseCount() != m_QueueReleaseCount)
+				dropStaleItems();
+
 			// Needs to be stable to preserve the order of depth tested meshes
-			std::stable_sort(m_MainRenderData.begin(), m_MainRenderData.end(), &Renderer3D::meshSortFunc);
-
-			Mesh         currentMesh          = m_MainRenderData[0].mesh;
-			Material     currentMaterial      = m_MainRenderData[0].material;
-			Shader       currentShader		  = m_MainRenderData[0].getShader();
-			unsigned int currentIndexOffset   = m_MainRenderData[0].startIndex;
-			unsigned int currentIndexCount    = m_MainRenderData[0].indicies;
-			unsigned int currentDepthTestFunc = m_MainRenderData[0].depthMode;
-			bool         currentDepthWrite    = m_MainRenderData[0].depthWrite;
-			unsigned int currentCullMode      = m_MainRenderData[0].cullMode;
+			sortQueue();
+		}
+
+		if (!m_QueueItems.empty())
+		{
+			const _HandleTable<CompiledMeshData*>& meshes = _HandleTable<CompiledMeshData*>::get();
+			const _HandleTable<_Material*>& materials = _HandleTable<_Material*>::get();
+			const _HandleTable<_Shader*>& shaders = _HandleTable<_Shader*>::get();
+
+			MeshRenderData& firstRenderData = m_MainRenderData[m_QueueItems[0].index];
+
+			// The handles are compared while going through the queue, they're only resolved when they change
+			ResourceHandle currentMeshHandle     = firstRenderData.mesh;
+			ResourceHandle currentMaterialHandle = firstRenderData.material;
+			ResourceHandle currentShaderHandle   = firstRenderData.shader;
+
+			CompiledMeshData* currentMesh     = meshes.resolve(currentMeshHandle);
+			Material          currentMaterial = materials.resolve(currentMaterialHandle);
+			Shader            currentShader   = shaders.resolve(currentShaderHandle);
+			unsigned int currentIndexOffset   = firstRenderData.startIndex;
+			unsigned int currentIndexCount    = firstRenderData.indicies;
+			unsigned int currentDepthTestFunc = firstRenderData.depthMode;
+			bool         currentDepthWrite    = firstRenderData.depthWrite;
+			unsigned int currentCullMode      = firstRenderData.cullMode;
 			
 			// Setup first meshes material and vertex data
 			currentShader->bind();
-			currentMaterial->bindTextures();
+			if (firstRenderData.batched)
+				currentMaterial->bindBatchPages();
+			else
+				currentMaterial->bindTextures();
+
+			// Every material drawn with material batching this queue, indexed by each instance's material index
+			if (!m_BatchMaterials.empty())
+			{
+				size_t materialOffset;
+				size_t materialSize = m_BatchMaterials.size() * sizeof(BatchedMaterialData);
+				memcpy(m_MaterialRing.allocate(materialSize, materialOffset), m_BatchMaterials.data(), materialSize);
+				glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, m_MaterialRing.getBuffer(), materialOffset, materialSize);
+			}
 
 			// Set the depth test function to the first one
-			glDepthMask(currentDepthWrite);
-			glDepthFunc(currentDepthTestFunc);
+			_glState->setDepthMask(currentDepthWrite);
+			_glState->setDepthFunc(currentDepthTestFunc);
 
 			// Set the cull mode of the renderer
 			if (currentCullMode != LOST_CULL_NONE) 
 			{
 				// Set the current current cull mode
-				glCullFace(currentCullMode);
+				_glState->setCullFace(currentCullMode);
 				m_CullingEnabled = true;
 
 				// Culling is automatically enabled at the end of every frame, we don't need to enable it
 			}
 			else
 			{
-				glDisable(GL_CULL_FACE);
+				_glState->setCapability(GL_CULL_FACE, false);
 				m_CullingEnabled = false;
 			} 
 
 			// Vertex Array Object
-			glBindVertexArray(VAOs[getCurrentWindowID()]);
-			// Vertex Buffer Data
-			glBindBuffer(GL_ARRAY_BUFFER, VBO);
-			glBufferData(GL_ARRAY_BUFFER, ((CompiledMeshData*)currentMesh)->vertexData.size() * sizeof(float), ((CompiledMeshData*)currentMesh)->vertexData.data(), GL_STATIC_DRAW);
-			if (getWindows().size() > 1) // I have no idea why this is necessary, something to do with context switching probably
-				glBufferData(GL_ARRAY_BUFFER, ((CompiledMeshData*)currentMesh)->vertexData.size() * sizeof(float), ((CompiledMeshData*)currentMesh)->vertexData.data(), GL_STATIC_DRAW);
-
-			// Create transform list, reserving the maximum size that could occur
-			std::vector<glm::mat4x4> transforms;
-			transforms.reserve(m_MainRenderData.size() * 2);
-
-			for (int i = 0; i < m_MainRenderData.size(); i++)
+			_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
+			// Point the VAO at wherever the first mesh is stored
+			bindMeshBuffers(currentMesh, true);
+
+			// Reserve space for every instance in the ring buffer, the transforms get written straight into it
+			// Each batch then draws the range of instances it wrote, starting at batchStart
+			unsigned int baseInstance;
+			unsigned int* materialIndices;
+			unsigned int itemCount = (unsigned int)m_QueueItems.size();
+			glm::mat4x4* instanceData = allocateInstances(itemCount, baseInstance, &materialIndices);
+			unsigned int batchStart = 0;
+
+			for (unsigned int i = 0; i < itemCount; i++)
 			{
-				MeshRenderData& renderData = m_MainRenderData[i];
+				unsigned int itemIndex = m_QueueItems[i].index;
+				MeshRenderData& renderData = m_MainRenderData[itemIndex];
+
+				// With material batching each instance reads it's own material, so only a change in texture pages breaks the batch
+				bool materialChanged = renderData.material != currentMaterialHandle && (!renderData.batched || !materials.resolve(renderData.material)->sharesBatchPages(currentMaterial));
+				bool shaderChanged = renderData.shader != currentShaderHandle;
 
-				if (renderData.mesh != currentMesh || renderData.getShader() != currentShader || renderData.material != currentMaterial || currentIndexOffset != renderData.startIndex || currentDepthTestFunc != renderData.depthMode || currentDepthWrite != renderData.depthWrite || currentCullMode != renderData.cullMode)
+				if (renderData.mesh != currentMeshHandle || shaderChanged || materialChanged || currentIndexOffset != renderData.startIndex || currentDepthTestFunc != renderData.depthMode || currentDepthWrite != renderData.depthWrite || currentCullMode != renderData.cullMode)
 				{
 					// Render all matching meshes with instancing
+					// When using LOST_SUBMIT_INDIRECT this is only queued, and is drawn with every other batch sharing the same state
+					submitDraw(currentMesh, currentIndexOffset, currentIndexCount, i - batchStart, baseInstance + batchStart);
 
-					// Matrix Buffer Data
-					glBindBuffer(GL_ARRAY_BUFFER, MBO);
-					glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(glm::mat4x4), transforms.data(), GL_STATIC_DRAW);
-					// Element Buffer Data
-					glBindBuffer(GL_ARRAY_BUFFER, EBO);
-					glBufferData(GL_ELEMENT_ARRAY_BUFFER, currentIndexCount * sizeof(int), ((CompiledMeshData*)currentMesh)->indexData.data() + currentIndexOffset, GL_STATIC_DRAW);
+					// Start the next batch at this instance
+					batchStart = i;
 
-					glDrawElementsInstanced(((CompiledMeshData*)currentMesh)->meshRenderMode, currentIndexCount, GL_UNSIGNED_INT, 0, transforms.size() / 2);
+					CompiledMeshData* mesh = renderData.mesh != currentMeshHandle ? meshes.resolve(renderData.mesh) : currentMesh;
 
-					// Recreate transform list, reserving the maximum size that could occur
-					transforms.clear();
-					transforms.reserve(2 * (m_MainRenderData.size() - i));
+					// Any change in state, or where the mesh data comes from, needs the queued draws to be drawn first
+					if (shaderChanged || materialChanged || currentDepthTestFunc != renderData.depthMode || currentDepthWrite != renderData.depthWrite || currentCullMode != renderData.cullMode
+						|| mesh->resident != currentMesh->resident
+						|| mesh->meshRenderMode != currentMesh->meshRenderMode
+						|| mesh->vertexLayout != currentMesh->vertexLayout)
+						flushDraws();
 
 					// Set the index offset for the new mesh
 					currentIndexOffset = renderData.startIndex;
@@ -680,14 +1230,14 @@ namespace lost
 					if (renderData.depthMode != currentDepthTestFunc)
 					{
 						currentDepthTestFunc = renderData.depthMode;
-						glDepthFunc(currentDepthTestFunc);
+						_glState->setDepthFunc(currentDepthTestFunc);
 					}
 
 					// Set the new depth write settings
 					if (renderData.depthWrite != currentDepthWrite)
 					{
 						currentDepthWrite = renderData.depthWrite;
-						glDepthMask(currentDepthWrite);
+						_glState->setDepthMask(currentDepthWrite);
 					}
 
 					// Set the new cull mode
@@ -702,91 +1252,88 @@ namespace lost
 							// Check if culling is already enabled
 							if (!m_CullingEnabled)
 							{
-								glEnable(GL_CULL_FACE);
+								_glState->setCapability(GL_CULL_FACE, true);
 								m_CullingEnabled = true;
 							}
 
 							// Set the current current cull mode
-							glCullFace(currentCullMode);
+							_glState->setCullFace(currentCullMode);
 						}
 						else if (m_CullingEnabled) // Check if it is enabled
 						{
-							glDisable(GL_CULL_FACE);
+							_glState->setCapability(GL_CULL_FACE, false);
 							m_CullingEnabled = false;
 						}
 					}
 
-					// Update mesh vertex data if necessary
-					if (renderData.mesh != currentMesh)
+					// Switch between the mesh arena and the stream buffers if necessary
+					if (mesh != currentMesh)
 					{
-						currentMesh = renderData.mesh;
-
-						// Vertex Buffer Data
-						glBindBuffer(GL_ARRAY_BUFFER, VBO);
-						glBufferData(GL_ARRAY_BUFFER, ((CompiledMeshData*)currentMesh)->vertexData.size() * sizeof(float), ((CompiledMeshData*)currentMesh)->vertexData.data(), GL_STATIC_DRAW);
-
+						currentMeshHandle = renderData.mesh;
+						currentMesh = mesh;
+						bindMeshBuffers(currentMesh);
 					}
 
 					// Update shader
-					if (renderData.getShader() != currentShader)
+					if (shaderChanged)
 					{
-						currentShader = renderData.getShader();
+						currentShaderHandle = renderData.shader;
+						currentShader = shaders.resolve(currentShaderHandle);
 						currentShader->bind();
 					}
 
-					// Update mesh material if necessary
-					if (renderData.material != currentMaterial)
+					// Update mesh material if necessary, batched materials only need their texture pages bound
+					if (materialChanged || shaderChanged)
 					{
-						currentMaterial = renderData.material;
-						currentMaterial->bindTextures();
+						currentMaterialHandle = renderData.material;
+						currentMaterial = materials.resolve(currentMaterialHandle);
+						if (renderData.batched)
+							currentMaterial->bindBatchPages();
+						else
+						{
+							currentMaterial->bindTextures();
 
-						if (currentMaterial->hasMaterialUniforms())
-							currentMaterial->bindMaterialUniforms();
+							if (currentMaterial->hasMaterialUniforms())
+								currentMaterial->bindMaterialUniforms();
+						}
 					}
 
 				}
 
-				transforms.push_back(renderData.mvpTransform);
-				transforms.push_back(renderData.modelTransform);
-				if (i == 0)
-				{
-					glBindBuffer(GL_ARRAY_BUFFER, MBO);
-					glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(glm::mat4x4), transforms.data(), GL_STATIC_DRAW);
-					glBindBuffer(GL_ARRAY_BUFFER, EBO);
-					glBufferData(GL_ELEMENT_ARRAY_BUFFER, currentIndexCount * sizeof(int), ((CompiledMeshData*)currentMesh)->indexData.data() + currentIndexOffset, GL_STATIC_DRAW);
-				}
-
+				instanceData[i * 2    ] = m_MainTransforms[itemIndex * 2];
+				instanceData[i * 2 + 1] = m_MainTransforms[itemIndex * 2 + 1];
+				materialIndices[i] = renderData.batchIndex;
 			}
 
 			// Render the final batch, as it's not included in the loop
-			
-			// Matrix Buffer Data
-			glBindBuffer(GL_ARRAY_BUFFER, MBO);
-			glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(glm::mat4x4), transforms.data(), GL_STATIC_DRAW);
-			// Element Buffer Data
-			glBindBuffer(GL_ARRAY_BUFFER, EBO);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_MainRenderData[m_MainRenderData.size() - 1].indicies * sizeof(int), ((CompiledMeshData*)m_MainRenderData[m_MainRenderData.size() - 1].mesh)->indexData.data() + m_MainRenderData[m_MainRenderData.size() - 1].startIndex, GL_STATIC_DRAW);
-			
-			glDrawElementsInstanced(((CompiledMeshData*)m_MainRenderData[m_MainRenderData.size() - 1].mesh)->meshRenderMode, m_MainRenderData[m_MainRenderData.size() - 1].indicies, GL_UNSIGNED_INT, 0, transforms.size() / 2);
+			submitDraw(currentMesh, currentIndexOffset, currentIndexCount, itemCount - batchStart, baseInstance + batchStart);
+			flushDraws();
 
-			glDepthMask(true);
-			glDepthFunc(LOST_DEPTH_TEST_LESS);
+			_glState->setDepthMask(true);
+			_glState->setDepthFunc(LOST_DEPTH_TEST_LESS);
 		}
 
 		m_MainRenderData.clear();
+		m_MainTransforms.clear();
+		m_QueueItems.clear();
+		m_BatchMaterials.clear();
+		m_BatchStamp = s_NextBatchStamp++;
+		m_SegmentStarts.clear();
+		m_SortSequence = 0;
+		m_LastItemOrdered = false;
 
 		Renderer::renderInstanceQueue();
 	}
 
 	void Renderer3D::finalize()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		_glState->bindFramebuffer(0);
 
 		// Bind the current post processing shader
 
 		int width, height;
 		glfwGetFramebufferSize(glfwGetCurrentContext(), &width, &height);
-		glViewport(0, 0, width, height);
+		_glState->setViewport(0, 0, width, height);
 
 		// Setup quad over entire screen
 
@@ -796,28 +1343,25 @@ namespace lost
 			0.0f, 0.0f, 1.0f, 0.0f,
 			-1.0f, -1.0f, 0.0f, 1.0f
 		);
-		glBindVertexArray(VAOs[getCurrentWindowID()]);
-		// Vertex Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, ((CompiledMeshData*)standardQuad)->vertexData.size() * sizeof(float), ((CompiledMeshData*)standardQuad)->vertexData.data(), GL_STATIC_DRAW);
+		_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
+		// The quad is already inside of the mesh arena, only bind it
+		bindMeshBuffers((CompiledMeshData*)standardQuad, true);
 		// Matrix Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, MBO);
-		glBufferData(GL_ARRAY_BUFFER, 1 * sizeof(glm::mat4x4), &transform, GL_STATIC_DRAW);
-		// Element Buffer Data
-		glBindBuffer(GL_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, ((CompiledMeshData*)standardQuad)->indexData.size() * sizeof(int), ((CompiledMeshData*)standardQuad)->indexData.data(), GL_STATIC_DRAW);
+		unsigned int baseInstance;
+		glm::mat4x4* instanceData = allocateInstances(1, baseInstance);
+		instanceData[0] = transform;
+		instanceData[1] = transform;
 
 		// Bind color texture of the main render pass
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_MainRenderPasses[getCurrentWindowID()]->textures[0]);
+		_glState->bindTexture(0, GL_TEXTURE_2D, m_MainRenderPasses[getCurrentWindowID()]->textures[0]);
 		_defaultShader->bind();
 
 		// Render the quad with the texture
-		glDisable(GL_DEPTH_TEST);
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK);
-		glDrawElements(GL_TRIANGLES, ((CompiledMeshData*)standardQuad)->indexData.size(), GL_UNSIGNED_INT, 0);
-		glEnable(GL_DEPTH_TEST);
+		_glState->setCapability(GL_DEPTH_TEST, false);
+		_glState->setCapability(GL_CULL_FACE, true);
+		_glState->setCullFace(GL_BACK);
+		drawMeshInstanced((CompiledMeshData*)standardQuad, 0, ((CompiledMeshData*)standardQuad)->indexData.size(), 1, baseInstance);
+		_glState->setCapability(GL_DEPTH_TEST, true);
 
 		Renderer::finalize();
 	}
@@ -829,12 +1373,14 @@ namespace lost
 
 		if (mesh != nullptr)
 		{
-			glBindVertexArray(VAOs[getCurrentWindowID()]);
-			glDrawElements(GL_TRIANGLES, ((CompiledMeshData*)mesh)->indexData.size(), GL_UNSIGNED_INT, 0);
+			_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
+			bindMeshBuffers((CompiledMeshData*)mesh, true);
+			drawMeshInstanced((CompiledMeshData*)mesh, 0, ((CompiledMeshData*)mesh)->indexData.size(), 1, 0);
 		}
 #else
-		glBindVertexArray(VAOs[getCurrentWindowID()]);
-		glDrawElements(GL_TRIANGLES, ((CompiledMeshData*)mesh)->indexData.size(), GL_UNSIGNED_INT, 0);
+		_glState->bindVertexArray(VAOs[getCurrentWindowID()]);
+		bindMeshBuffers((CompiledMeshData*)mesh, true);
+		drawMeshInstanced((CompiledMeshData*)mesh, 0, ((CompiledMeshData*)mesh)->indexData.size(), 1, 0);
 #endif
 	}
 #pragma endregion
@@ -909,45 +1455,34 @@ namespace lost
 		_renderer->renderFullScreenQuadImmediate();
 	}
 
+	void _uploadMesh(Mesh mesh)
+	{
+		_renderer->uploadMesh(mesh);
+	}
+
+	void _releaseMesh(Mesh mesh)
+	{
+		if (_renderer)
+			_renderer->releaseMesh(mesh);
+	}
+
 	void _renderChar(Bounds2D bounds, Bounds2D texbounds, Material mat, Shader shaderOverride)
 	{
 
 		// If no material is given use the default one
 		if (mat == nullptr) mat = getDefaultWhiteMaterial();
 
-		Window currentWindow = getCurrentWindow();
-
-		float xScale = 2.0f / getWidth(currentWindow);
-		float yScale = 2.0f / getHeight(currentWindow);
-		Vec2 scale = { xScale, yScale };
-
 		// Get current render color from state
 		const Color& color = getNormalizedColor();
 
-		const lost::Vec2 reusedCornerA = lost::Vec2{ bounds.x, bounds.y };
-		const lost::Vec2 reusedCornerB = lost::Vec2{ bounds.x + bounds.w, bounds.y + bounds.h };
-
-		CompiledMeshData mesh = {};
-		mesh.vertexData.reserve(16 * 6);
-		mesh.vertexData = {
-			reusedCornerA.x,     reusedCornerA.y, 0.0f, texbounds.x,               texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			bounds.w + bounds.x, bounds.y,        0.0f, texbounds.x + texbounds.w, texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			reusedCornerB.x,     reusedCornerB.y, 0.0f, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			reusedCornerB.x,     reusedCornerB.y, 0.0f, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			bounds.x, bounds.h + bounds.y,        0.0f, texbounds.x,               texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			reusedCornerA.x,     reusedCornerA.y, 0.0f, texbounds.x,               texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f
-		};
-		mesh.indexData = { 2, 1, 0, 5, 4, 3 };
-		mesh.materialSlotIndicies = { 0 };
-		mesh.meshRenderMode = LOST_MESH_TRIANGLES;
-
-		// Rotate the transform around the axis that goes into the screen (Z)
-
 		glm::mat4x4 transform = get2DScaleMat();
 
-		std::vector<Material> materialList = { mat };
-
-		_renderer->addRawToQueue(mesh, materialList, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, shaderOverride, !lost::_renderTextureStack.empty());
+		// Written straight into the renderer's stream buffer, characters using the same font batch together
+		Vertex2D* vertex = _renderer->addRawQuads(1, mat, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, shaderOverride, !lost::_renderTextureStack.empty());
+		vertex = write2DVertex(vertex, bounds.x,            bounds.y,            texbounds.x,               texbounds.y,               color);
+		vertex = write2DVertex(vertex, bounds.x + bounds.w, bounds.y,            texbounds.x + texbounds.w, texbounds.y,               color);
+		vertex = write2DVertex(vertex, bounds.x + bounds.w, bounds.y + bounds.h, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color);
+		         write2DVertex(vertex, bounds.x,            bounds.y + bounds.h, texbounds.x,               texbounds.y + texbounds.h, color);
 	}
 
 	RenderPass _getCurrentRenderPass()
@@ -994,6 +1529,9 @@ namespace lost
 
 	void renderMesh(Mesh mesh, std::vector<Material> materials, Vec3 pos, Vec3 rotation, Vec3 scale)
 	{
+		// Meshes still loading don't know how many materials they have yet
+		if (mesh != nullptr && ((CompiledMeshData*)mesh)->loading)
+			return;
 
 		if (((CompiledMeshData*)mesh)->materialSlotIndicies.size() != materials.size())
 		{
@@ -1032,8 +1570,6 @@ namespace lost
 		// If no material is given use the default one
 		if (mat == nullptr) mat = getDefaultWhiteMaterial();
 
-		Window currentWindow = getCurrentWindow();
-
 		origin.y *= -1; // Not entirely sure why this is necessary, probably something with the different coordinate system
 
 		// Get current render color from state
@@ -1041,48 +1577,33 @@ namespace lost
 
 		texbounds.h -= 0.000001f;
 
-		CompiledMeshData mesh = {};
-		mesh.vertexData.reserve(16 * 6);
+		glm::mat4x4 transform = get2DScaleMat();
+
+		// Written straight into the renderer's stream buffer, the corners are ordered top left, top right, bottom right, bottom left
+		Vertex2D* vertex = _renderer->addRawQuads(1, mat, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
 		if (angle != 0.0f)
 		{
-			const lost::Vec2 reusedCornerA = lost::Vec2{ -(origin.x * cosf(angle) + origin.y * sinf(angle)) + bounds.x, origin.x * -sinf(angle) + origin.y * cosf(angle) + bounds.y };
-			const lost::Vec2 reusedCornerB = lost::Vec2{ -((origin.x - bounds.w) * cosf(angle) + (origin.y + bounds.h) * sinf(angle)) + bounds.x, (origin.x - bounds.w) * -sinf(angle) + (origin.y + bounds.h) * cosf(angle) + bounds.y };
-
-			mesh.vertexData = {
-				reusedCornerA.x,      reusedCornerA.y,                                                                                                                    0.0f, texbounds.x,               texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				-((origin.x - bounds.w) * cosf(angle) + (origin.y) * sinf(angle)) + bounds.x, (origin.x - bounds.w) * -sinf(angle) + (origin.y) * cosf(angle) + bounds.y, 0.0f, texbounds.x + texbounds.w, texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				reusedCornerB.x,      reusedCornerB.y,                                                                                                                    0.0f, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				reusedCornerB.x,      reusedCornerB.y,                                                                                                                    0.0f, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				-((origin.x) * cosf(angle) + (origin.y + bounds.h) * sinf(angle)) + bounds.x, (origin.x) * -sinf(angle) + (origin.y + bounds.h) * cosf(angle) + bounds.y, 0.0f, texbounds.x,               texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				reusedCornerA.x,      reusedCornerA.y,                                                                                                                    0.0f, texbounds.x,               texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f
-			};
+			const float cosAngle = cosf(angle);
+			const float sinAngle = sinf(angle);
+
+			// Rotate each corner around the origin
+			const float left   = origin.x;
+			const float right  = origin.x - bounds.w;
+			const float top    = origin.y;
+			const float bottom = origin.y + bounds.h;
+
+			vertex = write2DVertex(vertex, -(left  * cosAngle + top    * sinAngle) + bounds.x, left  * -sinAngle + top    * cosAngle + bounds.y, texbounds.x,               texbounds.y,               color);
+			vertex = write2DVertex(vertex, -(right * cosAngle + top    * sinAngle) + bounds.x, right * -sinAngle + top    * cosAngle + bounds.y, texbounds.x + texbounds.w, texbounds.y,               color);
+			vertex = write2DVertex(vertex, -(right * cosAngle + bottom * sinAngle) + bounds.x, right * -sinAngle + bottom * cosAngle + bounds.y, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color);
+			         write2DVertex(vertex, -(left  * cosAngle + bottom * sinAngle) + bounds.x, left  * -sinAngle + bottom * cosAngle + bounds.y, texbounds.x,               texbounds.y + texbounds.h, color);
 		}
 		else
 		{
-			const lost::Vec2 reusedCornerA = lost::Vec2{ -(origin.x) + bounds.x, origin.y + bounds.y };
-			const lost::Vec2 reusedCornerB = lost::Vec2{ -((origin.x - bounds.w)) + bounds.x, (origin.y + bounds.h) + bounds.y };
-
-			mesh.vertexData = {
-				reusedCornerA.x,      reusedCornerA.y,                0.0f, texbounds.x,               texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				-origin.x + bounds.w + bounds.x, origin.y + bounds.y, 0.0f, texbounds.x + texbounds.w, texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				reusedCornerB.x,      reusedCornerB.y,                0.0f, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				reusedCornerB.x,      reusedCornerB.y,                0.0f, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				-origin.x + bounds.x, origin.y + bounds.h + bounds.y, 0.0f, texbounds.x,               texbounds.y + texbounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-				reusedCornerA.x,      reusedCornerA.y,                0.0f, texbounds.x,               texbounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f
-			};
+			vertex = write2DVertex(vertex, -origin.x + bounds.x,            origin.y + bounds.y,            texbounds.x,               texbounds.y,               color);
+			vertex = write2DVertex(vertex, -origin.x + bounds.w + bounds.x, origin.y + bounds.y,            texbounds.x + texbounds.w, texbounds.y,               color);
+			vertex = write2DVertex(vertex, -origin.x + bounds.w + bounds.x, origin.y + bounds.h + bounds.y, texbounds.x + texbounds.w, texbounds.y + texbounds.h, color);
+			         write2DVertex(vertex, -origin.x + bounds.x,            origin.y + bounds.h + bounds.y, texbounds.x,               texbounds.y + texbounds.h, color);
 		}
-
-		mesh.indexData = { 2, 1, 0, 5, 4, 3 };
-		mesh.materialSlotIndicies = { 0 };
-		mesh.meshRenderMode = LOST_MESH_TRIANGLES;
-
-		// Rotate the transform around the axis that goes into the screen (Z)
-
-		glm::mat4x4 transform = get2DScaleMat();
-		
-		std::vector<Material> materialList = { mat };
-
-		_renderer->addRawToQueue(mesh, materialList, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
 	}
 
 	void renderRect3D(Vec3 position, Vec2 size, Vec3 rotation, Bounds2D texBounds, Material mat)
@@ -1093,18 +1614,6 @@ namespace lost
 		// Get current render color from state
 		const Color& color = getNormalizedColor();
 
-		CompiledMeshData mesh = {};
-		//   x ----- y ---- z               u ----------------------- v               r ------- g ------ b ----- a   nx -- ny -- nz
-		mesh.vertexData = {
-			0.0f,   0.0f,   0.0f, texBounds.x,               texBounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			size.x, 0.0f,   0.0f, texBounds.x + texBounds.w, texBounds.y,               color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			size.x, size.y, 0.0f, texBounds.x + texBounds.w, texBounds.y + texBounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			0.0f,   size.y, 0.0f, texBounds.x,               texBounds.y + texBounds.h, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f
-		};
-		mesh.indexData = { 2, 1, 3, 0 };
-		mesh.materialSlotIndicies = { 0 };
-		mesh.meshRenderMode = LOST_MESH_TRIANGLE_STRIP;
-
 		glm::mat4x4 transform = glm::eulerAngleXYZ(glm::radians(rotation.x), glm::radians(rotation.y), glm::radians(rotation.z));
 		transform[3][0] += position.x;
 		transform[3][1] += position.y;
@@ -1112,9 +1621,11 @@ namespace lost
 
 		glm::mat4x4 mpvTransform = _getCurrentCamera()->getPV() * transform;
 
-		std::vector<Material> materialList = { mat };
-
-		_renderer->addRawToQueue(mesh, materialList, mpvTransform, transform);
+		Vertex2D* vertex = _renderer->addRawQuads(1, mat, mpvTransform, transform);
+		vertex = write2DVertex(vertex, 0.0f,   0.0f,   texBounds.x,               texBounds.y,               color);
+		vertex = write2DVertex(vertex, size.x, 0.0f,   texBounds.x + texBounds.w, texBounds.y,               color);
+		vertex = write2DVertex(vertex, size.x, size.y, texBounds.x + texBounds.w, texBounds.y + texBounds.h, color);
+		         write2DVertex(vertex, 0.0f,   size.y, texBounds.x,               texBounds.y + texBounds.h, color);
 	}
 
 	void renderCircle(Vec2 position, float radius, Material mat, int detail)
@@ -1137,35 +1648,33 @@ namespace lost
 		// If no material is given use the default one
 		if (mat == nullptr) mat = getDefaultWhiteMaterial();
 
-		Window currentWindow = getCurrentWindow();
+		if (detail < 3)
+			return;
 
 		// Get current render color from state
 		const Color& color = getNormalizedColor();
 
-		CompiledMeshData mesh = {};
+		glm::mat4x4 transform = get2DScaleMat(angle, position);
 
-		// Generate polygon
+		// Generate polygon, the fan is split into triangles so it can be batched with other raw meshes
+		unsigned int* indexData;
+		unsigned int indexBase;
+		Vertex2D* vertex = _renderer->addRawGeometry(LOST_MESH_TRIANGLES, detail, (detail - 2) * 3, indexData, indexBase, mat, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
 		for (int i = 0; i < detail; i++)
 		{
 			float theta = -(float)i / (float)detail * TAU;
 			Vec2 pos = { sinf(theta) * extents.x - origin.x, cosf(theta) * extents.y - origin.y };
 			Vec2 texCoord = { sinf(theta) * 0.5f + 0.5f, cosf(theta) * 0.5f + 0.5f };
 
-			mesh.vertexData.insert(mesh.vertexData.end(), {
-				pos.x, pos.y, 0.0f, texCoord.x, texCoord.y, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f
-			});
-
-			mesh.indexData.push_back(i);
+			vertex = write2DVertex(vertex, pos.x, pos.y, texCoord.x, texCoord.y, color);
 		}
 
-		mesh.materialSlotIndicies = { 0 };
-		mesh.meshRenderMode = LOST_MESH_TRIANGLE_FAN;
-
-		glm::mat4x4 transform = get2DScaleMat(angle, position);
-
-		std::vector<Material> materialList = { mat };
-
-		_renderer->addRawToQueue(mesh, materialList, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
+		for (int i = 1; i < detail - 1; i++)
+		{
+			*indexData++ = indexBase;
+			*indexData++ = indexBase + i;
+			*indexData++ = indexBase + i + 1;
+		}
 	}
 
 	void renderEllipse3D(Vec3 position, Vec2 extents, Vec3 rotation, Material mat, int detail)
@@ -1173,27 +1682,11 @@ namespace lost
 		// If no material is given use the default one
 		if (mat == nullptr) mat = getDefaultWhiteMaterial();
 
+		if (detail < 3)
+			return;
+
 		// Get current render color from state
 		const Color& color = getNormalizedColor();
-		
-		CompiledMeshData mesh = {};
-
-		// Generate polygon
-		for (int i = 0; i < detail; i++)
-		{
-			float theta = -(float)i / (float)detail * TAU;
-			Vec2 pos = { sinf(theta) * extents.x, cosf(theta) * extents.y };
-			Vec2 texCoord = { sinf(theta) * 0.5f + 0.5f, cosf(theta) * 0.5f + 0.5f };
-
-			mesh.vertexData.insert(mesh.vertexData.end(), {
-				pos.x, pos.y, 0.0f, texCoord.x, texCoord.y, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f
-			});
-
-			mesh.indexData.push_back(i);
-		}
-
-		mesh.materialSlotIndicies = { 0 };
-		mesh.meshRenderMode = LOST_MESH_TRIANGLE_FAN;
 
 		glm::mat4x4 transform = glm::eulerAngleXYZ(glm::radians(rotation.x), glm::radians(rotation.y), glm::radians(rotation.z));
 		transform[3][0] += position.x;
@@ -1202,9 +1695,25 @@ namespace lost
 
 		glm::mat4x4 mpvTransform = _getCurrentCamera()->getPV() * transform;
 
-		std::vector<Material> materialList = { mat };
+		// Generate polygon, the fan is split into triangles so it can be batched with other raw meshes
+		unsigned int* indexData;
+		unsigned int indexBase;
+		Vertex2D* vertex = _renderer->addRawGeometry(LOST_MESH_TRIANGLES, detail, (detail - 2) * 3, indexData, indexBase, mat, mpvTransform, transform);
+		for (int i = 0; i < detail; i++)
+		{
+			float theta = -(float)i / (float)detail * TAU;
+			Vec2 pos = { sinf(theta) * extents.x, cosf(theta) * extents.y };
+			Vec2 texCoord = { sinf(theta) * 0.5f + 0.5f, cosf(theta) * 0.5f + 0.5f };
+
+			vertex = write2DVertex(vertex, pos.x, pos.y, texCoord.x, texCoord.y, color);
+		}
 
-		_renderer->addRawToQueue(mesh, materialList, mpvTransform, transform);
+		for (int i = 1; i < detail - 1; i++)
+		{
+			*indexData++ = indexBase;
+			*indexData++ = indexBase + i;
+			*indexData++ = indexBase + i + 1;
+		}
 	}
 
 	void renderTexture(Texture texture, Bounds2D bounds, Bounds2D texBounds)
@@ -1221,6 +1730,7 @@ namespace lost
 
 		if (bounds.w == -1.0f) bounds.w = texture->getWidth();
 		if (bounds.h == -1.0f) bounds.h = texture->getHeight();
+		_requestTextureLevel(texture, fmaxf(fabsf(bounds.w / texBounds.w), fabsf(bounds.h / texBounds.h)));
 
 		renderRect(bounds, texBounds, texture->getMaterial());
 	}
@@ -1229,33 +1739,71 @@ namespace lost
 	{
 		if (w == -1.0f) w = texture->getWidth();
 		if (h == -1.0f) h = texture->getHeight();
+		_requestTextureLevel(texture, fmaxf(fabsf(w), fabsf(h)));
 
 		renderRect({ x, y, w, h }, { 0.0f, 0.0f, 1.0f, 1.0f }, texture->getMaterial());
 	}
 
-	void renderLine(float x1, float y1, float x2, float y2)
+	void renderSprite(Sprite sprite, float x, float y, float w, float h)
 	{
-		Window currentWindow = getCurrentWindow();
+		if (w == -1.0f) w = (float)sprite->getWidth();
+		if (h == -1.0f) h = (float)sprite->getHeight();
 
-		// Get current render color from state
+		renderRect({ x, y, w, h }, sprite->getTexBounds(), sprite->getMaterial());
+	}
+
+	void renderSpritePro(Sprite sprite, Bounds2D bounds, Vec2 origin, float angle)
+	{
+		renderRectPro(bounds, origin, angle, sprite->getTexBounds(), sprite->getMaterial());
+	}
+
+	void renderSprites(const Sprite* sprites, const Bounds2D* bounds, unsigned int count)
+	{
 		const Color& color = getNormalizedColor();
+		glm::mat4x4 transform = get2DScaleMat();
+		bool invertCullMode = !lost::_renderTextureStack.empty();
 
-		CompiledMeshData mesh = {};
-		mesh.vertexData = {
-			x1, y1, 0.0f, 0.0f, 0.0f, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-			x2, y2, 0.0f, 0.0f, 0.0f, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
-		};
-		mesh.indexData = { 0, 1 };
-		mesh.materialSlotIndicies = { 0 };
-		mesh.meshRenderMode = LOST_MESH_LINES;
+		unsigned int start = 0;
+		while (start < count)
+		{
+			// Each run of sprites using the same page is written with a single call to the renderer
+			Material material = sprites[start]->getMaterial();
+			unsigned int end = start + 1;
+			while (end < count && end - start < s_MaxRawMeshQuads && sprites[end]->getMaterial() == material)
+				end++;
+
+			Vertex2D* vertex = _renderer->addRawQuads(end - start, material, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, invertCullMode);
+			for (unsigned int i = start; i < end; i++)
+			{
+				const Bounds2D& area = bounds[i];
+				Bounds2D texBounds = sprites[i]->getTexBounds();
+				texBounds.h -= 0.000001f;
+
+				vertex = write2DVertex(vertex, area.x,          area.y,          texBounds.x,               texBounds.y,               color);
+				vertex = write2DVertex(vertex, area.x + area.w, area.y,          texBounds.x + texBounds.w, texBounds.y,               color);
+				vertex = write2DVertex(vertex, area.x + area.w, area.y + area.h, texBounds.x + texBounds.w, texBounds.y + texBounds.h, color);
+				vertex = write2DVertex(vertex, area.x,          area.y + area.h, texBounds.x,               texBounds.y + texBounds.h, color);
+			}
+
+			start = end;
+		}
+	}
 
-		// Rotate the transform around the axis that goes into the screen (Z)
+	void renderLine(float x1, float y1, float x2, float y2)
+	{
+		// Get current render color from state
+		const Color& color = getNormalizedColor();
 
 		glm::mat4x4 transform = get2DScaleMat();
 
-		std::vector<Material> materialList = { getDefaultWhiteMaterial() };
+		unsigned int* indexData;
+		unsigned int indexBase;
+		Vertex2D* vertex = _renderer->addRawGeometry(LOST_MESH_LINES, 2, 2, indexData, indexBase, getDefaultWhiteMaterial(), transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
+		vertex = write2DVertex(vertex, x1, y1, 0.0f, 0.0f, color);
+		         write2DVertex(vertex, x2, y2, 0.0f, 0.0f, color);
 
-		_renderer->addRawToQueue(mesh, materialList, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
+		indexData[0] = indexBase;
+		indexData[1] = indexBase + 1;
 	}
 
 	void renderLine(Vec2 a, Vec2 b)
@@ -1265,32 +1813,26 @@ namespace lost
 
 	void renderLineStrip(const std::vector<Vec2>& points)
 	{
-		Window currentWindow = getCurrentWindow();
+		if (points.size() < 2)
+			return;
 
 		// Get current render color from state
 		const Color& color = getNormalizedColor();
 
-		CompiledMeshData mesh = {};
-		mesh.vertexData = {};
-		mesh.indexData = {};
-		mesh.vertexData.reserve(points.size() * 16);
-		mesh.indexData.reserve(points.size());
-		for (const Vec2& p : points)
-		{
-			mesh.vertexData.insert(mesh.vertexData.end(), { p.x, p.y, 0.0f, 0.0f, 0.0f, color.r, color.g, color.b, color.a, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f });
-			mesh.indexData.push_back(mesh.indexData.size());
-		}
-
-		mesh.materialSlotIndicies = { 0 };
-		mesh.meshRenderMode = LOST_MESH_LINE_STRIP;
-
-		// Rotate the transform around the axis that goes into the screen (Z)
-
 		glm::mat4x4 transform = get2DScaleMat();
 
-		std::vector<Material> materialList = { getDefaultWhiteMaterial() };
+		// Rendered as separate lines rather than a strip so it can be batched with other lines
+		unsigned int* indexData;
+		unsigned int indexBase;
+		Vertex2D* vertex = _renderer->addRawGeometry(LOST_MESH_LINES, points.size(), (points.size() - 1) * 2, indexData, indexBase, getDefaultWhiteMaterial(), transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
+		for (const Vec2& p : points)
+			vertex = write2DVertex(vertex, p.x, p.y, 0.0f, 0.0f, color);
 
-		_renderer->addRawToQueue(mesh, materialList, transform, transform, LOST_DEPTH_TEST_ALWAYS, false, nullptr, !lost::_renderTextureStack.empty());
+		for (unsigned int i = 0; i + 1 < points.size(); i++)
+		{
+			*indexData++ = indexBase + i;
+			*indexData++ = indexBase + i + 1;
+		}
 	}
 
 	void renderInstanceQueue()
@@ -1300,10 +1842,11 @@ namespace lost
 
 	void beginMesh(unsigned int meshMode, bool screenspace)
 	{
-		// Clear the old data that was used in the last mesh
-		_renderer->_TempMeshBuild = {};
+		// Clear the old data that was used in the last mesh, keeping the memory for the next one
+		_renderer->_TempMeshBuild.vertexData.clear();
+		_renderer->_TempMeshBuild.indexData.clear();
 		_renderer->_TempMeshBuild.meshRenderMode = meshMode;
-		_renderer->_TempMeshBuild.materialSlotIndicies = { 0 };
+		_renderer->_TempMeshBuild.materialSlotIndicies.assign(1, 0);
 		_renderer->_TempMeshUsesWorldTransform = !screenspace;
 		_renderer->_TempMeshModelTransform = glm::identity<glm::mat4x4>();
 
@@ -1363,7 +1906,7 @@ namespace lost
 
 		// Create a vector of the vertex data
 		// [!] TODO: Convert this into a function just incase we change the format
-		std::vector<float> vertexData = {
+		const float vertexData[16] = {
 			position.x, position.y, position.z,
 			textureCoord.x, textureCoord.y,
 			vertexColor.r, vertexColor.g, vertexColor.b, vertexColor.a,
@@ -1371,7 +1914,7 @@ namespace lost
 			0.0f, 0.0f, 0.0f, 0.0f // Normal, Tangent
 		};
 		// Append the data to the end of the list
-		_renderer->_TempMeshBuild.vertexData.insert(_renderer->_TempMeshBuild.vertexData.end(), vertexData.begin(), vertexData.end());
+		_renderer->_TempMeshBuild.vertexData.insert(_renderer->_TempMeshBuild.vertexData.end(), vertexData, vertexData + 16);
 		_renderer->_TempMeshBuild.indexData.push_back(_renderer->_TempMeshBuild.indexData.size());
 	}
 
@@ -1382,7 +1925,7 @@ namespace lost
 
 		// Create a vector of the vertex data
 		// [!] TODO: Convert this into a function just incase we change the format
-		std::vector<float> vertexData = {
+		const float vertexData[16] = {
 			vertex.position.x, vertex.position.y, vertex.position.z,
 			vertex.textureCoord.x, vertex.textureCoord.y,
 			vertex.vertexColor.r * currentColor.r, vertex.vertexColor.g * currentColor.g, vertex.vertexColor.b * currentColor.b, vertex.vertexColor.a * currentColor.a,
@@ -1391,7 +1934,7 @@ namespace lost
 		};
 
 		// Append the data to the end of the list
-		_renderer->_TempMeshBuild.vertexData.insert(_renderer->_TempMeshBuild.vertexData.end(), vertexData.begin(), vertexData.end());
+		_renderer->_TempMeshBuild.vertexData.insert(_renderer->_TempMeshBuild.vertexData.end(), vertexData, vertexData + 16);
 		_renderer->_TempMeshBuild.indexData.push_back(_renderer->_TempMeshBuild.indexData.size());
 	}
 
@@ -1428,6 +1971,66 @@ namespace lost
 		_renderer->setCullMode(cullMode);
 	}
 
+	void setSubmissionMode(unsigned int submissionMode)
+	{
+		_renderer->setSubmissionMode(submissionMode);
+	}
+
+	void setFrustumCulling(bool state)
+	{
+		_renderer->setFrustumCulling(state);
+	}
+
+	void setCullDistance(float distance)
+	{
+		_renderer->setCullDistance(distance);
+	}
+
+	CommandList createCommandList()
+	{
+		return new _CommandList();
+	}
+
+	void destroyCommandList(CommandList commandList)
+	{
+		delete commandList;
+	}
+
+	void beginCommandList(CommandList commandList)
+	{
+		commandList->begin(_getCurrentCamera()->getPV(), _renderer->getFrustumCulling(), _renderer->getCullDistance());
+	}
+
+	void recordMesh(CommandList commandList, Mesh mesh, const std::vector<Material>& materials, const glm::mat4x4& transform)
+	{
+		commandList->record(mesh, materials.data(), materials.size(), transform);
+	}
+
+	void recordMesh(CommandList commandList, Mesh mesh, const std::vector<Material>& materials, Vec3 pos, Vec3 rotation, Vec3 scale)
+	{
+		glm::mat4x4 transform = glm::mat4x4(
+			scale.x, 0.0f,    0.0f,    0.0f,
+			0.0f,    scale.y, 0.0f,    0.0f,
+			0.0f,    0.0f,    scale.z, 0.0f,
+			0.0f,    0.0f,    0.0f,    1.0f
+		);
+
+		transform = glm::eulerAngleXYZ(glm::radians(rotation.x), glm::radians(rotation.y), glm::radians(rotation.z)) * transform;
+		transform[3][0] += pos.x;
+		transform[3][1] += pos.y;
+		transform[3][2] += pos.z;
+
+		commandList->record(mesh, materials.data(), materials.size(), transform);
+	}
+
+	void submitCommandList(CommandList commandList)
+	{
+		// Recording can happen on any thread so it can't log, report anything that went wrong now we're on the main thread
+		debugLogIf(commandList->getInvalidCount() > 0, std::to_string(commandList->getInvalidCount()) + " meshes recorded into a command list were null or had an incorrect amount of material inputs", LOST_LOG_WARNING);
+
+		_renderer->submitCommandList(commandList);
+	}
+
 	unsigned int getRenderTexture(unsigned int pass, unsigned int windowID)
 	{
 		if (windowID == -1)
@@ -1,9 +1,14 @@
 #pragma once
 #include "Mesh/Mesh.h"
+#include "Mesh/MeshArena.h"
+#include "RingBuffer.h"
+#include "CommandList.h"
 #include "glm/glm.hpp"
 #include <vector>
+#include <cstdint>
 #include "RenderPass.h"
 #include "Structs.h" 
+#include "Texture/TextureAtlas.h"
 
 enum RenderMode2D
 {
@@ -32,6 +37,18 @@ enum RendererMode
 	LOST_RENDER_3D
 };
 
+enum SubmissionMode
+{
+	// Every batch of identical meshes is drawn with it's own instanced draw call
+	LOST_SUBMIT_DIRECT,
+
+	// This is the DEFAULT setting Lost has the renderer set to on start up
+	// Batches which share the same shader, material and render state are gathered into one
+	// glMultiDrawElementsIndirect call, even if they use different meshes
+	// Only effects the 3D renderer
+	LOST_SUBMIT_INDIRECT
+};
+
 namespace lost
 {
 	
@@ -79,6 +96,14 @@ namespace lost
 	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
 	void _renderFullScreenQuadImmediate();
 
+	// Uploads the mesh into the renderer's persistent mesh arena, this only needs to be done once per mesh
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _uploadMesh(Mesh mesh);
+
+	// Frees the space the mesh took up inside of the renderer's mesh arena, ran when a mesh is unloaded
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _releaseMesh(Mesh mesh);
+
 	// Renders a quad to the screen, this is the same as renderRectPro but has a shader override
 	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
 	void _renderChar(Bounds2D bounds, Bounds2D texBounds = { 0.0f, 0.0f, 1.0f, 1.0f }, Material mat = nullptr, Shader shaderOverride = nullptr);
@@ -141,6 +166,13 @@ namespace lost
 	// Renders the texture to the screen in the area given
 	void renderTexture(Texture texture, float x, float y, float w = -1, float h = -1);
 
+	// Renders the sprite to the screen in the area given, by default at the sprite's size
+	void renderSprite(Sprite sprite, float x, float y, float w = -1, float h = -1);
+	// Renders the sprite to the screen, allows for rotation around the origin
+	void renderSpritePro(Sprite sprite, Bounds2D bounds, Vec2 origin, float angle);
+	// Renders each sprite into the area at the same index, sprites next to each other sharing a page are written as one batch
+	void renderSprites(const Sprite* sprites, const Bounds2D* bounds, unsigned int count);
+
 	// Renders a 2D line
 	void renderLine(float x1, float y1, float x2, float y2);
 	// Renders a 2D line
@@ -185,6 +217,39 @@ namespace lost
 	// Sets the current backface culling override, LOST_CULL_AUTO is default, which doesn't override material cull settings
 	void setCullMode(unsigned int cullMode);
 
+	// Sets how the renderer gives draw calls to OpenGL, follows the SubmissionMode enum, LOST_SUBMIT_INDIRECT is default
+	void setSubmissionMode(unsigned int submissionMode);
+
+	// Sets if meshes entirely outside of the camera's view are skipped before being queued, enabled by default
+	// Disabling this also disables distance culling
+	void setFrustumCulling(bool state);
+	// Sets the view depth past which meshes are skipped before being queued, 0 (the default) disables distance culling
+	void setCullDistance(float distance);
+
+	// [---------------]
+	//   Command Lists
+	// [---------------]
+
+	// Creates a command list, which lets meshes be recorded from other threads
+	CommandList createCommandList();
+	// Destroys the command list given, it must not be destroyed while it's submitted and the queue hasn't been rendered
+	void destroyCommandList(CommandList commandList);
+
+	// Clears the command list and sets it to record with the current camera's view and the renderer's culling settings
+	// Must be ran on the main thread before any thread records into it
+	void beginCommandList(CommandList commandList);
+
+	// Records the mesh into the command list, transforming and culling it on the thread this was ran on
+	// Safe to run on any thread, as long as no other thread is recording into the same command list
+	void recordMesh(CommandList commandList, Mesh mesh, const std::vector<Material>& materials, const glm::mat4x4& transform);
+	// Records the mesh into the command list using the position, rotation and scale given, see recordMesh()
+	void recordMesh(CommandList commandList, Mesh mesh, const std::vector<Material>& materials, Vec3 pos, Vec3 rotation = { 0.0f, 0.0f, 0.0f }, Vec3 scale = { 1.0f, 1.0f, 1.0f });
+
+	// Gives every mesh recorded into the command list to the renderer, must be ran on the main thread once every thread has finished recording
+	// The meshes are merged into the render queue and sorted with everything else the next time the queue is rendered (at the latest the end of the frame)
+	// The command list can't be began again until that has happened
+	void submitCommandList(CommandList commandList);
+
 	// Returns the OpenGL texture id of the render pass selected, by default getting the render texture of the window that's active
 	unsigned int getRenderTexture(unsigned int pass, unsigned int windowID = -1);
 	// Returns the OpenGL texture ids of the render passes used by a window, by default getting the render textures of the window that's active
@@ -204,11 +269,12 @@ namespace lost
 			bool depthWrite;
 			Shader shaderOverride;
 			bool invertCullMode;
+			bool quads; // If the raw mesh is made of quads using the shared quad index pattern
 
-			bool compare(const std::vector<Material>& _materials, const glm::mat4x4& _mvpTransform, const glm::mat4x4& _modelTransform, unsigned int _depthTestFuncOverride, bool _depthWrite, Shader _shaderOverride, bool _invertCullMode)
+			bool compare(const Material* _materials, unsigned int _materialCount, const glm::mat4x4& _mvpTransform, const glm::mat4x4& _modelTransform, unsigned int _depthTestFuncOverride, bool _depthWrite, Shader _shaderOverride, bool _invertCullMode)
 			{
 				// Check if the material array is the same
-				if (materials.size() != _materials.size())
+				if (materials.size() != _materialCount)
 					return false;
 
 				if (invertCullMode != _invertCullMode)
@@ -216,7 +282,7 @@ namespace lost
 
 				for (int i = 0; i < materials.size(); i++)
 				{
-					if (materials.at(i) != _materials.at(i))
+					if (materials[i] != _materials[i])
 						return false;
 				}
 
@@ -232,6 +298,16 @@ namespace lost
 				return mvpTransform == _mvpTransform;
 			}
 		};
+
+		// The layout OpenGL reads indirect draw commands in
+		struct DrawElementsIndirectCommand
+		{
+			unsigned int count;
+			unsigned int instanceCount;
+			unsigned int firstIndex;
+			int baseVertex;
+			unsigned int baseInstance;
+		};
 	public:
 		Renderer();
 		virtual ~Renderer();
@@ -242,6 +318,14 @@ namespace lost
 		// Sets the cull mode
 		void setCullMode(unsigned int cullMode);
 
+		// Sets the submission mode, follows the SubmissionMode enum
+		void setSubmissionMode(unsigned int submissionMode);
+
+		inline void setFrustumCulling(bool state)   { m_FrustumCulling = state; };
+		inline void setCullDistance(float distance) { m_CullDistance = distance; };
+		inline bool  getFrustumCulling() const      { return m_FrustumCulling; };
+		inline float getCullDistance()   const      { return m_CullDistance; };
+
 		// Generates the buffer objects used by the renderer, gets ran after the invisible context is created
 		void generateBufferObjects();
 
@@ -253,6 +337,20 @@ namespace lost
 		// Adds a mesh to the image queue and renders it if the conditions are met
 		virtual void addRawToQueue(CompiledMeshData& meshData, std::vector<Material>& materials, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride = LOST_DEPTH_TEST_AUTO, bool depthWrite = true, Shader shaderOverride = nullptr, bool invertCullMode = false);
 
+		// Stores the command list to be merged into the queue the next time it's rendered
+		virtual void submitCommandList(CommandList commandList);
+		// Adds every mesh recorded into the command list to the queue, they were already culled while being recorded
+		virtual void mergeCommandList(CommandList commandList);
+
+		// Returns space for "quadCount" quads inside of the stream buffer, 4 LOST_VERTEX_LAYOUT_2D verticies each ordered top left, top right, bottom right, bottom left
+		// The verticies are written to directly, the indicies come from a pattern made once at start up, nothing is allocated
+		// The memory is only valid until the next raw mesh is added
+		Vertex2D* addRawQuads(unsigned int quadCount, Material material, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride = LOST_DEPTH_TEST_AUTO, bool depthWrite = true, Shader shaderOverride = nullptr, bool invertCullMode = false);
+		// Returns space for "vertexCount" LOST_VERTEX_LAYOUT_2D verticies inside of the stream buffer, and sets "indexData" to space for "indexCount" indicies
+		// "indexBase" needs to be added to every index written, as the geometry may be appended to the last raw mesh
+		// Only LOST_MESH_POINTS, LOST_MESH_LINES and LOST_MESH_TRIANGLES are batched, the memory is only valid until the next raw mesh is added
+		Vertex2D* addRawGeometry(unsigned int renderMode, unsigned int vertexCount, unsigned int indexCount, unsigned int*& indexData, unsigned int& indexBase, Material material, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride = LOST_DEPTH_TEST_AUTO, bool depthWrite = true, Shader shaderOverride = nullptr, bool invertCullMode = false);
+
 		virtual void initRenderInstanceQueue();
 		// Renders the queue of meshes in the render queue
 		virtual void renderInstanceQueue();
@@ -300,6 +398,13 @@ namespace lost
 		// Used when rendering post processing shaders
 		void renderFullScreenQuadImmediate();
 
+		// Uploads the mesh into the mesh arena, after this the mesh's data is never sent to the GPU again
+		void uploadMesh(Mesh mesh);
+		// Frees the space the mesh took up inside of the mesh arena
+		void releaseMesh(Mesh mesh);
+
+		inline const _MeshArena& getMeshArena() const { return m_MeshArena; };
+
 		// Mesh Building
 
 		// The mesh used when running beingMesh and endMesh;
@@ -316,19 +421,69 @@ namespace lost
 		unsigned int m_CullMode = LOST_CULL_AUTO;
 		bool m_CullingEnabled = true; // Checks if culling is enabled, this is to reduce calls
 
+		bool m_FrustumCulling = true; // If meshes outside of the view frustum are skipped when queued
+		float m_CullDistance = 0.0f; // The view depth past which meshes are skipped when queued, 0 if disabled
+
+		std::vector<CommandList> m_SubmittedCommandLists; // Merged into the queue in the order they were submitted
+		std::vector<Material> m_MergeMaterials; // Reused when merging command lists to avoid reallocating
+
 		CompiledMeshData* m_RawMeshInstance = nullptr; // Is set to the last raw mesh rendered, reset on queue render
 		RawMeshBuffer m_RawMeshBuffer; // Stores the settings of the last raw mesh rendered
 
+		// Raw meshes are reused every queue, only the first m_RawMeshCount are in use
+		// Their data is written straight into m_StreamVertexData and m_StreamIndexData rather than their own vectors
 		std::vector<CompiledMeshData*> m_RawMeshes;
+		unsigned int m_RawMeshCount = 0;
+
+		// Returns the raw mesh the geometry described should be written into, continuing the last one when the settings match
+		// Queues the last raw mesh and starts a new one otherwise
+		CompiledMeshData* getRawMesh(unsigned int renderMode, unsigned int vertexLayout, bool quads, unsigned int quadCount, const Material* materials, unsigned int materialCount, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode);
+
+		// Uploads every raw mesh into the stream buffers (VBO and EBO) in one go
+		// The quad index pattern at the start of the EBO is only uploaded once
+		void streamRawMeshes();
+		// Binds the buffers the mesh was uploaded to, either the mesh arena or the stream buffers, and sets up it's vertex layout
+		// Only rebinds if the mesh uses a different buffer or layout to the last one bound, unless "force" is true
+		void bindMeshBuffers(const CompiledMeshData* mesh, bool force = false);
+		// Sets the formats of the vertex attributes on the bound VAO to the layout given, follows the VertexLayout enum
+		// The stride is part of the buffer binding, so it's set by bindMeshBuffers()
+		void bindVertexLayout(unsigned int vertexLayout);
+		// Draws the range of indicies given of the mesh, using the instances starting at baseInstance in the instance ring buffer
+		void drawMeshInstanced(const CompiledMeshData* mesh, unsigned int startIndex, unsigned int indexCount, unsigned int instanceCount, unsigned int baseInstance);
+		// Returns mapped memory for "instanceCount" instances, stored as { mvp, model } pairs, which can be written to directly
+		// "baseInstance" is set to the instance to draw them with, the memory is only valid until the next allocation
+		// Each instance also has a material index for shaders using material batching, "materialIndices" is set to them if given, otherwise they're zeroed
+		glm::mat4x4* allocateInstances(unsigned int instanceCount, unsigned int& baseInstance, unsigned int** materialIndices = nullptr);
+
+		// Draws the batch given, when using LOST_SUBMIT_INDIRECT the batch is queued until flushDraws() is ran
+		// Every batch submitted between flushes must share the same state, buffers and render mode
+		void submitDraw(const CompiledMeshData* mesh, unsigned int startIndex, unsigned int indexCount, unsigned int instanceCount, unsigned int baseInstance);
+		// Draws every batch queued by submitDraw() in one glMultiDrawElementsIndirect call
+		void flushDraws();
+
+		unsigned int m_SubmissionMode = LOST_SUBMIT_INDIRECT;
+		std::vector<DrawElementsIndirectCommand> m_IndirectCommands; // Reused every flush to avoid reallocating
+		unsigned int m_IndirectRenderMode = LOST_MESH_TRIANGLES; // The render mode every queued command uses
+		_RingBuffer m_IndirectRing; // GPU side command buffer, persistently mapped and triple buffered
+
+		std::vector<char> m_StreamVertexData; // Reused every queue to avoid reallocating, each raw mesh is stored in it's own vertex layout
+		std::vector<unsigned int> m_StreamIndexData; // Reused every queue to avoid reallocating, starts with the quad index pattern
+		unsigned int m_QuadPatternSize = 0; // The amount of indicies at the start of m_StreamIndexData used by the quad pattern
+		unsigned int m_StreamIndexCapacity = 0; // The amount of indicies the EBO can hold before being reallocated
+		int m_BoundMeshBuffer = -1; // 1 if the mesh arena is bound, 0 if the stream buffers are bound, -1 if unknown
+		unsigned int m_BoundVertexLayout = LOST_VERTEX_LAYOUT_FULL; // The vertex layout the bound VAO is set up for
+
+		_MeshArena m_MeshArena; // Persistent storage for every loaded mesh
 
 		std::vector<RenderPass> m_MainRenderPasses;
 		RenderPass m_CurrentRenderPass = nullptr;
 
 		unsigned int m_EmptyVAO = 0; // The invisible windows VAO
 		std::vector<unsigned int> VAOs; // One per window
-		unsigned int VBO; // Vertex Buffer Object
-		unsigned int MBO; // Matrix Buffer Object
-		unsigned int EBO; // Element Buffer Object
+		unsigned int VBO; // Vertex Buffer Object, only used to stream raw meshes
+		_RingBuffer m_InstanceRing; // Matrix Buffer Object, persistently mapped and triple buffered
+		_RingBuffer m_MaterialRing; // Material buffer for shaders using material batching, persistently mapped and triple buffered
+		unsigned int EBO; // Element Buffer Object, only used to stream raw meshes
 	};
 
 	class Renderer2D : public Renderer
@@ -342,6 +497,9 @@ namespace lost
 		// Adds a mesh to the image queue and renders it if the conditions are met
 		virtual void addRawToQueue(CompiledMeshData& meshData, std::vector<Material>& materials, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride = LOST_DEPTH_TEST_AUTO, bool depthWrite = true, Shader shaderOverride = nullptr, bool invertCullMode = false);
 
+		// Merges the command list straight away, as the 2D renderer never sorts it's queue
+		virtual void submitCommandList(CommandList commandList);
+
 		// Renders the queue of meshes in the render queue
 		virtual void renderInstanceQueue();
 
@@ -353,7 +511,7 @@ namespace lost
 		Mesh m_CurrentMeshID = nullptr;
 		Material m_CurrentMaterial = nullptr;
 		unsigned int m_CurrentIndexOffset = -1;
-		std::vector<glm::mat4x4> m_TransformArray;
+		std::vector<glm::mat4x4> m_TransformArray; // Stored as { mvp, model } pairs
 	};
 
 	class Renderer3D : public Renderer
@@ -362,84 +520,71 @@ namespace lost
 		
 		struct MeshRenderData
 		{
-			Mesh mesh;
-
-			Material material;
+			// Handles instead of pointers, so items whose resources were destroyed after being queued can be found and dropped
+			ResourceHandle mesh;
+			ResourceHandle material;
+			ResourceHandle shader; // The shader override if one was given, otherwise the material's shader
 
 			unsigned int startIndex;
 			unsigned int indicies;
 
-			float depthVal;
+			bool batched;            // If the shader uses material batching
+			unsigned int batchIndex; // The material's index in the queue's material buffer when batched
 
-			glm::mat4x4 mvpTransform;
-			glm::mat4x4 modelTransform;
+			float depthVal; // The view depth found when the mesh's bounds were culled, used by the sort key
 
 			unsigned int cullMode = LOST_CULL_AUTO;
 			unsigned int ZSortMode = LOST_ZSORT_NORMAL;
 			unsigned int depthMode = LOST_DEPTH_TEST_LESS;
 			unsigned int renderMode = LOST_MESH_TRIANGLES;
 			bool depthWrite = true;
-
-			Shader shaderOverride = nullptr;
-
-			bool depthComp(MeshRenderData& other) const
-			{
-				return other.depthVal > depthVal;
-			}
-
-			Shader getShader() const
-			{
-				return shaderOverride ? shaderOverride : material->getShader();
-			}
 		};
 
-		static bool meshSortFunc(const MeshRenderData& lhs, const MeshRenderData& rhs)
+		// A queued item's sort key alongside where its MeshRenderData is stored
+		// Only these get moved around while sorting, the render data itself stays where it was queued
+		struct QueueItem
 		{
-			// Check if ZSorting is disabled
-			if (lhs.ZSortMode == LOST_ZSORT_NONE || rhs.ZSortMode == LOST_ZSORT_NONE)
-				return false;
-			// Check if ZSorting is done by depth
-			if (lhs.ZSortMode == LOST_ZSORT_DEPTH || rhs.ZSortMode == LOST_ZSORT_DEPTH)
-				return (lhs.depthVal < rhs.depthVal);
-
-			// Normal ZSorting
-
-			// [!] TODO: Remove this and replace with LOST_ZSORT_NONE
-			if (lhs.depthMode == LOST_DEPTH_TEST_ALWAYS || rhs.depthMode == LOST_DEPTH_TEST_ALWAYS)
-			{
-				// No batching when using LOST_DEPTH_TEST_ALWAYS
-				// This is to preserve order when rendering
-				return false;
-			}
+			uint64_t key;
+			unsigned int index;
+		};
 
-			// Normal, has batching
-			if (lhs.material->getQueueLevel() != rhs.material->getQueueLevel())
-				return lhs.material->getQueueLevel() < rhs.material->getQueueLevel();
-			if (lhs.getShader() != rhs.getShader())
-				return lhs.getShader() < rhs.getShader();
-			if (lhs.material != rhs.material)
-				return lhs.material < rhs.material;
-			if (lhs.mesh != rhs.mesh)
-				return lhs.mesh < rhs.mesh;
-			if (lhs.startIndex != rhs.startIndex)
-				return lhs.startIndex < rhs.startIndex;
-
-			// Ordered from most commonly to least commonly used
-			if (lhs.cullMode != rhs.cullMode)
-				return lhs.cullMode < rhs.cullMode;
-			if (lhs.depthMode != rhs.depthMode)
-				return lhs.depthMode < rhs.depthMode;
-			if (lhs.depthWrite != rhs.depthWrite)
-				return lhs.depthWrite < rhs.depthWrite;
-
-			return (lhs.depthVal < rhs.depthVal);
-		}
+		// Builds the sort key of the render data given, "material" being the material it uses and "materialSlot" the slot of the mesh it renders
+		// Keys are laid out (from the most significant bit) as:
+		//  [63..52] Queue level
+		//  [51..42] Shader id
+		//  [41..31] Material id, or a hash of the texture pages used for materials using material batching
+		//  [30..20] Mesh id
+		//  [19..16] Material slot
+		//  [15..14] Cull mode
+		//  [13..11] Depth test function
+		//  [10]     Depth write
+		//  [9..0]   Quantized view depth, nearest first
+		// Ordered items (LOST_DEPTH_TEST_ALWAYS or LOST_ZSORT_NONE) use their sequence number as the whole key
+		// The queue is split into segments whenever it switches between ordered and batched items, see m_SegmentStarts
+		// LOST_ZSORT_DEPTH items replace the shader, material, mesh and slot ids with their view depth, furthest first
+		// The ids are the low bits of the resources' handle slots, which only collide with more resources alive than the ids can hold
+		// Collisions only cost batching as the queue still compares the full handles
+		uint64_t makeSortKey(const MeshRenderData& renderData, Material material, unsigned int materialSlot);
+
+		// Removes the items from m_QueueItems whose mesh, material or shader was destroyed after they were queued
+		void dropStaleItems();
+
+		// Sorts each segment of m_QueueItems by key with a stable LSD radix sort
+		void sortQueue();
+		// Sorts "itemCount" items of m_QueueItems from "start", passes where every key shares the same byte are skipped
+		void sortQueueRange(size_t start, size_t itemCount);
+
+		// Adds a render data entry to the queue for each of the mesh's material slots, the mesh must have already been culled
+		void queueMesh(Mesh mesh, const Material* materials, unsigned int materialCount, float depthVal, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride, bool depthWrite, Shader shaderOverride, bool invertCullMode);
 	public:
 		Renderer3D();
 		virtual ~Renderer3D();
 
 		// Adds a mesh to the image queue and renders it if the conditions are met
 		virtual void addMeshToQueue(Mesh mesh, std::vector<Material>& materials, const glm::mat4x4& mvpTransform, const glm::mat4x4& modelTransform, unsigned int depthTestFuncOverride = LOST_DEPTH_TEST_AUTO, bool depthWrite = true, Shader shaderOverride = nullptr, bool invertCullMode = false);
+
+		// Adds every mesh recorded into the command list to the queue without culling them again
+		virtual void mergeCommandList(CommandList commandList);
 		
 		// Renders the queue of meshes in the render queue
 		virtual void renderInstanceQueue();
@@ -451,5 +596,18 @@ namespace lost
 		virtual void renderMesh(Mesh mesh, glm::mat4x4& transform);
 	private:
 		std::vector<MeshRenderData> m_MainRenderData;
+		// The mvp then model transform of each item in m_MainRenderData, kept apart so the state compared while batching stays small
+		std::vector<glm::mat4x4> m_MainTransforms;
+
+		std::vector<QueueItem> m_QueueItems;
+		std::vector<QueueItem> m_QueueScratch; // Ping pong buffer for sortQueue()
+
+		std::vector<unsigned int> m_SegmentStarts; // Where each segment of m_QueueItems after the first starts, see makeSortKey()
+		unsigned int m_SortSequence = 0; // The amount of items queued, used to keep ordered items in order
+		bool m_LastItemOrdered = false;  // If the last item queued had to keep it's order
+		unsigned int m_QueueReleaseCount = 0; // The amount of handles released when the queue started, see _getHandleReleaseCount()
+
+		std::vector<BatchedMaterialData> m_BatchMaterials; // Every material using material batching this queue, uploaded when the queue is rendered
+		unsigned int m_BatchStamp = 0; // Identifies this queue to materials, see _Material::getBatchStamp()
 	};
 }
\ No newline at end of file
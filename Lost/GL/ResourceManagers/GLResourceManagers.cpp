@@ -1,6 +1,11 @@
 #include "GLResourceManagers.h"
 #include "../LostGL.h"
-#include <unordered_map>
+#include "../DeferredDestroy.h"
+#include "../Mesh/MeshCache.h"
+#include "../Mesh/ObjParser.h"
+#include "../../AsyncLoader.h"
+#include "../../MappedFile.h"
+#include "../../Parallel.h"
 #include <iostream>
 #include <algorithm>
 //#include <hash_set>
@@ -20,42 +25,11 @@ static std::vector<std::string> split(const std::string& s, char delim) {
 	return elems;
 }
 
-struct IndexData
-{
-	int vertex;
-	int texcoord;
-	int normal;
-	std::size_t hash = 0;
-
-	IndexData(int _vertex, int _texcoord, int _normal)
-	{
-		vertex = _vertex;
-		texcoord = _texcoord;
-		normal = _normal;
-		hash = ((std::hash<int>()(vertex)
-			^ (std::hash<int>()(texcoord) << 1)) >> 1)
-			^ (std::hash<int>()(normal) << 1);
-	};
-
-	bool operator==(const IndexData& other) const
-	{
-		return vertex == other.vertex && texcoord == other.texcoord && normal == other.normal;
-	}
-};
-
-template <>
-struct std::hash<IndexData>
-{
-	std::size_t operator()(const IndexData& k) const
-	{
-		return k.hash;
-	}
-};
-
 namespace lost
 {
 
 	ResourceManager<Texture>* _textureRM = nullptr;
+	ResourceManager<Sprite>* _spriteRM = nullptr;
 	ResourceManager<Material>* _materialRM = nullptr;
 	ResourceManager<Shader>* _shaderRM = nullptr;
 	ResourceManager<PostProcessingShader>* _postProcessingShaderRM = nullptr;
@@ -64,18 +38,21 @@ namespace lost
 
 	void _initRMs()
 	{
-		_textureRM = new ResourceManager<Texture>("Textures");
-		_materialRM = new ResourceManager<Material>("Materials");
-		_shaderRM = new ResourceManager<Shader>("Shaders");
-		_meshRM = new ResourceManager<Mesh>("Meshes");
-		_fontRM = new ResourceManager<Font>("Fonts");
-		_postProcessingShaderRM = new ResourceManager<PostProcessingShader>("Post-processing Shaders");
+		// Unloaded resources are only destroyed once the GPU has finished the frame, as queued draws may still use them
+		_textureRM = new ResourceManager<Texture>("Textures", &_deferResourceDestroy<Texture>);
+		_spriteRM = new ResourceManager<Sprite>("Sprites", &_deferResourceDestroy<Sprite>);
+		_materialRM = new ResourceManager<Material>("Materials", &_deferResourceDestroy<Material>);
+		_shaderRM = new ResourceManager<Shader>("Shaders", &_deferResourceDestroy<Shader>);
+		_meshRM = new ResourceManager<Mesh>("Meshes", &_deferResourceDestroy<Mesh>);
+		_fontRM = new ResourceManager<Font>("Fonts", &_deferResourceDestroy<Font>);
+		_postProcessingShaderRM = new ResourceManager<PostProcessingShader>("Post-processing Shaders", &_deferResourceDestroy<PostProcessingShader>);
 	}
 
 	void _destroyRMs()
 	{
 		delete _fontRM;
 		delete _textureRM;
+		delete _spriteRM;
 		delete _materialRM;
 		delete _shaderRM;
 		delete _postProcessingShaderRM;
@@ -103,6 +80,25 @@ namespace lost
 		return tex;
 	}
 
+	Texture loadTextureAsync(const char* fileLocation, const char* id)
+	{
+		lost::Texture tex = nullptr;
+
+		// If "id" is nullptr set it to the filename
+		if (!id) id = fileLocation;
+
+		if (!_textureRM->hasValue(id))
+		{
+			tex = new lost::_Texture();
+			tex->loadTextureAsync(fileLocation);
+		}
+		else
+			tex = _textureRM->getValue(id);
+
+		_textureRM->addValue(tex, id);
+		return tex;
+	}
+
 	Texture makeTexture(const char* data, int width, int height, const char* id, unsigned int format)
 	{
 		lost::Texture tex = nullptr;
@@ -140,6 +136,11 @@ namespace lost
 		return _textureRM->getValue(id);
 	}
 
+	Texture getTexture(ResourceID id)
+	{
+		return _textureRM->getValue(id);
+	}
+
 	void unloadTexture(const char* id)
 	{
 		_textureRM->destroyValue(id);
@@ -167,6 +168,75 @@ namespace lost
 
 #pragma endregion
 
+#pragma region Sprite
+
+	Sprite loadSprite(const char* fileLocation, const char* id)
+	{
+		lost::Sprite sprite = nullptr;
+
+		// If "id" is nullptr set it to the filename
+		if (!id) id = fileLocation;
+
+		if (!_spriteRM->hasValue(id))
+		{
+			sprite = new lost::_Sprite();
+			sprite->loadSprite(fileLocation);
+		}
+		else
+			sprite = _spriteRM->getValue(id);
+
+		_spriteRM->addValue(sprite, id);
+		return sprite;
+	}
+
+	Sprite makeSprite(const unsigned char* data, int width, int height, const char* id)
+	{
+		lost::Sprite sprite = nullptr;
+
+		if (!_spriteRM->hasValue(id))
+		{
+			sprite = new lost::_Sprite();
+			sprite->makeSprite(data, width, height);
+		}
+		else
+			sprite = _spriteRM->getValue(id);
+
+		_spriteRM->addValue(sprite, id);
+		return sprite;
+	}
+
+	Sprite getSprite(const char* id)
+	{
+		return _spriteRM->getValue(id);
+	}
+
+	Sprite getSprite(ResourceID id)
+	{
+		return _spriteRM->getValue(id);
+	}
+
+	void unloadSprite(const char* id)
+	{
+		_spriteRM->destroyValue(id);
+	}
+
+	void unloadSprite(Sprite sprite)
+	{
+		_spriteRM->destroyValueByValue(sprite);
+	}
+
+	void forceUnloadSprite(const char* id)
+	{
+		_spriteRM->forceDestroyValue(id);
+	}
+
+	void forceUnloadSprite(Sprite sprite)
+	{
+		_spriteRM->forceDestroyValueByValue(sprite);
+	}
+
+#pragma endregion
+
 #pragma region Material
 	Material makeMaterial(std::vector<Texture> textures, const char* id, Shader shader, unsigned int renderQueue)
 	{
@@ -189,6 +259,11 @@ namespace lost
 		return _materialRM->getValue(id);
 	}
 
+	Material getMateral(ResourceID id)
+	{
+		return _materialRM->getValue(id);
+	}
+
 	std::vector<Material> loadMaterialsFromOBJMTL(const char* objFileLoc)
 	{
 		// We need to load the OBJ file to preserve the order that the materials are in in the .obj
@@ -373,6 +448,11 @@ namespace lost
 		return _shaderRM->getValue(id);
 	}
 
+	Shader getShader(ResourceID id)
+	{
+		return _shaderRM->getValue(id);
+	}
+
 	void unloadShader(const char* id)
 	{
 		_shaderRM->destroyValue(id);
@@ -428,6 +508,11 @@ namespace lost
 		return _postProcessingShaderRM->getValue(id);
 	}
 
+	PostProcessingShader getPostProcessingShader(ResourceID id)
+	{
+		return _postProcessingShaderRM->getValue(id);
+	}
+
 	void destroyPostProcessingShader(const char* id)
 	{
 		_postProcessingShaderRM->destroyValue(id);
@@ -452,13 +537,98 @@ namespace lost
 
 #pragma region Mesh
 
+	// A value a triangle adds to one of it's verticies, kept for the thread that owns the vertex to add it later
+	template <typename Value>
+	struct VertexContribution
+	{
+		unsigned int vertex;
+		Value value;
+	};
+
+	// Adds triangleValue(firstIndex) onto sums[] of each of the triangle's 3 verticies, for every triangle in indices
+	// The triangles are split into ranges worked on at the same time, and each range owns a range of verticies only it writes to
+	// Since meshes mostly index verticies close to the triangles using them, most sums are written straight away,
+	// while the rest are handed to the owning range and added once every range is done
+	template <typename Value, typename TriangleFunction>
+	static void accumulatePerVertex(const std::vector<unsigned int>& indices, size_t vertexCount, Value* sums, TriangleFunction triangleValue)
+	{
+		size_t triangleCount = indices.size() / 3;
+		unsigned int rangeCount = _parallelRangeCount(triangleCount, 16384);
+
+		if (rangeCount == 1)
+		{
+			for (size_t i = 0; i < triangleCount * 3; i += 3)
+			{
+				Value value = triangleValue(i);
+				sums[indices[i    ]] += value;
+				sums[indices[i + 1]] += value;
+				sums[indices[i + 2]] += value;
+			}
+			return;
+		}
+
+		// Each range owns the verticies past the largest one used by the ranges before it
+		std::vector<unsigned int> largestVertex(rangeCount, 0);
+		_parallelRanges(rangeCount, triangleCount, [&](size_t begin, size_t end, unsigned int range)
+		{
+			unsigned int largest = 0;
+			for (size_t i = begin * 3; i < end * 3; i++)
+				largest = std::max(largest, indices[i]);
+			largestVertex[range] = largest;
+		});
+
+		std::vector<size_t> ownedStarts(rangeCount + 1, vertexCount);
+		ownedStarts[0] = 0;
+		for (unsigned int range = 1; range < rangeCount; range++)
+			ownedStarts[range] = std::min(std::max(ownedStarts[range - 1], (size_t)largestVertex[range - 1] + 1), vertexCount);
+
+		// outboxes[range * rangeCount + owner] holds what "range" added to verticies "owner" owns
+		std::vector<std::vector<VertexContribution<Value>>> outboxes(rangeCount * rangeCount);
+		_parallelRanges(rangeCount, triangleCount, [&](size_t begin, size_t end, unsigned int range)
+		{
+			size_t ownedStart = ownedStarts[range];
+			size_t ownedEnd = ownedStarts[range + 1];
+
+			for (size_t i = begin * 3; i < end * 3; i += 3)
+			{
+				Value value = triangleValue(i);
+				for (size_t corner = i; corner < i + 3; corner++)
+				{
+					unsigned int vertex = indices[corner];
+					if (vertex >= ownedStart && vertex < ownedEnd)
+					{
+						sums[vertex] += value;
+						continue;
+					}
+
+					unsigned int owner = (unsigned int)(std::upper_bound(ownedStarts.begin(), ownedStarts.end() - 1, (size_t)vertex) - ownedStarts.begin()) - 1;
+					outboxes[range * rangeCount + owner].push_back({ vertex, value });
+				}
+			}
+		});
+
+		_parallelRanges(rangeCount, rangeCount, [&](size_t firstOwner, size_t lastOwner, unsigned int)
+		{
+			for (size_t owner = firstOwner; owner < lastOwner; owner++)
+				for (unsigned int range = 0; range < rangeCount; range++)
+					for (const VertexContribution<Value>& contribution : outboxes[range * rangeCount + owner])
+						sums[contribution.vertex] += contribution.value;
+		});
+	}
+
 	void _generateNormals(std::vector<Vertex>* verticies, const std::vector<unsigned int>& indices)
 	{
-		for (int i = 0; i < indices.size(); i += 3)
+		std::vector<Vertex>& vertices = *verticies;
+
+		std::vector<Vec3> normals(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+			normals[i] = vertices[i].vertexNormal;
+
+		accumulatePerVertex(indices, vertices.size(), normals.data(), [&](size_t i)
 		{
-			Vec3 p1 = (*verticies)[indices[i    ]].position;
-			Vec3 p2 = (*verticies)[indices[i + 1]].position;
-			Vec3 p3 = (*verticies)[indices[i + 2]].position;
+			Vec3 p1 = vertices[indices[i    ]].position;
+			Vec3 p2 = vertices[indices[i + 1]].position;
+			Vec3 p3 = vertices[indices[i + 2]].position;
 
 			Vec3 U = p2 - p1;
 			Vec3 V = p3 - p1;
@@ -470,26 +640,37 @@ namespace lost
 				U.x * V.y - U.y * V.x
 			};
 			normal.normalize();
+			return normal;
+		});
 
-			(*verticies)[indices[i    ]].vertexNormal += normal;
-			(*verticies)[indices[i + 1]].vertexNormal += normal;
-			(*verticies)[indices[i + 2]].vertexNormal += normal;
-		}
-
-		for (Vertex& v : *verticies)
-			v.vertexNormal.normalize();
+		_parallelRanges(_parallelRangeCount(vertices.size(), 16384), vertices.size(), [&](size_t begin, size_t end, unsigned int)
+		{
+			for (size_t i = begin; i < end; i++)
+				vertices[i].vertexNormal = normals[i].normalized();
+		});
 	}
 
+	// The sums of the s and t directions of every triangle using a vertex
+	struct TangentSums
+	{
+		Vec3 s;
+		Vec3 t;
+
+		void operator+=(const TangentSums& rhs)
+		{
+			s += rhs.s;
+			t += rhs.t;
+		}
+	};
+
 	void _generateTangents(std::vector<Vertex>* verticies, const std::vector<unsigned int>& indices)
 	{
 		size_t vertexCount = verticies->size();
 		std::vector<Vertex>& vertices = *verticies; // Spelled correctly
 
-		Vec3* tan1 = new Vec3[vertexCount * 2];
-		Vec3* tan2 = tan1 + vertexCount;
-		memset(tan1, 0, vertexCount * sizeof(Vec3) * 2);
-		unsigned int indexCount = (unsigned int)indices.size();
-		for (unsigned int a = 0; a < indexCount; a += 3) {
+		std::vector<TangentSums> tangents(vertexCount);
+		accumulatePerVertex(indices, vertexCount, tangents.data(), [&](size_t a)
+		{
 			long i1 = indices[a];
 			long i2 = indices[a + 1];
 			long i3 = indices[a + 2];
@@ -510,27 +691,26 @@ namespace lost
 			float t1 = w2.y - w1.y;
 			float t2 = w3.y - w1.y;
 			float r = 1.0F / (s1 * t2 - s2 * t1);
-			Vec3 sdir((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
-			Vec3 tdir((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r);
-			tan1[i1] += sdir;
-			tan1[i2] += sdir;
-			tan1[i3] += sdir;
-			tan2[i1] += tdir;
-			tan2[i2] += tdir;
-			tan2[i3] += tdir;
-		}
-		for (unsigned int a = 0; a < vertexCount; a++) {
-			const Vec3& n = vertices[a].vertexNormal;
-			const Vec3& t = tan1[a];
-			const glm::vec3 nglm = n.getGLM();
-			const glm::vec3 tglm = t.getGLM();
-			const glm::vec3 tan2glm = tan2[a].getGLM();
-			// Gram-Schmidt orthogonalize
-			vertices[a].vertexTangent = Vec4((t - n * n.dot(t)).normalized(), 0.0f);
-			// Calculate handedness (direction of bitangent)
-			vertices[a].vertexTangent.w = (glm::dot(glm::cross(nglm, tglm), tan2glm)) < 0.0F ? 1.0F : -1.0F;
-		}
-		delete[] tan1;
+			TangentSums sums;
+			sums.s = Vec3((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
+			sums.t = Vec3((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r);
+			return sums;
+		});
+
+		_parallelRanges(_parallelRangeCount(vertexCount, 16384), vertexCount, [&](size_t begin, size_t end, unsigned int)
+		{
+			for (size_t a = begin; a < end; a++) {
+				const Vec3& n = vertices[a].vertexNormal;
+				const Vec3& t = tangents[a].s;
+				const glm::vec3 nglm = n.getGLM();
+				const glm::vec3 tglm = t.getGLM();
+				const glm::vec3 tan2glm = tangents[a].t.getGLM();
+				// Gram-Schmidt orthogonalize
+				vertices[a].vertexTangent = Vec4((t - n * n.dot(t)).normalized(), 0.0f);
+				// Calculate handedness (direction of bitangent)
+				vertices[a].vertexTangent.w = (glm::dot(glm::cross(nglm, tglm), tan2glm)) < 0.0F ? 1.0F : -1.0F;
+			}
+		});
 	}
 
 	const char* _getShaderID(Shader shader)
@@ -538,7 +718,30 @@ namespace lost
 		return _shaderRM->getIDByValue(shader);
 	}
 
-	Mesh loadMesh(const char* objLoc, const char* id)
+	Mesh loadMesh(const char* objLoc, const char* id, unsigned int vertexLayout)
+	{
+		lost::Mesh mesh = nullptr;
+
+		// If "id" is nullptr set it to the filename
+		if (!id) id = objLoc;
+
+		std::string loc = objLoc;
+
+		if (!_meshRM->hasValue(id))
+		{
+			if (loc.substr(loc.size() - 3, 3) == "obj")
+				mesh = _loadMeshOBJ(objLoc, vertexLayout);
+			else
+				debugLog("Object file type not supported! \"" + loc + "\" Currently Lost only supports .obj", LOST_LOG_ERROR);
+		}
+		else
+			mesh = _meshRM->getValue(id);
+
+		_meshRM->addValue(mesh, id);
+		return mesh;
+	}
+
+	Mesh loadMeshAsync(const char* objLoc, const char* id, unsigned int vertexLayout)
 	{
 		lost::Mesh mesh = nullptr;
 
@@ -550,7 +753,7 @@ namespace lost
 		if (!_meshRM->hasValue(id))
 		{
 			if (loc.substr(loc.size() - 3, 3) == "obj")
-				mesh = _loadMeshOBJ(objLoc);
+				mesh = _loadMeshOBJAsync(objLoc, vertexLayout);
 			else
 				debugLog("Object file type not supported! \"" + loc + "\" Currently Lost only supports .obj", LOST_LOG_ERROR);
 		}
@@ -581,6 +784,12 @@ namespace lost
 			// Copy material take over inducies
 			((CompiledMeshData*)mesh)->materialSlotIndicies.insert(((CompiledMeshData*)mesh)->materialSlotIndicies.begin(), meshData.materialSlotIndicies.begin(), meshData.materialSlotIndicies.end());
 
+			((CompiledMeshData*)mesh)->vertexLayout = meshData.vertexLayout;
+			((CompiledMeshData*)mesh)->bounds = _calculateMeshBounds(((CompiledMeshData*)mesh)->vertexData);
+
+			// Upload the mesh to the GPU once, the renderer only binds offsets into it from now on
+			_uploadMesh(mesh);
+
 			debugLog(std::string("Successfully created new mesh with ") + std::to_string(meshData.verticies.size()) + " verticies", LOST_LOG_SUCCESS);
 		}
 		else
@@ -595,6 +804,11 @@ namespace lost
 		return _meshRM->getValue(id);
 	}
 
+	Mesh getMesh(ResourceID id)
+	{
+		return _meshRM->getValue(id);
+	}
+
 	void unloadMesh(const char* id)
 	{
 		_meshRM->destroyValue(id);
@@ -615,175 +829,60 @@ namespace lost
 		_meshRM->forceDestroyValueByValue(mesh);
 	}
 
-	Mesh _loadMeshOBJ(const char* objLoc)
+	void setMeshVertexLayout(Mesh mesh, unsigned int vertexLayout)
 	{
-
-		// Load file
-		std::string meshFile = loadfile(objLoc);
-
-		std::vector<std::string> fileLines = split(meshFile, '\n');
-
-#ifdef LOST_DEBUG_MODE
-		int processingLine = 0;
-		int fileLength = fileLines.size();
-		int percentAcross = 0;
-		if (fileLength > 10000)
-			std::cout << "\x1B[38;2;100;150;255m[ Info ] Loading large object (\"" << std::string(objLoc) << "\")\x1B[0m |          |\b\b\b\b\b\b\b\b\b\b\b";
-#endif
-
-		std::unordered_map<std::string, int> vertexIndexMap;
-		vertexIndexMap.reserve(fileLines.size());
-
-		std::vector<Vec4> vertexData;
-		std::vector<Vec3> normalData;
-		std::vector<Vec3> textureData;
-		vertexData.reserve(fileLines.size());
-		normalData.reserve(fileLines.size());
-		textureData.reserve(fileLines.size());
-
-		MeshData meshData = {};
-
-		for (std::string& line : fileLines)
+		if (vertexLayout >= LOST_VERTEX_LAYOUT_COUNT)
 		{
-			std::vector<std::string> tokens = split(line, ' ');
-
-#ifdef LOST_DEBUG_MODE
-			if (fileLength > 10000)
-			{
-				processingLine++;
-
-				if ((processingLine * 100 / fileLength) >= percentAcross + 1)
-				{
-					percentAcross++;
-					if (percentAcross % 10 == 0)
-					{
-						if (percentAcross == 100)
-							std::cout << "\b\xB0\xB2\b\b\b\b\b\b\b\b\b\b\xB2\xB1 DONE \xB1\xB2\n";
-						else if (percentAcross <= 10)
-							std::cout << "\xB2";
-						else
-							std::cout << "\b\xB0\xB2";
-					}
-				}
-			}
-#endif
-
-			if (tokens.size() > 0)
-			{
-
-				// All of these are done before the faces
-				if (tokens[0] == "v")
-				{
-#ifdef LOST_DEBUG_MODE
-					if (tokens.size() < 4 || tokens.size() > 5)
-					{
-						debugLog(std::string("Malformed .obj file, \"") + objLoc + "\" vertex with less than 3 or more than 4 floats", LOST_LOG_ERROR);
-						Vec4 vertex = { 0.0f, 0.0f, 0.0f, 0.0f };
-						vertexData.push_back(vertex);
-						continue;
-					}
-#endif
-					Vec4 vertex = { std::stof(tokens[1]), std::stof(tokens[2]), std::stof(tokens[3]), tokens.size() == 5 ? std::stof(tokens[4]) : 1.0f };
-					vertexData.push_back(vertex);
-					continue;
-				}
+			debugLog("Vertex layout enum out of bounds, keeping the mesh's current layout", LOST_LOG_WARNING);
+			return;
+		}
 
-				if (tokens[0] == "vn")
-				{
-#ifdef LOST_DEBUG_MODE
-					if (tokens.size() != 4)
-					{
-						debugLog(std::string("Malformed .obj file, \"") + objLoc + "\" normal with more or less than 3 floats", LOST_LOG_ERROR);
-						Vec3 normal = { 0.0f, 0.0f, 0.0f };
-						normalData.push_back(normal);
-						continue;
-					}
-#endif
-					Vec3 normal = { std::stof(tokens[1]), std::stof(tokens[2]), std::stof(tokens[3]) };
-					normalData.push_back(normal);
-					continue;
-				}
+		CompiledMeshData* meshData = (CompiledMeshData*)mesh;
+		if (meshData->vertexLayout == vertexLayout)
+			return;
 
-				if (tokens[0] == "vt")
-				{
-#ifdef LOST_DEBUG_MODE
-					if (tokens.size() < 2 || tokens.size() > 4)
-					{
-						debugLog(std::string("Malformed .obj file, \"") + objLoc + "\" normal with less than 1 or more than 3 floats", LOST_LOG_ERROR);
-						Vec3 texture = { 0.0f, 0.0f, 0.0f };
-						textureData.push_back(texture);
-						continue;
-					}
-#endif
-					Vec3 texture = { std::stof(tokens[1]), tokens.size() >= 3 ? std::stof(tokens[2]) : 0.0f, tokens.size() >= 4 ? std::stof(tokens[3]) : 0.0f };
-					textureData.push_back(texture);
-					continue;
-				}
+		// Meshes still loading are uploaded with whatever layout they have once they're done
+		if (meshData->loading)
+		{
+			meshData->vertexLayout = vertexLayout;
+			return;
+		}
 
-				// Faces, turn arbitrary data into verticies
-				if (tokens[0] == "f")
-				{
-#ifdef LOST_DEBUG_MODE
-					if (tokens.size() != 4)
-					{
-						debugLog(std::string("Malformed .obj file, \"") + objLoc + "\" face with less than or more than 3 verticies\nMake sure mesh is triangulated!", LOST_LOG_ERROR);
-						continue;
-					}
-#endif
+		// The space the mesh takes up depends on it's layout, so it has to be released before changing it
+		_releaseMesh(mesh);
+		meshData->vertexLayout = vertexLayout;
+		_uploadMesh(mesh);
+	}
 
-					// Create vertices and indices
-					for (int i = 1; i < tokens.size(); i++)
-					{
-						std::vector<std::string> subTokens = split(tokens[i], '/');
-
-						if (vertexIndexMap.count(tokens[i]) == 0)
-						{
-							Vertex vert = {};
-
-							vert.position = vertexData[std::stoi(subTokens[0]) - 1].xyz;
-							// Check if theres a texCoord included
-							if (subTokens.size() >= 2)
-								vert.textureCoord = { textureData[std::stoi(subTokens[1]) - 1].x, 1.0f - textureData[std::stoi(subTokens[1]) - 1].y };
-							else
-								vert.textureCoord = { 0.0f, 0.0f };
-							// Check if theres a normal included
-							if (subTokens.size() >= 3)
-								vert.vertexNormal = normalData[std::stoi(subTokens[2]) - 1];
-							else
-								vert.vertexNormal = { 0.0f, 0.0f, 0.0f }; 
-
-							vert.vertexColor = { 1.0f, 1.0f, 1.0f, 1.0f };
-
-							vertexIndexMap[tokens[i]] = meshData.verticies.size();
-							meshData.verticies.push_back(vert);
-						}
-
-						meshData.indexArray.push_back(vertexIndexMap[tokens[i]]);
-					}
+	bool _compileMeshOBJ(const char* objLoc, CompiledMeshData* data)
+	{
+		// If the mesh was cooked since the .obj last changed, it's copied straight out of the cache instead
+		if (_readMeshCache(objLoc, data))
+		{
+			debugLog(std::string("Successfully loaded cooked mesh with ") + std::to_string(data->vertexData.size() / (sizeof(Vertex) / sizeof(float))) + " verticies", LOST_LOG_SUCCESS);
+			return true;
+		}
 
-					continue;
-				}
+		// The file is mapped rather than read, the parser scans it straight out of the mapping
+		_MappedFile meshFile;
+		if (!meshFile.open(objLoc))
+			return false;
 
-				// Materials
-				if (tokens[0] == "usemtl")
-				{
-					meshData.materialSlotIndicies.push_back(meshData.indexArray.size());
-				}
-			}
-		}
+		MeshData meshData = {};
+		bool hasNormals = _parseOBJ(meshFile.getData(), meshFile.getSize(), objLoc, meshData);
+		uint64_t sourceHash = _hashMeshSource(meshFile.getData(), meshFile.getSize());
+		meshFile.close();
 
 		// Some objects don't have any usemtl lines and are just raw objects, we need to account for this
 		if (meshData.materialSlotIndicies.empty())
 			meshData.materialSlotIndicies.push_back(0);
 
-		if (normalData.empty())
+		if (!hasNormals)
 			_generateNormals(&meshData.verticies, meshData.indexArray);
 
 		_generateTangents(&meshData.verticies, meshData.indexArray);
 
 		// Compile mesh data into usable mesh data
-		CompiledMeshData* data = new CompiledMeshData();
-
 		// This works only because the Vertex class is essentially just a list of floats, in order:
 		// Position, Texcoord, Color, Normal, Tangent, Bitangent
 		for (Vertex& vertex : meshData.verticies)
@@ -797,11 +896,82 @@ namespace lost
 		// Copy material take over inducies
 		data->materialSlotIndicies.insert(data->materialSlotIndicies.begin(), meshData.materialSlotIndicies.begin(), meshData.materialSlotIndicies.end());
 
+		data->bounds = _calculateMeshBounds(data->vertexData);
+
+		// Cook the mesh so the next load doesn't have to do any of this
+		_writeMeshCache(objLoc, data, sourceHash);
+
 		debugLog(std::string("Successfully created new mesh with ") + std::to_string(meshData.verticies.size()) + " verticies", LOST_LOG_SUCCESS);
+		return true;
+	}
+
+	Mesh _loadMeshOBJ(const char* objLoc, unsigned int vertexLayout)
+	{
+		CompiledMeshData* data = new CompiledMeshData();
+		if (!_compileMeshOBJ(objLoc, data))
+		{
+			delete data;
+			return nullptr;
+		}
+
+		// Upload the mesh to the GPU once, the renderer only binds offsets into it from now on
+		data->vertexLayout = vertexLayout;
+		_uploadMesh(data);
 		
 		return data;
 	}
 
+	// The mesh compiled on a worker thread, moved into the mesh given out once it's back on the main thread
+	class MeshLoad : public _AsyncLoad
+	{
+	public:
+		MeshLoad(CompiledMeshData* mesh, const char* objLoc) : _AsyncLoad(mesh), m_Location(objLoc) {};
+
+		void load() override
+		{
+			m_Loaded = _compileMeshOBJ(m_Location.c_str(), &m_Data);
+		}
+
+		void finish() override
+		{
+			// A mesh which failed to load stays empty, it was already logged by the worker
+			if (!m_Loaded)
+				return;
+
+			CompiledMeshData* mesh = (CompiledMeshData*)getTarget();
+			mesh->vertexData.swap(m_Data.vertexData);
+			mesh->indexData.swap(m_Data.indexData);
+			mesh->materialSlotIndicies.swap(m_Data.materialSlotIndicies);
+			mesh->meshRenderMode = m_Data.meshRenderMode;
+			mesh->bounds = m_Data.bounds;
+			mesh->loading = false;
+
+			_uploadMesh(mesh);
+		}
+	private:
+		std::string m_Location;
+		CompiledMeshData m_Data;
+		bool m_Loaded = false;
+	};
+
+	Mesh _loadMeshOBJAsync(const char* objLoc, unsigned int vertexLayout)
+	{
+		CompiledMeshData* data = new CompiledMeshData();
+		data->vertexLayout = vertexLayout;
+		data->loading = true;
+
+		_queueAsyncLoad(new MeshLoad(data, objLoc));
+		return data;
+	}
+
+	template <>
+	void _destroyResource<Mesh>(Mesh mesh)
+	{
+		_cancelAsyncLoads(mesh);
+		_releaseMesh(mesh);
+		delete (CompiledMeshData*)mesh;
+	}
+
 #pragma endregion
 
 #pragma region Font
@@ -824,11 +994,34 @@ namespace lost
 		return font;
 	}
 
+	Font loadFontAsync(const char* fontLoc, float fontHeight, const char* id)
+	{
+		lost::Font font = nullptr;
+
+		// If "id" is nullptr set it to the filename
+		if (!id) id = fontLoc;
+
+		if (!_fontRM->hasValue(id))
+		{
+			font = _loadFontNoManagerAsync(fontLoc, fontHeight);
+		}
+		else
+			font = _fontRM->getValue(id);
+
+		_fontRM->addValue(font, id);
+		return font;
+	}
+
 	Font getFont(const char* id)
 	{
 		return _fontRM->getValue(id);
 	}
 
+	Font getFont(ResourceID id)
+	{
+		return _fontRM->getValue(id);
+	}
+
 	void unloadFont(const char* id)
 	{
 		_fontRM->destroyValue(id);
@@ -849,5 +1042,44 @@ namespace lost
 		_fontRM->forceDestroyValueByValue(font);
 	}
 
+#pragma endregion
+
+#pragma region Handles
+
+	ResourceHandle getMeshHandle(Mesh mesh)
+	{
+		return ((CompiledMeshData*)mesh)->handle.get((CompiledMeshData*)mesh);
+	}
+
+	ResourceHandle getFontHandle(Font font)
+	{
+		return font->handle.get(font);
+	}
+
+	Texture resolveTexture(ResourceHandle handle)
+	{
+		return _HandleTable<_Texture*>::get().resolve(handle);
+	}
+
+	Material resolveMaterial(ResourceHandle handle)
+	{
+		return _HandleTable<_Material*>::get().resolve(handle);
+	}
+
+	Shader resolveShader(ResourceHandle handle)
+	{
+		return _HandleTable<_Shader*>::get().resolve(handle);
+	}
+
+	Mesh resolveMesh(ResourceHandle handle)
+	{
+		return _HandleTable<CompiledMeshData*>::get().resolve(handle);
+	}
+
+	Font resolveFont(ResourceHandle handle)
+	{
+		return _HandleTable<_Font*>::get().resolve(handle);
+	}
+
 #pragma endregion
 }
\ No newline at end of file
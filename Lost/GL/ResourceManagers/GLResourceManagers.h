@@ -2,6 +2,7 @@
 #include "../../ResourceManager.h"
 #include "../Texture/Texture.h"
 #include "../Texture/Material.h"
+#include "../Texture/TextureAtlas.h"
 #include "../Shaders/Shader.h"
 #include "../Shaders/PostProcessingShader.h"
 #include "../Mesh/Mesh.h"
@@ -11,6 +12,7 @@ namespace lost
 {
 
 	extern ResourceManager<Texture>* _textureRM;
+	extern ResourceManager<Sprite>* _spriteRM;
 	extern ResourceManager<Material>* _materialRM;
 	extern ResourceManager<PostProcessingShader>* _postProcessingShaderRM;
 	extern ResourceManager<Shader>* _shaderRM;
@@ -23,9 +25,12 @@ namespace lost
 	extern void _destroyRMs();
 
 	Texture loadTexture(const char* fileLocation, const char* id = nullptr);
+	// Returns straight away, the texture shows as the default white texture until it has loaded in the background
+	Texture loadTextureAsync(const char* fileLocation, const char* id = nullptr);
 	Texture makeTexture(const char* data, int width, int height, const char* id, unsigned int format = LOST_FORMAT_RGBA);
 	Texture makeTexture(unsigned int openGLTexture, const char* id);
 	Texture getTexture(const char* id);
+	Texture getTexture(ResourceID id);
 	void    unloadTexture(const char* id);
 	void    unloadTexture(Texture texture);
 	void    forceUnloadTexture(const char* id);
@@ -35,11 +40,23 @@ namespace lost
 	// NOTE: This is only used inside of the Lost engine, though it is static and has no effect
 	const char* _getTextureID(Texture texture);
 
+	// Sprites are small textures packed together into the texture atlas' pages, sprites sharing a page draw in one batch
+	Sprite loadSprite(const char* fileLocation, const char* id = nullptr);
+	// Packs the RGBA pixels given into the atlas
+	Sprite makeSprite(const unsigned char* data, int width, int height, const char* id);
+	Sprite getSprite(const char* id);
+	Sprite getSprite(ResourceID id);
+	void   unloadSprite(const char* id);
+	void   unloadSprite(Sprite sprite);
+	void   forceUnloadSprite(const char* id);
+	void   forceUnloadSprite(Sprite sprite);
+
 	// Takes the list of textures as the input into the shaders texture slots
 	// If shader is not set, uses the default shader. This shader changes based on which renderer is being used.
 	// RenderQueue is how it is ordered in rendering, lower is first, higher is last
 	Material makeMaterial(std::vector<Texture> textures, const char* id, Shader shader = nullptr, unsigned int renderQueue = LOST_SHADER_OPAQUE);
 	Material getMateral(const char* id);
+	Material getMateral(ResourceID id);
 	std::vector<Material> loadMaterialsFromOBJMTL(const char* objFile);
 	void     destroyMaterial(const char* id);
 	void     destroyMaterial(Material material);
@@ -50,6 +67,7 @@ namespace lost
 	Shader loadShader(const char* vertexLoc, const char* fragmentLoc, const char* id);
 	Shader makeShader(const char* vertexCode, const char* fragmentCode, const char* id);
 	Shader getShader(const char* id);
+	Shader getShader(ResourceID id);
 	void   unloadShader(const char* id);
 	void   unloadShader(Shader& shader);
 	void   forceUnloadShader(const char* id);
@@ -61,6 +79,7 @@ namespace lost
 	PostProcessingShader makePostProcessingShader(Shader shader, const char* id, void (*funcOverride)(PostProcessingShader) = nullptr);
 	PostProcessingShader makePostProcessingShader(const std::vector<Shader>& shaders, const char* id, void (*funcOverride)(PostProcessingShader) = nullptr);
 	PostProcessingShader getPostProcessingShader(const char* id);
+	PostProcessingShader getPostProcessingShader(ResourceID id);
 	void				 destroyPostProcessingShader(const char* id);
 	void				 destroyPostProcessingShader(PostProcessingShader shader);
 	void				 forceDestroyPostProcessingShader(const char* id);
@@ -70,22 +89,51 @@ namespace lost
 	// NOTE: This is only used inside of the Lost engine, though it is static and has no effect
 	const char* _getShaderID(Shader shader);
 
-	Mesh loadMesh(const char* objLoc, const char* id = nullptr);
+	// "vertexLayout" is the layout the mesh is stored in on the GPU, follows the VertexLayout enum
+	Mesh loadMesh(const char* objLoc, const char* id = nullptr, unsigned int vertexLayout = LOST_VERTEX_LAYOUT_FULL);
+	// Returns straight away, the mesh isn't drawn until it has loaded in the background
+	Mesh loadMeshAsync(const char* objLoc, const char* id = nullptr, unsigned int vertexLayout = LOST_VERTEX_LAYOUT_FULL);
 	Mesh makeMesh(MeshData& meshData, const char* id);
 	Mesh getMesh(const char* id);
+	Mesh getMesh(ResourceID id);
 	void unloadMesh(const char* id);
 	void unloadMesh(Mesh& obj);
 	void forceUnloadMesh(const char* id);
 	void forceUnloadMesh(Mesh& obj);
+	// Changes the layout the mesh is stored in on the GPU and uploads it again, follows the VertexLayout enum
+	void setMeshVertexLayout(Mesh mesh, unsigned int vertexLayout);
 
 	// Mesh Load Functions
-	Mesh _loadMeshOBJ(const char* objLoc);
+	// Reads the .obj (or it's cooked mesh) into data without touching OpenGL, so it can be ran on any thread, returns false if it couldn't be read
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	bool _compileMeshOBJ(const char* objLoc, CompiledMeshData* data);
+	Mesh _loadMeshOBJ(const char* objLoc, unsigned int vertexLayout = LOST_VERTEX_LAYOUT_FULL);
+	Mesh _loadMeshOBJAsync(const char* objLoc, unsigned int vertexLayout = LOST_VERTEX_LAYOUT_FULL);
+
+	// Meshes are stored as void*, so they need to be cast back before they get deleted
+	// This also frees the space they took up inside of the renderer's mesh arena
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	template <>
+	void _destroyResource<Mesh>(Mesh mesh);
 
 	// Font Load Functions
 	Font loadFont(const char* fontLoc, float fontHeight, const char* id = nullptr);
+	// Returns straight away, text using the font isn't drawn until it has loaded in the background
+	Font loadFontAsync(const char* fontLoc, float fontHeight, const char* id = nullptr);
 	Font getFont(const char* id);
+	Font getFont(ResourceID id);
 	void unloadFont(const char* id);
 	void unloadFont(Font& font);
 	void forceUnloadFont(const char* id);
 	void forceUnloadFont(Font& font);
+
+	// Handles are small references to resources, resolving one returns nullptr once the resource it points to was destroyed
+	// Handles and resolving them are only valid on the main thread
+	ResourceHandle getMeshHandle(Mesh mesh);
+	ResourceHandle getFontHandle(Font font);
+	Texture  resolveTexture(ResourceHandle handle);
+	Material resolveMaterial(ResourceHandle handle);
+	Shader   resolveShader(ResourceHandle handle);
+	Mesh     resolveMesh(ResourceHandle handle);
+	Font     resolveFont(ResourceHandle handle);
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "RingBuffer.h"
+#include <glad/glad.h>
+#include <string>
+#include "GLStateCache.h"
+#include "../Log.h"
+
+namespace lost
+{
+
+	_RingBuffer::_RingBuffer()
+	{
+	}
+
+	_RingBuffer::~_RingBuffer()
+	{
+		destroy();
+	}
+
+	void _RingBuffer::init(size_t sectionSize, unsigned int sectionCount, size_t alignment)
+	{
+		m_Alignment = alignment;
+		m_SectionCount = sectionCount;
+
+		// Sections need to start on an aligned offset too
+		m_SectionSize = ((sectionSize + m_Alignment - 1) / m_Alignment) * m_Alignment;
+
+		create();
+	}
+
+	void* _RingBuffer::allocate(size_t size, size_t& offset)
+	{
+		size = ((size + m_Alignment - 1) / m_Alignment) * m_Alignment;
+
+		if (size > m_SectionSize)
+		{
+			// Too large for a single section, recreate the buffer with larger sections
+			size_t newSectionSize = m_SectionSize * 2;
+			while (newSectionSize < size)
+				newSectionSize *= 2;
+
+			debugLog("Ring buffer grew from " + std::to_string(m_SectionSize) + " to " + std::to_string(newSectionSize) + " bytes per section", LOST_LOG_INFO);
+
+			destroy();
+			m_SectionSize = newSectionSize;
+			create();
+		}
+		else if (m_SectionUsed + size > m_SectionSize)
+			advance();
+
+		offset = m_CurrentSection * m_SectionSize + m_SectionUsed;
+		m_SectionUsed += size;
+
+		return m_MappedData + offset;
+	}
+
+	void _RingBuffer::advance()
+	{
+		// Nothing was written, there is no need to fence anything
+		if (m_SectionUsed == 0)
+			return;
+
+		m_Fences[m_CurrentSection] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		m_CurrentSection = (m_CurrentSection + 1) % m_SectionCount;
+		m_SectionUsed = 0;
+
+		// Usually this has been signaled long ago, unless the CPU is more than "sectionCount" frames ahead
+		waitForSection(m_CurrentSection);
+	}
+
+	void _RingBuffer::create()
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLsizeiptr size = (GLsizeiptr)(m_SectionSize * m_SectionCount);
+
+		// GL_COPY_WRITE_BUFFER is used so we don't mess with the currently bound VAO
+		glGenBuffers(1, &m_Buffer);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, m_Buffer);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+		m_MappedData = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		debugLogIf(m_MappedData == nullptr, "Failed to persistently map ring buffer", LOST_LOG_FATAL);
+
+		m_Fences.assign(m_SectionCount, nullptr);
+		m_CurrentSection = 0;
+		m_SectionUsed = 0;
+	}
+
+	void _RingBuffer::destroy()
+	{
+		if (m_Buffer == 0)
+			return;
+
+		for (unsigned int i = 0; i < m_SectionCount; i++)
+			waitForSection(i);
+
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, m_Buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		_glState->bindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		_deleteGLBuffers(1, &m_Buffer);
+
+		m_Buffer = 0;
+		m_MappedData = nullptr;
+	}
+
+	void _RingBuffer::waitForSection(unsigned int section)
+	{
+		GLsync fence = (GLsync)m_Fences[section];
+		if (fence == nullptr)
+			return;
+
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		while (result == GL_TIMEOUT_EXPIRED)
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+
+		glDeleteSync(fence);
+		m_Fences[section] = nullptr;
+	}
+
+}
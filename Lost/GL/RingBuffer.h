@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+
+namespace lost
+{
+
+	// A persistently mapped buffer split up into sections which are written to in turn
+	// Each section is fenced once the GPU has been given all the work using it, and is only written to again
+	// once that fence has been signaled. This means data can be written straight into the buffer without
+	// the driver needing to copy or orphan anything.
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _RingBuffer
+	{
+	public:
+		_RingBuffer();
+		~_RingBuffer();
+
+		// Creates and maps the buffer, must be ran while a context is active
+		// "alignment" is the size every allocation is rounded up to, allocations start on a multiple of it
+		void init(size_t sectionSize, unsigned int sectionCount = 3, size_t alignment = 1);
+
+		// Returns a pointer to "size" bytes of mapped memory, "offset" is set to where it is inside of the buffer
+		// Moves on to the next section if the current one is full, growing the buffer if "size" is larger than a section
+		void* allocate(size_t size, size_t& offset);
+
+		// Fences the current section and moves onto the next one, waiting for the GPU to finish with it if necessary
+		// Should be ran once all the work using the current section has been given to OpenGL, usually at the end of a frame
+		void advance();
+
+		inline unsigned int getBuffer()      const { return m_Buffer; };
+		inline size_t       getSectionSize() const { return m_SectionSize; };
+	private:
+		// Creates the buffer and maps it
+		void create();
+		// Unmaps and deletes the buffer, waiting for the GPU to finish using every section
+		void destroy();
+		// Waits for the fence of the section given, then removes it
+		void waitForSection(unsigned int section);
+
+		unsigned int m_Buffer = 0;
+		char* m_MappedData = nullptr;
+
+		size_t m_SectionSize = 0;
+		size_t m_Alignment = 1;
+		unsigned int m_SectionCount = 0;
+
+		unsigned int m_CurrentSection = 0;
+		size_t m_SectionUsed = 0; // The amount of bytes used in the current section
+
+		std::vector<void*> m_Fences; // GLsync objects, one per section
+	};
+
+}
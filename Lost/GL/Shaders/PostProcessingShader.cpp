@@ -41,8 +41,7 @@ namespace lost
 		// Set the inputs for the texture, the outputs are already set by the beginFrame function
 		for (int i = 0; i < renderBufferTextures.size(); i++)
 		{
-			glActiveTexture(GL_TEXTURE0 + i);
-			glBindTexture(GL_TEXTURE_2D, renderBufferTextures.at(i));
+			_glState->bindTexture(i, GL_TEXTURE_2D, renderBufferTextures.at(i));
 		}
 
 		m_FunctionOverride(this);
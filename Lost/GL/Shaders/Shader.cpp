@@ -3,6 +3,7 @@
 #include <vector>
 #include "../LostGL.h"
 #include <set>
+#include <cctype>
 #include "ShaderCode.h"
 
 template <typename Out>
@@ -27,6 +28,198 @@ namespace lost
 		"resolution"
 	};
 
+#pragma region Material Batching
+
+	// Fragment shaders containing this line are rewritten to use material batching
+	const static std::string _BatchPragma = "#pragma lost_batch_materials";
+
+	// Reads the name, type and if a "uniform type name;" line is an array
+	static void parseUniformLine(const std::string& line, std::string& uniformName, std::string& uniformTypename, bool& isArray)
+	{
+		std::vector<std::string> uniformData = split(split(split(split(line.substr(8, line.length() - 9), ';')[0], '=')[0], '[')[0], ' ');
+		isArray = split(split(split(line.substr(8, line.length() - 9), ';')[0], '=')[0], '[').size() > 1;
+		for (int i = uniformData.size() - 1; i >= 0; i--)
+		{
+			if (uniformData[i].empty())
+				uniformData.erase(uniformData.begin() + i);
+		}
+		uniformName = uniformData.back();
+		uniformTypename = uniformData.at(uniformData.size() - 2);
+	}
+
+	// Reads the name of a "uniform sampler2D name;" line
+	static std::string parseSamplerLine(const std::string& line)
+	{
+		return split(split(line.substr(18, line.length() - 19), ';')[0], '[')[0];
+	}
+
+	// Returns the expression a material parameter of the type given is read with, or an empty string if the type can't be a parameter
+	// Every parameter is stored as a vec4, integers are stored as their bits
+	static std::string getParameterRead(unsigned int type, unsigned int slot)
+	{
+		std::string parameter = "lostMaterial.parameters[" + std::to_string(slot) + "]";
+		switch (type)
+		{
+		case LOST_TYPE_FLOAT: return "(" + parameter + ".x)";
+		case LOST_TYPE_VEC2:  return "(" + parameter + ".xy)";
+		case LOST_TYPE_VEC3:  return "(" + parameter + ".xyz)";
+		case LOST_TYPE_VEC4:  return "(" + parameter + ")";
+		case LOST_TYPE_INT:   return "floatBitsToInt(" + parameter + ".x)";
+		case LOST_TYPE_IVEC2: return "floatBitsToInt(" + parameter + ".xy)";
+		case LOST_TYPE_IVEC3: return "floatBitsToInt(" + parameter + ".xyz)";
+		case LOST_TYPE_IVEC4: return "floatBitsToInt(" + parameter + ")";
+		case LOST_TYPE_UINT:  return "floatBitsToUint(" + parameter + ".x)";
+		case LOST_TYPE_UVEC2: return "floatBitsToUint(" + parameter + ".xy)";
+		case LOST_TYPE_UVEC3: return "floatBitsToUint(" + parameter + ".xyz)";
+		case LOST_TYPE_UVEC4: return "floatBitsToUint(" + parameter + ")";
+		default:              return "";
+		}
+	}
+
+	static bool isIdentifierCharacter(char character)
+	{
+		return isalnum((unsigned char)character) || character == '_';
+	}
+
+	// Replaces every "texture(name, uv)" sampling one of the textures given with "lostTexture(name, slot, uv)"
+	static void replaceTextureCalls(std::string& source, const std::map<std::string, unsigned int>& textureSlots)
+	{
+		size_t position = 0;
+		while ((position = source.find("texture(", position)) != std::string::npos)
+		{
+			size_t nameStart = position + 8;
+
+			// Part of a longer name, like "myTexture("
+			if (position > 0 && isIdentifierCharacter(source[position - 1]))
+			{
+				position = nameStart;
+				continue;
+			}
+
+			while (nameStart < source.size() && isspace((unsigned char)source[nameStart]))
+				nameStart++;
+			size_t nameEnd = nameStart;
+			while (nameEnd < source.size() && isIdentifierCharacter(source[nameEnd]))
+				nameEnd++;
+
+			auto texture = textureSlots.find(source.substr(nameStart, nameEnd - nameStart));
+			if (texture == textureSlots.end())
+			{
+				position = nameEnd;
+				continue;
+			}
+
+			std::string replacement = "lostTexture(" + texture->first + ", " + std::to_string(texture->second) + "u";
+			source.replace(position, nameEnd - position, replacement);
+			position += replacement.size();
+		}
+	}
+
+	// Rewrites the shaders given to use material batching, the fragment shader must contain _BatchPragma
+	//  - Each "uniform sampler2D" becomes the sampler2DArray of the page the material's texture is in,
+	//    and sampling it with texture() reads from the material's layer
+	//  - Each uniform which can be a parameter is replaced with a read from the material's parameters
+	//  - The vertex shader passes each instance's material index through to the fragment shader
+	// Returns false if the shader has too many textures or parameters to be batched, the shaders are then left as they were
+	static bool makeBatchedShader(const std::string& vs, const std::string& fs, std::string& batchedVS, std::string& batchedFS, std::map<std::string, unsigned int>& parameterSlots)
+	{
+		std::vector<std::string> lines = split(fs, '\n');
+
+		std::map<std::string, unsigned int> textureSlots;
+		for (std::string& line : lines)
+		{
+			if (line.substr(0, 8) != "uniform ")
+				continue;
+
+			if (line.substr(8, 10) == "sampler2D ")
+			{
+				unsigned int slot = textureSlots.size();
+				textureSlots[parseSamplerLine(line)] = slot;
+				continue;
+			}
+
+			std::string uniformName, uniformTypename;
+			bool isArray;
+			parseUniformLine(line, uniformName, uniformTypename, isArray);
+
+			unsigned int uniformType = _UniformNameIDMap.count(uniformTypename) ? _UniformNameIDMap.at(uniformTypename) : LOST_TYPE_STRUCT;
+			if (!isArray && _BuiltInUniforms.find(uniformName) == _BuiltInUniforms.end() && !getParameterRead(uniformType, 0).empty())
+			{
+				unsigned int slot = parameterSlots.size();
+				parameterSlots[uniformName] = slot;
+			}
+		}
+
+		if (textureSlots.size() > _MaxBatchTextures || parameterSlots.size() > _MaxBatchParameters)
+		{
+			debugLog("Shader uses more than " + std::to_string(_MaxBatchTextures) + " textures or " + std::to_string(_MaxBatchParameters) + " uniforms, material batching has been disabled for it", LOST_LOG_WARNING);
+			parameterSlots.clear();
+			return false;
+		}
+
+		batchedFS.clear();
+		for (std::string& line : lines)
+		{
+			if (line.substr(0, _BatchPragma.size()) == _BatchPragma)
+			{
+				batchedFS +=
+					"struct LostMaterial\n"
+					"{\n"
+					"	uint layers[" + std::to_string(_MaxBatchTextures) + "];\n"
+					"	vec4 parameters[" + std::to_string(_MaxBatchParameters) + "];\n"
+					"};\n"
+					"layout(std430, binding = 0) readonly buffer LostMaterials\n"
+					"{\n"
+					"	LostMaterial lostMaterials[];\n"
+					"};\n"
+					"flat in uint lostMaterialIndex;\n"
+					"#define lostMaterial lostMaterials[lostMaterialIndex]\n"
+					"vec4 lostTexture(sampler2DArray page, uint slot, vec2 uv)\n"
+					"{\n"
+					"	return texture(page, vec3(uv, float(lostMaterial.layers[slot])));\n"
+					"}\n";
+			}
+			else if (line.substr(0, 18) == "uniform sampler2D ")
+				batchedFS += "uniform sampler2DArray " + parseSamplerLine(line) + ";\n";
+			else if (line.substr(0, 8) == "uniform ")
+			{
+				std::string uniformName, uniformTypename;
+				bool isArray;
+				parseUniformLine(line, uniformName, uniformTypename, isArray);
+
+				if (parameterSlots.count(uniformName))
+					batchedFS += "#define " + uniformName + " " + getParameterRead(_UniformNameIDMap.at(uniformTypename), parameterSlots.at(uniformName)) + "\n";
+				else
+					batchedFS += line + "\n";
+			}
+			else
+				batchedFS += line + "\n";
+		}
+		replaceTextureCalls(batchedFS, textureSlots);
+
+		// The user's main is renamed so a main passing the material index through can be added after it
+		const std::string vsInputs =
+			"layout(location = 13) in uint lostInstanceMaterial;\n"
+			"flat out uint lostMaterialIndex;\n"
+			"#define main lostUserMain\n";
+
+		size_t versionLine = vs.find("#version");
+		size_t insertAt = versionLine == std::string::npos ? 0 : vs.find('\n', versionLine);
+		insertAt = insertAt == std::string::npos ? vs.size() : insertAt + 1;
+
+		batchedVS = vs.substr(0, insertAt) + (insertAt == vs.size() && insertAt > 0 ? "\n" : "") + vsInputs + vs.substr(insertAt) +
+			"\n#undef main\n"
+			"void main()\n"
+			"{\n"
+			"	lostMaterialIndex = lostInstanceMaterial;\n"
+			"	lostUserMain();\n"
+			"}\n";
+
+		return true;
+	}
+
+#pragma endregion
+
 	_Shader::_Shader()
 	{
 	}
@@ -38,7 +231,7 @@ namespace lost
 
 	_Shader::~_Shader()
 	{
-		glDeleteProgram(m_ShaderID);
+		_deleteGLProgram(m_ShaderID);
 	}
 
 	void _Shader::loadShader(const char* vsDir, const char* fsDir)
@@ -81,8 +274,13 @@ namespace lost
 
 		m_Functional = true;
 
-		buildModule(vs, GL_VERTEX_SHADER);
-		buildModule(fs, GL_FRAGMENT_SHADER);
+		// Shaders opting into material batching are compiled from rewritten source, the uniforms are still read from the original
+		std::string batchedVS, batchedFS;
+		std::map<std::string, unsigned int> parameterSlots;
+		m_MaterialBatching = std::string(fs).find(_BatchPragma) != std::string::npos && makeBatchedShader(vs, fs, batchedVS, batchedFS, parameterSlots);
+
+		buildModule(m_MaterialBatching ? batchedVS.c_str() : vs, GL_VERTEX_SHADER);
+		buildModule(m_MaterialBatching ? batchedFS.c_str() : fs, GL_FRAGMENT_SHADER);
 
 		m_ShaderID = glCreateProgram();
 		glAttachShader(m_ShaderID, m_VertID);
@@ -108,10 +306,9 @@ namespace lost
 		glDeleteShader(m_VertID);
 		glDeleteShader(m_FragID);
 
-		GLint prog = 0; // Get program currently being active
-		glGetIntegerv(GL_CURRENT_PROGRAM, &prog);
+		unsigned int prog = _glState->getProgram(); // Get program currently being active
 		 
-		glUseProgram(m_ShaderID); // Swap to this current shader program
+		_glState->useProgram(m_ShaderID); // Swap to this current shader program
 
 #ifdef LOST_DEBUG_MODE
 		std::vector<std::string> textureNames;
@@ -130,7 +327,7 @@ namespace lost
 				// check if uniform is a sampler2D, and if it is hook it up to the texture map
 				if (string.substr(8, 10) == "sampler2D ")
 				{
-					std::string textureName = split(split(string.substr(18, string.length() - 19), ';')[0], '[')[0];
+					std::string textureName = parseSamplerLine(string);
 					unsigned int id = m_TextureMap.size();
 					glUniform1i(glGetUniformLocation(m_ShaderID, textureName.c_str()), id);
 					m_TextureMap[textureName] = id;
@@ -140,23 +337,18 @@ namespace lost
 				}
 				else // Otherwise add the value as a uniform value
 				{
-					std::vector<std::string> uniformData = split(split(split(split(string.substr(8, string.length() - 9), ';')[0], '=')[0], '[')[0], ' ');
-					bool isArray = split(split(split(string.substr(8, string.length() - 9), ';')[0], '=')[0], '[').size() > 1;
-					for (int i = uniformData.size() - 1; i >= 0; i--)
-					{
-						if (uniformData[i].empty())
-							uniformData.erase(uniformData.begin() + i);
-					}
-					std::string uniformName = uniformData.back();
+					std::string uniformName, uniformTypename;
+					bool isArray;
+					parseUniformLine(string, uniformName, uniformTypename, isArray);
 					// Get the type and convert it to the associated enum, unknown values are considered structs (including errors)
-					std::string uniformTypename = uniformData.at(uniformData.size() - 2);
 					unsigned int uniformType = _UniformNameIDMap.count(uniformTypename) ? _UniformNameIDMap.at(uniformTypename) : LOST_TYPE_STRUCT;
 
 					m_UniformMap[uniformName] = UniformData{ 
 						(unsigned int)glGetUniformLocation(m_ShaderID, uniformName.c_str()), 
 						uniformType,
 						_BuiltInUniforms.find(uniformName) != _BuiltInUniforms.end(),
-						isArray
+						isArray,
+						parameterSlots.count(uniformName) ? (int)parameterSlots.at(uniformName) : -1
 					};
 #ifdef LOST_DEBUG_MODE
 					uniformNames.push_back(uniformName);
@@ -168,7 +360,7 @@ namespace lost
 
 		m_ResolutionUniformLoc = glGetUniformLocation(m_ShaderID, "resolution");
 
-		glUseProgram(prog); // Change back to old program
+		_glState->useProgram(prog); // Change back to old program
 
 #ifdef LOST_DEBUG_MODE
 		debugLog("\n======[    Shader Created    ]======\n", LOST_LOG_NONE);
@@ -191,7 +383,7 @@ namespace lost
 
 	void _Shader::reloadShader()
 	{
-		glDeleteProgram(m_ShaderID);
+		_deleteGLProgram(m_ShaderID);
 
 		m_ResolutionUniformLoc = -1;
 		m_ShaderType = LOST_SHADER_TRANSPARENT;
@@ -230,7 +422,7 @@ namespace lost
 
 	void _Shader::bind()
 	{
-		glUseProgram(m_ShaderID);
+		_glState->useProgram(m_ShaderID);
 		if (m_ResolutionUniformLoc != -1)
 			glUniform2f(m_ResolutionUniformLoc, (float)getWidth(getCurrentWindow()), (float)getHeight(getCurrentWindow()));
 	}
@@ -274,12 +466,11 @@ namespace lost
 
 		// We need to make sure this shader is bound, we will store the current shader running so we can bind it again
 		// just in case this was ran in the middle of a call
-		int prog = 0;
-		// [!] TODO: Replace this with a static global singleton that can be used instead of querying the OpenGL state
-		glGetIntegerv(GL_CURRENT_PROGRAM, &prog);
+		// The state cache knows the current program, so OpenGL never has to be queried
+		unsigned int prog = _glState->getProgram();
 
 		if (prog != m_ShaderID)
-			glUseProgram(m_ShaderID);
+			_glState->useProgram(m_ShaderID);
 
 		switch (m_UniformMap[uniformName].type)
 		{
@@ -339,19 +530,18 @@ namespace lost
 
 		// Switch back to the old shader
 		if (prog != m_ShaderID)
-			glUseProgram(prog);
+			_glState->useProgram(prog);
 	}
 
 	void _Shader::setUniform(void* dataAt, unsigned int uniformLoc, unsigned int type, unsigned int count, unsigned int offset)
 	{
 		// We need to make sure this shader is bound, we will store the current shader running so we can bind it again
 		// just in case this was ran in the middle of a call
-		int prog = 0;
-		// [!] TODO: Replace this with a static global singleton that can be used instead of querying the OpenGL state
-		glGetIntegerv(GL_CURRENT_PROGRAM, &prog);
+		// The state cache knows the current program, so OpenGL never has to be queried
+		unsigned int prog = _glState->getProgram();
 
 		if (prog != m_ShaderID)
-			glUseProgram(m_ShaderID);
+			_glState->useProgram(m_ShaderID);
 
 		switch (type)
 		{
@@ -411,7 +601,7 @@ namespace lost
 
 		// Switch back to the old shader
 		if (prog != m_ShaderID)
-			glUseProgram(prog);
+			_glState->useProgram(prog);
 	}
 
 	void _Shader::buildModule(const char* code, uint32_t moduleType)
@@ -3,6 +3,7 @@
 #include "../../State.h"
 #include "../../Log.h"
 #include "../../FileIO.h"
+#include "../../ResourceHandle.h"
 #include <string>
 #include <map>
 
@@ -42,6 +43,10 @@ enum UniformDataType
 namespace lost
 {
 
+	// The most textures and parameters a material can have while drawn with a shader using material batching
+	const static unsigned int _MaxBatchTextures = 8;
+	const static unsigned int _MaxBatchParameters = 8;
+
 	const static std::map<std::string, unsigned int> _UniformNameIDMap = {
 		{ "float",	LOST_TYPE_FLOAT  },
 		{ "vec2",	LOST_TYPE_VEC2   },
@@ -98,6 +103,7 @@ namespace lost
 			unsigned int type = 0;
 			bool isEngine = false; // Specifies if the uniform is inbuilt
 			bool isArray = false;
+			int batchSlot = -1; // The material parameter the uniform reads from when using material batching, -1 if it's a normal uniform
 		};
 
 		// Default constructor, does nothing
@@ -131,6 +137,14 @@ namespace lost
 		void setUniform(void* dataAt, unsigned int uniformLoc, unsigned int type, unsigned int count = 1, unsigned int offset = 0);
 
 		inline unsigned int getShaderID() const { return m_ShaderID; };
+
+		// If the fragment shader opted into material batching with "#pragma lost_batch_materials"
+		// Materials using these shaders read their textures from texture pages and their uniforms from a storage buffer,
+		// so the renderer can draw materials together without binding each of them
+		inline bool usesMaterialBatching() const { return m_MaterialBatching; };
+
+		// A handle to the shader, which can be checked for if the shader was destroyed, see resolveShader()
+		inline ResourceHandle getHandle() { return m_Handle.get(this); };
 	private:
 
 		void buildModule(const char* code, uint32_t moduleType);
@@ -144,6 +158,7 @@ namespace lost
 		std::map<std::string, unsigned int> m_TextureMap = {};
 
 		bool m_Functional = false;
+		bool m_MaterialBatching = false;
 
 		std::string m_VSSourceLoc = "";
 		std::string m_FSSourceLoc = "";
@@ -154,6 +169,8 @@ namespace lost
 		uint32_t m_FragID = -1;
 
 		uint32_t m_ShaderID = -1;
+
+		_OwnedHandle<_Shader*> m_Handle;
 	};
 
 	// A reference to a shader
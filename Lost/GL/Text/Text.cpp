@@ -3,6 +3,7 @@
 #include "../Renderer.h"
 #include "../Shaders/ShaderCode.h"
 
+#include "../../AsyncLoader.h"
 #include "../../DeltaTime.h"
 
 #include "ft2build.h"
@@ -34,10 +35,11 @@ namespace lost
 		delete _textShader;
 	}
 
-    Font lost::_loadFontNoManager(const char* filePath, float fontSize)
-    {
-		Font newFont = new _Font();
+	// The size of the texture glyphs are rasterized into, it's square
+	static const int s_FontTextureSize = 512;
 
+	char* _rasterizeFont(const char* filePath, float fontSize, Glyph* glyphs, int& fontHeight)
+	{
 		FT_Library fontLibrary;
 		FT_Init_FreeType(&fontLibrary);
 
@@ -49,8 +51,7 @@ namespace lost
 		int row = 0;
 		int col = padding;
 
-		const int textureWidth = 512;
-		newFont->textureSize = textureWidth;
+		const int textureWidth = s_FontTextureSize;
 		char* textureBuffer = new char[textureWidth * textureWidth];
 
 		// Set the buffer to black
@@ -73,7 +74,7 @@ namespace lost
 			}
 
 			// Font Height
-			newFont->fontHeight = max((fontFace->size->metrics.ascender - fontFace->size->metrics.descender) >> 6, newFont->fontHeight);
+			fontHeight = max((fontFace->size->metrics.ascender - fontFace->size->metrics.descender) >> 6, fontHeight);
 
 			for (unsigned int y = 0; y < fontFace->glyph->bitmap.rows; ++y)
 			{
@@ -84,7 +85,7 @@ namespace lost
 				}
 			}
 
-			Glyph* glyph = &(newFont->glyphs[glyphIdx]);
+			Glyph* glyph = &(glyphs[glyphIdx]);
 			glyph->textureCoords = { col, row };
 			glyph->size =
 			{
@@ -108,15 +109,64 @@ namespace lost
 		FT_Done_Face(fontFace);
 		FT_Done_FreeType(fontLibrary);
 
+		return textureBuffer;
+	}
+
+	void _finishFont(const char* filePath, Font font, const char* textureBuffer)
+	{
 		// Upload OpenGL Texture
-		newFont->fontTexture = makeTexture(textureBuffer, textureWidth, textureWidth, filePath, LOST_FORMAT_R);
-		newFont->fontMaterial = makeMaterial({ newFont->fontTexture }, filePath, _textShader);
-		newFont->fontMaterial->setDepthTestFunc(LOST_DEPTH_TEST_ALWAYS);
-		newFont->fontMaterial->setDepthWrite(false);
+		font->textureSize = s_FontTextureSize;
+		font->fontTexture = makeTexture(textureBuffer, s_FontTextureSize, s_FontTextureSize, filePath, LOST_FORMAT_R);
+		font->fontMaterial = makeMaterial({ font->fontTexture }, filePath, _textShader);
+		font->fontMaterial->setDepthTestFunc(LOST_DEPTH_TEST_ALWAYS);
+		font->fontMaterial->setDepthWrite(false);
+	}
+
+	Font _loadFontNoManager(const char* filePath, float fontSize)
+	{
+		Font newFont = new _Font();
+
+		char* textureBuffer = _rasterizeFont(filePath, fontSize, newFont->glyphs, newFont->fontHeight);
+		_finishFont(filePath, newFont, textureBuffer);
 
 		delete[] textureBuffer;
 		return newFont;
-    }
+	}
+
+	// The glyphs rasterized on a worker thread, copied into the font given out once it's back on the main thread
+	class FontLoad : public _AsyncLoad
+	{
+	public:
+		FontLoad(Font font, const char* filePath, float fontSize) : _AsyncLoad(font), m_FilePath(filePath), m_FontSize(fontSize) {};
+		~FontLoad() { delete[] m_TextureBuffer; };
+
+		void load() override
+		{
+			m_TextureBuffer = _rasterizeFont(m_FilePath.c_str(), m_FontSize, m_Glyphs, m_FontHeight);
+		}
+
+		void finish() override
+		{
+			Font font = (Font)getTarget();
+			font->fontHeight = m_FontHeight;
+			memcpy(font->glyphs, m_Glyphs, sizeof(font->glyphs));
+
+			_finishFont(m_FilePath.c_str(), font, m_TextureBuffer);
+		}
+	private:
+		std::string m_FilePath;
+		float m_FontSize;
+		Glyph m_Glyphs[127] = {};
+		int m_FontHeight = 0;
+		char* m_TextureBuffer = nullptr;
+	};
+
+	Font _loadFontNoManagerAsync(const char* filePath, float fontSize)
+	{
+		Font newFont = new _Font();
+		_queueAsyncLoad(new FontLoad(newFont, filePath, fontSize));
+		return newFont;
+	}
 
 	Vec2 textBounds(const char* text, Font font, float scale)
 	{
@@ -221,6 +271,10 @@ namespace lost
 
 	void renderText(const char* text, Font font, Vec2 position, float scale, int hAlign, int vAlign, Shader shaderOverride)
 	{
+		// Fonts still loading have nothing to draw with
+		if (font != nullptr && font->fontMaterial == nullptr)
+			return;
+
 		if (text != nullptr) // Valid string
 		{
 			if (*text != '\0') // Not empty
@@ -296,8 +350,13 @@ namespace lost
 
 	_Font::~_Font()
 	{
-		lost::unloadTexture(fontTexture);
-		lost::destroyMaterial(fontMaterial);
+		_cancelAsyncLoads(this);
+
+		// Fonts still loading don't have a texture or material yet
+		if (fontTexture)
+			lost::unloadTexture(fontTexture);
+		if (fontMaterial)
+			lost::destroyMaterial(fontMaterial);
 	}
 
 }
@@ -32,8 +32,10 @@ namespace lost
 		int textureSize;
 		int fontHeight;
 		Glyph glyphs[127];
-		Texture fontTexture;
-		Material fontMaterial;
+		Texture fontTexture = nullptr;
+		Material fontMaterial = nullptr; // nullptr while the font is loading asynchronously
+
+		_OwnedHandle<_Font*> handle; // See getHandle()
 	};
 
 	// A reference to a font
@@ -42,7 +44,17 @@ namespace lost
 	void _initTextRendering();
 	void _destroyTextRendering();
 
+	// Rasterizes the printable ascii glyphs of the font into glyphs[] and a new greyscale texture buffer, which is returned and must be deleted[]
+	// Doesn't touch OpenGL, so can be ran on any thread
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	char* _rasterizeFont(const char* filePath, float fontSize, Glyph* glyphs, int& fontHeight);
+	// Uploads the texture buffer from _rasterizeFont() and makes the font's material
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _finishFont(const char* filePath, Font font, const char* textureBuffer);
+
 	Font _loadFontNoManager(const char* filePath, float fontSize);
+	// The font renders nothing until it has loaded in the background
+	Font _loadFontNoManagerAsync(const char* filePath, float fontSize);
 
 	// Returns the width and height of what the text given would take up when rendered
 	Vec2 textBounds(const char* text, Font font, float scale);
@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "../LostGL.h"
+#include "TexturePages.h"
 
 namespace lost
 {
@@ -114,6 +115,9 @@ namespace lost
 			uniform.uniformID = uniformName;
 			uniform.type = dataType;
 			uniform.location = m_Shader->getUniformLocation(uniformName);
+			uniform.batchSlot = m_Shader->getUniformNameMap().at(uniformName).batchSlot;
+
+			debugLogIf(m_Shader->usesMaterialBatching() && uniform.batchSlot == -1, "Material uniform (\"" + std::string(uniformName) + "\") can't be stored per material by a shader using material batching, it will be ignored", LOST_LOG_WARNING);
 
 			// Intialize the memory on the heap
 			size_t uniformDataSize = getBytesForType(uniform.type); // Get the size of the data given
@@ -136,6 +140,41 @@ namespace lost
 			m_Shader->setUniform(it.data, it.location, it.type);
 	}
 
+	void _Material::prepareBatch(BatchedMaterialData& data)
+	{
+		memset(&data, 0, sizeof(BatchedMaterialData));
+
+		m_BatchPageCount = m_Textures.size() < _MaxBatchTextures ? (unsigned int)m_Textures.size() : _MaxBatchTextures;
+		m_BatchPageHash = 2166136261u;
+		for (unsigned int i = 0; i < m_BatchPageCount; i++)
+		{
+			TexturePageSlot slot = _getTexturePageSlot(m_Textures[i] ? m_Textures[i] : getDefaultWhiteTexture());
+			m_BatchPages[i] = slot.page;
+			data.layers[i] = slot.layer;
+
+			m_BatchPageHash = (m_BatchPageHash ^ slot.page) * 16777619u;
+		}
+
+		for (MaterialUniform& it : m_MaterialUniforms)
+		{
+			if (it.batchSlot != -1)
+				memcpy(data.parameters[it.batchSlot], it.data, getBytesForType(it.type));
+		}
+	}
+
+	void _Material::bindBatchPages() const
+	{
+		for (unsigned int i = 0; i < m_BatchPageCount; i++)
+			_glState->bindTexture(i, GL_TEXTURE_2D_ARRAY, _getTexturePageTexture(m_BatchPages[i]));
+	}
+
+	bool _Material::sharesBatchPages(const _Material* other) const
+	{
+		if (m_BatchPageHash != other->m_BatchPageHash || m_BatchPageCount != other->m_BatchPageCount)
+			return false;
+
+		return memcmp(m_BatchPages, other->m_BatchPages, m_BatchPageCount * sizeof(unsigned int)) == 0;
+	}
 
 	void setMaterialUniform(Material mat, const char* uniformName, const void* data, unsigned int dataType)
 	{
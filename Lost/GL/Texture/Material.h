@@ -2,6 +2,7 @@
 #include "../Shaders/Shader.h"
 #include "Texture.h"
 #include <vector>
+#include <cstdint>
 
 enum DepthTestMode
 {
@@ -74,6 +75,15 @@ namespace lost
 
 		void* data = nullptr; // Pointer of data
 		unsigned int type = LOST_TYPE_ERROR; // Data type of the data
+
+		int batchSlot = -1; // The parameter the uniform is stored in when using material batching, see _Shader::usesMaterialBatching()
+	};
+
+	// A material as shaders using material batching read it from the material buffer, laid out the same as LostMaterial using std430
+	struct BatchedMaterialData
+	{
+		unsigned int layers[_MaxBatchTextures]; // The layer of the texture page each texture is in
+		float parameters[_MaxBatchParameters][4]; // Each material uniform's data, integers are stored as their bits
 	};
 
 	class _Material
@@ -102,6 +112,7 @@ namespace lost
 		void	setTexture(const char* slotName, Texture texture);
 		Texture getTexture(const char* slotName) const;
 		Texture getTextureWithID(unsigned int slot) const;
+		inline const std::vector<Texture>& getTextures() const { return m_Textures; };
 
 		void bindTextures() const;
 		void bindShader() const;
@@ -112,6 +123,23 @@ namespace lost
 		inline const std::vector<MaterialUniform>& getMaterialUniforms() const { return m_MaterialUniforms; };
 		void bindMaterialUniforms();
 
+		// Copies the material's textures into texture pages if they aren't already, and writes the material as it's read by shaders using material batching
+		void prepareBatch(BatchedMaterialData& data);
+		// Binds the texture page of each of the material's textures, as sampler2DArrays, prepareBatch() must have been ran first
+		void bindBatchPages() const;
+		// If the materials' textures are in the same texture pages, so they can be drawn in the same batch
+		bool sharesBatchPages(const _Material* other) const;
+		// A hash of the pages the material's textures are in, used to sort materials sharing pages next to each other
+		inline uint32_t getBatchPageHash() const { return m_BatchPageHash; };
+
+		// Which queue the material was last prepared for, and it's index in that queue's material buffer
+		inline unsigned int getBatchStamp() const { return m_BatchStamp; };
+		inline unsigned int getBatchIndex() const { return m_BatchIndex; };
+		inline void         setBatchIndex(unsigned int stamp, unsigned int index) { m_BatchStamp = stamp; m_BatchIndex = index; };
+
+		// A handle to the material, which can be checked for if the material was destroyed, see resolveMaterial()
+		inline ResourceHandle getHandle() { return m_Handle.get(this); };
+
 	private:
 		unsigned int m_QueueLevel;
 
@@ -131,6 +159,15 @@ namespace lost
 		Shader m_Shader;
 		std::vector<Texture> m_Textures;
 		std::vector<MaterialUniform> m_MaterialUniforms;
+
+		// Only used by shaders using material batching
+		unsigned int m_BatchPages[_MaxBatchTextures] = {};
+		unsigned int m_BatchPageCount = 0;
+		uint32_t m_BatchPageHash = 0;
+		unsigned int m_BatchStamp = 0;
+		unsigned int m_BatchIndex = 0;
+
+		_OwnedHandle<_Material*> m_Handle;
 	};
 
 	// A reference to a material
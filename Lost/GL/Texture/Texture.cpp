@@ -1,12 +1,19 @@
 #include "Texture.h"
 
 #include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 #include "Material.h"
+#include "TextureImage.h"
+#include "TexturePages.h"
+#include "TextureStreaming.h"
 #include "../LostGL.h"
+#include "../PixelTransfer.h"
 #include "../Renderer.h"
 #include "../../Log.h"
+#include "../../AsyncLoader.h"
 
 #include "../STB/STBImplementation.h"
 
@@ -19,25 +26,174 @@ namespace lost
 
 	_Texture::~_Texture()
 	{
+		_cancelAsyncLoads(this);
+		_releaseTexturePageSlot(this);
+		releaseStreamSource();
+
 		if (m_HandleDeletion)
-			glDeleteTextures(1, &m_Texture);
+			_deleteGLTextures(1, &m_Texture);
 		delete m_TextureMaterial;
 	}
 
+	// The image read on a worker thread, handed to the texture once it's back on the main thread
+	class TextureLoad : public _AsyncLoad
+	{
+	public:
+		TextureLoad(_Texture* texture, const char* dir) : _AsyncLoad(texture), m_Directory(dir) {};
+		~TextureLoad()
+		{
+			delete m_Image;
+			if (m_Upload != nullptr)
+				_cancelPixelUpload(m_Upload);
+		};
+
+		void load() override
+		{
+			m_Image = new _TextureImage();
+			if (!m_Image->read(m_Directory.c_str()))
+				return;
+
+			// The pixels are copied into the upload buffer here, so the main thread only has to start the transfer
+			// Streamed textures only upload a few of their levels, so aren't worth staging
+			if (isTextureStreaming() && m_Image->hasPrebuiltLevels())
+				return;
+
+			size_t size = 0;
+			for (const TextureLevel& level : m_Image->getLevels())
+				size += level.size;
+
+			m_Upload = _allocatePixelUpload(size);
+			if (m_Upload == nullptr)
+				return;
+
+			unsigned char* destination = m_Upload->data;
+			for (const TextureLevel& level : m_Image->getLevels())
+			{
+				memcpy(destination, level.data, level.size);
+				destination += level.size;
+			}
+		}
+
+		void finish() override
+		{
+			// The texture takes the image, it may keep it to stream levels from
+			_TextureImage* image = m_Image;
+			_PixelUpload* upload = m_Upload;
+			m_Image = nullptr;
+			m_Upload = nullptr;
+			((_Texture*)getTarget())->_finishLoad(m_Directory.c_str(), image, upload);
+		}
+	private:
+		std::string m_Directory;
+		_TextureImage* m_Image = nullptr;
+		_PixelUpload* m_Upload = nullptr;
+	};
+
+	// Makes an immutable texture holding the image's levels from firstLevel down, levelCount is set to how many it has
+	// Direct state access is used so the textures bound aren't changed
+	// The levels are read from the upload given if there is one, which is fenced afterwards
+	static unsigned int createTexture(const _TextureImage& image, unsigned int firstLevel, unsigned int& levelCount, _PixelUpload* upload = nullptr)
+	{
+		const std::vector<TextureLevel>& levels = image.getLevels();
+		const TextureLevel& base = levels[firstLevel];
+
+		// Block compressed levels can't be generated, so compressed images without levels of their own only get the one
+		bool generateLevels = !image.hasPrebuiltLevels() && !image.isCompressed();
+		levelCount = generateLevels ? _getMipLevelCount(base.width, base.height) : (unsigned int)levels.size() - firstLevel;
+
+		unsigned int texture;
+		glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+		glTextureStorage2D(texture, levelCount, image.getInternalFormat(), base.width, base.height);
+
+		// While a pixel unpack buffer is bound, the pointers given are offsets into it
+		size_t uploadOffset = 0;
+		if (upload != nullptr)
+		{
+			_glState->bindBuffer(GL_PIXEL_UNPACK_BUFFER, _getPixelUploadBuffer());
+			uploadOffset = upload->offset;
+			for (unsigned int i = 0; i < firstLevel; i++)
+				uploadOffset += levels[i].size;
+		}
+
+		for (unsigned int i = firstLevel; i < levels.size(); i++)
+		{
+			const TextureLevel& level = levels[i];
+			const void* pixels = upload != nullptr ? (const void*)(uintptr_t)uploadOffset : level.data;
+			uploadOffset += level.size;
+
+			if (image.isCompressed())
+				glCompressedTextureSubImage2D(texture, i - firstLevel, 0, 0, level.width, level.height, image.getInternalFormat(), level.size, pixels);
+			else
+				glTextureSubImage2D(texture, i - firstLevel, 0, 0, level.width, level.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		}
+
+		if (upload != nullptr)
+		{
+			_glState->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			_finishPixelUpload(upload);
+		}
+
+		if (generateLevels && levelCount > 1)
+			glGenerateTextureMipmap(texture);
+
+		//Configure sampler
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST);
+		glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		return texture;
+	}
+
 	void _Texture::loadTexture(const char* dir)
+	{
+		_TextureImage* image = new _TextureImage();
+		image->read(dir);
+
+		_finishLoad(dir, image);
+	}
+
+	void _Texture::loadTextureAsync(const char* dir)
 	{
 		m_Directory = dir;
 
-		int channels;
-		unsigned char* data = stbi_load(dir, &m_Width, &m_Height, &channels, STBI_rgb_alpha);
+		// The white texture stands in until the image is ready, it isn't owned so it must never be deleted by this
+		if (m_Texture == -1)
+		{
+			m_Revision++;
+			m_Width = 1;
+			m_Height = 1;
+			m_Texture = getDefaultWhiteTexture()->getTexture();
+			m_HandleDeletion = false;
+			m_TextureMaterial = new _Material(lost::_defaultShader, { this });
+		}
+
+		_queueAsyncLoad(new TextureLoad(this, dir));
+	}
+
+	void _Texture::_finishLoad(const char* dir, _TextureImage* image, _PixelUpload* upload)
+	{
+		m_Directory = dir;
+		m_Revision++;
+		releaseStreamSource();
 
-		if (data == 0)
+		if (!image->isValid())
 		{
+			delete image;
+			if (upload != nullptr)
+				_cancelPixelUpload(upload);
 			debugLog(std::string("Failed to load image at \"") + dir + "\", file may be broken, open by another program, missing or inaccessible", LOST_LOG_WARNING);
 
 			bool overridingTexture = m_Texture != -1;
+			if (overridingTexture && m_HandleDeletion)
+				_deleteGLTextures(1, &m_Texture);
 			
+			m_Width = 1;
+			m_Height = 1;
+			m_LevelCount = 1;
+			m_ResidentLevel = 0;
 			m_Texture = getDefaultWhiteTexture()->getTexture();
+			m_HandleDeletion = false;
 			if (!overridingTexture)
 				m_TextureMaterial = new _Material(lost::_defaultShader, { this });
 			else
@@ -46,32 +202,30 @@ namespace lost
 			return;
 		}
 
+		m_Width = image->getLevels()[0].width;
+		m_Height = image->getLevels()[0].height;
+
 		// Check if texture has already been loaded
 		bool overridingTexture = false;
 		if (m_Texture != -1)
 		{
 			overridingTexture = true;
-			glDeleteTextures(1, &m_Texture);
+			if (m_HandleDeletion)
+				_deleteGLTextures(1, &m_Texture);
 		}
 
-		//make the texture
-		glGenTextures(1, &m_Texture);
-
-		glBindTexture(GL_TEXTURE_2D, m_Texture);
+		// Streamed textures start with only their smallest levels, the rest are uploaded once something is drawn with them
+		bool streamed = isTextureStreaming() && image->hasPrebuiltLevels();
+		m_ResidentLevel = streamed ? _getStreamingStartLevel(*image) : 0;
+		m_Texture = createTexture(*image, m_ResidentLevel, m_LevelCount, upload);
 
-		//load data
-		glTexImage2D(GL_TEXTURE_2D,
-			0, GL_RGBA, m_Width, m_Height, 0,
-			GL_RGBA, GL_UNSIGNED_BYTE, data); 
-
-		//free data
-		stbi_image_free(data);
-
-		//Configure sampler
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		if (streamed)
+		{
+			m_StreamSource = image;
+			_registerStreamedTexture(this);
+		}
+		else
+			delete image;
 
 		if (!overridingTexture)
 			m_TextureMaterial = new _Material(lost::_defaultShader, { this });
@@ -83,22 +237,77 @@ namespace lost
 		m_HandleDeletion = true;
 	}
 
+	void _Texture::_setResidentLevel(unsigned int level)
+	{
+		if (m_StreamSource == nullptr)
+			return;
+
+		unsigned int lastLevel = (unsigned int)m_StreamSource->getLevels().size() - 1;
+		level = level < lastLevel ? level : lastLevel;
+		if (level == m_ResidentLevel)
+			return;
+
+		// Immutable storage can't change size, so the texture is made again with the levels wanted
+		unsigned int texture = createTexture(*m_StreamSource, level, m_LevelCount);
+		_deleteGLTextures(1, &m_Texture);
+
+		m_Texture = texture;
+		m_ResidentLevel = level;
+		m_Revision++;
+	}
+
+	void _Texture::_stopStreaming()
+	{
+		_setResidentLevel(0);
+		releaseStreamSource();
+	}
+
+	void _Texture::_replaceTexture(unsigned int openGLTexture, int width, int height)
+	{
+		releaseStreamSource();
+		if (m_Texture != -1 && m_HandleDeletion)
+			_deleteGLTextures(1, &m_Texture);
+
+		m_Texture = openGLTexture;
+		m_Width = width;
+		m_Height = height;
+		m_LevelCount = 1;
+		m_ResidentLevel = 0;
+		m_HandleDeletion = true;
+		m_Revision++;
+	}
+
+	void _Texture::releaseStreamSource()
+	{
+		if (m_StreamSource == nullptr)
+			return;
+
+		_unregisterStreamedTexture(this);
+		delete m_StreamSource;
+		m_StreamSource = nullptr;
+	}
+
 	void _Texture::makeTexture(const char* data, int width, int height, unsigned int format)
 	{
 		m_Width = width;
 		m_Height = height;
+		m_LevelCount = 1;
+		m_ResidentLevel = 0;
+		m_Revision++;
+		releaseStreamSource();
 
 		// Check if texture has already been loaded
 		if (m_Texture != -1)
 		{
-			glDeleteTextures(1, &m_Texture);
+			if (m_HandleDeletion)
+				_deleteGLTextures(1, &m_Texture);
 			delete m_TextureMaterial;
 		}
 
 		//make the texture
 		glGenTextures(1, &m_Texture);
 
-		glBindTexture(GL_TEXTURE_2D, m_Texture);
+		_glState->bindTexture(0, GL_TEXTURE_2D, m_Texture);
 
 		//load data
 		glTexImage2D(GL_TEXTURE_2D,
@@ -118,15 +327,22 @@ namespace lost
 
 	void _Texture::makeTexture(unsigned int openGLTexture, bool handleDelete)
 	{
-		m_HandleDeletion = handleDelete;
+		m_LevelCount = 1;
+		m_ResidentLevel = 0;
+		m_Revision++;
+		releaseStreamSource();
 
 		if (m_Texture != -1)
 		{
-			if (handleDelete)
-				glDeleteTextures(1, &m_Texture);
+			// Whether the old texture is ours to delete depends on how it was made, not on the one replacing it
+			if (m_HandleDeletion && m_Texture != openGLTexture)
+				_deleteGLTextures(1, &m_Texture);
 			delete m_TextureMaterial;
 		}
+		m_HandleDeletion = handleDelete;
 
+		// The size is read from the texture bound, so make sure it's the one given
+		_glState->bindTexture(0, GL_TEXTURE_2D, openGLTexture);
 		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &m_Width);
 		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &m_Height);
 
@@ -136,8 +352,7 @@ namespace lost
 
 	void _Texture::bind(int slot) const
 	{
-		glActiveTexture(GL_TEXTURE0 + slot); 
-		glBindTexture(GL_TEXTURE_2D, m_Texture);
+		_glState->bindTexture(slot, GL_TEXTURE_2D, m_Texture);
 	}
 
 }
\ No newline at end of file
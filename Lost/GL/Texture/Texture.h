@@ -1,11 +1,14 @@
 #pragma once
 #include "../STB/stb_image.h"
 #include <string>
+#include "../../ResourceHandle.h"
 
 namespace lost
 {
 
 	class _Material;
+	class _TextureImage;
+	struct _PixelUpload;
 
 	class _Texture
 	{
@@ -14,6 +17,13 @@ namespace lost
 		~_Texture();
 
 		void loadTexture(const char* dir);
+		// Shows the default white texture until the image at dir has been decoded on a worker thread and uploaded, see AsyncLoader.h
+		void loadTextureAsync(const char* dir);
+		// Uploads the image read from dir and takes ownership of it, if it failed to read the white texture is used
+		// Images without levels of their own have a full mip chain generated, .dds and .ktx2 levels are uploaded as they are
+		// If upload isn't nullptr it holds every level of the image one after the other, and is uploaded from instead
+		// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+		void _finishLoad(const char* dir, _TextureImage* image, _PixelUpload* upload = nullptr);
 		void makeTexture(const char* data, int width, int height, unsigned int format);
 		void makeTexture(unsigned int openGLTexture, bool handleDelete = false);
 
@@ -23,20 +33,59 @@ namespace lost
 		inline int getWidth() const { return m_Width; };
 		inline int getHeight() const { return m_Height; };
 
+		// The size of the largest level uploaded, smaller than the texture's size if it's being streamed, see TextureStreaming.h
+		inline int getResidentWidth() const { return m_Width >> m_ResidentLevel > 0 ? m_Width >> m_ResidentLevel : 1; };
+		inline int getResidentHeight() const { return m_Height >> m_ResidentLevel > 0 ? m_Height >> m_ResidentLevel : 1; };
+		// Which of the image's levels is the texture's first level, always 0 unless it's being streamed
+		inline unsigned int getResidentLevel() const { return m_ResidentLevel; };
+		// The amount of mip levels the OpenGL texture has
+		inline unsigned int getLevelCount() const { return m_LevelCount; };
+
 		inline unsigned int getTexture() const { return m_Texture; };
 		inline _Material* getMaterial() const { return m_TextureMaterial; };
+		// Increases every time the texture's contents are replaced, so copies of it know when they're out of date
+		inline unsigned int getRevision() const { return m_Revision; };
 
 		inline const char* getDirectory() const { return m_Directory.c_str(); };
+
+		// The image streamed levels are read from, nullptr if the texture isn't being streamed
+		// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+		inline const _TextureImage* _getStreamSource() const { return m_StreamSource; };
+		// Re-creates the texture starting at the image's level given, dropping or uploading levels as needed
+		// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+		void _setResidentLevel(unsigned int level);
+		// Uploads every level and stops streaming the texture, freeing the image
+		// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+		void _stopStreaming();
+		// Swaps in a texture owned by this, keeping the texture's material, used by textures that grow like atlas pages
+		// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+		void _replaceTexture(unsigned int openGLTexture, int width, int height);
+		// Marks the texture's contents as changed after writing into it, so copies of it are remade
+		// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+		inline void _markChanged() { m_Revision++; };
+
+		// A handle to the texture, which can be checked for if the texture was destroyed, see resolveTexture()
+		inline ResourceHandle getHandle() { return m_Handle.get(this); };
 	private:
+		// Drops the streamed image without touching the OpenGL texture
+		void releaseStreamSource();
+
 		int m_Width;
 		int m_Height;
 
 		unsigned int m_Texture = -1;
+		unsigned int m_Revision = 0;
+		unsigned int m_LevelCount = 1;
+		unsigned int m_ResidentLevel = 0;
 		_Material* m_TextureMaterial = nullptr;
 
+		_TextureImage* m_StreamSource = nullptr;
+
 		std::string m_Directory = "No directory";
 
 		bool m_HandleDeletion = true;
+
+		_OwnedHandle<_Texture*> m_Handle;
 	};
 
 	// A reference to a texture
@@ -0,0 +1,334 @@
+#include "TextureAtlas.h"
+
+#include <glad/glad.h>
+#include <climits>
+#include <vector>
+
+#include "../LostGL.h"
+#include "../GLStateCache.h"
+#include "../../Log.h"
+
+namespace lost
+{
+
+	// A page of the atlas, packed using max rects, which tracks the largest free rects left (which may overlap each other)
+	// and places each sprite in the one it fits tightest
+	struct AtlasPage
+	{
+		Texture texture = nullptr; // nullptr once the page has been emptied, the slot is reused by the next page made
+		int size = 0;
+		unsigned int spriteCount = 0;
+		std::vector<AtlasRect> freeRects;
+	};
+
+	static const int s_AtlasStartSize = 512;
+	static const int s_AtlasMaxSize = 2048;
+	// Empty pixels around each sprite, so filtering never reads from the sprite next to it
+	static const int s_AtlasPadding = 1;
+
+	static std::vector<AtlasPage> s_AtlasPages;
+
+	static inline bool rectsOverlap(const AtlasRect& a, const AtlasRect& b)
+	{
+		return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+	}
+
+	static inline bool rectContains(const AtlasRect& outer, const AtlasRect& inner)
+	{
+		return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+	}
+
+	static unsigned int createPageTexture(int size)
+	{
+		unsigned int texture;
+		glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+		glTextureStorage2D(texture, 1, GL_RGBA8, size, size);
+
+		// Starts fully transparent, so the padding between sprites is empty
+		glClearTexImage(texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		return texture;
+	}
+
+	// Removes free rects which are inside of another, they can never be a better fit than the one containing them
+	static void pruneFreeRects(AtlasPage& page)
+	{
+		std::vector<AtlasRect>& freeRects = page.freeRects;
+		for (size_t i = 0; i < freeRects.size();)
+		{
+			bool contained = false;
+			for (size_t j = 0; j < freeRects.size() && !contained; j++)
+				contained = j != i && rectContains(freeRects[j], freeRects[i]);
+
+			if (contained)
+				freeRects.erase(freeRects.begin() + i);
+			else
+				i++;
+		}
+	}
+
+	// Finds the free rect the size given fits tightest into (best short side fit), returns false if it fits into none
+	static bool findPosition(const AtlasPage& page, int width, int height, AtlasRect& rect)
+	{
+		int bestShortSide = INT_MAX;
+		int bestLongSide = INT_MAX;
+
+		for (const AtlasRect& freeRect : page.freeRects)
+		{
+			if (freeRect.w < width || freeRect.h < height)
+				continue;
+
+			int leftoverX = freeRect.w - width;
+			int leftoverY = freeRect.h - height;
+			int shortSide = leftoverX < leftoverY ? leftoverX : leftoverY;
+			int longSide = leftoverX < leftoverY ? leftoverY : leftoverX;
+
+			if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+			{
+				rect = { freeRect.x, freeRect.y, width, height };
+				bestShortSide = shortSide;
+				bestLongSide = longSide;
+			}
+		}
+
+		return bestShortSide != INT_MAX;
+	}
+
+	// Splits every free rect the used rect overlaps into the parts on each side of it
+	static void placeRect(AtlasPage& page, const AtlasRect& used)
+	{
+		std::vector<AtlasRect> splitRects;
+		for (size_t i = 0; i < page.freeRects.size();)
+		{
+			AtlasRect freeRect = page.freeRects[i];
+			if (!rectsOverlap(freeRect, used))
+			{
+				i++;
+				continue;
+			}
+
+			if (used.x > freeRect.x)
+				splitRects.push_back({ freeRect.x, freeRect.y, used.x - freeRect.x, freeRect.h });
+			if (used.x + used.w < freeRect.x + freeRect.w)
+				splitRects.push_back({ used.x + used.w, freeRect.y, freeRect.x + freeRect.w - (used.x + used.w), freeRect.h });
+			if (used.y > freeRect.y)
+				splitRects.push_back({ freeRect.x, freeRect.y, freeRect.w, used.y - freeRect.y });
+			if (used.y + used.h < freeRect.y + freeRect.h)
+				splitRects.push_back({ freeRect.x, used.y + used.h, freeRect.w, freeRect.y + freeRect.h - (used.y + used.h) });
+
+			page.freeRects[i] = page.freeRects.back();
+			page.freeRects.pop_back();
+		}
+
+		page.freeRects.insert(page.freeRects.end(), splitRects.begin(), splitRects.end());
+		pruneFreeRects(page);
+		page.spriteCount++;
+	}
+
+	// Doubles the size of the page, sprites stay where they are in pixels so only their UVs change
+	static void growPage(AtlasPage& page)
+	{
+		int oldSize = page.size;
+		int newSize = oldSize * 2;
+
+		unsigned int texture = createPageTexture(newSize);
+		glCopyImageSubData(page.texture->getTexture(), GL_TEXTURE_2D, 0, 0, 0, 0, texture, GL_TEXTURE_2D, 0, 0, 0, 0, oldSize, oldSize, 1);
+		page.texture->_replaceTexture(texture, newSize, newSize);
+
+		// Free rects touching the old edges carry on into the new space
+		for (AtlasRect& freeRect : page.freeRects)
+		{
+			if (freeRect.x + freeRect.w == oldSize)
+				freeRect.w += oldSize;
+			if (freeRect.y + freeRect.h == oldSize)
+				freeRect.h += oldSize;
+		}
+		page.freeRects.push_back({ oldSize, 0, oldSize, newSize });
+		page.freeRects.push_back({ 0, oldSize, newSize, oldSize });
+		pruneFreeRects(page);
+
+		page.size = newSize;
+	}
+
+	// Finds space for a rect of the size given, in an existing page if it fits, otherwise growing one or making a new one
+	static bool allocateRect(int width, int height, unsigned int& pageIndex, AtlasRect& rect)
+	{
+		if (width > s_AtlasMaxSize || height > s_AtlasMaxSize)
+			return false;
+
+		for (unsigned int i = 0; i < s_AtlasPages.size(); i++)
+		{
+			if (s_AtlasPages[i].texture != nullptr && findPosition(s_AtlasPages[i], width, height, rect))
+			{
+				pageIndex = i;
+				placeRect(s_AtlasPages[i], rect);
+				return true;
+			}
+		}
+
+		// Growing keeps sprites together in as few pages as possible, so is preferred over making a new page
+		for (unsigned int i = 0; i < s_AtlasPages.size(); i++)
+		{
+			AtlasPage& page = s_AtlasPages[i];
+			while (page.texture != nullptr && page.size < s_AtlasMaxSize)
+			{
+				growPage(page);
+				if (findPosition(page, width, height, rect))
+				{
+					pageIndex = i;
+					placeRect(page, rect);
+					return true;
+				}
+			}
+		}
+
+		pageIndex = (unsigned int)s_AtlasPages.size();
+		for (unsigned int i = 0; i < s_AtlasPages.size(); i++)
+		{
+			if (s_AtlasPages[i].texture == nullptr)
+			{
+				pageIndex = i;
+				break;
+			}
+		}
+		if (pageIndex == s_AtlasPages.size())
+			s_AtlasPages.emplace_back();
+
+		AtlasPage& page = s_AtlasPages[pageIndex];
+		page.size = s_AtlasStartSize;
+		while (page.size < width || page.size < height)
+			page.size *= 2;
+
+		page.texture = new _Texture();
+		page.texture->makeTexture(createPageTexture(page.size), true);
+		page.spriteCount = 0;
+		page.freeRects.assign(1, { 0, 0, page.size, page.size });
+
+		rect = { 0, 0, width, height };
+		placeRect(page, rect);
+		return true;
+	}
+
+	static void releaseRect(unsigned int pageIndex, const AtlasRect& rect)
+	{
+		AtlasPage& page = s_AtlasPages[pageIndex];
+
+		// Empty pages are deleted, rather than kept around at whatever size they grew to
+		if (--page.spriteCount == 0)
+		{
+			delete page.texture;
+			page.texture = nullptr;
+			page.freeRects.clear();
+			return;
+		}
+
+		// The rect is free space which doesn't overlap any sprite, so it's a valid free rect as it is
+		page.freeRects.push_back(rect);
+		pruneFreeRects(page);
+	}
+
+	_Sprite::_Sprite()
+	{
+	}
+
+	_Sprite::~_Sprite()
+	{
+		release();
+	}
+
+	void _Sprite::loadSprite(const char* dir)
+	{
+		m_Directory = dir;
+
+		int width, height, channels;
+		unsigned char* data = stbi_load(dir, &width, &height, &channels, STBI_rgb_alpha);
+		if (data == nullptr)
+		{
+			debugLog(std::string("Failed to load sprite at \"") + dir + "\", file may be broken, open by another program, missing or inaccessible", LOST_LOG_WARNING);
+			release();
+			return;
+		}
+
+		makeSprite(data, width, height);
+		stbi_image_free(data);
+
+		debugLogIf(isPacked(), std::string("Successfully loaded sprite at \"") + dir + "\"", LOST_LOG_SUCCESS);
+	}
+
+	void _Sprite::makeSprite(const unsigned char* data, int width, int height)
+	{
+		release();
+
+		AtlasRect rect;
+		unsigned int page;
+		if (width <= 0 || height <= 0 || !allocateRect(width + s_AtlasPadding * 2, height + s_AtlasPadding * 2, page, rect))
+		{
+			debugLog("Failed to pack sprite \"" + m_Directory + "\" (" + std::to_string(width) + "x" + std::to_string(height) + "), sprites must fit inside of a " + std::to_string(s_AtlasMaxSize) + "x" + std::to_string(s_AtlasMaxSize) + " page with padding", LOST_LOG_WARNING);
+			return;
+		}
+
+		m_Page = page;
+		m_Rect = rect;
+		m_Width = width;
+		m_Height = height;
+
+		Texture pageTexture = s_AtlasPages[page].texture;
+		glTextureSubImage2D(pageTexture->getTexture(), 0, rect.x + s_AtlasPadding, rect.y + s_AtlasPadding, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		pageTexture->_markChanged();
+	}
+
+	Texture _Sprite::getPage() const
+	{
+		return isPacked() ? s_AtlasPages[m_Page].texture : nullptr;
+	}
+
+	Material _Sprite::getMaterial() const
+	{
+		return isPacked() ? s_AtlasPages[m_Page].texture->getMaterial() : getDefaultWhiteMaterial();
+	}
+
+	Bounds2D _Sprite::getTexBounds() const
+	{
+		if (!isPacked())
+			return { 0.0f, 0.0f, 1.0f, 1.0f };
+
+		float pageSize = (float)s_AtlasPages[m_Page].size;
+		return {
+			(m_Rect.x + s_AtlasPadding) / pageSize,
+			(m_Rect.y + s_AtlasPadding) / pageSize,
+			m_Width / pageSize,
+			m_Height / pageSize
+		};
+	}
+
+	void _Sprite::release()
+	{
+		if (isPacked())
+			releaseRect(m_Page, m_Rect);
+
+		m_Page = -1;
+		m_Width = 0;
+		m_Height = 0;
+	}
+
+	void _destroyTextureAtlas()
+	{
+		for (AtlasPage& page : s_AtlasPages)
+			delete page.texture;
+		s_AtlasPages.clear();
+	}
+
+	unsigned int getAtlasPageCount()
+	{
+		unsigned int pageCount = 0;
+		for (const AtlasPage& page : s_AtlasPages)
+			pageCount += page.texture != nullptr;
+		return pageCount;
+	}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Material.h"
+#include "../Vector.h"
+#include <string>
+
+namespace lost
+{
+
+	// Where a sprite is packed inside of it's atlas page, in pixels
+	struct AtlasRect
+	{
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+	};
+
+	// A small texture packed into one of the texture atlas' pages alongside others
+	// Every sprite in a page shares the page's texture and material, so drawing sprites from the same page never breaks a batch
+	// Pages start at 512x512 and grow up to 2048x2048, then new pages are made, sprites larger than a page can't be packed
+	// When a page grows the UVs of it's sprites change, always use getTexBounds() rather than storing them
+	class _Sprite
+	{
+	public:
+		_Sprite();
+		// Frees the sprite's space in it's page, the page is deleted once it has no sprites left
+		~_Sprite();
+
+		// Decodes the image at dir and packs it into a page, if it failed to load or doesn't fit the sprite is left empty
+		void loadSprite(const char* dir);
+		// Packs the RGBA pixels given into a page
+		void makeSprite(const unsigned char* data, int width, int height);
+
+		inline int getWidth() const { return m_Width; };
+		inline int getHeight() const { return m_Height; };
+		inline bool isPacked() const { return m_Page != -1; };
+
+		// The page the sprite is packed into, nullptr if it isn't packed
+		Texture  getPage() const;
+		// The material of the page, use with renderRect() and getTexBounds(), the default white material if it isn't packed
+		Material getMaterial() const;
+		// The area of the page the sprite takes up in UVs (0 to 1), as renderRect() takes them
+		Bounds2D getTexBounds() const;
+
+		inline const char* getDirectory() const { return m_Directory.c_str(); };
+	private:
+		void release();
+
+		unsigned int m_Page = -1;
+		AtlasRect m_Rect; // Including padding
+		int m_Width = 0;
+		int m_Height = 0;
+
+		std::string m_Directory = "No directory";
+	};
+
+	// A reference to a sprite
+	typedef _Sprite* Sprite;
+
+	// Deletes every atlas page, ran when Lost exits
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _destroyTextureAtlas();
+
+	// Returns the amount of atlas pages in use
+	unsigned int getAtlasPageCount();
+
+}
@@ -0,0 +1,297 @@
+#include "TextureImage.h"
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "../STB/stb_image.h"
+#include "../../Log.h"
+
+// S3TC is an extension rather than core, so glad doesn't define it's formats
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT        0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT       0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT       0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT       0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace lost
+{
+
+	// How the pixels of a format are laid out, compressed formats are stored in 4x4 blocks
+	struct ImageFormat
+	{
+		unsigned int internalFormat;
+		bool compressed;
+		unsigned int blockBytes; // Bytes per 4x4 block if compressed, otherwise bytes per pixel
+	};
+
+	static const ImageFormat s_UnknownFormat = { 0, false, 0 };
+
+	static inline uint32_t readU32(const unsigned char* at)
+	{
+		uint32_t value;
+		memcpy(&value, at, sizeof(value));
+		return value;
+	}
+
+	static inline uint64_t readU64(const unsigned char* at)
+	{
+		uint64_t value;
+		memcpy(&value, at, sizeof(value));
+		return value;
+	}
+
+	static inline uint32_t fourCC(const char* code)
+	{
+		return (uint32_t)(unsigned char)code[0] | ((uint32_t)(unsigned char)code[1] << 8) | ((uint32_t)(unsigned char)code[2] << 16) | ((uint32_t)(unsigned char)code[3] << 24);
+	}
+
+	static size_t getLevelSize(const ImageFormat& format, int width, int height)
+	{
+		if (format.compressed)
+			return (size_t)((width + 3) / 4) * ((height + 3) / 4) * format.blockBytes;
+		return (size_t)width * height * format.blockBytes;
+	}
+
+	unsigned int _getMipLevelCount(int width, int height)
+	{
+		unsigned int levels = 1;
+		for (int size = width > height ? width : height; size > 1; size >>= 1)
+			levels++;
+		return levels;
+	}
+
+	_TextureImage::_TextureImage()
+	{
+	}
+
+	_TextureImage::~_TextureImage()
+	{
+		stbi_image_free(m_Pixels);
+	}
+
+	bool _TextureImage::read(const char* dir)
+	{
+		std::string directory = dir;
+		std::string extension = directory.substr(directory.find_last_of('.') + 1);
+		for (char& character : extension)
+			character = (char)tolower(character);
+
+		if (extension == "dds")
+			return readDDS(dir);
+		if (extension == "ktx2")
+			return readKTX2(dir);
+
+		int width, height, channels;
+		m_Pixels = stbi_load(dir, &width, &height, &channels, STBI_rgb_alpha);
+		if (m_Pixels == nullptr)
+			return false;
+
+		m_InternalFormat = GL_RGBA8;
+		m_Compressed = false;
+		m_Levels.push_back({ m_Pixels, (unsigned int)(width * height * 4), width, height });
+		return true;
+	}
+
+#pragma region .dds file reading
+
+	// Reads the format of a DX10 extended header
+	static ImageFormat getDXGIFormat(uint32_t dxgiFormat)
+	{
+		switch (dxgiFormat)
+		{
+		case 28: return { GL_RGBA8, false, 4 };                                    // DXGI_FORMAT_R8G8B8A8_UNORM
+		case 29: return { GL_SRGB8_ALPHA8, false, 4 };                             // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+		case 71: return { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, true, 8 };             // DXGI_FORMAT_BC1_UNORM
+		case 72: return { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, true, 8 };       // DXGI_FORMAT_BC1_UNORM_SRGB
+		case 77: return { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, true, 16 };            // DXGI_FORMAT_BC3_UNORM
+		case 78: return { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, true, 16 };      // DXGI_FORMAT_BC3_UNORM_SRGB
+		case 98: return { GL_COMPRESSED_RGBA_BPTC_UNORM, true, 16 };               // DXGI_FORMAT_BC7_UNORM
+		case 99: return { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, true, 16 };         // DXGI_FORMAT_BC7_UNORM_SRGB
+		default: return s_UnknownFormat;
+		}
+	}
+
+	bool _TextureImage::readDDS(const char* dir)
+	{
+		// The header is 4 bytes of magic, then a 124 byte DDS_HEADER, then a 20 byte DDS_HEADER_DXT10 if the format is "DX10"
+		static const size_t headerSize = 4 + 124;
+		static const size_t dx10HeaderSize = 20;
+
+		if (!m_File.open(dir))
+			return false;
+
+		const unsigned char* data = (const unsigned char*)m_File.getData();
+		size_t size = m_File.getSize();
+
+		if (size < headerSize || memcmp(data, "DDS ", 4) != 0)
+		{
+			debugLog(std::string("Failed to load image at \"") + dir + "\", it isn't a .dds file", LOST_LOG_WARNING);
+			return false;
+		}
+
+		uint32_t flags = readU32(data + 8);
+		int height = (int)readU32(data + 12);
+		int width = (int)readU32(data + 16);
+		uint32_t mipCount = readU32(data + 28);
+		uint32_t pixelFlags = readU32(data + 80);
+		uint32_t pixelFourCC = readU32(data + 84);
+		uint32_t caps2 = readU32(data + 112);
+
+		ImageFormat format = s_UnknownFormat;
+		size_t dataOffset = headerSize;
+		bool isArray = (caps2 & 0x200) != 0; // DDSCAPS2_CUBEMAP
+
+		if (pixelFlags & 0x4) // DDPF_FOURCC
+		{
+			if (pixelFourCC == fourCC("DXT1"))
+				format = { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, true, 8 };
+			else if (pixelFourCC == fourCC("DXT5"))
+				format = { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, true, 16 };
+			else if (pixelFourCC == fourCC("DX10") && size >= headerSize + dx10HeaderSize)
+			{
+				format = getDXGIFormat(readU32(data + headerSize));
+				isArray |= readU32(data + headerSize + 4) != 3 || readU32(data + headerSize + 12) > 1; // Only single 2D textures
+				dataOffset += dx10HeaderSize;
+			}
+		}
+		else if ((pixelFlags & 0x40) && readU32(data + 88) == 32 &&
+			readU32(data + 92) == 0x000000FF && readU32(data + 96) == 0x0000FF00 && readU32(data + 100) == 0x00FF0000) // DDPF_RGB, in RGBA order
+			format = { GL_RGBA8, false, 4 };
+
+		if (format.internalFormat == 0 || isArray || width <= 0 || height <= 0)
+		{
+			debugLog(std::string("Failed to load image at \"") + dir + "\", only 2D BC1, BC3, BC7 and RGBA8 .dds files are supported", LOST_LOG_WARNING);
+			return false;
+		}
+
+		// The levels are stored one after the other, from largest to smallest
+		unsigned int levelCount = (flags & 0x20000) && mipCount > 0 ? mipCount : 1; // DDSD_MIPMAPCOUNT
+		levelCount = levelCount < _getMipLevelCount(width, height) ? levelCount : _getMipLevelCount(width, height);
+
+		size_t offset = dataOffset;
+		for (unsigned int level = 0; level < levelCount; level++)
+		{
+			int levelWidth = width >> level > 0 ? width >> level : 1;
+			int levelHeight = height >> level > 0 ? height >> level : 1;
+			size_t levelSize = getLevelSize(format, levelWidth, levelHeight);
+
+			if (offset > size || levelSize > size - offset)
+			{
+				debugLog(std::string("Failed to load image at \"") + dir + "\", the .dds file is cut short", LOST_LOG_WARNING);
+				m_Levels.clear();
+				return false;
+			}
+
+			m_Levels.push_back({ data + offset, (unsigned int)levelSize, levelWidth, levelHeight });
+			offset += levelSize;
+		}
+
+		m_InternalFormat = format.internalFormat;
+		m_Compressed = format.compressed;
+		return true;
+	}
+
+#pragma endregion
+
+#pragma region .ktx2 file reading
+
+	// Reads a VkFormat, .ktx2 files store their format the way Vulkan does
+	static ImageFormat getVkFormat(uint32_t vkFormat)
+	{
+		switch (vkFormat)
+		{
+		case 37:  return { GL_RGBA8, false, 4 };                                   // VK_FORMAT_R8G8B8A8_UNORM
+		case 43:  return { GL_SRGB8_ALPHA8, false, 4 };                            // VK_FORMAT_R8G8B8A8_SRGB
+		case 131: return { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, true, 8 };             // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case 132: return { GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, true, 8 };            // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+		case 133: return { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, true, 8 };            // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		case 134: return { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, true, 8 };      // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+		case 137: return { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, true, 16 };           // VK_FORMAT_BC3_UNORM_BLOCK
+		case 138: return { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, true, 16 };     // VK_FORMAT_BC3_SRGB_BLOCK
+		case 145: return { GL_COMPRESSED_RGBA_BPTC_UNORM, true, 16 };              // VK_FORMAT_BC7_UNORM_BLOCK
+		case 146: return { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, true, 16 };        // VK_FORMAT_BC7_SRGB_BLOCK
+		default:  return s_UnknownFormat;
+		}
+	}
+
+	bool _TextureImage::readKTX2(const char* dir)
+	{
+		// 12 byte identifier, 68 byte header and index, then 24 bytes per level in the level index
+		static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+		static const size_t headerSize = 80;
+		static const size_t levelIndexSize = 24;
+
+		if (!m_File.open(dir))
+			return false;
+
+		const unsigned char* data = (const unsigned char*)m_File.getData();
+		size_t size = m_File.getSize();
+
+		if (size < headerSize || memcmp(data, identifier, sizeof(identifier)) != 0)
+		{
+			debugLog(std::string("Failed to load image at \"") + dir + "\", it isn't a .ktx2 file", LOST_LOG_WARNING);
+			return false;
+		}
+
+		ImageFormat format = getVkFormat(readU32(data + 12));
+		int width = (int)readU32(data + 20);
+		int height = (int)readU32(data + 24);
+		uint32_t depth = readU32(data + 28);
+		uint32_t layerCount = readU32(data + 32);
+		uint32_t faceCount = readU32(data + 36);
+		uint32_t levelCount = readU32(data + 40);
+		uint32_t supercompression = readU32(data + 44);
+
+		// Basis Universal and zstd supercompressed files would need transcoding first
+		if (format.internalFormat == 0 || supercompression != 0 || depth > 1 || layerCount > 1 || faceCount != 1 || width <= 0 || height <= 0)
+		{
+			debugLog(std::string("Failed to load image at \"") + dir + "\", only 2D BC1, BC3, BC7 and RGBA8 .ktx2 files without supercompression are supported", LOST_LOG_WARNING);
+			return false;
+		}
+
+		// A level count of 0 asks for the levels to be generated
+		levelCount = levelCount > 0 ? levelCount : 1;
+		levelCount = levelCount < _getMipLevelCount(width, height) ? levelCount : _getMipLevelCount(width, height);
+
+		if (headerSize + levelCount * levelIndexSize > size)
+		{
+			debugLog(std::string("Failed to load image at \"") + dir + "\", the .ktx2 file is cut short", LOST_LOG_WARNING);
+			return false;
+		}
+
+		for (unsigned int level = 0; level < levelCount; level++)
+		{
+			const unsigned char* levelIndex = data + headerSize + level * levelIndexSize;
+			uint64_t offset = readU64(levelIndex);
+			uint64_t length = readU64(levelIndex + 8);
+
+			int levelWidth = width >> level > 0 ? width >> level : 1;
+			int levelHeight = height >> level > 0 ? height >> level : 1;
+			size_t levelSize = getLevelSize(format, levelWidth, levelHeight);
+
+			// Compared without adding the two, which could wrap around with crafted values
+			if (offset > size || length > size - offset || length < levelSize)
+			{
+				debugLog(std::string("Failed to load image at \"") + dir + "\", the .ktx2 file is cut short", LOST_LOG_WARNING);
+				m_Levels.clear();
+				return false;
+			}
+
+			m_Levels.push_back({ data + offset, (unsigned int)levelSize, levelWidth, levelHeight });
+		}
+
+		m_InternalFormat = format.internalFormat;
+		m_Compressed = format.compressed;
+		return true;
+	}
+
+#pragma endregion
+
+}
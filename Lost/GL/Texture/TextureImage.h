@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include "../../MappedFile.h"
+
+namespace lost
+{
+
+	// One mip level of an image, pointing into the image's pixels or the file it was mapped from
+	struct TextureLevel
+	{
+		const unsigned char* data;
+		unsigned int size; // In bytes
+		int width;
+		int height;
+	};
+
+	// An image read from disk, ready to be uploaded, reading one never touches OpenGL so it can be done on any thread
+	// .dds and .ktx2 files are mapped and their pre-built levels are uploaded as they are, which can be block compressed (BC1, BC3 or BC7)
+	// Anything else is decoded to RGBA8 by stb_image, and has it's mips generated once it's uploaded
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _TextureImage
+	{
+	public:
+		_TextureImage();
+		~_TextureImage();
+
+		// Returns false and logs why if the image couldn't be read, leaving it empty
+		bool read(const char* dir);
+
+		inline bool isValid() const { return !m_Levels.empty(); };
+
+		// The sized internal format the image is uploaded as, eg. GL_RGBA8 or GL_COMPRESSED_RGBA_BPTC_UNORM
+		inline unsigned int getInternalFormat() const { return m_InternalFormat; };
+		inline bool isCompressed() const { return m_Compressed; };
+		// If the levels were made ahead of time, otherwise there's only the first and the rest need generating
+		inline bool hasPrebuiltLevels() const { return m_Levels.size() > 1; };
+
+		inline const std::vector<TextureLevel>& getLevels() const { return m_Levels; };
+	private:
+		// Images can only be owned by one thing at a time, since they own the file they were mapped from
+		_TextureImage(const _TextureImage&) = delete;
+		_TextureImage& operator=(const _TextureImage&) = delete;
+
+		bool readDDS(const char* dir);
+		bool readKTX2(const char* dir);
+
+		unsigned int m_InternalFormat = 0;
+		bool m_Compressed = false;
+		std::vector<TextureLevel> m_Levels;
+
+		unsigned char* m_Pixels = nullptr; // Decoded by stb_image
+		_MappedFile m_File;                // Mapped .dds or .ktx2
+	};
+
+	// Returns the amount of mip levels a full chain down to 1x1 has for an image of the size given
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned int _getMipLevelCount(int width, int height);
+
+}
@@ -0,0 +1,162 @@
+#include "TexturePages.h"
+
+#include <glad/glad.h>
+#include <unordered_map>
+#include <vector>
+
+#include "../GLStateCache.h"
+#include "../../Log.h"
+
+namespace lost
+{
+
+	struct TexturePage
+	{
+		unsigned int texture = 0;
+		int width = 0;
+		int height = 0;
+		unsigned int format = 0;
+		unsigned int levels = 1;
+
+		unsigned int layerCapacity = 0;
+		unsigned int layersUsed = 0; // Layers past this have never been used
+		std::vector<unsigned int> freeLayers; // Layers before layersUsed which were released
+	};
+
+	struct PagedTexture
+	{
+		TexturePageSlot slot;
+		unsigned int revision; // The revision of the texture when it was copied, see _Texture::getRevision()
+	};
+
+	static const unsigned int s_FirstPageLayers = 4;
+	static const unsigned int s_MaxPageLayers = 256;
+
+	static std::vector<TexturePage> s_Pages;
+	static std::unordered_map<const _Texture*, PagedTexture> s_PagedTextures;
+
+	// The size of a mip level along one axis
+	static inline int getLevelSize(int size, unsigned int level)
+	{
+		return size >> level > 0 ? size >> level : 1;
+	}
+
+	// Direct state access is used throughout, so making pages never changes the textures bound
+	static unsigned int createPageTexture(const TexturePage& page)
+	{
+		unsigned int texture;
+		glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &texture);
+		glTextureStorage3D(texture, page.levels, page.format, page.width, page.height, page.layerCapacity);
+
+		// Matches the sampler every texture is made with
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, page.levels > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST);
+		glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		return texture;
+	}
+
+	static void growPage(TexturePage& page)
+	{
+		unsigned int oldTexture = page.texture;
+		unsigned int oldCapacity = page.layerCapacity;
+
+		page.layerCapacity = oldCapacity * 2 < s_MaxPageLayers ? oldCapacity * 2 : s_MaxPageLayers;
+		page.texture = createPageTexture(page);
+
+		for (unsigned int level = 0; level < page.levels; level++)
+			glCopyImageSubData(oldTexture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, page.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, getLevelSize(page.width, level), getLevelSize(page.height, level), oldCapacity);
+		_deleteGLTextures(1, &oldTexture);
+	}
+
+	// Finds a free layer in a page matching the size, format and levels given, making or growing a page if there isn't one
+	static TexturePageSlot allocateLayer(int width, int height, unsigned int format, unsigned int levels)
+	{
+		for (unsigned int i = 0; i < s_Pages.size(); i++)
+		{
+			TexturePage& page = s_Pages[i];
+			if (page.width != width || page.height != height || page.format != format || page.levels != levels)
+				continue;
+
+			if (!page.freeLayers.empty())
+			{
+				TexturePageSlot slot = { i, page.freeLayers.back() };
+				page.freeLayers.pop_back();
+				return slot;
+			}
+
+			if (page.layersUsed == page.layerCapacity && page.layerCapacity < s_MaxPageLayers)
+				growPage(page);
+
+			if (page.layersUsed < page.layerCapacity)
+				return { i, page.layersUsed++ };
+		}
+
+		TexturePage page;
+		page.width = width;
+		page.height = height;
+		page.format = format;
+		page.levels = levels;
+		page.layerCapacity = s_FirstPageLayers;
+		page.texture = createPageTexture(page);
+		page.layersUsed = 1;
+		s_Pages.push_back(page);
+
+		return { (unsigned int)s_Pages.size() - 1, 0 };
+	}
+
+	TexturePageSlot _getTexturePageSlot(Texture texture)
+	{
+		auto pagedTexture = s_PagedTextures.find(texture);
+		if (pagedTexture != s_PagedTextures.end())
+		{
+			if (pagedTexture->second.revision == texture->getRevision())
+				return pagedTexture->second.slot;
+
+			// The texture was reloaded since it was copied, it may not even be the same size anymore
+			_releaseTexturePageSlot(texture);
+		}
+
+		int format = 0;
+		glGetTextureLevelParameteriv(texture->getTexture(), 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+
+		// Streamed textures are copied at the size they currently are, they're copied again whenever their levels change
+		int width = texture->getResidentWidth();
+		int height = texture->getResidentHeight();
+		unsigned int levels = texture->getLevelCount();
+
+		TexturePageSlot slot = allocateLayer(width, height, (unsigned int)format, levels);
+		for (unsigned int level = 0; level < levels; level++)
+			glCopyImageSubData(texture->getTexture(), GL_TEXTURE_2D, level, 0, 0, 0, s_Pages[slot.page].texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, slot.layer, getLevelSize(width, level), getLevelSize(height, level), 1);
+
+		s_PagedTextures[texture] = { slot, texture->getRevision() };
+		return slot;
+	}
+
+	void _releaseTexturePageSlot(const _Texture* texture)
+	{
+		auto pagedTexture = s_PagedTextures.find(texture);
+		if (pagedTexture == s_PagedTextures.end())
+			return;
+
+		TexturePageSlot slot = pagedTexture->second.slot;
+		s_Pages[slot.page].freeLayers.push_back(slot.layer);
+		s_PagedTextures.erase(pagedTexture);
+	}
+
+	unsigned int _getTexturePageTexture(unsigned int page)
+	{
+		return s_Pages[page].texture;
+	}
+
+	void _destroyTexturePages()
+	{
+		for (TexturePage& page : s_Pages)
+			_deleteGLTextures(1, &page.texture);
+
+		s_Pages.clear();
+		s_PagedTextures.clear();
+	}
+
+}
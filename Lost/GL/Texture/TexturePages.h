@@ -0,0 +1,33 @@
+#pragma once
+#include "Texture.h"
+
+namespace lost
+{
+
+	// Where a texture's copy is stored inside of the texture pages
+	struct TexturePageSlot
+	{
+		unsigned int page = 0;  // Which page (GL_TEXTURE_2D_ARRAY) the copy is in
+		unsigned int layer = 0; // The layer of the page the copy is in
+	};
+
+	// Texture pages are texture arrays holding copies of textures which share the same size, format and mip levels
+	// Materials using a shader with material batching read their textures from these, so materials whose textures
+	// share pages can be drawn together, only the layers they read change between them
+	// Textures are copied the first time they're needed and again if they are reloaded, rendering into a texture
+	// afterwards won't update it's copy
+
+	// Returns where the texture's copy is stored, copying it into a page if it hasn't been already
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	TexturePageSlot _getTexturePageSlot(Texture texture);
+	// Frees the layer used by the texture's copy, ran when the texture is destroyed
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _releaseTexturePageSlot(const _Texture* texture);
+	// Returns the OpenGL texture array of the page given, this changes whenever the page grows
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned int _getTexturePageTexture(unsigned int page);
+	// Deletes every page, ran when Lost exits
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _destroyTexturePages();
+
+}
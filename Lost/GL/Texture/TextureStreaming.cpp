@@ -0,0 +1,154 @@
+#include "TextureStreaming.h"
+
+#include <atomic>
+#include <climits>
+#include <unordered_map>
+#include <vector>
+
+#include "TextureImage.h"
+
+namespace lost
+{
+
+	struct StreamedTexture
+	{
+		unsigned int requestedLevel = UINT_MAX; // The finest level asked for since the last update, UINT_MAX if it wasn't drawn
+		unsigned int framesOverRequested = 0;   // How many updates in a row the texture has had more levels than it needed
+	};
+
+	// Levels at or below this size are uploaded when a streamed texture loads
+	static const int s_StreamStartSize = 64;
+	// How many frames a texture has to go without needing it's finer levels before they are dropped
+	static const unsigned int s_StreamShrinkFrames = 120;
+
+	static std::atomic<bool> s_TextureStreaming(false); // Read by loader threads deciding if they need to stage pixels
+	static unsigned int s_StreamingBudget = 8 * 1024 * 1024;
+
+	static std::unordered_map<_Texture*, StreamedTexture> s_StreamedTextures;
+
+	// The amount of bytes uploaded when a texture is made starting at the level given
+	static size_t getUploadSize(const _TextureImage& image, unsigned int firstLevel)
+	{
+		size_t size = 0;
+		for (unsigned int i = firstLevel; i < image.getLevels().size(); i++)
+			size += image.getLevels()[i].size;
+		return size;
+	}
+
+	void setTextureStreaming(bool enabled)
+	{
+		s_TextureStreaming = enabled;
+		if (enabled)
+			return;
+
+		// Stopping unregisters the texture, so the list is copied first
+		std::vector<_Texture*> streamedTextures;
+		streamedTextures.reserve(s_StreamedTextures.size());
+		for (auto& streamedTexture : s_StreamedTextures)
+			streamedTextures.push_back(streamedTexture.first);
+
+		for (_Texture* texture : streamedTextures)
+			texture->_stopStreaming();
+	}
+
+	bool isTextureStreaming()
+	{
+		return s_TextureStreaming;
+	}
+
+	void setTextureStreamingBudget(unsigned int bytesPerFrame)
+	{
+		s_StreamingBudget = bytesPerFrame;
+	}
+
+	unsigned int _getStreamingStartLevel(const _TextureImage& image)
+	{
+		const std::vector<TextureLevel>& levels = image.getLevels();
+		for (unsigned int i = 0; i < levels.size(); i++)
+		{
+			if (levels[i].width <= s_StreamStartSize && levels[i].height <= s_StreamStartSize)
+				return i;
+		}
+		return (unsigned int)levels.size() - 1;
+	}
+
+	void _registerStreamedTexture(Texture texture)
+	{
+		s_StreamedTextures[texture] = StreamedTexture();
+	}
+
+	void _unregisterStreamedTexture(const _Texture* texture)
+	{
+		s_StreamedTextures.erase((_Texture*)texture);
+	}
+
+	void _requestTextureLevel(Texture texture, float pixelsAcross)
+	{
+		const _TextureImage* image = texture->_getStreamSource();
+		if (image == nullptr)
+			return;
+
+		auto streamedTexture = s_StreamedTextures.find(texture);
+		if (streamedTexture == s_StreamedTextures.end())
+			return;
+
+		// Each level halves the size, so the level needed is how many times the texture can be halved and still cover the pixels
+		unsigned int level = 0;
+		unsigned int lastLevel = (unsigned int)image->getLevels().size() - 1;
+		float texels = (float)(texture->getWidth() > texture->getHeight() ? texture->getWidth() : texture->getHeight());
+		while (level < lastLevel && texels * 0.5f >= pixelsAcross)
+		{
+			texels *= 0.5f;
+			level++;
+		}
+
+		unsigned int& requestedLevel = streamedTexture->second.requestedLevel;
+		requestedLevel = level < requestedLevel ? level : requestedLevel;
+	}
+
+	void _updateTextureStreaming()
+	{
+		size_t uploaded = 0;
+		for (auto& streamedTexture : s_StreamedTextures)
+		{
+			_Texture* texture = streamedTexture.first;
+			StreamedTexture& state = streamedTexture.second;
+			const _TextureImage& image = *texture->_getStreamSource();
+
+			// Textures which weren't drawn keep what they have, unless it's more than they'd start with
+			unsigned int residentLevel = texture->getResidentLevel();
+			unsigned int targetLevel = state.requestedLevel;
+			if (targetLevel == UINT_MAX)
+			{
+				unsigned int startLevel = _getStreamingStartLevel(image);
+				targetLevel = residentLevel > startLevel ? residentLevel : startLevel;
+			}
+			state.requestedLevel = UINT_MAX;
+
+			if (targetLevel < residentLevel)
+			{
+				// Growing is done straight away so textures sharpen as soon as they're seen, as long as the budget allows
+				state.framesOverRequested = 0;
+				size_t uploadSize = getUploadSize(image, targetLevel);
+				if (uploaded > 0 && uploaded + uploadSize > s_StreamingBudget)
+					continue;
+
+				texture->_setResidentLevel(targetLevel);
+				uploaded += uploadSize;
+			}
+			else if (targetLevel > residentLevel)
+			{
+				// Shrinking waits, so textures moving in and out of view aren't uploaded again and again
+				if (++state.framesOverRequested < s_StreamShrinkFrames)
+					continue;
+
+				state.framesOverRequested = 0;
+				texture->_setResidentLevel(targetLevel);
+				uploaded += getUploadSize(image, targetLevel);
+			}
+			else
+				state.framesOverRequested = 0;
+		}
+	}
+
+}
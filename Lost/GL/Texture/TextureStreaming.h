@@ -0,0 +1,36 @@
+#pragma once
+#include "Texture.h"
+
+namespace lost
+{
+
+	class _TextureImage;
+
+	// Texture streaming keeps only the mip levels that are actually seen uploaded to the GPU
+	// Streamed textures start with just their smallest levels, each frame the renderer works out how large the meshes
+	// using them are on screen, and the levels needed for that are uploaded the next frame, up to a budget of bytes
+	// Levels that haven't been needed for a while are dropped again, the image they came from stays mapped so they can be reuploaded
+	// Only .dds and .ktx2 files with levels of their own are streamed, anything else is always fully uploaded
+
+	// Enables or disables streaming textures loaded from now on, disabling it fully uploads every texture being streamed
+	void setTextureStreaming(bool enabled);
+	bool isTextureStreaming();
+	// Sets how many bytes of levels can be uploaded each frame while streaming, by default 8MB
+	// At least one texture is always grown per frame, even if it's levels are above the budget
+	void setTextureStreamingBudget(unsigned int bytesPerFrame);
+
+	// Returns which of the image's levels streamed textures start at
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	unsigned int _getStreamingStartLevel(const _TextureImage& image);
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _registerStreamedTexture(Texture texture);
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _unregisterStreamedTexture(const _Texture* texture);
+	// Asks for the texture to have enough levels to be drawn pixelsAcross pixels wide, does nothing if it isn't being streamed
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _requestTextureLevel(Texture texture, float pixelsAcross);
+	// Grows textures which were drawn larger than their levels allow, and shrinks ones which haven't been, ran once per frame
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	void _updateTextureStreaming();
+
+}
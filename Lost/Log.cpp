@@ -2,6 +2,7 @@
 #include <cassert>
 #include <Windows.h>
 #include <iostream>
+#include <mutex>
 
 namespace lost
 {
@@ -45,25 +46,32 @@ namespace lost
 
 	std::vector<_Log> _logList;
 
-	const std::vector<_Log>& _getLogList()
+	// Async loader workers log too, so the list, the context and the console output all go through this
+	static std::mutex s_LogMutex;
+
+	std::vector<_Log> _getLogList()
 	{
+		std::lock_guard<std::mutex> lock(s_LogMutex);
 		return _logList;
 	}
 
 	void setLogContext(std::string context)
 	{
+		std::lock_guard<std::mutex> lock(s_LogMutex);
 		_logHasContext = true;
 		_logContext = context;
 	}
 
 	void clearLogContext()
 	{
+		std::lock_guard<std::mutex> lock(s_LogMutex);
 		_logHasContext = false;
 	}
 
 	void log(std::string text, int level)
 	{
 		std::string errorMsg;
+		std::unique_lock<std::mutex> lock(s_LogMutex);
 
 #ifdef LOST_DEBUG_MODE
 		_logList.push_back(_Log{ text, (unsigned int)level });
@@ -81,6 +89,9 @@ namespace lost
 
 			std::cout << "\n" << _terminalSequnceCodes[level] << errorMsg << "\x1B[0m\n" << std::endl;
 
+			// The message box waits on the user, other threads shouldn't be stuck behind it
+			lock.unlock();
+
 			if (level >= LOST_LOG_ERROR)
 			{
 				std::wstring wStrErrorText = std::wstring(errorMsg.begin(), errorMsg.end());
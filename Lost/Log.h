@@ -44,7 +44,8 @@ namespace lost
 		// [?] TODO: Time?
 	};
 
-	const std::vector<_Log>& _getLogList();
+	// Returns a copy, as the list can be written to from other threads
+	std::vector<_Log> _getLogList();
 
 	// Should not be accessed by the user
 	extern bool _logHasContext;
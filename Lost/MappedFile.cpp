@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+#include <string>
+#include "Log.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lost
+{
+
+	_MappedFile::_MappedFile()
+	{
+	}
+
+	_MappedFile::~_MappedFile()
+	{
+		close();
+	}
+
+	bool _MappedFile::open(const char* fileDir)
+	{
+		close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(fileDir, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			log(std::string("File at \"") + fileDir + "\" failed to load.\nFile may be open by another program, missing or inaccessible.", LOST_LOG_ERROR);
+			return false;
+		}
+		m_File = file;
+
+		LARGE_INTEGER size;
+		GetFileSizeEx(file, &size);
+		m_Size = (size_t)size.QuadPart;
+
+		// Empty files can't be mapped, but are still valid
+		if (m_Size == 0)
+			return true;
+
+		m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_Mapping)
+			m_Data = (const char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+		m_File = ::open(fileDir, O_RDONLY);
+		if (m_File == -1)
+		{
+			log(std::string("File at \"") + fileDir + "\" failed to load.\nFile may be open by another program, missing or inaccessible.", LOST_LOG_ERROR);
+			return false;
+		}
+
+		struct stat fileStats;
+		fstat(m_File, &fileStats);
+		m_Size = (size_t)fileStats.st_size;
+
+		// Empty files can't be mapped, but are still valid
+		if (m_Size == 0)
+			return true;
+
+		void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+		if (data != MAP_FAILED)
+		{
+			m_Data = (const char*)data;
+			madvise(data, m_Size, MADV_SEQUENTIAL);
+		}
+#endif
+
+		if (m_Data == nullptr)
+		{
+			log(std::string("File at \"") + fileDir + "\" could not be mapped into memory.", LOST_LOG_ERROR);
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void _MappedFile::close()
+	{
+#ifdef _WIN32
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_Mapping)
+			CloseHandle(m_Mapping);
+		if (m_File)
+			CloseHandle(m_File);
+
+		m_Mapping = nullptr;
+		m_File = nullptr;
+#else
+		if (m_Data)
+			munmap((void*)m_Data, m_Size);
+		if (m_File != -1)
+			::close(m_File);
+
+		m_File = -1;
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+}
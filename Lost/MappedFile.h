@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+
+namespace lost
+{
+
+	// A read only view of a file's contents, mapped straight into memory rather than copied out of it
+	// The operating system pages the file in as it's read, so large files can be scanned without loading them first
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _MappedFile
+	{
+	public:
+		_MappedFile();
+		~_MappedFile();
+
+		// Maps the file at fileDir, closing any file already mapped, returns false and logs the error if it can't be opened
+		bool open(const char* fileDir);
+		// Unmaps the file, any pointers into it become invalid
+		void close();
+
+		// The file's contents, which are not null terminated, nullptr if the file is empty or not open
+		inline const char* getData() const { return m_Data; };
+		inline size_t      getSize() const { return m_Size; };
+	private:
+		const char* m_Data = nullptr;
+		size_t m_Size = 0;
+
+#ifdef _WIN32
+		void* m_File = nullptr;    // HANDLE
+		void* m_Mapping = nullptr; // HANDLE
+#else
+		int m_File = -1;
+#endif
+	};
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace lost
+{
+
+	// The amount of threads busy with background work, the async loader's workers while loading and the extra threads of _parallelRanges()
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	inline std::atomic<unsigned int>& _parallelBusyThreads()
+	{
+		static std::atomic<unsigned int> busyThreads(0);
+		return busyThreads;
+	}
+
+	// If the calling thread is one of the threads counted by _parallelBusyThreads()
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	inline bool& _parallelThreadIsBusy()
+	{
+		thread_local bool busy = false;
+		return busy;
+	}
+
+	// Returns how many ranges "count" items should be split into to be worked on in parallel
+	// Each range has at least "minimumPerRange" items, and there is at most one per hardware thread that isn't already busy
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	inline unsigned int _parallelRangeCount(size_t count, size_t minimumPerRange)
+	{
+		size_t hardwareThreads = std::thread::hardware_concurrency();
+		size_t rangeCount = minimumPerRange > 0 ? count / minimumPerRange : count;
+
+		// Loads running on the async loader's workers would otherwise each start a thread per hardware thread
+		// The calling thread works on a range itself, so it isn't counted against what's free
+		size_t busyThreads = _parallelBusyThreads().load(std::memory_order_relaxed);
+		if (_parallelThreadIsBusy() && busyThreads > 0)
+			busyThreads--;
+		size_t freeThreads = hardwareThreads > busyThreads ? hardwareThreads - busyThreads : 1;
+
+		if (rangeCount > freeThreads)
+			rangeCount = freeThreads;
+		return rangeCount > 1 ? (unsigned int)rangeCount : 1;
+	}
+
+	// Splits [0, count) into "rangeCount" contiguous ranges, running function(begin, end, rangeIndex) on each of them at the same time
+	// The calling thread works on the first range itself, and only returns once every range is done
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	template <typename Function>
+	void _parallelRanges(unsigned int rangeCount, size_t count, Function function)
+	{
+		if (rangeCount <= 1)
+		{
+			function((size_t)0, count, 0u);
+			return;
+		}
+
+		// Counted as busy while they run, so work started on other threads in the meantime leaves them their hardware threads
+		_parallelBusyThreads().fetch_add(rangeCount - 1, std::memory_order_relaxed);
+
+		std::vector<std::thread> workers;
+		workers.reserve(rangeCount - 1);
+		for (unsigned int range = 1; range < rangeCount; range++)
+		{
+			workers.emplace_back([&function, count, range, rangeCount]()
+			{
+				_parallelThreadIsBusy() = true;
+				function(count * range / rangeCount, count * (range + 1) / rangeCount, range);
+			});
+		}
+
+		function((size_t)0, count / rangeCount, 0u);
+
+		for (std::thread& worker : workers)
+			worker.join();
+
+		_parallelBusyThreads().fetch_sub(rangeCount - 1, std::memory_order_relaxed);
+	}
+
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#define LOST_HANDLE_INDEX_BITS 20 // Up to ~1 million of each type of resource alive at once
+#define LOST_HANDLE_INDEX_MASK ((1u << LOST_HANDLE_INDEX_BITS) - 1)
+
+namespace lost
+{
+
+	// A small reference to a resource which knows if the resource has been destroyed
+	// The low 20 bits are the resource's slot, the high 12 bits are the slot's generation which changes every time the slot is reused
+	// 0 is never a valid handle
+	typedef uint32_t ResourceHandle;
+
+	// Gets the slot of the handle given, slots are dense so they can be used as small ids
+	inline unsigned int getHandleIndex(ResourceHandle handle) { return handle & LOST_HANDLE_INDEX_MASK; };
+
+	// Counts every handle released, used to know if any queued handles could have gone stale
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	inline unsigned int& _getHandleReleaseCount()
+	{
+		static unsigned int s_ReleaseCount = 0;
+		return s_ReleaseCount;
+	}
+
+	// Dense array of slots which handles to resources of type T point into
+	// Handles must only be made, released and resolved on the main thread
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	template <typename T>
+	class _HandleTable
+	{
+	public:
+		static inline _HandleTable& get()
+		{
+			static _HandleTable s_Table;
+			return s_Table;
+		}
+
+		inline ResourceHandle create(T value)
+		{
+			unsigned int index;
+			if (!m_FreeSlots.empty())
+			{
+				index = m_FreeSlots.back();
+				m_FreeSlots.pop_back();
+			}
+			else
+			{
+				// Slot 0 is left unused so no handle can ever be 0
+				if (m_Slots.empty())
+					m_Slots.push_back({ nullptr, 1 });
+
+				index = (unsigned int)m_Slots.size();
+				if (index > LOST_HANDLE_INDEX_MASK)
+					return 0;
+				m_Slots.push_back({ nullptr, 1 });
+			}
+
+			m_Slots[index].value = value;
+			return (m_Slots[index].generation << LOST_HANDLE_INDEX_BITS) | index;
+		}
+
+		inline void release(ResourceHandle handle)
+		{
+			if (!isValid(handle))
+				return;
+
+			Slot& slot = m_Slots[getHandleIndex(handle)];
+			slot.value = nullptr;
+			// Generation 0 is skipped when it wraps around so a reused slot never matches a handle of 0
+			slot.generation = (slot.generation + 1) & ((1u << (32 - LOST_HANDLE_INDEX_BITS)) - 1);
+			if (slot.generation == 0)
+				slot.generation = 1;
+
+			m_FreeSlots.push_back(getHandleIndex(handle));
+			_getHandleReleaseCount()++;
+		}
+
+		inline bool isValid(ResourceHandle handle) const
+		{
+			unsigned int index = getHandleIndex(handle);
+			return index != 0 && index < m_Slots.size() && m_Slots[index].generation == (handle >> LOST_HANDLE_INDEX_BITS);
+		}
+
+		// Returns nullptr if the resource the handle pointed to was destroyed
+		inline T resolve(ResourceHandle handle) const
+		{
+			return isValid(handle) ? m_Slots[getHandleIndex(handle)].value : nullptr;
+		}
+	private:
+		struct Slot
+		{
+			T value;
+			unsigned int generation;
+		};
+
+		std::vector<Slot> m_Slots;
+		std::vector<unsigned int> m_FreeSlots;
+	};
+
+	// Held by a resource to own it's handle, the handle is made the first time it's asked for and released with the resource
+	// Copies of a resource are a different resource, so they start without a handle
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	template <typename T>
+	class _OwnedHandle
+	{
+	public:
+		_OwnedHandle() {};
+		_OwnedHandle(const _OwnedHandle&) {};
+		_OwnedHandle& operator=(const _OwnedHandle&) { return *this; };
+		~_OwnedHandle() { release(); };
+
+		inline ResourceHandle get(T owner)
+		{
+			if (m_Handle == 0)
+				m_Handle = _HandleTable<T>::get().create(owner);
+			return m_Handle;
+		}
+
+		inline void release()
+		{
+			if (m_Handle != 0)
+				_HandleTable<T>::get().release(m_Handle);
+			m_Handle = 0;
+		}
+	private:
+		ResourceHandle m_Handle = 0;
+	};
+
+}
@@ -1,30 +1,167 @@
 #pragma once
 #include <vector>
-#include <map>
 #include <string>
+#include <cstdint>
+#include <type_traits>
 #include "State.h"
 #include "Log.h"
 
+// Hashes a string literal into a ResourceID while compiling, so lookups using it never touch the string at runtime
+// e.g. lost::getTexture(LOST_ID("Player"))
+#define LOST_ID(id) (std::integral_constant<lost::ResourceID, lost::_hashResourceID(id)>::value)
+
 namespace lost
 {
 
+	typedef uint64_t ResourceID;
+
+	// 64-bit FNV-1a hash of a resource ID, usable in constant expressions
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	constexpr ResourceID _hashResourceID(const char* id)
+	{
+		ResourceID hash = 14695981039346656037ull;
+		while (*id)
+		{
+			hash ^= (unsigned char)*id++;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Destroys the data held inside of a resource manager once it's count reaches 0
+	// Specialize this for resources which need more cleanup than a delete
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
 	template <typename T>
-	struct DataCount
+	inline void _destroyResource(T value)
 	{
+		delete value;
+	}
+
+	template <typename T>
+	struct ResourceEntry
+	{
+		std::string id;
+		ResourceID hash;
 		T data;
 		unsigned int count = 0;
 	};
 
+	// Open addressing hash table (linear probing) mapping a 64-bit key to an index into a resource manager's entries
+	// NOTE: This is only used inside of the Lost engine, do not run it (unless you know what you're doing)
+	class _ResourceIndex
+	{
+	public:
+		static const unsigned int NotFound = 0xFFFFFFFF;
+
+		inline unsigned int find(uint64_t key) const
+		{
+			if (m_Slots.empty())
+				return NotFound;
+
+			size_t mask = m_Slots.size() - 1;
+			for (size_t i = home(key, mask); m_Slots[i].index != NotFound; i = (i + 1) & mask)
+				if (m_Slots[i].key == key)
+					return m_Slots[i].index;
+			return NotFound;
+		}
+
+		// Inserts the key, or updates the index it points to if it already exists
+		inline void set(uint64_t key, unsigned int index)
+		{
+			// Keep the table at most half full so probe chains stay short
+			if ((m_Count + 1) * 2 > m_Slots.size())
+				grow();
+
+			size_t mask = m_Slots.size() - 1;
+			size_t i = home(key, mask);
+			for (; m_Slots[i].index != NotFound; i = (i + 1) & mask)
+			{
+				if (m_Slots[i].key == key)
+				{
+					m_Slots[i].index = index;
+					return;
+				}
+			}
+			m_Slots[i] = { key, index };
+			m_Count++;
+		}
+
+		inline void erase(uint64_t key)
+		{
+			if (m_Slots.empty())
+				return;
+
+			size_t mask = m_Slots.size() - 1;
+			size_t i = home(key, mask);
+			for (; m_Slots[i].key != key || m_Slots[i].index == NotFound; i = (i + 1) & mask)
+				if (m_Slots[i].index == NotFound)
+					return;
+
+			// Shift the following slots of the probe chain back instead of leaving a tombstone
+			for (size_t j = (i + 1) & mask; m_Slots[j].index != NotFound; j = (j + 1) & mask)
+			{
+				size_t k = home(m_Slots[j].key, mask);
+				bool inRange = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+				if (!inRange)
+				{
+					m_Slots[i] = m_Slots[j];
+					i = j;
+				}
+			}
+			m_Slots[i].index = NotFound;
+			m_Count--;
+		}
+
+		inline void clear()
+		{
+			m_Slots.clear();
+			m_Count = 0;
+		}
+	private:
+		struct Slot
+		{
+			uint64_t key;
+			unsigned int index;
+		};
+
+		// Keys are either FNV hashes or pointers, which both have weak low bits, so they are mixed before masking
+		static inline size_t home(uint64_t key, size_t mask)
+		{
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdull;
+			key ^= key >> 33;
+			return (size_t)key & mask;
+		}
+
+		inline void grow()
+		{
+			std::vector<Slot> old;
+			old.swap(m_Slots);
+			m_Slots.assign(old.empty() ? 16 : old.size() * 2, { 0, NotFound });
+			m_Count = 0;
+			for (const Slot& slot : old)
+				if (slot.index != NotFound)
+					set(slot.key, slot.index);
+		}
+
+		std::vector<Slot> m_Slots;
+		size_t m_Count = 0;
+	};
+
 	template <typename T>
 	class ResourceManager
 	{
 	public:
-		ResourceManager(const char* _typeName = "");
+		// "destroy" is ran on values as they're destroyed, resources which may still be in use can pass a function that defers destroying them
+		// Remaining values are always destroyed straight away with _destroyResource() when the manager is deleted
+		ResourceManager(const char* _typeName = "", void (*destroy)(T) = &_destroyResource<T>);
 		~ResourceManager();
 
 		void addValue(T value, const char* id);
 
 		T getValue(const char* id) const;
+		// Gets a value by it's hashed ID, use LOST_ID() to hash a literal ID while compiling
+		T getValue(ResourceID id) const;
 		const char* getIDByValue(T value) const;
 
 		int getValueCount() const;
@@ -32,123 +169,211 @@ namespace lost
 		// Destroys a value within the resource manager by the ID of the value given
 		// If required use destroyValueByValue() to remove the value from the manager by the value instead
 		void destroyValue(const char* id);
+		void destroyValue(ResourceID id);
 		// Destroys a value within the resource manager
 		void destroyValueByValue(T value);
 
 		void forceDestroyValue(const char* id);
+		void forceDestroyValue(ResourceID id);
 		void forceDestroyValueByValue(T value);
 
-		inline bool hasValue(const char* id) const { return m_Data.count(id); };
+		inline bool hasValue(const char* id) const { return hasValue(_hashResourceID(id)); };
+		inline bool hasValue(ResourceID id) const { return m_IDIndex.find(id) != _ResourceIndex::NotFound; };
 
-		inline const std::map<std::string, DataCount<T>>& getDataMap() const { return m_Data; };
+		// Returns the entry of the ID given or nullptr if it doesn't exist
+		// NOTE: Entries move around when values are destroyed, so don't keep the pointer across frames
+		const ResourceEntry<T>* findEntry(ResourceID id) const;
+		inline const std::vector<ResourceEntry<T>>& getEntries() const { return m_Entries; };
 	private:
-		std::map<std::string, DataCount<T>> m_Data;
+		void destroyEntry(unsigned int index);
+
+		static inline uint64_t valueKey(T value) { return (uint64_t)(uintptr_t)value; };
+
+		// Entries are kept packed, the indices map an ID's hash or a value's pointer to it's place in m_Entries
+		std::vector<ResourceEntry<T>> m_Entries;
+		_ResourceIndex m_IDIndex;
+		_ResourceIndex m_ValueIndex;
 		const char* m_TypeName;
+		void (*m_Destroy)(T);
 	};
 
 	template<typename T>
-	inline ResourceManager<T>::ResourceManager(const char* _typeName)
-		: m_TypeName(_typeName)
+	inline ResourceManager<T>::ResourceManager(const char* _typeName, void (*destroy)(T))
+		: m_TypeName(_typeName), m_Destroy(destroy)
 	{
 	}
 
 	template<typename T>
 	inline ResourceManager<T>::~ResourceManager()
 	{
-		for (typename std::map<std::string, DataCount<T>>::iterator it = m_Data.begin(); it != m_Data.end(); it++)
-			delete it->second.data;
+		for (ResourceEntry<T>& entry : m_Entries)
+			_destroyResource(entry.data);
 
-		debugLog("Successfully destroyed/unloaded all remaining (" + std::to_string(m_Data.size()) + ") " + std::string(m_TypeName), LOST_LOG_SUCCESS);
-		m_Data.clear();
+		debugLog("Successfully destroyed/unloaded all remaining (" + std::to_string(m_Entries.size()) + ") " + std::string(m_TypeName), LOST_LOG_SUCCESS);
+		m_Entries.clear();
+		m_IDIndex.clear();
+		m_ValueIndex.clear();
 	}
 
 	template<typename T>
 	inline void ResourceManager<T>::addValue(T value, const char* id)
 	{
-		unsigned int count = m_Data.count(id) == 0 ? 1 : m_Data[id].count + 1;
-		m_Data[id] = { value, count };
+		ResourceID hash = _hashResourceID(id);
+		unsigned int index = m_IDIndex.find(hash);
+		if (index != _ResourceIndex::NotFound)
+		{
+#ifdef LOST_DEBUG_MODE
+			if (m_Entries[index].id != id)
+				log("Resource ID hash collision between \"" + m_Entries[index].id + "\" and \"" + std::string(id) + "\"", LOST_LOG_ERROR);
+#endif
+			ResourceEntry<T>& entry = m_Entries[index];
+			if (entry.data != value)
+			{
+				m_ValueIndex.erase(valueKey(entry.data));
+				m_ValueIndex.set(valueKey(value), index);
+				entry.data = value;
+			}
+			entry.count++;
+			return;
+		}
+
+		index = (unsigned int)m_Entries.size();
+		m_Entries.push_back({ id, hash, value, 1 });
+		m_IDIndex.set(hash, index);
+
+#ifdef LOST_DEBUG_MODE
+		if (m_ValueIndex.find(valueKey(value)) != _ResourceIndex::NotFound)
+			log("Value added to a resource manager under \"" + std::string(id) + "\" is already stored under another ID", LOST_LOG_WARNING);
+#endif
+		m_ValueIndex.set(valueKey(value), index);
 	}
 
 	template<typename T>
 	inline T ResourceManager<T>::getValue(const char* id) const
 	{
-#ifdef LOST_DEBUG_MODE
-		if (m_Data.count(id) == 0) // Check if key exists
+		const ResourceEntry<T>* entry = findEntry(_hashResourceID(id));
+		if (entry == nullptr)
 		{
-			log("Tried to get a value from a resource manager that didn't exist (" + std::string(id) + ")", LOST_LOG_WARNING);
+			debugLog("Tried to get a value from a resource manager that didn't exist (" + std::string(id) + ")", LOST_LOG_WARNING);
 			return nullptr;
 		}
-#endif
-		return m_Data.at(id).data;
+		return entry->data;
 	}
 
 	template<typename T>
-	inline const char* ResourceManager<T>::getIDByValue(T value) const
+	inline T ResourceManager<T>::getValue(ResourceID id) const
 	{
-		for (typename std::map<std::string, DataCount<T>>::const_iterator it = m_Data.begin(); it != m_Data.end(); it++)
+		const ResourceEntry<T>* entry = findEntry(id);
+		if (entry == nullptr)
 		{
-			if ((it->second).data == value)
-				return it->first.c_str();
+			debugLog("Tried to get a value from a resource manager that didn't exist (hash " + std::to_string(id) + ")", LOST_LOG_WARNING);
+			return nullptr;
 		}
-		return nullptr;
+		return entry->data;
+	}
+
+	template<typename T>
+	inline const char* ResourceManager<T>::getIDByValue(T value) const
+	{
+		unsigned int index = m_ValueIndex.find(valueKey(value));
+		return index != _ResourceIndex::NotFound ? m_Entries[index].id.c_str() : nullptr;
 	}
 
 	template<typename T>
 	inline int ResourceManager<T>::getValueCount() const
 	{
-		return m_Data.size();
+		return m_Entries.size();
+	}
+
+	template<typename T>
+	inline const ResourceEntry<T>* ResourceManager<T>::findEntry(ResourceID id) const
+	{
+		unsigned int index = m_IDIndex.find(id);
+		return index != _ResourceIndex::NotFound ? &m_Entries[index] : nullptr;
+	}
+
+	template<typename T>
+	inline void ResourceManager<T>::destroyEntry(unsigned int index)
+	{
+		T value = m_Entries[index].data;
+		m_IDIndex.erase(m_Entries[index].hash);
+		if (m_ValueIndex.find(valueKey(value)) == index)
+			m_ValueIndex.erase(valueKey(value));
+
+		// Move the last entry into the hole so the entries stay packed
+		unsigned int last = (unsigned int)m_Entries.size() - 1;
+		if (index != last)
+		{
+			m_Entries[index] = std::move(m_Entries[last]);
+			m_IDIndex.set(m_Entries[index].hash, index);
+			if (m_ValueIndex.find(valueKey(m_Entries[index].data)) == last)
+				m_ValueIndex.set(valueKey(m_Entries[index].data), index);
+		}
+		m_Entries.pop_back();
+
+		// Destroyed last as destroying a resource may release others
+		m_Destroy(value);
 	}
 
 	template<typename T>
 	inline void ResourceManager<T>::destroyValue(const char* id)
 	{
-		if (m_Data[id].count == 1)
+		destroyValue(_hashResourceID(id));
+	}
+
+	template<typename T>
+	inline void ResourceManager<T>::destroyValue(ResourceID id)
+	{
+		unsigned int index = m_IDIndex.find(id);
+		if (index == _ResourceIndex::NotFound)
 		{
-			delete m_Data[id].data;
-			m_Data.erase(id);
+			debugLog("Tried to destroy a value from a resource manager that didn't exist (hash " + std::to_string(id) + ")", LOST_LOG_WARNING);
 			return;
 		}
-		m_Data[id].count--;
+
+		if (m_Entries[index].count <= 1)
+		{
+			destroyEntry(index);
+			return;
+		}
+		m_Entries[index].count--;
 	}
 
 	template<typename T>
 	inline void ResourceManager<T>::destroyValueByValue(T value)
 	{
-		for (typename std::map<std::string, DataCount<T>>::iterator it = m_Data.begin(); it != m_Data.end(); it++)
+		unsigned int index = m_ValueIndex.find(valueKey(value));
+		if (index == _ResourceIndex::NotFound)
+			return;
+
+		if (m_Entries[index].count <= 1)
 		{
-			if ((it->second).data == value)
-			{
-				if (it->second.count == 1)
-				{
-					m_Data.erase(it);
-					delete value;
-					break;
-				}
-				it->second.count--;
-			}
+			destroyEntry(index);
+			return;
 		}
+		m_Entries[index].count--;
 	}
 
 	template<typename T>
 	inline void ResourceManager<T>::forceDestroyValue(const char* id)
 	{
-		delete m_Data[id].data;
-		m_Data.erase(id);
-		return;
+		forceDestroyValue(_hashResourceID(id));
+	}
+
+	template<typename T>
+	inline void ResourceManager<T>::forceDestroyValue(ResourceID id)
+	{
+		unsigned int index = m_IDIndex.find(id);
+		if (index != _ResourceIndex::NotFound)
+			destroyEntry(index);
 	}
 
 	template<typename T>
 	inline void ResourceManager<T>::forceDestroyValueByValue(T value)
 	{
-		for (typename std::map<std::string, DataCount<T>>::iterator it = m_Data.begin(); it != m_Data.end(); it++)
-		{
-			if ((it->second).data == value)
-			{
-				m_Data.erase(it);
-				delete value;
-				break;
-			}
-		}
+		unsigned int index = m_ValueIndex.find(valueKey(value));
+		if (index != _ResourceIndex::NotFound)
+			destroyEntry(index);
 	}
 
-}
\ No newline at end of file
+}
@@ -24,6 +24,8 @@ namespace lost
 
 	void exit()
 	{
+		// Stop loading in the background before anything being loaded into is destroyed
+		lost::_exitAsyncLoader();
 		lost::_exitAudio();
 		lost::_exitGL();
 	}
@@ -8,6 +8,8 @@
 #include "Audio/Audio.h"
 #include "Input/Input.h"
 #include "DeltaTime.h"
+#include "AsyncLoader.h"
+#include "GL/Texture/TextureStreaming.h"
 
 namespace lost
 {
@@ -10,6 +10,7 @@
 #include "imgui/imgui_internal.h"
 
 #include "GL/Renderer.h"
+#include "GL/GLStateCache.h"
 #include "DeltaTime.h"
 
 #include <tchar.h>
@@ -687,8 +688,8 @@ namespace lost
 
 	struct _imGuiTextureViewer
 	{
-		_imGuiTextureViewer(typename std::map<std::string, DataCount<Texture>>::const_iterator tex)
-			: value{ tex }
+		_imGuiTextureViewer(ResourceID tex)
+			: textureID{ tex }
 		{
 
 		};
@@ -700,26 +701,34 @@ namespace lost
 
 		void render(int id)
 		{
+			// Close the viewer if the texture was unloaded
+			const ResourceEntry<Texture>* value = _textureRM->findEntry(textureID);
+			if (value == nullptr)
+			{
+				shouldBeOpen = false;
+				return;
+			}
+
 			ImGui::PushID(id);
-			ImGui::Begin((std::string("Texture Viewer: ") + value->first + "##" + value->first).c_str(), &shouldBeOpen, 0);
+			ImGui::Begin((std::string("Texture Viewer: ") + value->id + "##" + value->id).c_str(), &shouldBeOpen, 0);
 
 			ImVec2 bounds = ImGui::GetWindowSize();
 
-			float aspect = (float)value->second.data->getHeight() / (float)value->second.data->getWidth();
+			float aspect = (float)value->data->getHeight() / (float)value->data->getWidth();
 			float imageScaleX = bounds.x * imageRatio;
 			float imageScaleY = bounds.y / aspect - (ImGui::GetWindowSize().y - ImGui::GetContentRegionAvail().y);
 			float imageScale = fminf(imageScaleX, imageScaleY);
 
-			ImGui::Image((ImTextureID)(intptr_t)(value->second.data->getTexture()), { imageScale, imageScale * aspect });
+			ImGui::Image((ImTextureID)(intptr_t)(value->data->getTexture()), { imageScale, imageScale * aspect });
 
 			ImGui::SameLine();
 			ImGui::BeginGroup();
 
 			ImGui::SeparatorText("Image Info");
-			ImGui::Text("Image ID: %s", value->first.c_str());
-			ImGui::Text("Image Location: %s", value->second.data->getDirectory());
+			ImGui::Text("Image ID: %s", value->id.c_str());
+			ImGui::Text("Image Location: %s", value->data->getDirectory());
 
-			bool isLoadedImage = std::string(value->second.data->getDirectory()) == "No directory";
+			bool isLoadedImage = std::string(value->data->getDirectory()) == "No directory";
 
 			// Change image file
 			ImGui::BeginDisabled(isLoadedImage);
@@ -730,17 +739,17 @@ namespace lost
 				if (!fileSelected.empty())
 				{
 					// Swap image
-					value->second.data->loadTexture(fileSelected.c_str());
+					value->data->loadTexture(fileSelected.c_str());
 				}
 			}
 
 			if (ImGui::Button("Reload Image", { ImGui::GetContentRegionAvail().x, 0 }))
-				value->second.data->loadTexture(value->second.data->getDirectory());
+				value->data->loadTexture(value->data->getDirectory());
 			ImGui::EndDisabled();
 
 			ImGui::SeparatorText("Image Data");
-			ImGui::Text("Width: %i", value->second.data->getWidth());
-			ImGui::Text("Height: %i", value->second.data->getHeight());
+			ImGui::Text("Width: %i", value->data->getWidth());
+			ImGui::Text("Height: %i", value->data->getHeight());
 
 			ImGui::EndGroup();
 
@@ -751,7 +760,7 @@ namespace lost
 		float imageRatio = 0.4;
 
 		bool shouldBeOpen = true;
-		typename std::map<std::string, DataCount<Texture>>::const_iterator value;
+		ResourceID textureID;
 	};
 
 	std::vector<_imGuiTextureViewer*> textureViews;
@@ -957,7 +966,7 @@ namespace lost
 
 	std::map<std::string, UniformSelection> uniformSelectors;
 
-	lost::PlaybackSound* lastSoundPlayed = nullptr;
+	lost::VoiceHandle lastSoundPlayed = 0;
 	lost::SoundStream lastSoundStreamPlayed = nullptr;
 
 	// Is ran inside of a child window
@@ -974,7 +983,7 @@ namespace lost
 		int yPos = ImGui::GetCursorPosY();
 
 		// Loop through all loaded textures
-		const std::map<std::string, DataCount<Texture>>& dataMap = _textureRM->getDataMap();
+		const std::vector<ResourceEntry<Texture>>& dataMap = _textureRM->getEntries();
 
 		if (dataMap.empty())
 		{
@@ -983,13 +992,13 @@ namespace lost
 		}
 
 		int index = 0;
-		for (typename std::map<std::string, DataCount<Texture>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<Texture>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
 		{
 			ImGui::PushID(index);
 
 			// If any of the buttons are pressed create a texture view window
-			if (ImGui::ImageButton("Box", (ImTextureID)(intptr_t)(it->second.data->getTexture()), buttonSize))
-				textureViews.push_back(new _imGuiTextureViewer(it));
+			if (ImGui::ImageButton("Box", (ImTextureID)(intptr_t)(it->data->getTexture()), buttonSize))
+				textureViews.push_back(new _imGuiTextureViewer(it->hash));
 
 			// Wrap the buttons around the size of the window
 			float lastButtonXMax = ImGui::GetItemRectMax().x;
@@ -1018,23 +1027,23 @@ namespace lost
 	// Is ran inside of a child window
 	void _imGuiDisplayMaterialAssetList()
 	{
-		const std::map<std::string, DataCount<Material>>& dataMap = _materialRM->getDataMap();
+		const std::vector<ResourceEntry<Material>>& dataMap = _materialRM->getEntries();
 		if (dataMap.empty())
 		{
 			ImGui::TextDisabled("No Materials Loaded...");
 			return;
 		}
 
-		for (typename std::map<std::string, DataCount<Material>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<Material>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
 		{
-			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->first + "##MaterialPreview").c_str(), it->first.c_str());
+			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->id + "##MaterialPreview").c_str(), it->id.c_str());
 			if (isOpen)
 			{
 				// Display material settings, the stuff that won't change
 				ImGui::SeparatorText("Material Settings");
-				ImGui::Text("Material ID: %s", it->first.c_str());
+				ImGui::Text("Material ID: %s", it->id.c_str());
 
-				const char* shaderName = lost::_getShaderID(it->second.data->getShader());
+				const char* shaderName = lost::_getShaderID(it->data->getShader());
 				ImGui::Text("Shader:");
 				ImGui::SameLine();
 				if (shaderName != nullptr)
@@ -1053,25 +1062,25 @@ namespace lost
 				// Loop over the texture slots of the shader
 				ImVec2 hoverToolTipSize = { 300.0f, 300.0f };
 
-				const std::map<std::string, unsigned int>& shaderTextureNameMap = it->second.data->getShader()->getTextureNameMap();
+				const std::map<std::string, unsigned int>& shaderTextureNameMap = it->data->getShader()->getTextureNameMap();
 				for (typename std::map<std::string, unsigned int>::const_iterator shaderIt = shaderTextureNameMap.begin(); shaderIt != shaderTextureNameMap.end(); shaderIt++)
 				{
 					ImGui::BulletText("(%i) %s:", shaderIt->second, shaderIt->first.c_str());
 					ImGui::SameLine();
-					const char* textureID = lost::_getTextureID(it->second.data->getTexture(shaderIt->first.c_str()));
+					const char* textureID = lost::_getTextureID(it->data->getTexture(shaderIt->first.c_str()));
 					if (textureID != nullptr)
 					{
 						ImGui::TextColored(ImColor(135, 191, 255, 255), textureID);
 						if (ImGui::BeginItemTooltip())
 						{
-							ImGui::Image((ImTextureID)(intptr_t)(it->second.data->getTexture(shaderIt->first.c_str())->getTexture()), hoverToolTipSize);
+							ImGui::Image((ImTextureID)(intptr_t)(it->data->getTexture(shaderIt->first.c_str())->getTexture()), hoverToolTipSize);
 							ImGui::EndTooltip();
 						}
 					}
 					else
 					{
 						// Check if the image used is nullptr, meaning it doesn't exist at all
-						if (it->second.data->getTexture(shaderIt->first.c_str()) == nullptr)
+						if (it->data->getTexture(shaderIt->first.c_str()) == nullptr)
 						{
 							ImGui::TextColored(ImColor(80, 107, 138, 255), "(null)");
 							ImGui::SetItemTooltip("This texture slot is empty, this may cause issues");
@@ -1089,7 +1098,7 @@ namespace lost
 				ImGui::SeparatorText("Material Uniforms");
 #pragma region MaterialUniforms
 
-				const std::vector<lost::MaterialUniform>& materialUniformList = it->second.data->getMaterialUniforms();
+				const std::vector<lost::MaterialUniform>& materialUniformList = it->data->getMaterialUniforms();
 				if (!materialUniformList.empty()) // Check if the material has any set uniforms
 				{
 					for (const lost::MaterialUniform& uniform : materialUniformList)
@@ -1216,7 +1225,7 @@ namespace lost
 				ImGui::SameLine();
 				{
 					int item_current = 1;
-					switch (it->second.data->getFaceCullMode())
+					switch (it->data->getFaceCullMode())
 					{
 					case LOST_CULL_NONE:
 						item_current = 0;
@@ -1244,11 +1253,11 @@ namespace lost
 					ImGui::Combo("##Cull Func", &item_current, items, IM_ARRAYSIZE(items), 4);
 
 					if (item_old != item_current)
-						it->second.data->setFaceCullMode(enumVals[item_current]);
+						it->data->setFaceCullMode(enumVals[item_current]);
 
 					ImGui::SameLine();
 					ImGui::TextDisabled("(?)");
-					switch (it->second.data->getFaceCullMode())
+					switch (it->data->getFaceCullMode())
 					{
 					case LOST_CULL_AUTO:
 						ImGui::SetItemTooltip("This value is reserved for the renderer's \"Cull Override\"");
@@ -1278,7 +1287,7 @@ namespace lost
 				ImGui::SameLine();
 				{
 					int item_current = 1;
-					switch (it->second.data->getDepthTestFunc())
+					switch (it->data->getDepthTestFunc())
 					{
 					case LOST_DEPTH_TEST_NEVER:
 						item_current = 0;
@@ -1322,11 +1331,11 @@ namespace lost
 					ImGui::Combo("##Depth Test Func", &item_current, items, IM_ARRAYSIZE(items), 4);
 
 					if (item_old != item_current)
-						it->second.data->setDepthTestFunc(enumVals[item_current]);
+						it->data->setDepthTestFunc(enumVals[item_current]);
 
 					ImGui::SameLine();
 					ImGui::TextDisabled("(?)");
-					switch (it->second.data->getDepthTestFunc())
+					switch (it->data->getDepthTestFunc())
 					{
 					case LOST_DEPTH_TEST_LEQUAL:
 						ImGui::SetItemTooltip("Only renders the pixel if the depth is less than or equal to the depth buffer");
@@ -1369,10 +1378,10 @@ namespace lost
 				ImGui::SameLine();
 
 				// Toggle box for depth write
-				bool depthWrite = it->second.data->getDepthWrite();
+				bool depthWrite = it->data->getDepthWrite();
 				ImGui::Checkbox("##depthWrite", &depthWrite);
-				if (depthWrite != it->second.data->getDepthWrite())
-					it->second.data->setDepthWrite(depthWrite);
+				if (depthWrite != it->data->getDepthWrite())
+					it->data->setDepthWrite(depthWrite);
 				ImGui::SameLine();
 
 				if (depthWrite)
@@ -1391,10 +1400,10 @@ namespace lost
 				ImGui::Text("Queue Level:");
 				ImGui::SameLine();
 
-				int queueLevel = it->second.data->getQueueLevel();
+				int queueLevel = it->data->getQueueLevel();
 				ImGui::DragInt("##queueSet", &queueLevel);
-				if (it->second.data->getQueueLevel() != queueLevel)
-					it->second.data->setQueueLevel(queueLevel);
+				if (it->data->getQueueLevel() != queueLevel)
+					it->data->setQueueLevel(queueLevel);
 
 				// ZSort Mode
 				// [!] TODO: Add ZSort modes
@@ -1403,7 +1412,7 @@ namespace lost
 				ImGui::SameLine();
 				{
 					int item_current = 1;
-					switch (it->second.data->getZSortMode())
+					switch (it->data->getZSortMode())
 					{
 					case LOST_ZSORT_NORMAL:
 						item_current = 0;
@@ -1427,11 +1436,11 @@ namespace lost
 					ImGui::Combo("##ZSort Func", &item_current, items, IM_ARRAYSIZE(items), 4);
 
 					if (item_old != item_current)
-						it->second.data->setZSortMode(enumVals[item_current]);
+						it->data->setZSortMode(enumVals[item_current]);
 
 					ImGui::SameLine();
 					ImGui::TextDisabled("(?)");
-					switch (it->second.data->getZSortMode())
+					switch (it->data->getZSortMode())
 					{
 					case LOST_ZSORT_NORMAL:
 						ImGui::SetItemTooltip("Sorts into the most optimal order when rendering\nDoes not preserve the order things are rendered or allow for transparency");
@@ -1457,31 +1466,51 @@ namespace lost
 
 	void _imGuiDisplayMeshAssetList()
 	{
-		const std::map<std::string, DataCount<Mesh>>& dataMap = _meshRM->getDataMap();
+		const std::vector<ResourceEntry<Mesh>>& dataMap = _meshRM->getEntries();
 		if (dataMap.empty())
 		{
 			ImGui::TextDisabled("No Meshes Loaded...");
 			return;
 		}
 
-		for (typename std::map<std::string, DataCount<Mesh>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<Mesh>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
 		{
-			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->first + "##MeshPreview").c_str(), it->first.c_str());
+			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->id + "##MeshPreview").c_str(), it->id.c_str());
 			if (isOpen)
 			{
-				CompiledMeshData* mesh = (CompiledMeshData*)(it->second.data);
-
-				// [!] TODO: Refactor meshes, they need to have their own VBO or
-				// [!]       a shared VBO that is spread across every loaded mesh
-				// [!]       storing an index for where to find the mesh in the
-				// [!]       list, this makes unloading meshes hard but saves on
-				// [!]       data transfers and API Calls
+				CompiledMeshData* mesh = (CompiledMeshData*)(it->data);
 
 				ImGui::SeparatorText("Mesh Info");
 				ImGui::Text("Verticies:");
 				ImGui::SameLine();
 				ImGui::TextColored(ImColor(135, 191, 255, 255), "%i", mesh->indexData.size());
 
+				ImGui::Text("GPU Resident:");
+				ImGui::SameLine();
+				if (mesh->resident)
+				{
+					ImGui::TextColored(ImColor(135, 191, 255, 255), "Yes");
+					ImGui::SetItemTooltip("Stored in the mesh arena at vertex %u, index %u", mesh->baseVertex, mesh->firstIndex);
+				}
+				else
+					ImGui::TextColored(ImColor(80, 107, 138, 255), "No");
+
+				ImGui::Text("Vertex Layout:");
+				ImGui::SameLine();
+				switch (mesh->vertexLayout)
+				{
+				case LOST_VERTEX_LAYOUT_COMPACT:
+					ImGui::TextColored(ImColor(135, 191, 255, 255), "Compact");
+					break;
+				case LOST_VERTEX_LAYOUT_2D:
+					ImGui::TextColored(ImColor(135, 191, 255, 255), "2D");
+					break;
+				default:
+					ImGui::TextColored(ImColor(135, 191, 255, 255), "Full");
+					break;
+				}
+				ImGui::SetItemTooltip("%u bytes per vertex", _getVertexStride(mesh->vertexLayout));
+
 				ImGui::Text("Render Mode:");
 				ImGui::SameLine();
 				switch (mesh->meshRenderMode)
@@ -1526,33 +1555,33 @@ namespace lost
 
 	void _imGuiDisplayShaderAssetList()
 	{
-		const std::map<std::string, DataCount<Shader>>& dataMap = _shaderRM->getDataMap();
+		const std::vector<ResourceEntry<Shader>>& dataMap = _shaderRM->getEntries();
 		if (dataMap.empty())
 		{
 			ImGui::TextDisabled("No Shaders Loaded...");
 			return;
 		}
 
-		for (typename std::map<std::string, DataCount<Shader>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<Shader>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
 		{
-			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->first + "##ShaderPreview").c_str(), it->first.c_str());
+			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->id + "##ShaderPreview").c_str(), it->id.c_str());
 			if (isOpen)
 			{
 				ImGui::SeparatorText("Shader Info");
 
 				ImGui::Text("Name:");
 				ImGui::SameLine();
-				ImGui::TextColored(ImColor(135, 191, 255, 255), it->first.c_str());
+				ImGui::TextColored(ImColor(135, 191, 255, 255), it->id.c_str());
 
 				// Get the file location text, if it's nullptr returning it with in-build
-				const char* vertDir = it->second.data->getVertexDir();
+				const char* vertDir = it->data->getVertexDir();
 				vertDir = vertDir == nullptr ? "In-built" : vertDir;
-				const char* fragDir = it->second.data->getFragmentDir();
+				const char* fragDir = it->data->getFragmentDir();
 				fragDir = fragDir == nullptr ? "In-built" : fragDir;
 
-				const char* vertSource = it->second.data->getVertexSource();
+				const char* vertSource = it->data->getVertexSource();
 				vertSource = vertSource == nullptr ? "Unknown source..." : vertSource;
-				const char* fragSource = it->second.data->getFragmentSource();
+				const char* fragSource = it->data->getFragmentSource();
 				fragSource = fragSource == nullptr ? "Unknown source..." : fragSource;
 
 				ImGui::Text("Vertex Shader:");
@@ -1563,11 +1592,11 @@ namespace lost
 				ImGui::TextColored(ImColor(135, 191, 255, 255), fragDir);
 
 				if (ImGui::Button("Reload Shader", { ImGui::GetContentRegionAvail().x, 0 }))
-					it->second.data->reloadShader();
+					it->data->reloadShader();
 
 				ImGui::SeparatorText("Texture Slots");
 				// Loop over texture slots in shader
-				const std::map<std::string, unsigned int>& textureSlots = it->second.data->getTextureNameMap();
+				const std::map<std::string, unsigned int>& textureSlots = it->data->getTextureNameMap();
 				for (typename std::map<std::string, unsigned int>::const_iterator texIt = textureSlots.begin(); texIt != textureSlots.end(); texIt++)
 				{
 					ImGui::Bullet();
@@ -1580,7 +1609,7 @@ namespace lost
 
 				ImGui::SeparatorText("Uniforms");
 				// Loop over uniforms in shader
-				const std::map<std::string, lost::_Shader::UniformData>& uniforms = it->second.data->getUniformNameMap();
+				const std::map<std::string, lost::_Shader::UniformData>& uniforms = it->data->getUniformNameMap();
 
 				std::vector<const char*> nameList;
 				std::vector<const lost::_Shader::UniformData*> uniformList;
@@ -1648,17 +1677,17 @@ namespace lost
 						int* currentItem = nullptr;
 						UniformSelection* selection = nullptr;
 
-						if (uniformSelectors.count(it->first) > 0)
+						if (uniformSelectors.count(it->id) > 0)
 						{
-							currentItem = &(uniformSelectors[it->first].selectedUniformIndex);
-							selection = &uniformSelectors[it->first];
+							currentItem = &(uniformSelectors[it->id].selectedUniformIndex);
+							selection = &uniformSelectors[it->id];
 						}
 						else
 						{
-							uniformSelectors[it->first] = UniformSelection{};
-							currentItem = &(uniformSelectors[it->first].selectedUniformIndex);
+							uniformSelectors[it->id] = UniformSelection{};
+							currentItem = &(uniformSelectors[it->id].selectedUniformIndex);
 
-							selection = &uniformSelectors[it->first];
+							selection = &uniformSelectors[it->id];
 							selection->selectedUniformIndex = 0;
 						}
 
@@ -1694,31 +1723,31 @@ namespace lost
 							case LOST_TYPE_VEC2:
 							case LOST_TYPE_VEC3:
 							case LOST_TYPE_VEC4:
-								glGetUniformfv(it->second.data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, selection->fv);
+								glGetUniformfv(it->data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, selection->fv);
 								break;
 							case LOST_TYPE_INT:
 							case LOST_TYPE_IVEC2:
 							case LOST_TYPE_IVEC3:
 							case LOST_TYPE_IVEC4:
-								glGetUniformiv(it->second.data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, selection->iv);
+								glGetUniformiv(it->data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, selection->iv);
 								break;
 							case LOST_TYPE_UINT:
 							case LOST_TYPE_UVEC2:
 							case LOST_TYPE_UVEC3:
 							case LOST_TYPE_UVEC4:
-								glGetUniformuiv(it->second.data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, selection->uiv);
+								glGetUniformuiv(it->data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, selection->uiv);
 								break;
 							//case LOST_DOUBLE:
 							//case LOST_DVEC2:
 							//case LOST_DVEC3:
 							//case LOST_DVEC4:
-							//	glGetUniformdv(it->second.data->getShaderID(), (*uniformList.at(*currentItem)).location, selection->dv);
+							//	glGetUniformdv(it->data->getShaderID(), (*uniformList.at(*currentItem)).location, selection->dv);
 							//	break;
 							case LOST_TYPE_BOOL:
 							case LOST_TYPE_BVEC2:
 							case LOST_TYPE_BVEC3:
 							case LOST_TYPE_BVEC4:
-								glGetUniformiv(it->second.data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, (int*)selection->bv);
+								glGetUniformiv(it->data->getShaderID(), (*uniformList.at(*currentItem)).location + selection->offset, (int*)selection->bv);
 								break;
 							default:
 								break;
@@ -1804,7 +1833,7 @@ namespace lost
 						ImGui::BeginDisabled(selection->liveSet);
 						if (ImGui::Button("Set!"))
 						{
-							it->second.data->setUniform((void*)(selection->fv), (*uniformList.at(*currentItem)).location, (*uniformList.at(*currentItem)).type, 1, selection->offset);
+							it->data->setUniform((void*)(selection->fv), (*uniformList.at(*currentItem)).location, (*uniformList.at(*currentItem)).type, 1, selection->offset);
 						}
 						ImGui::EndDisabled();
 
@@ -1820,7 +1849,7 @@ namespace lost
 						ImGui::SetItemTooltip("Sets the uniform as the setting changes, this setting turns off if you change the selected uniform");
 						if (change && selection->liveSet)
 						{
-							it->second.data->setUniform((void*)(selection->fv), (*uniformList.at(*currentItem)).location, (*uniformList.at(*currentItem)).type, 1, selection->offset);
+							it->data->setUniform((void*)(selection->fv), (*uniformList.at(*currentItem)).location, (*uniformList.at(*currentItem)).type, 1, selection->offset);
 						}
 					}
 					else
@@ -1839,7 +1868,7 @@ namespace lost
 
 	void _imGuiDisplayFontAssetList()
 	{
-		const std::map<std::string, DataCount<Font>>& dataMap = _fontRM->getDataMap();
+		const std::vector<ResourceEntry<Font>>& dataMap = _fontRM->getEntries();
 
 		if (dataMap.empty())
 		{
@@ -1847,18 +1876,18 @@ namespace lost
 			return;
 		}
 
-		for (typename std::map<std::string, DataCount<Font>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<Font>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
 		{
-			const Font font = it->second.data;
+			const Font font = it->data;
 
-			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->first + "##FontPreview").c_str(), it->first.c_str());
+			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->id + "##FontPreview").c_str(), it->id.c_str());
 			if (isOpen)
 			{
 				ImGui::SeparatorText("Font Info");
 
 				ImGui::Text("ID:");
 				ImGui::SameLine();
-				ImGui::TextColored(ImColor(135, 191, 255, 255), it->first.c_str());
+				ImGui::TextColored(ImColor(135, 191, 255, 255), it->id.c_str());
 
 				ImGui::Text("Font Height:");
 				ImGui::SameLine();
@@ -1885,7 +1914,7 @@ namespace lost
 
 	void _imGuiDisplayPostProcessingShaderAssetList()
 	{
-		const std::map<std::string, DataCount<PostProcessingShader>>& dataMap = _postProcessingShaderRM->getDataMap();
+		const std::vector<ResourceEntry<PostProcessingShader>>& dataMap = _postProcessingShaderRM->getEntries();
 
 		if (dataMap.empty())
 		{
@@ -1893,9 +1922,9 @@ namespace lost
 			return;
 		}
 
-		for (typename std::map<std::string, DataCount<PostProcessingShader>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<PostProcessingShader>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
 		{
-			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->first + "##PostProcessingShaderPreview").c_str(), it->first.c_str());
+			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->id + "##PostProcessingShaderPreview").c_str(), it->id.c_str());
 			if (isOpen)
 			{
 				ImGui::SeparatorText("Post-processing Shader Info");
@@ -1909,7 +1938,7 @@ namespace lost
 
 		if (LOST_LOG_QUEUE_SIZE > 0) // Check if there is a log queue
 		{
-			const std::vector<_Log>& logList = lost::_getLogList();
+			const std::vector<_Log> logList = lost::_getLogList();
 
 			float offset = 0;
 			ImVec2 cursorPos = ImGui::GetCursorScreenPos();
@@ -1975,7 +2004,7 @@ namespace lost
 	{
 		ImGui::SeparatorText("Sounds (Loaded onto RAM)");
 
-		const std::map<std::string, DataCount<Sound>>& dataMap = _soundRM->getDataMap();
+		const std::vector<ResourceEntry<Sound>>& dataMap = _soundRM->getEntries();
 
 		if (dataMap.empty())
 		{
@@ -1984,22 +2013,22 @@ namespace lost
 		else
 		{
 			if (!lost::isSoundPlaying(lastSoundPlayed))
-				lastSoundPlayed = nullptr;
+				lastSoundPlayed = 0;
 
-			ImGui::BeginDisabled(lastSoundPlayed == nullptr);
+			ImGui::BeginDisabled(lastSoundPlayed == 0);
 			if (ImGui::Button("Stop last sound played", ImVec2(ImGui::GetContentRegionAvail().x, 0)))
 			{
 				lost::stopSound(lastSoundPlayed);
-				lastSoundPlayed = nullptr;
+				lastSoundPlayed = 0;
 			}
 			ImGui::EndDisabled();
 		}
 
-		for (typename std::map<std::string, DataCount<Sound>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<Sound>>::const_iterator it = dataMap.begin(); it != dataMap.end(); it++)
 		{
-			const Sound sound = it->second.data;
+			const Sound sound = it->data;
 
-			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->first + "##SoundPreview").c_str(), it->first.c_str());
+			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->id + "##SoundPreview").c_str(), it->id.c_str());
 			if (isOpen)
 			{
 				ImGui::SeparatorText("Sound Info");
@@ -2013,7 +2042,7 @@ namespace lost
 
 				ImGui::Text("ID:");
 				ImGui::SameLine();
-				ImGui::TextColored(ImColor(135, 191, 255, 255), it->first.c_str());
+				ImGui::TextColored(ImColor(135, 191, 255, 255), it->id.c_str());
 
 				// Playtime in seconds
 				float playTime = (float)sound->_getSoundInfo().sampleCount / (float)sound->_getSoundInfo().sampleRate;
@@ -2052,7 +2081,7 @@ namespace lost
 
 		ImGui::SeparatorText("Sound Streams");
 
-		const std::map<std::string, DataCount<SoundStream>>& streamDataMap = _streamRM->getDataMap();
+		const std::vector<ResourceEntry<SoundStream>>& streamDataMap = _streamRM->getEntries();
 
 		if (streamDataMap.empty())
 		{
@@ -2072,11 +2101,11 @@ namespace lost
 			ImGui::EndDisabled();
 		}
 
-		for (typename std::map<std::string, DataCount<SoundStream>>::const_iterator it = streamDataMap.begin(); it != streamDataMap.end(); it++)
+		for (typename std::vector<ResourceEntry<SoundStream>>::const_iterator it = streamDataMap.begin(); it != streamDataMap.end(); it++)
 		{
-			const SoundStream stream = it->second.data;
+			const SoundStream stream = it->data;
 
-			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->first + "##SoundPreview").c_str(), it->first.c_str());
+			bool isOpen = ImGui::BeginCollapsingHeaderEx((it->id + "##SoundPreview").c_str(), it->id.c_str());
 			if (isOpen)
 			{
 				ImGui::SeparatorText("Sound Info");
@@ -2091,7 +2120,7 @@ namespace lost
 
 				ImGui::Text("ID:");
 				ImGui::SameLine();
-				ImGui::TextColored(ImColor(135, 191, 255, 255), it->first.c_str());
+				ImGui::TextColored(ImColor(135, 191, 255, 255), it->id.c_str());
 
 				// Playtime in seconds
 				float playTime = (float)stream->_getSoundInfo().sampleCount / (float)stream->_getSoundInfo().sampleRate;
@@ -2213,6 +2242,9 @@ namespace lost
 			else
 				ImGui::Text("2D");
 
+			lost::GLStateStats stateStats = lost::getGLStateStats();
+			ImGui::Text("State Changes: %u made / %u skipped (last frame)", stateStats.callsMade, stateStats.callsSaved);
+
 			ImGui::Text("Available Output Passes:");
 			for (int i = 0; i < state.currentBuffers.size(); i++)
 			{